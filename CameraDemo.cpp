@@ -21,6 +21,7 @@
 #include "Camera.h"
 #include "skinnedmesh.h"
 #include "mesh.h"
+#include "Waves.h"
 
 
 long long m_startTime;
@@ -71,6 +72,10 @@ private:
 */
 	Camera mCam;
 	POINT mLastMousePos;
+	Assimp::AsyncImporter mAsyncImporter;
+	TexturePathResolver mTextureResolver;
+	// shared by all meshes, so atlases they have in common are loaded once
+	TextureCache* mTextureCache;
 };
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
@@ -90,16 +95,22 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 }
  
 CameraApp::CameraApp(HINSTANCE hInstance)
-: D3DApp(hInstance)
+: D3DApp(hInstance), skinnedmesh(0), mTextureResolver("assert"), mTextureCache(0)
 {
 	mMainWndCaption = L"Camera Demo";
 	mLastMousePos.x = 0;
 	mLastMousePos.y = 0;
 	mCam.SetPosition(0.0f, 10.0f, 20.0f);	
+	// block compressed with mips by 'assimp bake', loaded without decoding
+	mTextureResolver.SetPreferredExtension(".dds");
 }
 
 CameraApp::~CameraApp()
 {
+	// cancels a pending load before mAsyncImporter goes away
+	delete skinnedmesh;
+	delete mTextureCache;
+	mTextureResolver.SaveCache("TexturePaths.cache");
 	/*
 	ReleaseCOM(mBrickTexSRV);*/
 
@@ -119,9 +130,17 @@ bool CameraApp::Init()
 		L"Textures/floor.dds", 0, 0, &mFloorTexSRV, 0 ));
 	BuildSkullGeometryBuffers();
 	*/
+	// a warm start resolves the textures without scanning assert
+	mTextureResolver.LoadCache("TexturePaths.cache");
+	mTextureCache = new TextureCache(new D3D11TextureBackend(md3dDevice));
 	skinnedmesh = new SkinnedMesh();
 	skinnedmesh->Init(md3dDevice);
-	skinnedmesh->LoadMesh("assert\\mesh\\cloud_all_action.DAE");
+	skinnedmesh->SetTextureResolver(&mTextureResolver);
+	skinnedmesh->SetTextureCache(mTextureCache);
+	// 24 instead of 52 bytes per vertex, see SkinnedVertex.h
+	skinnedmesh->SetVertexFormat(SKINNED_VERTEX_PACKED);
+	// streamed in the background, UpdateScene picks it up once it is ready
+	skinnedmesh->LoadMeshAsync(mAsyncImporter, "assert\\mesh\\cloud_all_action.DAE");
 
 	AnimationFrame af;
 
@@ -197,6 +216,11 @@ void CameraApp::UpdateScene(float dt)
 	XMFLOAT4X4 worldpos;
 	XMStoreFloat4x4(&worldpos, world);
 	skinnedmesh->Update(dt, worldpos);
+	skinnedmesh->FinishLoadMesh();
+	if (!skinnedmesh->IsLoaded())
+	{
+		return;
+	}
 	if (GetAsyncKeyState('M') & 0x8000)
 	{
 		skinnedmesh->m_CurrentAction = "run";
@@ -258,7 +282,26 @@ void CameraApp::UpdateScene(float dt)
 		m_startTime = (double)GetCurrentTimeMillis();
 	}
 	
+	if (GetAsyncKeyState('Q') & 1)
+	{
+		skinnedmesh->SetDualQuatSkinning(!skinnedmesh->GetDualQuatSkinning());
+	}
 	skinnedmesh->BoneTransform(RunningTime, skinnedmesh->Transforms);
+	if (skinnedmesh->GetDualQuatSkinning())
+	{
+		skinnedmesh->BoneTransformDualQuat(RunningTime, skinnedmesh->DualQuatTransforms);
+	}
+	// CPU skinning throughput in the current pose
+	if (GetAsyncKeyState('K') & 1)
+	{
+		skinnedmesh->BenchmarkCpuSkinning(100);
+	}
+	// Waves simulation against its scalar reference, then its throughput on large grids
+	if (GetAsyncKeyState('J') & 1)
+	{
+		printf("Waves deviation from the scalar update %g\n", Waves::CompareWithReference(517, 263, 200));
+		Waves::Benchmark(20);
+	}
 }
 void CameraApp::DrawScene()
 {
@@ -269,7 +312,10 @@ void CameraApp::DrawScene()
 	//md3dImmediateContext->OMSetDepthStencilState(RenderStates::MarkMirrorDSS, 1);
 	//md3dImmediateContext->OMSetDepthStencilState(0, 0);
 	//background_mesh->Render(md3dImmediateContext);
-	skinnedmesh->Render(md3dImmediateContext);
+	if (skinnedmesh->IsLoaded())
+	{
+		skinnedmesh->Render(md3dImmediateContext);
+	}
 
 	HR(mSwapChain->Present(0, 0));
 }
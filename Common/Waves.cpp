@@ -4,20 +4,36 @@
 
 #include "Waves.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
 #include <vector>
 #include <cassert>
+#include <xmmintrin.h>
 
 Waves::Waves()
 : mNumRows(0), mNumCols(0), mVertexCount(0), mTriangleCount(0), 
-  mK1(0.0f), mK2(0.0f), mK3(0.0f), mTimeStep(0.0f), mSpatialStep(0.0f),
-  mPrevSolution(0), mCurrSolution(0), mNormals(0), mTangentX(0)
+  mK1(0.0f), mK2(0.0f), mK3(0.0f), mTimeStep(0.0f), mSpatialStep(0.0f), mTime(0.0f),
+  mNumThreads(std::max(1u, std::thread::hardware_concurrency())),
+  mNumBands(0), mGeneration(0), mPending(0), mQuit(false),
+  mPrevHeights(0), mCurrHeights(0), mSolution(0), mNormals(0), mTangentX(0)
 {
 }
 
 Waves::~Waves()
 {
-	delete[] mPrevSolution;
-	delete[] mCurrSolution;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mStart.notify_all();
+	for(UINT w = 0; w < mWorkers.size(); ++w)
+		mWorkers[w].join();
+
+	delete[] mPrevHeights;
+	delete[] mCurrHeights;
+	delete[] mSolution;
 	delete[] mNormals;
 	delete[] mTangentX;
 }
@@ -62,6 +78,7 @@ void Waves::Init(UINT m, UINT n, float dx, float dt, float speed, float damping)
 
 	mTimeStep    = dt;
 	mSpatialStep = dx;
+	mTime        = 0.0f;
 
 	float d = damping*dt+2.0f;
 	float e = (speed*speed)*(dt*dt)/(dx*dx);
@@ -70,13 +87,15 @@ void Waves::Init(UINT m, UINT n, float dx, float dt, float speed, float damping)
 	mK3     = (2.0f*e) / d;
 
 	// In case Init() called again.
-	delete[] mPrevSolution;
-	delete[] mCurrSolution;
+	delete[] mPrevHeights;
+	delete[] mCurrHeights;
+	delete[] mSolution;
 	delete[] mNormals;
 	delete[] mTangentX;
 
-	mPrevSolution = new XMFLOAT3[m*n];
-	mCurrSolution = new XMFLOAT3[m*n];
+	mPrevHeights  = new float[m*n];
+	mCurrHeights  = new float[m*n];
+	mSolution     = new XMFLOAT3[m*n];
 	mNormals      = new XMFLOAT3[m*n];
 	mTangentX     = new XMFLOAT3[m*n];
 
@@ -91,38 +110,272 @@ void Waves::Init(UINT m, UINT n, float dx, float dt, float speed, float damping)
 		{
 			float x = -halfWidth + j*dx;
 
-			mPrevSolution[i*n+j] = XMFLOAT3(x, 0.0f, z);
-			mCurrSolution[i*n+j] = XMFLOAT3(x, 0.0f, z);
-			mNormals[i*n+j]      = XMFLOAT3(0.0f, 1.0f, 0.0f);
-			mTangentX[i*n+j]     = XMFLOAT3(1.0f, 0.0f, 0.0f);
+			mPrevHeights[i*n+j] = 0.0f;
+			mCurrHeights[i*n+j] = 0.0f;
+			mSolution[i*n+j]    = XMFLOAT3(x, 0.0f, z);
+			mNormals[i*n+j]     = XMFLOAT3(0.0f, 1.0f, 0.0f);
+			mTangentX[i*n+j]    = XMFLOAT3(1.0f, 0.0f, 0.0f);
 		}
 	}
 }
 
-void Waves::Update(float dt)
+void Waves::SetThreadCount(UINT numThreads)
 {
-	static float t = 0;
+	mNumThreads = numThreads ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+}
 
+void Waves::Update(float dt)
+{
 	// Accumulate time.
-	t += dt;
+	mTime += dt;
 
 	// Only update the simulation at the specified time step.
-	if( t >= mTimeStep )
+	if( mTime >= mTimeStep )
+	{
+		Step();
+
+		mTime = 0.0f; // reset time
+	}
+}
+
+void Waves::Step()
+{
+	// Only update interior points; we use zero boundary conditions.
+	if(mNumRows < 3 || mNumCols < 3)
+		return;
+
+	UINT numInterior = mNumRows-2;
+	UINT numBands    = std::max(1u, std::min(mNumThreads, numInterior / MIN_ROWS_PER_THREAD));
+	if(numBands == 1)
+	{
+		StepRows(1, mNumRows-1);
+		std::swap(mPrevHeights, mCurrHeights);
+		return;
+	}
+
+	// New workers start at the current generation and wait for the one handed out below.
+	for(UINT w = mWorkers.size(); w+1 < numBands; ++w)
+		mWorkers.push_back(std::thread(&Waves::WorkerLoop, this, w, mGeneration));
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mFirstRows.resize(numBands+1);
+	for(UINT b = 0; b <= numBands; ++b)
+		mFirstRows[b] = 1 + (UINT)((unsigned long long)b*numInterior / numBands);
+	mNumBands = numBands;
+	mPending  = numBands-1;
+	++mGeneration;
+	lock.unlock();
+	mStart.notify_all();
+
+	StepRows(mFirstRows[numBands-1], mFirstRows[numBands]);
+
+	lock.lock();
+	while(mPending)
+		mDone.wait(lock);
+	lock.unlock();
+
+	// The rows on either side of a band boundary need the heights of the other band.
+	for(UINT b = 1; b < numBands; ++b)
+	{
+		ShadeRow(mFirstRows[b]-1);
+		ShadeRow(mFirstRows[b]);
+	}
+
+	// We overwrote the previous buffer with the new data, so this data needs to become
+	// the current solution and the old current solution becomes the new previous solution.
+	std::swap(mPrevHeights, mCurrHeights);
+}
+
+void Waves::WorkerLoop(UINT b, UINT generation)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for(;;)
+	{
+		while(!mQuit && mGeneration == generation)
+			mStart.wait(lock);
+		if(mQuit)
+			return;
+		generation = mGeneration;
+
+		// Fewer bands than workers after SetThreadCount() or on a smaller grid.
+		if(b+1 >= mNumBands)
+			continue;
+		UINT firstRow = mFirstRows[b];
+		UINT endRow   = mFirstRows[b+1];
+		lock.unlock();
+		StepRows(firstRow, endRow);
+		lock.lock();
+		if(--mPending == 0)
+			mDone.notify_one();
+	}
+}
+
+void Waves::StepRows(UINT firstRow, UINT endRow)
+{
+	for(UINT i = firstRow; i < endRow; ++i)
+	{
+		StepRow(i);
+
+		// Row i-1 has its new neighbours now, unless it is the first of the band and
+		// the row above belongs to another band.
+		if(i > firstRow && (i-1 > firstRow || firstRow == 1))
+			ShadeRow(i-1);
+	}
+	if(endRow == mNumRows-1 && (endRow-1 > firstRow || firstRow == 1))
+		ShadeRow(endRow-1);
+}
+
+void Waves::StepRow(UINT i)
+{
+	// After this update we will be discarding the old previous buffer, so overwrite
+	// that buffer with the new update.  This works in place because we won't need
+	// prev_ij again and the assignment happens last.
+
+	// Note j indexes x and i indexes z: h(x_j, z_i, t_k)
+	// Moreover, our +z axis goes "down"; this is just to
+	// keep consistent with our row indices going down.
+	const UINT n = mNumCols;
+	float* prev = mPrevHeights + i*n;
+	const float* curr = mCurrHeights + i*n;
+	const float* up   = curr - n;
+	const float* down = curr + n;
+
+	// The additions and products happen in the same order as in the scalar loop
+	// below, so both give the same result to the bit.
+	const __m128 k1 = _mm_set1_ps(mK1);
+	const __m128 k2 = _mm_set1_ps(mK2);
+	const __m128 k3 = _mm_set1_ps(mK3);
+	UINT j = 1;
+	for(; j+4 < n; j += 4)
+	{
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(down+j), _mm_loadu_ps(up+j));
+		sum = _mm_add_ps(sum, _mm_loadu_ps(curr+j+1));
+		sum = _mm_add_ps(sum, _mm_loadu_ps(curr+j-1));
+		__m128 h = _mm_add_ps(_mm_mul_ps(k1, _mm_loadu_ps(prev+j)), _mm_mul_ps(k2, _mm_loadu_ps(curr+j)));
+		_mm_storeu_ps(prev+j, _mm_add_ps(h, _mm_mul_ps(k3, sum)));
+	}
+	for(; j < n-1; ++j)
+	{
+		prev[j] = mK1*prev[j] + mK2*curr[j] + mK3*(down[j] + up[j] + curr[j+1] + curr[j-1]);
+	}
+}
+
+// Writes four points held as one register per component to consecutive XMFLOAT3s.
+static void StoreFloat3x4(XMFLOAT3* dest, __m128 x, __m128 y, __m128 z)
+{
+	__m128 xy01 = _mm_unpacklo_ps(x, y);
+	__m128 xy23 = _mm_unpackhi_ps(x, y);
+	__m128 z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+	__m128 y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+	__m128 y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+	float* f = &dest->x;
+	_mm_storeu_ps(f,   _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(f+4, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(f+8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+void Waves::ShadeRow(UINT i)
+{
+	// The new solution is still in the previous buffer, Step() swaps them last.
+	const UINT n = mNumCols;
+	const float* h      = mPrevHeights + i*n;
+	const float* top    = h - n;
+	const float* bottom = h + n;
+	XMFLOAT3* solution  = mSolution + i*n;
+	XMFLOAT3* normals   = mNormals + i*n;
+	XMFLOAT3* tangentX  = mTangentX + i*n;
+
+	//
+	// Compute normals using finite difference scheme.
+	//
+	// Normalized the way XMVector3Normalize does: ((x*x + y*y) + z*z), square root,
+	// divide.  The normal's y and the tangent's x are both 2*dx.
+	const float twoDx  = 2.0f*mSpatialStep;
+	const __m128 y     = _mm_set1_ps(twoDx);
+	const __m128 yy    = _mm_mul_ps(y, y);
+	UINT j = 1;
+	for(; j+4 < n; j += 4)
+	{
+		__m128 l  = _mm_loadu_ps(h+j-1);
+		__m128 r  = _mm_loadu_ps(h+j+1);
+		__m128 nx = _mm_sub_ps(l, r);
+		__m128 nz = _mm_sub_ps(_mm_loadu_ps(bottom+j), _mm_loadu_ps(top+j));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), yy), _mm_mul_ps(nz, nz)));
+		StoreFloat3x4(normals+j, _mm_div_ps(nx, length), _mm_div_ps(y, length), _mm_div_ps(nz, length));
+
+		__m128 ty = _mm_sub_ps(r, l);
+		length = _mm_sqrt_ps(_mm_add_ps(yy, _mm_mul_ps(ty, ty)));
+		StoreFloat3x4(tangentX+j, _mm_div_ps(y, length), _mm_div_ps(ty, length), _mm_setzero_ps());
+
+		solution[j].y   = h[j];
+		solution[j+1].y = h[j+1];
+		solution[j+2].y = h[j+2];
+		solution[j+3].y = h[j+3];
+	}
+	for(; j < n-1; ++j)
+	{
+		float l  = h[j-1];
+		float r  = h[j+1];
+		float nx = l-r;
+		float nz = bottom[j]-top[j];
+		float length = sqrtf(nx*nx + twoDx*twoDx + nz*nz);
+		normals[j] = XMFLOAT3(nx/length, twoDx/length, nz/length);
+
+		float ty = r-l;
+		length = sqrtf(twoDx*twoDx + ty*ty);
+		tangentX[j] = XMFLOAT3(twoDx/length, ty/length, 0.0f);
+
+		solution[j].y = h[j];
+	}
+}
+
+void Waves::Disturb(UINT i, UINT j, float magnitude)
+{
+	// Don't disturb boundaries.
+	assert(i > 1 && i < mNumRows-2);
+	assert(j > 1 && j < mNumCols-2);
+
+	float halfMag = 0.5f*magnitude;
+
+	// Disturb the ijth vertex height and its neighbors.
+	const UINT k = i*mNumCols+j;
+	const UINT neighbors[5] = { k, k+1, k-1, k+mNumCols, k-mNumCols };
+	for(UINT v = 0; v < 5; ++v)
+	{
+		mCurrHeights[neighbors[v]] += v ? halfMag : magnitude;
+		mSolution[neighbors[v]].y = mCurrHeights[neighbors[v]];
+	}
+}
+
+//
+// The scalar update on XMFLOAT3 arrays Waves used to do, kept to check and time Step() against.
+//
+class ReferenceWaves
+{
+public:
+	ReferenceWaves(UINT m, UINT n, float dx, float k1, float k2, float k3)
+	: mNumRows(m), mNumCols(n), mK1(k1), mK2(k2), mK3(k3), mSpatialStep(dx),
+	  mPrevSolution(m*n), mCurrSolution(m*n), mNormals(m*n, XMFLOAT3(0.0f, 1.0f, 0.0f)), mTangentX(m*n, XMFLOAT3(1.0f, 0.0f, 0.0f))
+	{
+		float halfWidth = (n-1)*dx*0.5f;
+		float halfDepth = (m-1)*dx*0.5f;
+		for(UINT i = 0; i < m; ++i)
+		{
+			for(UINT j = 0; j < n; ++j)
+			{
+				mPrevSolution[i*n+j] = XMFLOAT3(-halfWidth + j*dx, 0.0f, halfDepth - i*dx);
+				mCurrSolution[i*n+j] = mPrevSolution[i*n+j];
+			}
+		}
+	}
+
+	void Step()
 	{
-		// Only update interior points; we use zero boundary conditions.
 		for(UINT i = 1; i < mNumRows-1; ++i)
 		{
 			for(UINT j = 1; j < mNumCols-1; ++j)
 			{
-				// After this update we will be discarding the old previous
-				// buffer, so overwrite that buffer with the new update.
-				// Note how we can do this inplace (read/write to same element) 
-				// because we won't need prev_ij again and the assignment happens last.
-
-				// Note j indexes x and i indexes z: h(x_j, z_i, t_k)
-				// Moreover, our +z axis goes "down"; this is just to 
-				// keep consistent with our row indices going down.
-
 				mPrevSolution[i*mNumCols+j].y = 
 					mK1*mPrevSolution[i*mNumCols+j].y +
 					mK2*mCurrSolution[i*mNumCols+j].y +
@@ -133,16 +386,8 @@ void Waves::Update(float dt)
 			}
 		}
 
-		// We just overwrote the previous buffer with the new data, so
-		// this data needs to become the current solution and the old
-		// current solution becomes the new previous solution.
-		std::swap(mPrevSolution, mCurrSolution);
-
-		t = 0.0f; // reset time
+		mPrevSolution.swap(mCurrSolution);
 
-		//
-		// Compute normals using finite difference scheme.
-		//
 		for(UINT i = 1; i < mNumRows-1; ++i)
 		{
 			for(UINT j = 1; j < mNumCols-1; ++j)
@@ -164,21 +409,111 @@ void Waves::Update(float dt)
 			}
 		}
 	}
+
+	void Disturb(UINT i, UINT j, float magnitude)
+	{
+		float halfMag = 0.5f*magnitude;
+
+		mCurrSolution[i*mNumCols+j].y     += magnitude;
+		mCurrSolution[i*mNumCols+j+1].y   += halfMag;
+		mCurrSolution[i*mNumCols+j-1].y   += halfMag;
+		mCurrSolution[(i+1)*mNumCols+j].y += halfMag;
+		mCurrSolution[(i-1)*mNumCols+j].y += halfMag;
+	}
+
+	UINT mNumRows;
+	UINT mNumCols;
+	float mK1;
+	float mK2;
+	float mK3;
+	float mSpatialStep;
+	std::vector<XMFLOAT3> mPrevSolution;
+	std::vector<XMFLOAT3> mCurrSolution;
+	std::vector<XMFLOAT3> mNormals;
+	std::vector<XMFLOAT3> mTangentX;
+};
+
+// Same sequence for every run, i and j within the rows and columns Disturb() accepts.
+static void RandomDisturbance(UINT& seed, UINT m, UINT n, UINT& i, UINT& j, float& magnitude)
+{
+	seed = seed*1664525u + 1013904223u;
+	i = 2 + (seed >> 8) % (m-4);
+	seed = seed*1664525u + 1013904223u;
+	j = 2 + (seed >> 8) % (n-4);
+	seed = seed*1664525u + 1013904223u;
+	magnitude = 0.25f + 0.25f*((seed >> 8) % 1024)/1024.0f;
 }
 
-void Waves::Disturb(UINT i, UINT j, float magnitude)
+static float MaxDifference(const XMFLOAT3& a, const XMFLOAT3& b)
 {
-	// Don't disturb boundaries.
-	assert(i > 1 && i < mNumRows-2);
-	assert(j > 1 && j < mNumCols-2);
+	return std::max(fabsf(a.x-b.x), std::max(fabsf(a.y-b.y), fabsf(a.z-b.z)));
+}
 
-	float halfMag = 0.5f*magnitude;
+float Waves::CompareWithReference(UINT m, UINT n, UINT numSteps, UINT numThreads)
+{
+	assert(m > 4 && n > 4);
 
-	// Disturb the ijth vertex height and its neighbors.
-	mCurrSolution[i*mNumCols+j].y     += magnitude;
-	mCurrSolution[i*mNumCols+j+1].y   += halfMag;
-	mCurrSolution[i*mNumCols+j-1].y   += halfMag;
-	mCurrSolution[(i+1)*mNumCols+j].y += halfMag;
-	mCurrSolution[(i-1)*mNumCols+j].y += halfMag;
+	Waves waves;
+	waves.SetThreadCount(numThreads);
+	waves.Init(m, n, 0.8f, 0.03f, 3.25f, 0.4f);
+	ReferenceWaves reference(m, n, waves.mSpatialStep, waves.mK1, waves.mK2, waves.mK3);
+
+	UINT seed = 1;
+	for(UINT s = 0; s < numSteps; ++s)
+	{
+		UINT i, j;
+		float magnitude;
+		RandomDisturbance(seed, m, n, i, j, magnitude);
+		waves.Disturb(i, j, magnitude);
+		reference.Disturb(i, j, magnitude);
+		waves.Step();
+		reference.Step();
+	}
+
+	float maxDifference = 0.0f;
+	for(UINT k = 0; k < m*n; ++k)
+	{
+		maxDifference = std::max(maxDifference, MaxDifference(waves[k], reference.mCurrSolution[k]));
+		maxDifference = std::max(maxDifference, MaxDifference(waves.Normal(k), reference.mNormals[k]));
+		maxDifference = std::max(maxDifference, MaxDifference(waves.TangentX(k), reference.mTangentX[k]));
+	}
+	return maxDifference;
+}
+
+void Waves::Benchmark(UINT numSteps)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const UINT sizes[] = { 1024, 2048 };
+	for(UINT s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+	{
+		const UINT m = sizes[s];
+		const UINT n = sizes[s];
+		double milliseconds[3];
+
+		// The constants don't depend on the grid size.  The grid is only allocated once the
+		// reference is gone, the 32-bit demo has no room for both.
+		Waves waves;
+		waves.Init(2, 2, 0.8f, 0.03f, 3.25f, 0.4f);
+		{
+			ReferenceWaves reference(m, n, waves.mSpatialStep, waves.mK1, waves.mK2, waves.mK3);
+			reference.Disturb(m/2, n/2, 1.0f);
+			Clock::time_point start = Clock::now();
+			for(UINT i = 0; i < numSteps; ++i)
+				reference.Step();
+			milliseconds[0] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+		for(UINT run = 1; run < 3; ++run)
+		{
+			waves.Init(m, n, 0.8f, 0.03f, 3.25f, 0.4f);
+			waves.SetThreadCount(run == 1 ? 1 : 0);
+			waves.Disturb(m/2, n/2, 1.0f);
+			Clock::time_point start = Clock::now();
+			for(UINT i = 0; i < numSteps; ++i)
+				waves.Step();
+			milliseconds[run] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		printf("Waves %ux%u: scalar %.2f ms, SIMD %.2f ms, %u threads %.2f ms per step\n",
+			m, n, milliseconds[0] / numSteps, milliseconds[1] / numSteps, waves.mNumThreads, milliseconds[2] / numSteps);
+	}
 }
-	
@@ -4,6 +4,12 @@
 // Performs the calculations for the wave simulation.  After the simulation has been
 // updated, the client must copy the current solution into vertex buffers for rendering.
 // This class only does the calculations, it does not do any drawing.
+//
+// The heights are stored apart from the positions so the finite difference stencil runs
+// on four columns at a time.  The grid is split into bands of rows, one per thread, and
+// each band writes the positions, normals and tangents of a row right behind the stencil
+// while the neighbouring heights are still in cache.  The threads of the bands are started
+// by the first step that needs them and wait for the next step in between.
 //***************************************************************************************
 
 #ifndef WAVES_H
@@ -11,6 +17,10 @@
 
 #include <Windows.h>
 #include <xnamath.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 class Waves
 {
@@ -26,7 +36,7 @@ public:
 	float Depth()const;
 
 	// Returns the solution at the ith grid point.
-	const XMFLOAT3& operator[](int i)const { return mCurrSolution[i]; }
+	const XMFLOAT3& operator[](int i)const { return mSolution[i]; }
 
 	// Returns the solution normal at the ith grid point.
 	const XMFLOAT3& Normal(int i)const { return mNormals[i]; }
@@ -38,7 +48,35 @@ public:
 	void Update(float dt);
 	void Disturb(UINT i, UINT j, float magnitude);
 
+	// Number of threads Update() splits the rows over, 0 for one per hardware thread.
+	void SetThreadCount(UINT numThreads);
+
+	// Runs numSteps time steps with the same random disturbances on an m x n grid here and
+	// with the scalar update this class used to do on XMFLOAT3 arrays, and returns the
+	// largest difference of the positions, normals and tangents.  The order of operations
+	// is the same, so anything but 0 is an error.  numThreads as for SetThreadCount().
+	static float CompareWithReference(UINT m, UINT n, UINT numSteps, UINT numThreads = 0);
+
+	// Prints the time per step of the scalar update and of this one on one and on all
+	// threads for 1024x1024 and 2048x2048 grids.
+	static void Benchmark(UINT numSteps);
+
 private:
+	// Bands of rows are never smaller than this.
+	enum { MIN_ROWS_PER_THREAD = 64 };
+
+	Waves(const Waves& rhs);
+	Waves& operator=(const Waves& rhs);
+
+	void Step();
+	// Steps band b of mFirstRows whenever Step() hands out bands, until mQuit is set.
+	void WorkerLoop(UINT b, UINT generation);
+	void StepRows(UINT firstRow, UINT endRow);
+	void StepRow(UINT i);
+	// Writes the position, normal and tangent of the interior points of row i from the new
+	// heights of rows i-1 to i+1.
+	void ShadeRow(UINT i);
+
 	UINT mNumRows;
 	UINT mNumCols;
 
@@ -52,9 +90,24 @@ private:
 
 	float mTimeStep;
 	float mSpatialStep;
+	float mTime;
+
+	UINT mNumThreads;
+
+	// Worker b steps band b, Step() itself the last one.
+	std::vector<std::thread> mWorkers;
+	std::mutex mMutex;
+	std::condition_variable mStart;
+	std::condition_variable mDone;
+	std::vector<UINT> mFirstRows;	// numBands+1 entries, the last is mNumRows-1
+	UINT mNumBands;
+	UINT mGeneration;	// counts the steps handed to the workers
+	UINT mPending;		// bands of the current step still running on workers
+	bool mQuit;
 
-	XMFLOAT3* mPrevSolution;
-	XMFLOAT3* mCurrSolution;
+	float* mPrevHeights;
+	float* mCurrHeights;
+	XMFLOAT3* mSolution;
 	XMFLOAT3* mNormals;
 	XMFLOAT3* mTangentX;
 };
@@ -0,0 +1,588 @@
+#include "CpuSkinning.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+SkinningJob::SkinningJob()
+{
+	pVertices = NULL;
+	pExtraBones = NULL;
+	pNormals = NULL;
+	NumVertices = 0;
+	pPalette = NULL;
+	pDualQuats = NULL;
+	NumPalette = 0;
+	pOutPositions = NULL;
+	pOutNormals = NULL;
+}
+
+static inline unsigned int PaletteIndex(float ID, unsigned int NumPalette)
+{
+	const unsigned int Index = (unsigned int)ID;
+	assert(Index < NumPalette);
+	return Index < NumPalette ? Index : NumPalette - 1;
+}
+
+static void AccumulateReference(const SkinningJob& Job, const VertexBoneData& Bones, float M[3][4])
+{
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		const Matrix4f& Bone = Job.pPalette[PaletteIndex(Bones.IDs[k], Job.NumPalette)];
+		for (unsigned int r = 0; r < 3; r++)
+		{
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				M[r][c] += Bone.m[r][c] * Bones.Weights[k];
+			}
+		}
+	}
+}
+
+static void AccumulateDualQuatReference(const SkinningJob& Job, const VertexBoneData& Bones, const float Pivot[4], DualQuat& Blend)
+{
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		const DualQuat& Bone = Job.pDualQuats[PaletteIndex(Bones.IDs[k], Job.NumPalette)];
+		const float Dot = Bone.Real[0] * Pivot[0] + Bone.Real[1] * Pivot[1] + Bone.Real[2] * Pivot[2] + Bone.Real[3] * Pivot[3];
+		const float Weight = Dot < 0.0f ? -Bones.Weights[k] : Bones.Weights[k];
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			Blend.Real[i] += Bone.Real[i] * Weight;
+			Blend.Dual[i] += Bone.Dual[i] * Weight;
+		}
+	}
+}
+
+static void SkinVertexDualQuatReference(const SkinningJob& Job, unsigned int v)
+{
+	const VertexBoneData& Bones = Job.pVertices[v].bonedata;
+	const float* Pivot = Job.pDualQuats[PaletteIndex(Bones.IDs[0], Job.NumPalette)].Real;
+	DualQuat Blend;
+	Blend.Real[3] = 0.0f;
+	AccumulateDualQuatReference(Job, Bones, Pivot, Blend);
+	if (Job.pExtraBones)
+	{
+		AccumulateDualQuatReference(Job, Job.pExtraBones[v], Pivot, Blend);
+	}
+	const float Length = sqrtf(Blend.Real[0] * Blend.Real[0] + Blend.Real[1] * Blend.Real[1] + Blend.Real[2] * Blend.Real[2] + Blend.Real[3] * Blend.Real[3]);
+	if (Length > 0.0f)
+	{
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			Blend.Real[i] /= Length;
+			Blend.Dual[i] /= Length;
+		}
+	}
+	else
+	{
+		Blend = DualQuat();
+	}
+	Job.pOutPositions[v] = Blend.Transform(Job.pVertices[v].m_pos);
+	if (Job.pNormals)
+	{
+		Vector3f Normal = Blend.Rotate(Job.pNormals[v]);
+		const float NormalLength = sqrtf(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+		Job.pOutNormals[v] = NormalLength > 0.0f ? Normal * (1.0f / NormalLength) : Normal;
+	}
+}
+
+void SkinVerticesReference(const SkinningJob& Job, unsigned int Begin, unsigned int End)
+{
+	for (unsigned int v = Begin; v < End; v++)
+	{
+		const Vector3f& Pos = Job.pVertices[v].m_pos;
+		if (!Job.NumPalette)
+		{
+			Job.pOutPositions[v] = Pos;
+			if (Job.pNormals)
+			{
+				Job.pOutNormals[v] = Job.pNormals[v];
+			}
+			continue;
+		}
+		if (Job.pDualQuats)
+		{
+			SkinVertexDualQuatReference(Job, v);
+			continue;
+		}
+		float M[3][4] = { { 0.0f } };
+		AccumulateReference(Job, Job.pVertices[v].bonedata, M);
+		if (Job.pExtraBones)
+		{
+			AccumulateReference(Job, Job.pExtraBones[v], M);
+		}
+		float Out[3];
+		for (unsigned int r = 0; r < 3; r++)
+		{
+			Out[r] = M[r][0] * Pos.x + M[r][1] * Pos.y + M[r][2] * Pos.z + M[r][3];
+		}
+		Job.pOutPositions[v] = Vector3f(Out[0], Out[1], Out[2]);
+		if (Job.pNormals)
+		{
+			const Vector3f& Normal = Job.pNormals[v];
+			for (unsigned int r = 0; r < 3; r++)
+			{
+				Out[r] = M[r][0] * Normal.x + M[r][1] * Normal.y + M[r][2] * Normal.z;
+			}
+			const float Length = sqrtf(Out[0] * Out[0] + Out[1] * Out[1] + Out[2] * Out[2]);
+			const float Scale = Length > 0.0f ? 1.0f / Length : 0.0f;
+			Job.pOutNormals[v] = Vector3f(Out[0] * Scale, Out[1] * Scale, Out[2] * Scale);
+		}
+	}
+}
+
+static inline void StoreVector3(Vector3f& Out, __m128 Value)
+{
+	float Temp[4];
+	_mm_storeu_ps(Temp, Value);
+	Out = Vector3f(Temp[0], Temp[1], Temp[2]);
+}
+
+// Adds the first three rows of the influences' matrices, scaled by their weights
+static inline void AccumulateSSE(const SkinningJob& Job, const VertexBoneData& Bones, __m128& R0, __m128& R1, __m128& R2)
+{
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		const float* M = &Job.pPalette[PaletteIndex(Bones.IDs[k], Job.NumPalette)].m[0][0];
+		const __m128 W = _mm_set1_ps(Bones.Weights[k]);
+		R0 = _mm_add_ps(R0, _mm_mul_ps(_mm_loadu_ps(M), W));
+		R1 = _mm_add_ps(R1, _mm_mul_ps(_mm_loadu_ps(M + 4), W));
+		R2 = _mm_add_ps(R2, _mm_mul_ps(_mm_loadu_ps(M + 8), W));
+	}
+}
+
+// (R0 . V, R1 . V, R2 . V, 0)
+static inline __m128 TransformSSE(__m128 R0, __m128 R1, __m128 R2, __m128 V)
+{
+	__m128 X = _mm_mul_ps(R0, V);
+	__m128 Y = _mm_mul_ps(R1, V);
+	__m128 Z = _mm_mul_ps(R2, V);
+	__m128 W = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(X, Y, Z, W);
+	return _mm_add_ps(_mm_add_ps(X, Y), _mm_add_ps(Z, W));
+}
+
+// V must have w = 0, a zero vector stays zero
+static inline __m128 Normalize3SSE(__m128 V)
+{
+	__m128 Dot = _mm_mul_ps(V, V);
+	Dot = _mm_add_ps(Dot, _mm_shuffle_ps(Dot, Dot, _MM_SHUFFLE(2, 3, 0, 1)));
+	Dot = _mm_add_ps(Dot, _mm_shuffle_ps(Dot, Dot, _MM_SHUFFLE(1, 0, 3, 2)));
+	const __m128 Length = _mm_sqrt_ps(Dot);
+	return _mm_and_ps(_mm_cmpgt_ps(Length, _mm_setzero_ps()), _mm_div_ps(V, Length));
+}
+
+static inline void AccumulateDualQuatSSE(const SkinningJob& Job, const VertexBoneData& Bones, const float Pivot[4], __m128& Real, __m128& Dual)
+{
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		const DualQuat& Bone = Job.pDualQuats[PaletteIndex(Bones.IDs[k], Job.NumPalette)];
+		const float Dot = Bone.Real[0] * Pivot[0] + Bone.Real[1] * Pivot[1] + Bone.Real[2] * Pivot[2] + Bone.Real[3] * Pivot[3];
+		const __m128 W = _mm_set1_ps(Dot < 0.0f ? -Bones.Weights[k] : Bones.Weights[k]);
+		Real = _mm_add_ps(Real, _mm_mul_ps(_mm_loadu_ps(Bone.Real), W));
+		Dual = _mm_add_ps(Dual, _mm_mul_ps(_mm_loadu_ps(Bone.Dual), W));
+	}
+}
+
+// Blends the dual quaternions of a vertex and turns the result into the rows of a matrix
+static inline void BlendDualQuatSSE(const SkinningJob& Job, unsigned int v, __m128& R0, __m128& R1, __m128& R2)
+{
+	const VertexBoneData& Bones = Job.pVertices[v].bonedata;
+	const float* Pivot = Job.pDualQuats[PaletteIndex(Bones.IDs[0], Job.NumPalette)].Real;
+	__m128 Real = _mm_setzero_ps();
+	__m128 Dual = _mm_setzero_ps();
+	AccumulateDualQuatSSE(Job, Bones, Pivot, Real, Dual);
+	if (Job.pExtraBones)
+	{
+		AccumulateDualQuatSSE(Job, Job.pExtraBones[v], Pivot, Real, Dual);
+	}
+	__m128 Dot = _mm_mul_ps(Real, Real);
+	Dot = _mm_add_ps(Dot, _mm_shuffle_ps(Dot, Dot, _MM_SHUFFLE(2, 3, 0, 1)));
+	Dot = _mm_add_ps(Dot, _mm_shuffle_ps(Dot, Dot, _MM_SHUFFLE(1, 0, 3, 2)));
+	float r[4], d[4];
+	if (_mm_cvtss_f32(Dot) > 0.0f)
+	{
+		const __m128 Length = _mm_sqrt_ps(Dot);
+		_mm_storeu_ps(r, _mm_div_ps(Real, Length));
+		_mm_storeu_ps(d, _mm_div_ps(Dual, Length));
+	}
+	else
+	{
+		r[0] = r[1] = r[2] = 0.0f;
+		r[3] = 1.0f;
+		d[0] = d[1] = d[2] = d[3] = 0.0f;
+	}
+	const float x = r[0], y = r[1], z = r[2], w = r[3];
+	const float tx = 2.0f * (w * d[0] - d[3] * x + y * d[2] - z * d[1]);
+	const float ty = 2.0f * (w * d[1] - d[3] * y + z * d[0] - x * d[2]);
+	const float tz = 2.0f * (w * d[2] - d[3] * z + x * d[1] - y * d[0]);
+	R0 = _mm_set_ps(tx, 2.0f * (x * z + w * y), 2.0f * (x * y - w * z), 1.0f - 2.0f * (y * y + z * z));
+	R1 = _mm_set_ps(ty, 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + z * z), 2.0f * (x * y + w * z));
+	R2 = _mm_set_ps(tz, 1.0f - 2.0f * (x * x + y * y), 2.0f * (y * z + w * x), 2.0f * (x * z - w * y));
+}
+
+static inline void SkinVertexSSE(const SkinningJob& Job, unsigned int v)
+{
+	__m128 R0 = _mm_setzero_ps();
+	__m128 R1 = _mm_setzero_ps();
+	__m128 R2 = _mm_setzero_ps();
+	if (Job.pDualQuats)
+	{
+		BlendDualQuatSSE(Job, v, R0, R1, R2);
+	}
+	else
+	{
+		AccumulateSSE(Job, Job.pVertices[v].bonedata, R0, R1, R2);
+		if (Job.pExtraBones)
+		{
+			AccumulateSSE(Job, Job.pExtraBones[v], R0, R1, R2);
+		}
+	}
+	const Vector3f& Pos = Job.pVertices[v].m_pos;
+	StoreVector3(Job.pOutPositions[v], TransformSSE(R0, R1, R2, _mm_set_ps(1.0f, Pos.z, Pos.y, Pos.x)));
+	if (Job.pNormals)
+	{
+		const Vector3f& Normal = Job.pNormals[v];
+		const __m128 N = TransformSSE(R0, R1, R2, _mm_set_ps(0.0f, Normal.z, Normal.y, Normal.x));
+		StoreVector3(Job.pOutNormals[v], Normalize3SSE(N));
+	}
+}
+
+#if defined(__AVX__)
+// The same for two vertices at once, one in each 128 bit lane
+static inline __m256 Load2(const float* pLow, const float* pHigh)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pLow)), _mm_loadu_ps(pHigh), 1);
+}
+
+static inline void AccumulateAVX(const SkinningJob& Job, const VertexBoneData& A, const VertexBoneData& B, __m256& R0, __m256& R1, __m256& R2)
+{
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		const float* MA = &Job.pPalette[PaletteIndex(A.IDs[k], Job.NumPalette)].m[0][0];
+		const float* MB = &Job.pPalette[PaletteIndex(B.IDs[k], Job.NumPalette)].m[0][0];
+		const __m256 W = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(A.Weights[k])), _mm_set1_ps(B.Weights[k]), 1);
+		R0 = _mm256_add_ps(R0, _mm256_mul_ps(Load2(MA, MB), W));
+		R1 = _mm256_add_ps(R1, _mm256_mul_ps(Load2(MA + 4, MB + 4), W));
+		R2 = _mm256_add_ps(R2, _mm256_mul_ps(Load2(MA + 8, MB + 8), W));
+	}
+}
+
+static inline __m256 TransformAVX(__m256 R0, __m256 R1, __m256 R2, __m256 V)
+{
+	const __m256 X = _mm256_mul_ps(R0, V);
+	const __m256 Y = _mm256_mul_ps(R1, V);
+	const __m256 Z = _mm256_mul_ps(R2, V);
+	const __m256 W = _mm256_setzero_ps();
+	// transpose within the lanes, as _MM_TRANSPOSE4_PS does
+	const __m256 T0 = _mm256_unpacklo_ps(X, Y);
+	const __m256 T1 = _mm256_unpackhi_ps(X, Y);
+	const __m256 T2 = _mm256_unpacklo_ps(Z, W);
+	const __m256 T3 = _mm256_unpackhi_ps(Z, W);
+	const __m256 C0 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 C1 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2));
+	const __m256 C2 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0));
+	const __m256 C3 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2));
+	return _mm256_add_ps(_mm256_add_ps(C0, C1), _mm256_add_ps(C2, C3));
+}
+
+static inline __m256 Normalize3AVX(__m256 V)
+{
+	__m256 Dot = _mm256_mul_ps(V, V);
+	Dot = _mm256_add_ps(Dot, _mm256_shuffle_ps(Dot, Dot, _MM_SHUFFLE(2, 3, 0, 1)));
+	Dot = _mm256_add_ps(Dot, _mm256_shuffle_ps(Dot, Dot, _MM_SHUFFLE(1, 0, 3, 2)));
+	const __m256 Length = _mm256_sqrt_ps(Dot);
+	return _mm256_and_ps(_mm256_cmp_ps(Length, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_div_ps(V, Length));
+}
+
+static inline void SkinTwoVerticesAVX(const SkinningJob& Job, unsigned int v)
+{
+	__m256 R0 = _mm256_setzero_ps();
+	__m256 R1 = _mm256_setzero_ps();
+	__m256 R2 = _mm256_setzero_ps();
+	AccumulateAVX(Job, Job.pVertices[v].bonedata, Job.pVertices[v + 1].bonedata, R0, R1, R2);
+	if (Job.pExtraBones)
+	{
+		AccumulateAVX(Job, Job.pExtraBones[v], Job.pExtraBones[v + 1], R0, R1, R2);
+	}
+	const Vector3f& A = Job.pVertices[v].m_pos;
+	const Vector3f& B = Job.pVertices[v + 1].m_pos;
+	const __m256 P = TransformAVX(R0, R1, R2, _mm256_set_ps(1.0f, B.z, B.y, B.x, 1.0f, A.z, A.y, A.x));
+	StoreVector3(Job.pOutPositions[v], _mm256_castps256_ps128(P));
+	StoreVector3(Job.pOutPositions[v + 1], _mm256_extractf128_ps(P, 1));
+	if (Job.pNormals)
+	{
+		const Vector3f& NA = Job.pNormals[v];
+		const Vector3f& NB = Job.pNormals[v + 1];
+		const __m256 N = Normalize3AVX(TransformAVX(R0, R1, R2, _mm256_set_ps(0.0f, NB.z, NB.y, NB.x, 0.0f, NA.z, NA.y, NA.x)));
+		StoreVector3(Job.pOutNormals[v], _mm256_castps256_ps128(N));
+		StoreVector3(Job.pOutNormals[v + 1], _mm256_extractf128_ps(N, 1));
+	}
+}
+#endif
+
+void SkinVerticesSIMD(const SkinningJob& Job, unsigned int Begin, unsigned int End)
+{
+	if (!Job.NumPalette)
+	{
+		SkinVerticesReference(Job, Begin, End);
+		return;
+	}
+	unsigned int v = Begin;
+#if defined(__AVX__)
+	// the dual quaternion blend ends in scalar code, two of them gain nothing from AVX
+	for (; v + 2 <= End && !Job.pDualQuats; v += 2)
+	{
+		SkinTwoVerticesAVX(Job, v);
+	}
+#endif
+	for (; v < End; v++)
+	{
+		SkinVertexSSE(Job, v);
+	}
+}
+
+CpuSkinner::CpuSkinner(unsigned int NumThreads)
+{
+	m_NumThreads = NumThreads ? NumThreads : std::max(1u, std::thread::hardware_concurrency());
+	m_pJob = NULL;
+	m_NumRanges = 0;
+	m_RangeSize = 0;
+	m_Generation = 0;
+	m_Pending = 0;
+	m_Quit = false;
+	for (unsigned int i = 0; i + 1 < m_NumThreads; i++)
+	{
+		m_Workers.push_back(std::thread(&CpuSkinner::WorkerLoop, this, i));
+	}
+}
+
+CpuSkinner::~CpuSkinner()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_Start.notify_all();
+	for (unsigned int i = 0; i < m_Workers.size(); i++)
+	{
+		m_Workers[i].join();
+	}
+}
+
+void CpuSkinner::WorkerLoop(unsigned int Worker) const
+{
+	unsigned int Generation = 0;
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	for (;;)
+	{
+		while (!m_Quit && m_Generation == Generation)
+		{
+			m_Start.wait(Lock);
+		}
+		if (m_Quit)
+		{
+			return;
+		}
+		Generation = m_Generation;
+		// worker i skins range i, the calling thread the last one
+		if (Worker + 1 >= m_NumRanges)
+		{
+			continue;
+		}
+		const SkinningJob& Job = *m_pJob;
+		const unsigned int Begin = Worker * m_RangeSize;
+		const unsigned int End = Begin + m_RangeSize;
+		Lock.unlock();
+		SkinVerticesSIMD(Job, Begin, End);
+		Lock.lock();
+		if (--m_Pending == 0)
+		{
+			m_Done.notify_one();
+		}
+	}
+}
+
+void CpuSkinner::Skin(const SkinningJob& Job) const
+{
+	const unsigned int NumRanges = std::max(1u, std::min(m_NumThreads, Job.NumVertices / MIN_VERTICES_PER_THREAD));
+	if (NumRanges == 1)
+	{
+		SkinVerticesSIMD(Job, 0, Job.NumVertices);
+		return;
+	}
+	const unsigned int RangeSize = (Job.NumVertices + NumRanges - 1) / NumRanges;
+	std::lock_guard<std::mutex> SkinLock(m_SkinMutex);
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_pJob = &Job;
+	m_NumRanges = NumRanges;
+	m_RangeSize = RangeSize;
+	m_Pending = NumRanges - 1;
+	m_Generation++;
+	Lock.unlock();
+	m_Start.notify_all();
+	SkinVerticesSIMD(Job, (NumRanges - 1) * RangeSize, Job.NumVertices);
+	Lock.lock();
+	while (m_Pending)
+	{
+		m_Done.wait(Lock);
+	}
+	m_pJob = NULL;
+}
+
+void BuildHitboxProxy(const SkinnedVertex* pVertices, unsigned int NumVertices, HitboxProxy& Proxy)
+{
+	// corner c of a box lies at max in x if bit 0 is set, in y for bit 1 and in z for bit 2
+	static const unsigned int BoxIndices[36] =
+	{
+		0, 4, 6, 0, 6, 2,	// -x
+		1, 3, 7, 1, 7, 5,	// +x
+		0, 1, 5, 0, 5, 4,	// -y
+		2, 6, 7, 2, 7, 3,	// +y
+		0, 2, 3, 0, 3, 1,	// -z
+		4, 5, 7, 4, 7, 6	// +z
+	};
+	std::vector<Vector3f> Min, Max;
+	std::vector<bool> Used;
+	for (unsigned int v = 0; v < NumVertices; v++)
+	{
+		const VertexBoneData& Bones = pVertices[v].bonedata;
+		if (!(Bones.Weights[0] > 0.0f))
+		{
+			continue;
+		}
+		const unsigned int Bone = (unsigned int)Bones.IDs[0];
+		const Vector3f& Pos = pVertices[v].m_pos;
+		if (Bone >= Used.size())
+		{
+			Used.resize(Bone + 1, false);
+			Min.resize(Bone + 1);
+			Max.resize(Bone + 1);
+		}
+		if (!Used[Bone])
+		{
+			Used[Bone] = true;
+			Min[Bone] = Max[Bone] = Pos;
+			continue;
+		}
+		Min[Bone] = Vector3f(std::min(Min[Bone].x, Pos.x), std::min(Min[Bone].y, Pos.y), std::min(Min[Bone].z, Pos.z));
+		Max[Bone] = Vector3f(std::max(Max[Bone].x, Pos.x), std::max(Max[Bone].y, Pos.y), std::max(Max[Bone].z, Pos.z));
+	}
+
+	Proxy.m_Vertex.clear();
+	Proxy.m_Indices.clear();
+	Proxy.m_Bones.clear();
+	for (unsigned int Bone = 0; Bone < Used.size(); Bone++)
+	{
+		if (!Used[Bone])
+		{
+			continue;
+		}
+		const unsigned int Base = Proxy.m_Vertex.size();
+		VertexBoneData Rigid;
+		Rigid.IDs[0] = (float)Bone;
+		Rigid.Weights[0] = 1.0f;
+		for (unsigned int c = 0; c < 8; c++)
+		{
+			const Vector3f Corner((c & 1) ? Max[Bone].x : Min[Bone].x, (c & 2) ? Max[Bone].y : Min[Bone].y, (c & 4) ? Max[Bone].z : Min[Bone].z);
+			Proxy.m_Vertex.push_back(SkinnedVertex(Corner, Vector2f(0.0f, 0.0f), Rigid));
+		}
+		for (unsigned int i = 0; i < 36; i++)
+		{
+			Proxy.m_Indices.push_back(Base + BoxIndices[i]);
+		}
+		Proxy.m_Bones.push_back(Bone);
+	}
+}
+
+double BenchmarkSkinning(const CpuSkinner& Skinner, const SkinningJob& Job, unsigned int Iterations)
+{
+	// once to warm up caches and page in the output
+	Skinner.Skin(Job);
+	const std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < Iterations; i++)
+	{
+		Skinner.Skin(Job);
+	}
+	const double Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - Start).count();
+	return Seconds > 0.0 ? (double)Job.NumVertices * Iterations / Seconds : 0.0;
+}
+
+static float Distance(const Vector3f& a, const Vector3f& b)
+{
+	const Vector3f d = a - b;
+	return sqrtf(d.x * d.x + d.y * d.y + d.z * d.z);
+}
+
+float CompareSkinningWithReference(const CpuSkinner& Skinner, const SkinningJob& Job)
+{
+	if (!Job.NumVertices)
+	{
+		return 0.0f;
+	}
+	std::vector<Vector3f> Positions(Job.NumVertices);
+	std::vector<Vector3f> Normals(Job.pNormals ? Job.NumVertices : 0);
+	SkinningJob Reference = Job;
+	Reference.pOutPositions = &Positions[0];
+	Reference.pOutNormals = Normals.empty() ? NULL : &Normals[0];
+	SkinVerticesReference(Reference, 0, Job.NumVertices);
+	Skinner.Skin(Job);
+
+	float MaxError = 0.0f;
+	for (unsigned int v = 0; v < Job.NumVertices; v++)
+	{
+		MaxError = std::max(MaxError, Distance(Job.pOutPositions[v], Positions[v]));
+		if (Job.pNormals)
+		{
+			MaxError = std::max(MaxError, Distance(Job.pOutNormals[v], Normals[v]));
+		}
+	}
+	return MaxError;
+}
+
+float CompareRigidDualQuatWithMatrices(const SkinningJob& Job)
+{
+	if (!Job.NumVertices || !Job.pPalette || !Job.pDualQuats)
+	{
+		return 0.0f;
+	}
+	std::vector<SkinnedVertex> Rigid(Job.pVertices, Job.pVertices + Job.NumVertices);
+	for (unsigned int v = 0; v < Rigid.size(); v++)
+	{
+		VertexBoneData Strongest;
+		Strongest.IDs[0] = Rigid[v].bonedata.IDs[0];
+		Strongest.Weights[0] = 1.0f;
+		Rigid[v].bonedata = Strongest;
+	}
+	std::vector<Vector3f> MatrixPositions(Job.NumVertices), DualQuatPositions(Job.NumVertices);
+	std::vector<Vector3f> MatrixNormals(Job.pNormals ? Job.NumVertices : 0), DualQuatNormals(MatrixNormals.size());
+	SkinningJob Matrices = Job;
+	Matrices.pVertices = &Rigid[0];
+	Matrices.pExtraBones = NULL;
+	Matrices.pDualQuats = NULL;
+	Matrices.pOutPositions = &MatrixPositions[0];
+	Matrices.pOutNormals = MatrixNormals.empty() ? NULL : &MatrixNormals[0];
+	SkinningJob DualQuats = Matrices;
+	DualQuats.pDualQuats = Job.pDualQuats;
+	DualQuats.pOutPositions = &DualQuatPositions[0];
+	DualQuats.pOutNormals = DualQuatNormals.empty() ? NULL : &DualQuatNormals[0];
+	SkinVerticesReference(Matrices, 0, Job.NumVertices);
+	SkinVerticesReference(DualQuats, 0, Job.NumVertices);
+
+	float MaxError = 0.0f;
+	for (unsigned int v = 0; v < Job.NumVertices; v++)
+	{
+		MaxError = std::max(MaxError, Distance(MatrixPositions[v], DualQuatPositions[v]));
+		if (Job.pNormals)
+		{
+			MaxError = std::max(MaxError, Distance(MatrixNormals[v], DualQuatNormals[v]));
+		}
+	}
+	return MaxError;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#ifndef CPU_SKINNING_H
+#define	CPU_SKINNING_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SkinnedVertex.h"
+#include "DualQuat.h"
+
+// Skins vertices on the CPU the way the VS techniques in FX/color.fx do: the matrices of a
+// vertex's influences are blended by weight and transform its position and normal. Bone
+// matrices are expected to be affine, their last row is ignored. Normals are transformed
+// by the blended upper 3x3 and renormalized, like the shader no inverse transpose is used.
+// With a dual quaternion palette the influences are blended linearly in the hemisphere of
+// the strongest one and the normalized result transforms the vertex, as VSDualQuat does.
+// Nothing in here touches the device, so hit detection and headless tests can use it.
+struct SkinningJob
+{
+	SkinningJob();
+	const SkinnedVertex* pVertices;
+	const VertexBoneData* pExtraBones;	// influences 5 to 8 of every vertex or NULL
+	const Vector3f* pNormals;			// NULL skips normals
+	unsigned int NumVertices;
+	const Matrix4f* pPalette;			// indexed by the vertex bone indices
+	const DualQuat* pDualQuats;			// replaces pPalette if given
+	unsigned int NumPalette;
+	Vector3f* pOutPositions;
+	Vector3f* pOutNormals;				// only written if pNormals is given
+};
+
+// Scalar version the SIMD one is checked against, skins the vertices [Begin, End)
+void SkinVerticesReference(const SkinningJob& Job, unsigned int Begin, unsigned int End);
+// SSE, two vertices at a time with AVX when compiled for it (/arch:AVX)
+void SkinVerticesSIMD(const SkinningJob& Job, unsigned int Begin, unsigned int End);
+
+// Spreads SkinVerticesSIMD over threads in ranges of at least MIN_VERTICES_PER_THREAD,
+// the calling thread takes the last range. The other threads are started once and wait
+// for jobs, so a Skin call costs a wake up instead of creating and joining threads.
+class CpuSkinner
+{
+public:
+	enum { MIN_VERTICES_PER_THREAD = 4096 };
+	// 0 uses as many threads as the hardware runs concurrently
+	explicit CpuSkinner(unsigned int NumThreads = 0);
+	~CpuSkinner();
+	// one job at a time, concurrent calls wait for each other
+	void Skin(const SkinningJob& Job) const;
+	unsigned int GetNumThreads() const
+	{
+		return m_NumThreads;
+	}
+
+private:
+	CpuSkinner(const CpuSkinner&);
+	CpuSkinner& operator=(const CpuSkinner&);
+	void WorkerLoop(unsigned int Worker) const;
+
+	unsigned int m_NumThreads;
+	std::vector<std::thread> m_Workers;
+	mutable std::mutex m_SkinMutex;		// held by the Skin call that owns the workers
+	mutable std::mutex m_Mutex;			// guards the members below
+	mutable std::condition_variable m_Start;
+	mutable std::condition_variable m_Done;
+	mutable const SkinningJob* m_pJob;
+	mutable unsigned int m_NumRanges;
+	mutable unsigned int m_RangeSize;
+	mutable unsigned int m_Generation;	// counts the jobs handed to the workers
+	mutable unsigned int m_Pending;		// ranges of the current job still being skinned
+	bool m_Quit;
+};
+
+// Boxes around the bind pose vertices each palette bone influences most, as a mesh of
+// 8 corners and 12 triangles per box. The corners follow their bone alone, so skinning
+// the proxy costs 8 vertices per bone instead of the whole entry.
+struct HitboxProxy
+{
+	std::vector<SkinnedVertex> m_Vertex;
+	std::vector<unsigned int> m_Indices;
+	std::vector<unsigned int> m_Bones;	// palette bone of each box
+};
+
+// Vertices must carry their strongest influence first, as BoneInfluenceBuilder writes them
+void BuildHitboxProxy(const SkinnedVertex* pVertices, unsigned int NumVertices, HitboxProxy& Proxy);
+
+// Skins Job Iterations times and returns the vertices skinned per second
+double BenchmarkSkinning(const CpuSkinner& Skinner, const SkinningJob& Job, unsigned int Iterations);
+// Largest distance of Skinner's positions and normals to the ones of SkinVerticesReference,
+// the output arrays of Job are overwritten
+float CompareSkinningWithReference(const CpuSkinner& Skinner, const SkinningJob& Job);
+// Skins every vertex rigidly by its strongest influence, once with the matrix and once with
+// the dual quaternion palette of Job, and returns the largest distance between the results.
+// Both palettes describe the same pose, so anything beyond float precision is an error.
+float CompareRigidDualQuatWithMatrices(const SkinningJob& Job);
+
+#endif
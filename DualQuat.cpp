@@ -0,0 +1,101 @@
+#include "DualQuat.h"
+#include <cmath>
+
+// Hamilton product of quaternions stored x, y, z, w
+static void QuatMultiply(const float a[4], const float b[4], float Out[4])
+{
+	Out[0] = a[3] * b[0] + b[3] * a[0] + a[1] * b[2] - a[2] * b[1];
+	Out[1] = a[3] * b[1] + b[3] * a[1] + a[2] * b[0] - a[0] * b[2];
+	Out[2] = a[3] * b[2] + b[3] * a[2] + a[0] * b[1] - a[1] * b[0];
+	Out[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+}
+
+DualQuat::DualQuat()
+{
+	Real[0] = Real[1] = Real[2] = 0.0f;
+	Real[3] = 1.0f;
+	Dual[0] = Dual[1] = Dual[2] = Dual[3] = 0.0f;
+}
+
+DualQuat::DualQuat(const aiQuaternion& Rotation, const aiVector3D& Translation)
+{
+	Real[0] = Rotation.x;
+	Real[1] = Rotation.y;
+	Real[2] = Rotation.z;
+	Real[3] = Rotation.w;
+	const float t[4] = { 0.5f * Translation.x, 0.5f * Translation.y, 0.5f * Translation.z, 0.0f };
+	QuatMultiply(t, Real, Dual);
+}
+
+DualQuat DualQuat::operator*(const DualQuat& Right) const
+{
+	DualQuat Ret;
+	QuatMultiply(Real, Right.Real, Ret.Real);
+	float a[4], b[4];
+	QuatMultiply(Real, Right.Dual, a);
+	QuatMultiply(Dual, Right.Real, b);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		Ret.Dual[i] = a[i] + b[i];
+	}
+	return Ret;
+}
+
+Vector3f DualQuat::Rotate(const Vector3f& v) const
+{
+	// v + 2 r x (r x v + w v)
+	const Vector3f r(Real[0], Real[1], Real[2]);
+	const Vector3f c = r.Cross(v) + v * Real[3];
+	return v + r.Cross(c) * 2.0f;
+}
+
+Vector3f DualQuat::GetTranslation() const
+{
+	// vector part of 2 * Dual * conjugate(Real)
+	const Vector3f r(Real[0], Real[1], Real[2]);
+	const Vector3f d(Dual[0], Dual[1], Dual[2]);
+	return (d * Real[3] - r * Dual[3] + r.Cross(d)) * 2.0f;
+}
+
+Vector3f DualQuat::Transform(const Vector3f& Point) const
+{
+	return Rotate(Point) + GetTranslation();
+}
+
+bool DualQuatFromMatrix(const Matrix4f& Matrix, DualQuat& Out, float Tolerance)
+{
+	const float (&m)[4][4] = Matrix.m;
+	const aiMatrix4x4 Affine(m[0][0], m[0][1], m[0][2], m[0][3],
+		m[1][0], m[1][1], m[1][2], m[1][3],
+		m[2][0], m[2][1], m[2][2], m[2][3],
+		0.0f, 0.0f, 0.0f, 1.0f);
+	aiVector3D Scaling, Translation;
+	aiQuaternion Rotation;
+	Affine.Decompose(Scaling, Rotation, Translation);
+	Rotation.Normalize();
+	Out = DualQuat(Rotation, Translation);
+	return Affine.Determinant() > 0.0f && fabsf(Scaling.x - 1.0f) <= Tolerance &&
+		fabsf(Scaling.y - 1.0f) <= Tolerance && fabsf(Scaling.z - 1.0f) <= Tolerance;
+}
+
+Matrix4f DualQuatToMatrix(const DualQuat& Transform)
+{
+	const float x = Transform.Real[0], y = Transform.Real[1], z = Transform.Real[2], w = Transform.Real[3];
+	const Vector3f t = Transform.GetTranslation();
+	Matrix4f Ret;
+	Ret.m[0][0] = 1.0f - 2.0f * (y * y + z * z);
+	Ret.m[0][1] = 2.0f * (x * y - w * z);
+	Ret.m[0][2] = 2.0f * (x * z + w * y);
+	Ret.m[0][3] = t.x;
+	Ret.m[1][0] = 2.0f * (x * y + w * z);
+	Ret.m[1][1] = 1.0f - 2.0f * (x * x + z * z);
+	Ret.m[1][2] = 2.0f * (y * z - w * x);
+	Ret.m[1][3] = t.y;
+	Ret.m[2][0] = 2.0f * (x * z - w * y);
+	Ret.m[2][1] = 2.0f * (y * z + w * x);
+	Ret.m[2][2] = 1.0f - 2.0f * (x * x + y * y);
+	Ret.m[2][3] = t.z;
+	Ret.m[3][0] = Ret.m[3][1] = Ret.m[3][2] = 0.0f;
+	Ret.m[3][3] = 1.0f;
+	return Ret;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef DUAL_QUAT_H
+#define	DUAL_QUAT_H
+
+#include <assimp/types.h>
+#include "ogldev_math_3d.h"
+using namespace ogldev;
+
+// Rigid transform as unit dual quaternion: Real is the rotation, Dual = 0.5 * t * Real for
+// the translation t. Both parts are stored x, y, z, w, the way the shaders read them as two
+// float4, so a bone takes 32 bytes of palette instead of the 64 of a Matrix4f.
+struct DualQuat
+{
+	DualQuat();
+	DualQuat(const aiQuaternion& Rotation, const aiVector3D& Translation);
+	// Right is applied first, as with Matrix4f
+	DualQuat operator*(const DualQuat& Right) const;
+	Vector3f Transform(const Vector3f& Point) const;
+	Vector3f Rotate(const Vector3f& Vector) const;
+	Vector3f GetTranslation() const;
+	float Real[4];
+	float Dual[4];
+};
+
+// Rotation and translation of an affine matrix. Returns false if the matrix scales or
+// mirrors by more than Tolerance, Out lacks that part then.
+bool DualQuatFromMatrix(const Matrix4f& Matrix, DualQuat& Out, float Tolerance = 1e-3f);
+Matrix4f DualQuatToMatrix(const DualQuat& Transform);
+
+#endif
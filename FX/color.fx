@@ -14,6 +14,12 @@ cbuffer cbSkinned
 	float4x4 gBoneTransforms[96];
 };
 
+// real and dual part of every bone, x y z w each (DualQuat.h)
+cbuffer cbSkinnedDualQuat
+{
+	float4 gBoneDualQuats[192];
+};
+
 // Nonnumeric values cannot be added to a cbuffer.
 Texture2D gDiffuseMap;
 //Texture2D gNormalMap;
@@ -87,6 +93,98 @@ VertexOut VS(VertexIn vin)
     return vout;
 }
 
+// influences 5 to 8 from the second vertex stream
+struct VertexIn8
+{
+	float3 PosL         : POSITION;
+	float2 Tex          : TEXCOORD;
+	float4 Weights      : WEIGHTS0;
+	float4 BoneIndices  : BONEINDICES0;
+	float4 Weights1     : WEIGHTS1;
+	float4 BoneIndices1 : BONEINDICES1;
+};
+
+VertexOut VS8(VertexIn8 vin)
+{
+	VertexOut vout;
+
+	float4x4 BoneTransform = gBoneTransforms[vin.BoneIndices[0]] * vin.Weights[0];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[1]] * vin.Weights[1];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[2]] * vin.Weights[2];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[3]] * vin.Weights[3];
+	BoneTransform += gBoneTransforms[vin.BoneIndices1[0]] * vin.Weights1[0];
+	BoneTransform += gBoneTransforms[vin.BoneIndices1[1]] * vin.Weights1[1];
+	BoneTransform += gBoneTransforms[vin.BoneIndices1[2]] * vin.Weights1[2];
+	BoneTransform += gBoneTransforms[vin.BoneIndices1[3]] * vin.Weights1[3];
+	float4 pos = mul(BoneTransform, float4(vin.PosL, 1.0));
+	vout.PosH = mul(pos, gWorldViewProj);
+	vout.Tex = vin.Tex;
+	return vout;
+}
+
+// SkinnedVertex.h, PackedVertexLayout
+struct VertexInPacked
+{
+	float3 PosL        : POSITION;
+	float2 Tex         : TEXCOORD;     // R16G16_FLOAT
+	float4 Weights     : WEIGHTS;      // UNORM, sums up to one
+	uint4 BoneIndices  : BONEINDICES;  // R8G8B8A8_UINT
+};
+
+VertexOut VSPacked(VertexInPacked vin)
+{
+	VertexOut vout;
+
+	float4x4 BoneTransform = gBoneTransforms[vin.BoneIndices[0]] * vin.Weights[0];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[1]] * vin.Weights[1];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[2]] * vin.Weights[2];
+	BoneTransform += gBoneTransforms[vin.BoneIndices[3]] * vin.Weights[3];
+	float4 pos = mul(BoneTransform, float4(vin.PosL, 1.0));
+	vout.PosH = mul(pos, gWorldViewProj);
+	vout.Tex = vin.Tex;
+	return vout;
+}
+
+// Blends linearly in the hemisphere of the first, strongest influence and transforms
+// Pos by the normalized result
+float3 DualQuatSkin(float3 Pos, uint4 Bones, float4 Weights)
+{
+	float4 Pivot = gBoneDualQuats[2 * Bones[0]];
+	float4 Real = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float4 Dual = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	[unroll]
+	for (int i = 0; i < 4; ++i)
+	{
+		float4 BoneReal = gBoneDualQuats[2 * Bones[i]];
+		float Weight = dot(BoneReal, Pivot) < 0.0f ? -Weights[i] : Weights[i];
+		Real += BoneReal * Weight;
+		Dual += gBoneDualQuats[2 * Bones[i] + 1] * Weight;
+	}
+	float Length = length(Real);
+	Real /= Length;
+	Dual /= Length;
+	float3 Translation = 2.0f * (Real.w * Dual.xyz - Dual.w * Real.xyz + cross(Real.xyz, Dual.xyz));
+	return Pos + 2.0f * cross(Real.xyz, cross(Real.xyz, Pos) + Real.w * Pos) + Translation;
+}
+
+VertexOut VSDualQuat(VertexIn vin)
+{
+	VertexOut vout;
+	float3 pos = DualQuatSkin(vin.PosL, (uint4)vin.BoneIndices, vin.Weights);
+	vout.PosH = mul(float4(pos, 1.0f), gWorldViewProj);
+	vout.Tex = vin.Tex;
+	return vout;
+}
+
+VertexOut VSPackedDualQuat(VertexInPacked vin)
+{
+	VertexOut vout;
+	float3 pos = DualQuatSkin(vin.PosL, vin.BoneIndices, vin.Weights);
+	vout.PosH = mul(float4(pos, 1.0f), gWorldViewProj);
+	vout.Tex = vin.Tex;
+	return vout;
+}
+
 float4 PS(VertexOut pin) : SV_Target
 {
 	float4 Color;
@@ -103,3 +201,43 @@ technique11 ColorTech
         SetPixelShader( CompileShader( ps_5_0, PS() ) );
     }
 }
+
+technique11 ColorTechPacked
+{
+    pass P0
+    {
+        SetVertexShader( CompileShader( vs_5_0, VSPacked() ) );
+		SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS() ) );
+    }
+}
+
+technique11 ColorTech8
+{
+    pass P0
+    {
+        SetVertexShader( CompileShader( vs_5_0, VS8() ) );
+		SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS() ) );
+    }
+}
+
+technique11 ColorTechDualQuat
+{
+    pass P0
+    {
+        SetVertexShader( CompileShader( vs_5_0, VSDualQuat() ) );
+		SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS() ) );
+    }
+}
+
+technique11 ColorTechPackedDualQuat
+{
+    pass P0
+    {
+        SetVertexShader( CompileShader( vs_5_0, VSPackedDualQuat() ) );
+		SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS() ) );
+    }
+}
@@ -0,0 +1,94 @@
+#include "GeometryPool.h"
+#include "util.h"
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+GeometryPool::GeometryPool(unsigned int VertexStride)
+{
+	Reset(VertexStride);
+}
+
+void GeometryPool::Reset(unsigned int VertexStride)
+{
+	m_VertexStride = VertexStride;
+	m_NumVertices = 0;
+	m_Ranges.clear();
+	m_VertexData.clear();
+	m_IndexData.clear();
+}
+
+unsigned int GeometryPool::Add(const void* pVertices, unsigned int NumVertices, const unsigned int* pIndices, unsigned int NumIndices)
+{
+	Range r;
+	r.BaseVertex = m_NumVertices;
+	r.NumVertices = NumVertices;
+	r.NumIndices = NumIndices;
+	r.IndexSize = NumVertices <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	// pad, so the range starts at a whole index of its own size
+	const size_t Start = (m_IndexData.size() + r.IndexSize - 1) / r.IndexSize * r.IndexSize;
+	r.StartIndex = Start / r.IndexSize;
+	m_IndexData.resize(Start + NumIndices * r.IndexSize);
+	unsigned char* pOut = NumIndices ? &m_IndexData[Start] : NULL;
+	for (unsigned int i = 0; i < NumIndices; i++)
+	{
+		assert(pIndices[i] < NumVertices);
+		if (r.IndexSize == sizeof(uint16_t))
+		{
+			const uint16_t Index = (uint16_t)pIndices[i];
+			memcpy(pOut + i * sizeof(Index), &Index, sizeof(Index));
+		}
+		else
+		{
+			memcpy(pOut + i * sizeof(uint32_t), &pIndices[i], sizeof(uint32_t));
+		}
+	}
+
+	const size_t Bytes = (size_t)NumVertices * m_VertexStride;
+	m_VertexData.resize(m_VertexData.size() + Bytes);
+	if (Bytes)
+	{
+		memcpy(&m_VertexData[m_VertexData.size() - Bytes], pVertices, Bytes);
+	}
+	m_NumVertices += NumVertices;
+	m_Ranges.push_back(r);
+	return m_Ranges.size() - 1;
+}
+
+void GeometryPool::ReleaseData()
+{
+	std::vector<unsigned char>().swap(m_VertexData);
+	std::vector<unsigned char>().swap(m_IndexData);
+}
+
+void CreatePoolBuffers(ID3D11Device* device, const GeometryPool& Pool, ID3D11Buffer** ppVB, ID3D11Buffer** ppIB)
+{
+	D3D11_BUFFER_DESC vbd;
+	vbd.Usage = D3D11_USAGE_IMMUTABLE;
+	vbd.ByteWidth = Pool.GetVertexData().size();
+	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vbd.CPUAccessFlags = 0;
+	vbd.MiscFlags = 0;
+	vbd.StructureByteStride = 0;
+	D3D11_SUBRESOURCE_DATA vinitData;
+	vinitData.pSysMem = &Pool.GetVertexData()[0];// &indices[0]
+	HR(device->CreateBuffer(&vbd, &vinitData, ppVB));
+	if (!ppIB)
+	{
+		return;
+	}
+	D3D11_BUFFER_DESC ibd;
+	ibd.Usage = D3D11_USAGE_IMMUTABLE;
+	// index data of 16-bit ranges may end on half a UINT
+	ibd.ByteWidth = (Pool.GetIndexData().size() + 3) & ~3;
+	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	ibd.CPUAccessFlags = 0;
+	ibd.MiscFlags = 0;
+	ibd.StructureByteStride = 0;
+	D3D11_SUBRESOURCE_DATA iinitData;
+	std::vector<unsigned char> Indices(ibd.ByteWidth, 0);
+	std::copy(Pool.GetIndexData().begin(), Pool.GetIndexData().end(), Indices.begin());
+	iinitData.pSysMem = &Indices[0];//.data();
+	HR(device->CreateBuffer(&ibd, &iinitData, ppIB));
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef GEOMETRY_POOL_H
+#define	GEOMETRY_POOL_H
+
+#include <vector>
+
+struct ID3D11Device;
+struct ID3D11Buffer;
+
+// CPU side of a vertex/index arena shared by many draw ranges. Every range keeps its
+// own vertex numbering and is drawn with DrawIndexed(NumIndices, StartIndex, BaseVertex).
+// Ranges with at most 65536 vertices store 16 bit indices, the others 32 bit ones, so one
+// index buffer holds both; a range's indices start at a multiple of its index size.
+// The pool itself doesn't touch the device, CreatePoolBuffers uploads it.
+class GeometryPool
+{
+public:
+	struct Range
+	{
+		unsigned int BaseVertex;
+		unsigned int NumVertices;
+		unsigned int StartIndex;	// in units of IndexSize
+		unsigned int NumIndices;
+		unsigned int IndexSize;		// 2 or 4 bytes
+	};
+
+	explicit GeometryPool(unsigned int VertexStride = 0);
+	// Drops all ranges, the pool takes vertices of VertexStride bytes afterwards
+	void Reset(unsigned int VertexStride);
+	// Appends NumVertices vertices and their indices, which must be below NumVertices.
+	// Returns the slot of the new range.
+	unsigned int Add(const void* pVertices, unsigned int NumVertices, const unsigned int* pIndices, unsigned int NumIndices);
+	// Frees the vertex and index data once uploaded, the ranges stay valid
+	void ReleaseData();
+
+	unsigned int GetNumRanges() const
+	{
+		return m_Ranges.size();
+	}
+	const Range& GetRange(unsigned int Slot) const
+	{
+		return m_Ranges[Slot];
+	}
+	unsigned int GetVertexStride() const
+	{
+		return m_VertexStride;
+	}
+	const std::vector<unsigned char>& GetVertexData() const
+	{
+		return m_VertexData;
+	}
+	const std::vector<unsigned char>& GetIndexData() const
+	{
+		return m_IndexData;
+	}
+
+private:
+	unsigned int m_VertexStride;
+	unsigned int m_NumVertices;
+	std::vector<Range> m_Ranges;
+	std::vector<unsigned char> m_VertexData;
+	std::vector<unsigned char> m_IndexData;
+};
+
+// One immutable vertex and index buffer for all ranges of Pool. ppIB may be NULL for
+// pools of a secondary vertex stream.
+void CreatePoolBuffers(ID3D11Device* device, const GeometryPool& Pool, ID3D11Buffer** ppVB, ID3D11Buffer** ppIB);
+
+#endif
@@ -0,0 +1,14 @@
+#include "MeshImport.h"
+#include <assimp/config.h>
+#include <assimp/postprocess.h>
+
+Assimp::Importer& SetupCacheOptimizer(Assimp::Importer& Importer, unsigned int MaxBones)
+{
+	Importer.SetPropertyInteger(AI_CONFIG_PP_ICL_ALGORITHM, aiCacheLocalityAlgorithm_Forsyth);
+	Importer.SetPropertyBool(AI_CONFIG_PP_ICL_REORDER_VERTICES, true);
+	if (MaxBones)
+	{
+		Importer.SetPropertyInteger(AI_CONFIG_PP_SBBC_MAX_BONES, MaxBones);
+	}
+	return Importer;
+}
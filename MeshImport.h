@@ -0,0 +1,15 @@
+#pragma once
+
+#ifndef MESH_IMPORT_H
+#define	MESH_IMPORT_H
+
+#include <assimp/Importer.hpp>
+
+// Import settings shared by Mesh and SkinnedMesh. Faces are reordered for the
+// post-transform cache and vertices renumbered in the order of first use, so the
+// buffers built from the scene are cache friendly. With MaxBones set, meshes with
+// more bones than that are split (aiProcess_SplitByBoneCount), every entry then
+// draws with a palette of its own bones. Returns Importer.
+Assimp::Importer& SetupCacheOptimizer(Assimp::Importer& Importer, unsigned int MaxBones = 0);
+
+#endif
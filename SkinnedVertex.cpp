@@ -0,0 +1,392 @@
+#include "SkinnedVertex.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+BoneInfluenceStats::BoneInfluenceStats()
+{
+	NumVertices = 0;
+	NumTruncated = 0;
+	MaxInfluences = 0;
+	MaxDroppedWeight = 0.0f;
+	SumDroppedWeight = 0.0f;
+}
+
+void BoneInfluenceStats::Merge(const BoneInfluenceStats& Other)
+{
+	NumVertices += Other.NumVertices;
+	NumTruncated += Other.NumTruncated;
+	MaxInfluences = std::max(MaxInfluences, Other.MaxInfluences);
+	MaxDroppedWeight = std::max(MaxDroppedWeight, Other.MaxDroppedWeight);
+	SumDroppedWeight += Other.SumDroppedWeight;
+}
+
+BoneInfluenceBuilder::BoneInfluenceBuilder(unsigned int NumVertices, unsigned int MaxInfluences)
+{
+	assert(MaxInfluences > 0 && MaxInfluences <= MAX_INFLUENCES);
+	m_MaxInfluences = std::max(1u, std::min(MaxInfluences, (unsigned int)MAX_INFLUENCES));
+	m_Weights.resize(NumVertices * m_MaxInfluences, 0.0f);
+	m_IDs.resize(NumVertices * m_MaxInfluences, 0);
+	m_Count.resize(NumVertices, 0);
+	m_MinSlot.resize(NumVertices, 0);
+	m_NumSeen.resize(NumVertices, 0);
+	m_Total.resize(NumVertices, 0.0f);
+	m_Dropped.resize(NumVertices, 0.0f);
+}
+
+void BoneInfluenceBuilder::AddBone(unsigned int BoneIndex, const aiVertexWeight* pWeights, unsigned int NumWeights)
+{
+	for (unsigned int i = 0; i < NumWeights; i++)
+	{
+		const unsigned int Vertex = pWeights[i].mVertexId;
+		const float Weight = pWeights[i].mWeight;
+		if (Vertex >= m_Count.size() || !(Weight > 0.0f))
+		{
+			continue;
+		}
+		m_NumSeen[Vertex]++;
+		m_Total[Vertex] += Weight;
+		float* Weights = &m_Weights[Vertex * m_MaxInfluences];
+		unsigned int* IDs = &m_IDs[Vertex * m_MaxInfluences];
+		unsigned int Slot;
+		if (m_Count[Vertex] < m_MaxInfluences)
+		{
+			Slot = m_Count[Vertex]++;
+			if (Slot == 0 || Weight < Weights[m_MinSlot[Vertex]])
+			{
+				m_MinSlot[Vertex] = Slot;
+			}
+			Weights[Slot] = Weight;
+			IDs[Slot] = BoneIndex;
+			continue;
+		}
+		Slot = m_MinSlot[Vertex];
+		if (Weight <= Weights[Slot])
+		{
+			m_Dropped[Vertex] += Weight;
+			continue;
+		}
+		m_Dropped[Vertex] += Weights[Slot];
+		Weights[Slot] = Weight;
+		IDs[Slot] = BoneIndex;
+		for (unsigned int k = 0; k < m_MaxInfluences; k++)
+		{
+			if (Weights[k] < Weights[Slot])
+			{
+				Slot = k;
+			}
+		}
+		m_MinSlot[Vertex] = Slot;
+	}
+}
+
+void BoneInfluenceBuilder::Build(std::vector<VertexBoneData>& Bones, std::vector<VertexBoneData>* pExtraBones, BoneInfluenceStats& Stats) const
+{
+	const unsigned int NumVertices = m_Count.size();
+	Bones.assign(NumVertices, VertexBoneData());
+	if (pExtraBones)
+	{
+		pExtraBones->assign(NumVertices, VertexBoneData());
+	}
+	Stats = BoneInfluenceStats();
+	Stats.NumVertices = NumVertices;
+	for (unsigned int v = 0; v < NumVertices; v++)
+	{
+		// strongest first, so the first stream carries the most important influences
+		float Weights[MAX_INFLUENCES];
+		unsigned int IDs[MAX_INFLUENCES];
+		const unsigned int Count = m_Count[v];
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			unsigned int k = i;
+			const float Weight = m_Weights[v * m_MaxInfluences + i];
+			for (; k > 0 && Weights[k - 1] < Weight; k--)
+			{
+				Weights[k] = Weights[k - 1];
+				IDs[k] = IDs[k - 1];
+			}
+			Weights[k] = Weight;
+			IDs[k] = m_IDs[v * m_MaxInfluences + i];
+		}
+		const unsigned int Kept = std::min(Count, (pExtraBones ? 2u : 1u) * NUM_BONES_PER_VEREX);
+		float Sum = 0.0f;
+		for (unsigned int i = 0; i < Kept; i++)
+		{
+			Sum += Weights[i];
+		}
+		for (unsigned int i = 0; i < Kept; i++)
+		{
+			VertexBoneData& Data = i < NUM_BONES_PER_VEREX ? Bones[v] : (*pExtraBones)[v];
+			Data.Weights[i % NUM_BONES_PER_VEREX] = Weights[i] / Sum;
+			Data.IDs[i % NUM_BONES_PER_VEREX] = (float)IDs[i];
+		}
+
+		float Dropped = m_Dropped[v];
+		for (unsigned int i = Kept; i < Count; i++)
+		{
+			Dropped += Weights[i];
+		}
+		if (Dropped > 0.0f)
+		{
+			const float Fraction = Dropped / m_Total[v];
+			Stats.NumTruncated++;
+			Stats.MaxDroppedWeight = std::max(Stats.MaxDroppedWeight, Fraction);
+			Stats.SumDroppedWeight += Fraction;
+		}
+		Stats.MaxInfluences = std::max(Stats.MaxInfluences, m_NumSeen[v]);
+	}
+}
+
+PackedVertexLayout::PackedVertexLayout(bool Weights16, bool Normal)
+{
+	m_Weights16 = Weights16;
+	m_Normal = Normal;
+	m_TexOffset = sizeof(Vector3f);
+	m_WeightOffset = m_TexOffset + 2 * sizeof(uint16_t);
+	m_BoneOffset = m_WeightOffset + NUM_BONES_PER_VEREX * (Weights16 ? 2 : 1);
+	m_NormalOffset = m_BoneOffset + NUM_BONES_PER_VEREX;
+	m_Stride = m_NormalOffset + (Normal ? 2 * sizeof(int16_t) : 0);
+}
+
+uint16_t FloatToHalf(float Value)
+{
+	uint32_t Bits;
+	memcpy(&Bits, &Value, sizeof(Bits));
+	const uint32_t Sign = (Bits >> 16) & 0x8000;
+	const uint32_t Abs = Bits & 0x7fffffff;
+	if (Abs > 0x7f800000)
+	{
+		// NaN
+		return (uint16_t)(Sign | 0x7e00);
+	}
+	if (Abs >= 0x47800000)
+	{
+		// 65536 and above (or infinity) overflows
+		return (uint16_t)(Sign | 0x7c00);
+	}
+	if (Abs < 0x38800000)
+	{
+		// below 2^-14 the result is a denormal, below 2^-25 it is zero
+		if (Abs < 0x33000000)
+		{
+			return (uint16_t)Sign;
+		}
+		const uint32_t Shift = 126 - (Abs >> 23);
+		const uint32_t Mantissa = (Abs & 0x7fffff) | 0x800000;
+		uint32_t Half = Mantissa >> Shift;
+		const uint32_t Rest = Mantissa & ((1u << Shift) - 1);
+		const uint32_t HalfWay = 1u << (Shift - 1);
+		if (Rest > HalfWay || (Rest == HalfWay && (Half & 1)))
+		{
+			++Half;
+		}
+		return (uint16_t)(Sign | Half);
+	}
+	// rebias the exponent and round to nearest even, a carry may end up in infinity
+	uint32_t Half = (Abs - 0x38000000) >> 13;
+	const uint32_t Rest = Abs & 0x1fff;
+	if (Rest > 0x1000 || (Rest == 0x1000 && (Half & 1)))
+	{
+		++Half;
+	}
+	return (uint16_t)(Sign | Half);
+}
+
+float HalfToFloat(uint16_t Value)
+{
+	const uint32_t Sign = (uint32_t)(Value & 0x8000) << 16;
+	const uint32_t Exponent = (Value >> 10) & 0x1f;
+	const uint32_t Mantissa = Value & 0x3ff;
+	if (Exponent == 0)
+	{
+		const float Denormal = ldexpf((float)Mantissa, -24);
+		return Sign ? -Denormal : Denormal;
+	}
+	uint32_t Bits;
+	if (Exponent == 31)
+	{
+		Bits = Sign | 0x7f800000 | (Mantissa << 13);
+	}
+	else
+	{
+		Bits = Sign | ((Exponent + 112) << 23) | (Mantissa << 13);
+	}
+	float Result;
+	memcpy(&Result, &Bits, sizeof(Result));
+	return Result;
+}
+
+static float SignNotZero(float Value)
+{
+	return Value >= 0.0f ? 1.0f : -1.0f;
+}
+
+void OctEncodeNormal(const Vector3f& Normal, int16_t Out[2])
+{
+	// project onto the octahedron and fold the lower half over the diagonals
+	const float L1 = fabsf(Normal.x) + fabsf(Normal.y) + fabsf(Normal.z);
+	float u = L1 > 0.0f ? Normal.x / L1 : 0.0f;
+	float v = L1 > 0.0f ? Normal.y / L1 : 0.0f;
+	if (Normal.z < 0.0f)
+	{
+		const float OldU = u;
+		u = (1.0f - fabsf(v)) * SignNotZero(OldU);
+		v = (1.0f - fabsf(OldU)) * SignNotZero(v);
+	}
+	Out[0] = (int16_t)floorf(std::max(-1.0f, std::min(1.0f, u)) * 32767.0f + 0.5f);
+	Out[1] = (int16_t)floorf(std::max(-1.0f, std::min(1.0f, v)) * 32767.0f + 0.5f);
+}
+
+Vector3f OctDecodeNormal(const int16_t In[2])
+{
+	// same as the SNORM conversion of the input assembler
+	const float u = std::max(In[0] / 32767.0f, -1.0f);
+	const float v = std::max(In[1] / 32767.0f, -1.0f);
+	Vector3f Normal(u, v, 1.0f - fabsf(u) - fabsf(v));
+	if (Normal.z < 0.0f)
+	{
+		Normal.x = (1.0f - fabsf(v)) * SignNotZero(u);
+		Normal.y = (1.0f - fabsf(u)) * SignNotZero(v);
+	}
+	const float Length = sqrtf(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+	Normal.x /= Length;
+	Normal.y /= Length;
+	Normal.z /= Length;
+	return Normal;
+}
+
+void QuantizeWeights(const float* Weights, unsigned int Count, unsigned int MaxValue, unsigned int* Out)
+{
+	float Sum = 0.0f;
+	for (unsigned int i = 0; i < Count; i++)
+	{
+		Sum += std::max(Weights[i], 0.0f);
+	}
+	if (Sum <= 0.0f)
+	{
+		std::fill(Out, Out + Count, 0u);
+		return;
+	}
+	unsigned int Total = 0;
+	unsigned int Largest = 0;
+	for (unsigned int i = 0; i < Count; i++)
+	{
+		Out[i] = (unsigned int)(std::max(Weights[i], 0.0f) / Sum * MaxValue + 0.5f);
+		Total += Out[i];
+		if (Out[i] > Out[Largest])
+		{
+			Largest = i;
+		}
+	}
+	// the largest weight absorbs the rounding error so the sum is exact
+	Out[Largest] = (unsigned int)((int)Out[Largest] + (int)MaxValue - (int)Total);
+}
+
+void PackSkinnedVertex(const PackedVertexLayout& Layout, const SkinnedVertex& Vertex, const Vector3f& Normal, unsigned char* Out)
+{
+	memcpy(Out, &Vertex.m_pos, sizeof(Vector3f));
+	const uint16_t Tex[2] = { FloatToHalf(Vertex.m_tex.x), FloatToHalf(Vertex.m_tex.y) };
+	memcpy(Out + Layout.m_TexOffset, Tex, sizeof(Tex));
+	unsigned int Weights[NUM_BONES_PER_VEREX];
+	QuantizeWeights(Vertex.bonedata.Weights, NUM_BONES_PER_VEREX, Layout.m_Weights16 ? 0xffff : 0xff, Weights);
+	for (unsigned int i = 0; i < NUM_BONES_PER_VEREX; i++)
+	{
+		if (Layout.m_Weights16)
+		{
+			const uint16_t Weight = (uint16_t)Weights[i];
+			memcpy(Out + Layout.m_WeightOffset + i * sizeof(Weight), &Weight, sizeof(Weight));
+		}
+		else
+		{
+			Out[Layout.m_WeightOffset + i] = (unsigned char)Weights[i];
+		}
+		Out[Layout.m_BoneOffset + i] = (unsigned char)std::max(0.0f, std::min(Vertex.bonedata.IDs[i], 255.0f));
+	}
+	if (Layout.m_Normal)
+	{
+		int16_t Oct[2];
+		OctEncodeNormal(Normal, Oct);
+		memcpy(Out + Layout.m_NormalOffset, Oct, sizeof(Oct));
+	}
+}
+
+void UnpackSkinnedVertex(const PackedVertexLayout& Layout, const unsigned char* In, SkinnedVertex& Vertex, Vector3f& Normal)
+{
+	memcpy(&Vertex.m_pos, In, sizeof(Vector3f));
+	uint16_t Tex[2];
+	memcpy(Tex, In + Layout.m_TexOffset, sizeof(Tex));
+	Vertex.m_tex = Vector2f(HalfToFloat(Tex[0]), HalfToFloat(Tex[1]));
+	for (unsigned int i = 0; i < NUM_BONES_PER_VEREX; i++)
+	{
+		if (Layout.m_Weights16)
+		{
+			uint16_t Weight;
+			memcpy(&Weight, In + Layout.m_WeightOffset + i * sizeof(Weight), sizeof(Weight));
+			Vertex.bonedata.Weights[i] = Weight / 65535.0f;
+		}
+		else
+		{
+			Vertex.bonedata.Weights[i] = In[Layout.m_WeightOffset + i] / 255.0f;
+		}
+		Vertex.bonedata.IDs[i] = (float)In[Layout.m_BoneOffset + i];
+	}
+	if (Layout.m_Normal)
+	{
+		int16_t Oct[2];
+		memcpy(Oct, In + Layout.m_NormalOffset, sizeof(Oct));
+		Normal = OctDecodeNormal(Oct);
+	}
+}
+
+bool CheckPackedVertex(const PackedVertexLayout& Layout, const SkinnedVertex& Vertex, const Vector3f& Normal, const unsigned char* Packed)
+{
+	SkinnedVertex Decoded;
+	Vector3f DecodedNormal(0.0f, 0.0f, 0.0f);
+	UnpackSkinnedVertex(Layout, Packed, Decoded, DecodedNormal);
+	if (memcmp(&Decoded.m_pos, &Vertex.m_pos, sizeof(Vector3f)) != 0)
+	{
+		return false;
+	}
+	const float TexTolerance = 1.0f / 2048.0f;
+	if (!(fabsf(Decoded.m_tex.x - Vertex.m_tex.x) <= TexTolerance && fabsf(Decoded.m_tex.y - Vertex.m_tex.y) <= TexTolerance))
+	{
+		return false;
+	}
+
+	// weights are compared after renormalization, each may be off by the rounding
+	// of its own and the rounding error the largest weight absorbed
+	float Sum = 0.0f;
+	for (unsigned int i = 0; i < NUM_BONES_PER_VEREX; i++)
+	{
+		Sum += std::max(Vertex.bonedata.Weights[i], 0.0f);
+	}
+	const float WeightTolerance = (0.5f * NUM_BONES_PER_VEREX + 0.5f) / (Layout.m_Weights16 ? 65535.0f : 255.0f);
+	for (unsigned int i = 0; i < NUM_BONES_PER_VEREX; i++)
+	{
+		const float Expected = Sum > 0.0f ? std::max(Vertex.bonedata.Weights[i], 0.0f) / Sum : 0.0f;
+		if (fabsf(Decoded.bonedata.Weights[i] - Expected) > WeightTolerance)
+		{
+			return false;
+		}
+		if (Expected > 0.0f && Decoded.bonedata.IDs[i] != Vertex.bonedata.IDs[i])
+		{
+			return false;
+		}
+	}
+
+	if (Layout.m_Normal)
+	{
+		const float Length = sqrtf(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+		if (Length > 0.0f)
+		{
+			const float Cos = (Normal.x * DecodedNormal.x + Normal.y * DecodedNormal.y + Normal.z * DecodedNormal.z) / Length;
+			// cos(0.1 degrees)
+			if (Cos < 0.9999985f)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#ifndef SKINNED_VERTEX_H
+#define	SKINNED_VERTEX_H
+
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+#include <assimp/mesh.h>
+#include "util.h"
+#include "ogldev_math_3d.h"
+using namespace ogldev;
+
+struct VertexBoneData
+{
+	float Weights[NUM_BONES_PER_VEREX];
+	float IDs[NUM_BONES_PER_VEREX];
+	VertexBoneData(const VertexBoneData& vbd)
+	{
+		IDs[0] = vbd.IDs[0];
+		IDs[1] = vbd.IDs[1];
+		IDs[2] = vbd.IDs[2];
+		IDs[3] = vbd.IDs[3];
+
+		Weights[0] = vbd.Weights[0];
+		Weights[1] = vbd.Weights[1];
+		Weights[2] = vbd.Weights[2];
+		Weights[3] = vbd.Weights[3];
+	}
+	VertexBoneData()
+	{
+		Reset();
+	};
+	void Reset()
+	{
+		ZERO_MEM(IDs);
+		ZERO_MEM(Weights);
+	}
+};
+
+// 52 bytes, fed as float3 / float2 / 2 x float4
+struct SkinnedVertex
+{
+	Vector3f m_pos;
+	Vector2f m_tex;
+	VertexBoneData bonedata;
+	SkinnedVertex() { }
+	SkinnedVertex(const Vector3f& pos, const Vector2f& tex /*const nv::vec3f& normal*/,const VertexBoneData& boneinfo)
+	{
+		m_pos = pos;
+		m_tex = tex;
+		//m_normal = normal;
+		bonedata = boneinfo;
+	}
+};
+
+// Error made by dropping the weakest influences, as fraction of a vertex's total weight
+struct BoneInfluenceStats
+{
+	BoneInfluenceStats();
+	void Merge(const BoneInfluenceStats& Other);
+	// averaged over the truncated vertices only
+	float MeanDroppedWeight() const
+	{
+		return NumTruncated ? SumDroppedWeight / NumTruncated : 0.0f;
+	}
+	unsigned int NumVertices;
+	unsigned int NumTruncated;	// vertices which lost influences
+	unsigned int MaxInfluences;	// most influences found on a single vertex
+	float MaxDroppedWeight;
+	float SumDroppedWeight;
+};
+
+// Keeps the strongest MaxInfluences bone weights of every vertex while going once over
+// the weights of all bones. Each vertex tracks its weakest slot, so a weight is either
+// appended, replaces the weakest one or is dropped without searching the slots.
+class BoneInfluenceBuilder
+{
+public:
+	enum { MAX_INFLUENCES = 2 * NUM_BONES_PER_VEREX };
+	BoneInfluenceBuilder(unsigned int NumVertices, unsigned int MaxInfluences = NUM_BONES_PER_VEREX);
+	void AddBone(unsigned int BoneIndex, const aiVertexWeight* pWeights, unsigned int NumWeights);
+	// Writes the kept influences sorted by weight and renormalized to sum up to one, the
+	// first NUM_BONES_PER_VEREX to Bones and the others to pExtraBones if given.
+	void Build(std::vector<VertexBoneData>& Bones, std::vector<VertexBoneData>* pExtraBones, BoneInfluenceStats& Stats) const;
+
+private:
+	unsigned int m_MaxInfluences;
+	std::vector<float> m_Weights;			// m_MaxInfluences slots per vertex
+	std::vector<unsigned int> m_IDs;
+	std::vector<unsigned char> m_Count;		// used slots
+	std::vector<unsigned char> m_MinSlot;	// weakest of the used slots
+	std::vector<unsigned int> m_NumSeen;
+	std::vector<float> m_Total;
+	std::vector<float> m_Dropped;
+};
+
+enum SkinnedVertexFormat
+{
+	SKINNED_VERTEX_FLOAT,	// SkinnedVertex
+	SKINNED_VERTEX_PACKED	// PackedVertexLayout
+};
+
+// Byte layout of a packed skinned vertex:
+//   float3 position, half2 UV, UNORM8x4 (or UNORM16x4) weights summing up to exactly one,
+//   UINT8x4 bone indices and an optional octahedral normal as SNORM16x2.
+// That's 24 bytes in the default configuration.
+struct PackedVertexLayout
+{
+	PackedVertexLayout(bool Weights16 = false, bool Normal = false);
+	bool m_Weights16;
+	bool m_Normal;
+	unsigned int m_Stride;
+	unsigned int m_TexOffset;
+	unsigned int m_WeightOffset;
+	unsigned int m_BoneOffset;
+	unsigned int m_NormalOffset;
+};
+
+uint16_t FloatToHalf(float Value);
+float HalfToFloat(uint16_t Value);
+void OctEncodeNormal(const Vector3f& Normal, int16_t Out[2]);
+Vector3f OctDecodeNormal(const int16_t In[2]);
+
+// Quantizes Count weights to integers in [0, MaxValue] which sum up to exactly MaxValue,
+// unless all weights are zero.
+void QuantizeWeights(const float* Weights, unsigned int Count, unsigned int MaxValue, unsigned int* Out);
+
+// Writes Layout.m_Stride bytes to Out, Normal is only read if the layout has normals.
+// Bone indices must be below 256.
+void PackSkinnedVertex(const PackedVertexLayout& Layout, const SkinnedVertex& Vertex, const Vector3f& Normal, unsigned char* Out);
+void UnpackSkinnedVertex(const PackedVertexLayout& Layout, const unsigned char* In, SkinnedVertex& Vertex, Vector3f& Normal);
+
+// Round trip check of a packed vertex against its source. UVs must survive within
+// 1/2048, weights within the quantization step, normals within 0.1 degrees.
+bool CheckPackedVertex(const PackedVertexLayout& Layout, const SkinnedVertex& Vertex, const Vector3f& Normal, const unsigned char* Packed);
+
+#endif
@@ -0,0 +1,218 @@
+#include "Test.h"
+#include "CpuSkinning.h"
+#include <algorithm>
+
+// positions lie within 60 units of the origin, SIMD and scalar code add in different order
+static const float MaxSkinningError = 1e-3f;
+
+static DualQuat MakeRigidBone(TestRandom& Random)
+{
+	aiQuaternion Rotation(Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f));
+	Rotation.Normalize();
+	const aiVector3D Translation(Random.Uniform(-10.0f, 10.0f), Random.Uniform(-10.0f, 10.0f), Random.Uniform(-10.0f, 10.0f));
+	return DualQuat(Rotation, Translation);
+}
+
+static VertexBoneData MakeInfluences(TestRandom& Random, unsigned int NumPalette)
+{
+	VertexBoneData Bones;
+	float Sum = 0.0f;
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		Bones.IDs[k] = (float)(Random.Next() % NumPalette);
+		Bones.Weights[k] = Random.Uniform(0.0f, 1.0f);
+		Sum += Bones.Weights[k];
+	}
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		Bones.Weights[k] /= Sum;
+	}
+	return Bones;
+}
+
+// A random mesh and pose, the palette holds the same bones as matrices and dual quaternions
+struct SkinningScene
+{
+	SkinningScene(unsigned int NumVertices, unsigned int NumPalette, bool ExtraBones)
+	{
+		TestRandom Random(NumVertices);
+		for (unsigned int b = 0; b < NumPalette; b++)
+		{
+			m_DualQuats.push_back(MakeRigidBone(Random));
+			m_Palette.push_back(DualQuatToMatrix(m_DualQuats.back()));
+		}
+		for (unsigned int v = 0; v < NumVertices; v++)
+		{
+			const Vector3f Pos(Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f));
+			m_Vertices.push_back(SkinnedVertex(Pos, Vector2f(0.0f, 0.0f), MakeInfluences(Random, NumPalette)));
+			Vector3f Normal(Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f), 1.0f);
+			m_Normals.push_back(Normal.Normalize());
+			if (ExtraBones)
+			{
+				// both halves of an eight influence vertex weigh one half
+				VertexBoneData Extra = MakeInfluences(Random, NumPalette);
+				for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+				{
+					Extra.Weights[k] *= 0.5f;
+					m_Vertices.back().bonedata.Weights[k] *= 0.5f;
+				}
+				m_ExtraBones.push_back(Extra);
+			}
+		}
+		m_Positions.resize(NumVertices);
+		m_OutNormals.resize(NumVertices);
+	}
+	SkinningJob GetJob()
+	{
+		SkinningJob Job;
+		Job.pVertices = &m_Vertices[0];
+		Job.pExtraBones = m_ExtraBones.empty() ? NULL : &m_ExtraBones[0];
+		Job.pNormals = &m_Normals[0];
+		Job.NumVertices = m_Vertices.size();
+		Job.pPalette = &m_Palette[0];
+		Job.NumPalette = m_Palette.size();
+		Job.pOutPositions = &m_Positions[0];
+		Job.pOutNormals = &m_OutNormals[0];
+		return Job;
+	}
+	std::vector<SkinnedVertex> m_Vertices;
+	std::vector<VertexBoneData> m_ExtraBones;
+	std::vector<Vector3f> m_Normals;
+	std::vector<Matrix4f> m_Palette;
+	std::vector<DualQuat> m_DualQuats;
+	std::vector<Vector3f> m_Positions;
+	std::vector<Vector3f> m_OutNormals;
+};
+
+TEST(CpuSkinningMatchesReference)
+{
+	// enough vertices for four uneven ranges
+	SkinningScene Scene(4 * CpuSkinner::MIN_VERTICES_PER_THREAD + 123, 40, false);
+	const CpuSkinner Threaded(4);
+	const CpuSkinner SingleThread(1);
+	SkinningJob Job = Scene.GetJob();
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+	CHECK(CompareSkinningWithReference(SingleThread, Job) <= MaxSkinningError);
+
+	// a scaled bone skins with the matrix path alone
+	Scene.m_Palette[3].m[0][0] *= 2.0f;
+	Scene.m_Palette[3].m[1][1] *= 0.5f;
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+
+	Job.pDualQuats = &Scene.m_DualQuats[0];
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+}
+
+TEST(CpuSkinningMatchesReferenceWithEightInfluences)
+{
+	SkinningScene Scene(2 * CpuSkinner::MIN_VERTICES_PER_THREAD + 1, MAX_PALETTE_BONES, true);
+	const CpuSkinner Threaded(3);
+	SkinningJob Job = Scene.GetJob();
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+	Job.pDualQuats = &Scene.m_DualQuats[0];
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+
+	// without normals nothing is written to them
+	Job.pNormals = NULL;
+	Job.pOutNormals = NULL;
+	CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+}
+
+TEST(CpuSkinnerReusesItsThreads)
+{
+	// the workers take one job after the other, of any size and with a different range count
+	const CpuSkinner Threaded(4);
+	const unsigned int Sizes[] = { 5 * CpuSkinner::MIN_VERTICES_PER_THREAD, 7, 2 * CpuSkinner::MIN_VERTICES_PER_THREAD + 9 };
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		SkinningScene Scene(Sizes[i], 20, false);
+		const SkinningJob Job = Scene.GetJob();
+		for (unsigned int n = 0; n < 50; n++)
+		{
+			Threaded.Skin(Job);
+		}
+		CHECK(CompareSkinningWithReference(Threaded, Job) <= MaxSkinningError);
+		CHECK(BenchmarkSkinning(Threaded, Job, 10) > 0.0);
+	}
+}
+
+TEST(CpuSkinningWithoutPaletteCopiesVertices)
+{
+	SkinningScene Scene(10, 1, false);
+	SkinningJob Job = Scene.GetJob();
+	Job.pPalette = NULL;
+	Job.NumPalette = 0;
+	CpuSkinner(2).Skin(Job);
+	unsigned int Moved = 0;
+	for (unsigned int v = 0; v < Job.NumVertices; v++)
+	{
+		const Vector3f& In = Scene.m_Vertices[v].m_pos;
+		const Vector3f& Out = Scene.m_Positions[v];
+		Moved += In.x != Out.x || In.y != Out.y || In.z != Out.z ? 1 : 0;
+	}
+	CHECK(Moved == 0);
+}
+
+TEST(RigidDualQuatsMatchMatrices)
+{
+	SkinningScene Scene(1000, MAX_PALETTE_BONES, true);
+	SkinningJob Job = Scene.GetJob();
+	Job.pDualQuats = &Scene.m_DualQuats[0];
+	CHECK(CompareRigidDualQuatWithMatrices(Job) <= MaxSkinningError);
+
+	// the opposite dual quaternion is the same transform
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		Scene.m_DualQuats[5].Real[i] = -Scene.m_DualQuats[5].Real[i];
+		Scene.m_DualQuats[5].Dual[i] = -Scene.m_DualQuats[5].Dual[i];
+	}
+	CHECK(CompareRigidDualQuatWithMatrices(Job) <= MaxSkinningError);
+
+	// a bone whose palettes disagree shows up
+	Scene.m_Palette[5].m[0][3] += 1.0f;
+	CHECK(CompareRigidDualQuatWithMatrices(Job) >= 0.99f);
+}
+
+TEST(DualQuatsComposeLikeMatrices)
+{
+	TestRandom Random;
+	float MaxError = 0.0f;
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		const DualQuat A = MakeRigidBone(Random);
+		const DualQuat B = MakeRigidBone(Random);
+		const Matrix4f Product = DualQuatToMatrix(A) * DualQuatToMatrix(B);
+		DualQuat Back;
+		CHECK(DualQuatFromMatrix(Product, Back));
+		const Vector3f Point(Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f));
+		const Vector3f Expected = A.Transform(B.Transform(Point));
+		const Vector4f Transformed = Product * Vector4f(Point.x, Point.y, Point.z, 1.0f);
+		const Vector3f Results[] = { (A * B).Transform(Point), Back.Transform(Point), Vector3f(Transformed.x, Transformed.y, Transformed.z) };
+		for (unsigned int r = 0; r < 3; r++)
+		{
+			const Vector3f d = Results[r] - Expected;
+			MaxError = std::max(MaxError, sqrtf(d.x * d.x + d.y * d.y + d.z * d.z));
+		}
+	}
+	CHECK(MaxError <= MaxSkinningError);
+}
+
+TEST(ScaledMatricesHaveNoDualQuat)
+{
+	TestRandom Random;
+	Matrix4f Matrix = DualQuatToMatrix(MakeRigidBone(Random));
+	DualQuat Out;
+	CHECK(DualQuatFromMatrix(Matrix, Out));
+	Matrix4f Scaled = Matrix;
+	for (unsigned int r = 0; r < 3; r++)
+	{
+		Scaled.m[r][1] *= 1.5f;
+	}
+	CHECK(!DualQuatFromMatrix(Scaled, Out));
+	// mirrored
+	for (unsigned int r = 0; r < 3; r++)
+	{
+		Matrix.m[r][2] = -Matrix.m[r][2];
+	}
+	CHECK(!DualQuatFromMatrix(Matrix, Out));
+}
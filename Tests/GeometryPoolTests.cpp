@@ -0,0 +1,120 @@
+#include "Test.h"
+#include "GeometryPool.h"
+#include <stdint.h>
+#include <string.h>
+
+// reads index i of Range from the pool's index data
+static unsigned int GetIndex(const GeometryPool& Pool, const GeometryPool::Range& Range, unsigned int i)
+{
+	const unsigned char* p = &Pool.GetIndexData()[(Range.StartIndex + i) * Range.IndexSize];
+	if (Range.IndexSize == sizeof(uint16_t))
+	{
+		uint16_t Index;
+		memcpy(&Index, p, sizeof(Index));
+		return Index;
+	}
+	uint32_t Index;
+	memcpy(&Index, p, sizeof(Index));
+	return Index;
+}
+
+// a strip of NumVertices vertices whose first component is First + their number
+static void AddStrip(GeometryPool& Pool, unsigned int NumVertices, unsigned int NumIndices, float First)
+{
+	std::vector<float> Vertices(NumVertices * 3);
+	for (unsigned int i = 0; i < NumVertices; i++)
+	{
+		Vertices[i * 3] = First + i;
+	}
+	std::vector<unsigned int> Indices(NumIndices);
+	for (unsigned int i = 0; i < NumIndices; i++)
+	{
+		Indices[i] = (i * 7) % NumVertices;
+	}
+	Pool.Add(&Vertices[0], NumVertices, NumIndices ? &Indices[0] : NULL, NumIndices);
+}
+
+static bool CheckStrip(const GeometryPool& Pool, unsigned int Slot, float First)
+{
+	const GeometryPool::Range& Range = Pool.GetRange(Slot);
+	for (unsigned int i = 0; i < Range.NumIndices; i++)
+	{
+		if (GetIndex(Pool, Range, i) != (i * 7) % Range.NumVertices)
+		{
+			return false;
+		}
+	}
+	for (unsigned int i = 0; i < Range.NumVertices; i++)
+	{
+		float x;
+		memcpy(&x, &Pool.GetVertexData()[(Range.BaseVertex + i) * Pool.GetVertexStride()], sizeof(x));
+		if (x != First + i)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(GeometryPoolRangesShareBuffers)
+{
+	GeometryPool Pool(3 * sizeof(float));
+	AddStrip(Pool, 4, 3, 0.0f);
+	AddStrip(Pool, 10, 15, 100.0f);
+	REQUIRE(Pool.GetNumRanges() == 2);
+
+	const GeometryPool::Range& First = Pool.GetRange(0);
+	const GeometryPool::Range& Second = Pool.GetRange(1);
+	CHECK(First.BaseVertex == 0 && First.StartIndex == 0);
+	CHECK(Second.BaseVertex == 4);
+	CHECK(Second.StartIndex == 3);
+	CHECK(First.IndexSize == 2 && Second.IndexSize == 2);
+	CHECK(Pool.GetVertexData().size() == 14 * 3 * sizeof(float));
+	CHECK(Pool.GetIndexData().size() == 18 * sizeof(uint16_t));
+	CHECK(CheckStrip(Pool, 0, 0.0f));
+	CHECK(CheckStrip(Pool, 1, 100.0f));
+}
+
+TEST(GeometryPoolMixesIndexSizes)
+{
+	GeometryPool Pool(3 * sizeof(float));
+	// an odd number of 16 bit indices leaves the next 32 bit range unaligned
+	AddStrip(Pool, 0x10000, 5, 0.0f);
+	AddStrip(Pool, 0x10001, 4, 1.0f);
+	AddStrip(Pool, 3, 3, 2.0f);
+	REQUIRE(Pool.GetNumRanges() == 3);
+
+	// 65536 vertices still fit 16 bit indices
+	CHECK(Pool.GetRange(0).IndexSize == 2);
+	const GeometryPool::Range& Wide = Pool.GetRange(1);
+	CHECK(Wide.IndexSize == 4);
+	CHECK(Wide.StartIndex * Wide.IndexSize == 12);
+	CHECK(Wide.BaseVertex == 0x10000);
+	const GeometryPool::Range& Narrow = Pool.GetRange(2);
+	CHECK(Narrow.IndexSize == 2);
+	CHECK(Narrow.StartIndex * Narrow.IndexSize == 28);
+	CHECK(Narrow.BaseVertex == 0x20001);
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		CHECK(CheckStrip(Pool, i, (float)i));
+	}
+}
+
+TEST(GeometryPoolReleaseKeepsRanges)
+{
+	GeometryPool Pool(3 * sizeof(float));
+	AddStrip(Pool, 8, 6, 0.0f);
+	Pool.ReleaseData();
+	CHECK(Pool.GetVertexData().empty() && Pool.GetIndexData().empty());
+	REQUIRE(Pool.GetNumRanges() == 1);
+	CHECK(Pool.GetRange(0).NumVertices == 8 && Pool.GetRange(0).NumIndices == 6);
+
+	// a reset pool starts over with the new stride
+	Pool.Reset(sizeof(float));
+	CHECK(Pool.GetNumRanges() == 0);
+	CHECK(Pool.GetVertexStride() == sizeof(float));
+	const float Vertex = 1.0f;
+	const unsigned int Index = 0;
+	CHECK(Pool.Add(&Vertex, 1, &Index, 1) == 0);
+	CHECK(Pool.GetRange(0).BaseVertex == 0);
+}
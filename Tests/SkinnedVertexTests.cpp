@@ -0,0 +1,229 @@
+#include "Test.h"
+#include "SkinnedVertex.h"
+#include <algorithm>
+
+// the bounds CheckPackedVertex applies when SkinnedMesh packs its vertices
+static const float TexTolerance = 1.0f / 2048.0f;
+static const float MinNormalCos = 0.9999985f;	// cos(0.1 degrees)
+
+static float WeightTolerance(unsigned int MaxValue)
+{
+	return (0.5f * NUM_BONES_PER_VEREX + 0.5f) / MaxValue;
+}
+
+static bool IsHalfNaN(uint16_t Half)
+{
+	return (Half & 0x7c00) == 0x7c00 && (Half & 0x3ff) != 0;
+}
+
+TEST(HalfRoundTripIsExact)
+{
+	// every half survives the trip through float unchanged
+	unsigned int Mismatches = 0;
+	for (unsigned int h = 0; h < 0x10000; h++)
+	{
+		const uint16_t Half = (uint16_t)h;
+		const uint16_t Back = FloatToHalf(HalfToFloat(Half));
+		if (IsHalfNaN(Half) ? !IsHalfNaN(Back) : Back != Half)
+		{
+			Mismatches++;
+		}
+	}
+	CHECK(Mismatches == 0);
+}
+
+TEST(HalfRoundsToNearestEven)
+{
+	CHECK(FloatToHalf(1.0f) == 0x3c00);
+	CHECK(FloatToHalf(-2.0f) == 0xc000);
+	// halfway between two halves goes to the even one
+	CHECK(FloatToHalf(1.0f + ldexpf(1.0f, -11)) == 0x3c00);
+	CHECK(FloatToHalf(1.0f + 3.0f * ldexpf(1.0f, -11)) == 0x3c02);
+	CHECK(FloatToHalf(65504.0f) == 0x7bff);
+	CHECK(FloatToHalf(65520.0f) == 0x7c00);
+	CHECK(FloatToHalf(-1e10f) == 0xfc00);
+	// denormals and underflow
+	CHECK(FloatToHalf(ldexpf(1.0f, -24)) == 0x0001);
+	CHECK(FloatToHalf(ldexpf(1.0f, -26)) == 0x0000);
+	CHECK(FloatToHalf(ldexpf(3.0f, -25)) == 0x0002);
+	CHECK(HalfToFloat(0x0001) == ldexpf(1.0f, -24));
+}
+
+TEST(HalfKeepsUVsWithinTolerance)
+{
+	// UVs in (-2, 2) keep the 1/2048 CheckPackedVertex allows, larger ones don't
+	TestRandom Random;
+	float MaxError = 0.0f;
+	for (unsigned int i = 0; i < 100000; i++)
+	{
+		const float UV = Random.Uniform(-2.0f, 2.0f);
+		MaxError = std::max(MaxError, fabsf(HalfToFloat(FloatToHalf(UV)) - UV));
+	}
+	CHECK(MaxError <= TexTolerance);
+	// halfway between two halves above 2, which are 1/512 apart
+	const float Large = 3.0f + ldexpf(1.0f, -10);
+	CHECK(fabsf(HalfToFloat(FloatToHalf(Large)) - Large) > TexTolerance);
+}
+
+TEST(QuantizedWeightsSumUpExactly)
+{
+	const unsigned int MaxValues[] = { 0xff, 0xffff };
+	TestRandom Random;
+	for (unsigned int m = 0; m < 2; m++)
+	{
+		const unsigned int MaxValue = MaxValues[m];
+		unsigned int BadSums = 0;
+		float MaxError = 0.0f;
+		for (unsigned int i = 0; i < 20000; i++)
+		{
+			float Weights[NUM_BONES_PER_VEREX];
+			float Sum = 0.0f;
+			for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+			{
+				// some vertices have fewer influences
+				Weights[k] = Random.Next() % 4 ? Random.Uniform(0.0f, 1.0f) : 0.0f;
+				Sum += Weights[k];
+			}
+			if (Sum <= 0.0f)
+			{
+				continue;
+			}
+			unsigned int Out[NUM_BONES_PER_VEREX];
+			QuantizeWeights(Weights, NUM_BONES_PER_VEREX, MaxValue, Out);
+			unsigned int Total = 0;
+			for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+			{
+				Total += Out[k];
+				MaxError = std::max(MaxError, fabsf((float)Out[k] / MaxValue - Weights[k] / Sum));
+			}
+			BadSums += Total != MaxValue ? 1 : 0;
+		}
+		CHECK(BadSums == 0);
+		CHECK(MaxError <= WeightTolerance(MaxValue));
+	}
+}
+
+TEST(QuantizeWeightsEdgeCases)
+{
+	const float Zero[NUM_BONES_PER_VEREX] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	unsigned int Out[NUM_BONES_PER_VEREX] = { 1, 1, 1, 1 };
+	QuantizeWeights(Zero, NUM_BONES_PER_VEREX, 0xff, Out);
+	CHECK(Out[0] == 0 && Out[1] == 0 && Out[2] == 0 && Out[3] == 0);
+
+	// negative weights count as zero
+	const float Negative[NUM_BONES_PER_VEREX] = { 0.5f, -0.25f, 0.5f, 0.0f };
+	QuantizeWeights(Negative, NUM_BONES_PER_VEREX, 0xff, Out);
+	CHECK(Out[1] == 0 && Out[3] == 0);
+	CHECK(Out[0] + Out[2] == 0xff);
+
+	// equal thirds round down, the largest slot takes the remainder
+	const float Thirds[NUM_BONES_PER_VEREX] = { 1.0f, 1.0f, 1.0f, 0.0f };
+	QuantizeWeights(Thirds, NUM_BONES_PER_VEREX, 0xff, Out);
+	CHECK(Out[0] + Out[1] + Out[2] == 0xff);
+}
+
+TEST(OctNormalsStayWithinTolerance)
+{
+	TestRandom Random;
+	float MinCos = 1.0f;
+	for (unsigned int i = 0; i < 100000; i++)
+	{
+		Vector3f Normal(Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f));
+		const float Length = sqrtf(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+		if (Length < 1e-3f)
+		{
+			continue;
+		}
+		Normal.x /= Length;
+		Normal.y /= Length;
+		Normal.z /= Length;
+		int16_t Oct[2];
+		OctEncodeNormal(Normal, Oct);
+		const Vector3f Decoded = OctDecodeNormal(Oct);
+		MinCos = std::min(MinCos, Normal.x * Decoded.x + Normal.y * Decoded.y + Normal.z * Decoded.z);
+	}
+	CHECK(MinCos >= MinNormalCos);
+
+	// the axes map to the corners and centre of the octahedron exactly
+	const Vector3f Axes[] = { Vector3f(1, 0, 0), Vector3f(0, -1, 0), Vector3f(0, 0, 1), Vector3f(0, 0, -1) };
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		int16_t Oct[2];
+		OctEncodeNormal(Axes[i], Oct);
+		const Vector3f Decoded = OctDecodeNormal(Oct);
+		CHECK(Decoded.x == Axes[i].x && Decoded.y == Axes[i].y && Decoded.z == Axes[i].z);
+	}
+}
+
+static SkinnedVertex MakeVertex(TestRandom& Random)
+{
+	VertexBoneData Bones;
+	for (unsigned int k = 0; k < NUM_BONES_PER_VEREX; k++)
+	{
+		Bones.Weights[k] = Random.Uniform(0.0f, 1.0f);
+		Bones.IDs[k] = (float)(Random.Next() % MAX_PALETTE_BONES);
+	}
+	const Vector3f Pos(Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f), Random.Uniform(-50.0f, 50.0f));
+	const Vector2f Tex(Random.Uniform(-1.0f, 2.0f), Random.Uniform(-1.0f, 2.0f));
+	return SkinnedVertex(Pos, Tex, Bones);
+}
+
+TEST(PackedVerticesPassTheirCheck)
+{
+	TestRandom Random;
+	for (unsigned int l = 0; l < 4; l++)
+	{
+		const PackedVertexLayout Layout((l & 1) != 0, (l & 2) != 0);
+		std::vector<unsigned char> Packed(Layout.m_Stride);
+		unsigned int Rejected = 0;
+		for (unsigned int i = 0; i < 10000; i++)
+		{
+			const SkinnedVertex Vertex = MakeVertex(Random);
+			const Vector3f Normal(Random.Uniform(-1.0f, 1.0f), Random.Uniform(-1.0f, 1.0f), 0.5f);
+			PackSkinnedVertex(Layout, Vertex, Normal, &Packed[0]);
+			Rejected += CheckPackedVertex(Layout, Vertex, Normal, &Packed[0]) ? 0 : 1;
+		}
+		CHECK(Rejected == 0);
+	}
+	CHECK(PackedVertexLayout().m_Stride == 24);
+}
+
+TEST(PackedVertexCheckRejectsLosses)
+{
+	TestRandom Random;
+	const PackedVertexLayout Layout;
+	const Vector3f Normal(0.0f, 0.0f, 1.0f);
+	unsigned char Packed[32];
+
+	// a UV beyond the range in which half keeps 1/2048
+	SkinnedVertex Vertex = MakeVertex(Random);
+	Vertex.m_tex.x = 1000.3f;
+	PackSkinnedVertex(Layout, Vertex, Normal, Packed);
+	CHECK(!CheckPackedVertex(Layout, Vertex, Normal, Packed));
+
+	// bone indices must fit a byte
+	Vertex = MakeVertex(Random);
+	Vertex.bonedata.IDs[0] = 300.0f;
+	Vertex.bonedata.Weights[0] = 1.0f;
+	PackSkinnedVertex(Layout, Vertex, Normal, Packed);
+	CHECK(!CheckPackedVertex(Layout, Vertex, Normal, Packed));
+}
+
+TEST(BoneInfluenceStatsAverageTruncatedVertices)
+{
+	// vertex 0 has six equal influences, vertex 1 five and vertex 2 two
+	BoneInfluenceBuilder Builder(3);
+	for (unsigned int b = 0; b < 6; b++)
+	{
+		aiVertexWeight Weights[3] = { aiVertexWeight(0, 1.0f), aiVertexWeight(1, 1.0f), aiVertexWeight(2, 1.0f) };
+		Builder.AddBone(b, Weights, b < 2 ? 3 : b < 5 ? 2 : 1);
+	}
+	std::vector<VertexBoneData> Bones;
+	BoneInfluenceStats Stats;
+	Builder.Build(Bones, NULL, Stats);
+	CHECK(Stats.NumVertices == 3);
+	CHECK(Stats.NumTruncated == 2);
+	CHECK(Stats.MaxInfluences == 6);
+	CHECK_NEAR(Stats.MaxDroppedWeight, 2.0f / 6.0f, 1e-6f);
+	CHECK_NEAR(Stats.MeanDroppedWeight(), 0.5f * (2.0f / 6.0f + 1.0f / 5.0f), 1e-6f);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef TEST_H
+#define	TEST_H
+
+#include <stdio.h>
+#include <math.h>
+
+// Minimal self-registering tests for the parts of the demo that run without a device.
+// Every TEST registers itself before main, failed checks are printed with their file
+// and line, and the runner exits with the number of failed tests. The test project runs
+// it as a post-build step, so a failing check fails the build.
+typedef void (*TestFunction)();
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* Name, TestFunction Function);
+};
+
+void ReportFailure(const char* File, int Line, const char* Expression);
+
+#define TEST(Name) \
+	static void Name(); \
+	static TestRegistrar Name##Registrar(#Name, Name); \
+	static void Name()
+
+#define CHECK(Expression) \
+	do { if (!(Expression)) { ReportFailure(__FILE__, __LINE__, #Expression); } } while (0)
+
+// like CHECK, but leaves the test on failure
+#define REQUIRE(Expression) \
+	do { if (!(Expression)) { ReportFailure(__FILE__, __LINE__, #Expression); return; } } while (0)
+
+#define CHECK_NEAR(a, b, Tolerance) CHECK(fabs((double)(a) - (double)(b)) <= (double)(Tolerance))
+
+// Deterministic xorshift generator, so failures reproduce
+class TestRandom
+{
+public:
+	explicit TestRandom(unsigned int Seed = 2463534242u) : m_State(Seed ? Seed : 1u) {}
+	unsigned int Next()
+	{
+		m_State ^= m_State << 13;
+		m_State ^= m_State >> 17;
+		m_State ^= m_State << 5;
+		return m_State;
+	}
+	// uniform in [Min, Max)
+	float Uniform(float Min, float Max)
+	{
+		return Min + (Max - Min) * ((Next() >> 8) * (1.0f / 16777216.0f));
+	}
+
+private:
+	unsigned int m_State;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "Test.h"
+#include <vector>
+
+struct RegisteredTest
+{
+	const char* Name;
+	TestFunction Function;
+};
+
+static std::vector<RegisteredTest>& GetTests()
+{
+	static std::vector<RegisteredTest> Tests;
+	return Tests;
+}
+
+static unsigned int s_NumFailures = 0;
+
+TestRegistrar::TestRegistrar(const char* Name, TestFunction Function)
+{
+	RegisteredTest Test = { Name, Function };
+	GetTests().push_back(Test);
+}
+
+void ReportFailure(const char* File, int Line, const char* Expression)
+{
+	printf("%s(%d): check failed: %s\n", File, Line, Expression);
+	s_NumFailures++;
+}
+
+int main()
+{
+	const std::vector<RegisteredTest>& Tests = GetTests();
+	int NumFailed = 0;
+	for (unsigned int i = 0; i < Tests.size(); i++)
+	{
+		const unsigned int Before = s_NumFailures;
+		Tests[i].Function();
+		const bool Passed = s_NumFailures == Before;
+		printf("%-8s %s\n", Passed ? "passed" : "FAILED", Tests[i].Name);
+		NumFailed += Passed ? 0 : 1;
+	}
+	printf("%u tests, %d failed\n", (unsigned int)Tests.size(), NumFailed);
+	return NumFailed;
+}
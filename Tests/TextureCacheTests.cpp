@@ -0,0 +1,233 @@
+#include "Test.h"
+#include "TextureCache.h"
+#include <cstdio>
+
+// Counts what the cache asks for, the cache owns the backend so the counts live outside
+struct BackendCounts
+{
+	BackendCounts() : NumCreated(0), NumReleased(0) {}
+	unsigned int NumCreated;
+	unsigned int NumReleased;
+};
+
+// Resources are copies of the file contents and take as many bytes, files starting with
+// "broken" fail to decode
+class StubTextureBackend : public TextureBackend
+{
+public:
+	explicit StubTextureBackend(BackendCounts& Counts) : m_Counts(Counts) {}
+	virtual void* Create(const std::string& Path, const std::vector<unsigned char>& Data, size_t& Bytes)
+	{
+		const std::string Contents(Data.begin(), Data.end());
+		if (Contents.compare(0, 6, "broken") == 0)
+		{
+			return NULL;
+		}
+		m_Counts.NumCreated++;
+		Bytes = Data.size();
+		return new std::string(Contents);
+	}
+	virtual void Release(void* pResource)
+	{
+		m_Counts.NumReleased++;
+		delete static_cast<std::string*>(pResource);
+	}
+
+private:
+	BackendCounts& m_Counts;
+};
+
+// A file the cache reads, removed again at the end of the test
+class TestFile
+{
+public:
+	TestFile(const char* pPath, const std::string& Contents) : m_Path(pPath)
+	{
+		Write(Contents);
+	}
+	~TestFile()
+	{
+		remove(m_Path.c_str());
+	}
+	void Write(const std::string& Contents)
+	{
+		FILE* pFile = fopen(m_Path.c_str(), "wb");
+		fwrite(Contents.data(), 1, Contents.size(), pFile);
+		fclose(pFile);
+	}
+	const std::string& GetPath() const
+	{
+		return m_Path;
+	}
+
+private:
+	std::string m_Path;
+};
+
+static std::string GetContents(const TextureCache& Cache, TextureCache::Handle Texture)
+{
+	const std::string* pResource = static_cast<const std::string*>(Cache.GetResource(Texture));
+	return pResource ? *pResource : std::string();
+}
+
+TEST(TextureCacheSharesReferencedTextures)
+{
+	TestFile File("TextureCacheTest_a.dds", std::string(100, 'a'));
+	BackendCounts Counts;
+	{
+		TextureCache Cache(new StubTextureBackend(Counts));
+		TextureCache::Handle First = Cache.Acquire(File.GetPath());
+		TextureCache::Handle Second = Cache.Acquire(File.GetPath());
+		CHECK(First == Second);
+		Cache.Flush();
+		CHECK(Cache.GetState(First) == TEXTURE_READY);
+		CHECK(GetContents(Cache, First) == std::string(100, 'a'));
+		CHECK(Counts.NumCreated == 1);
+		CHECK(Cache.GetResidentBytes() == 100);
+
+		// unreferenced textures stay resident within the budget
+		Cache.Release(First);
+		Cache.Release(Second);
+		CHECK(Cache.GetNumResident() == 1);
+		CHECK(Counts.NumReleased == 0);
+	}
+	CHECK(Counts.NumReleased == 1);
+}
+
+TEST(TextureCacheEvictsLeastRecentlyReleased)
+{
+	TestFile A("TextureCacheTest_a.dds", std::string(100, 'a'));
+	TestFile B("TextureCacheTest_b.dds", std::string(100, 'b'));
+	TestFile C("TextureCacheTest_c.dds", std::string(100, 'c'));
+	BackendCounts Counts;
+	TextureCache Cache(new StubTextureBackend(Counts), 250);
+	TextureCache::Handle HandleA = Cache.Acquire(A.GetPath());
+	TextureCache::Handle HandleB = Cache.Acquire(B.GetPath());
+	TextureCache::Handle HandleC = Cache.Acquire(C.GetPath());
+	Cache.Flush();
+	// referenced textures may exceed the budget
+	CHECK(Cache.GetResidentBytes() == 300);
+
+	Cache.Release(HandleB);
+	CHECK(Cache.GetResidentBytes() == 200);
+	CHECK(Counts.NumReleased == 1);
+	Cache.Release(HandleA);
+	Cache.Release(HandleC);
+	CHECK(Cache.GetResidentBytes() == 200);
+	CHECK(Cache.GetNumEntries() == 2);
+
+	// A went unreferenced before C, a lower budget drops it first
+	Cache.SetBudget(100);
+	CHECK(Cache.GetNumEntries() == 1);
+	CHECK(Counts.NumReleased == 2);
+	// C stayed resident, reviving it creates nothing
+	HandleC = Cache.Acquire(C.GetPath());
+	Cache.Flush();
+	CHECK(Counts.NumCreated == 3);
+	CHECK(GetContents(Cache, HandleC) == std::string(100, 'c'));
+	Cache.Release(HandleC);
+}
+
+TEST(TextureCacheRevivesTextures)
+{
+	TestFile File("TextureCacheTest_a.dds", std::string(100, 'a'));
+	BackendCounts Counts;
+	TextureCache Cache(new StubTextureBackend(Counts), 100);
+	TextureCache::Handle Texture = Cache.Acquire(File.GetPath());
+	Cache.Flush();
+	Cache.Release(Texture);
+
+	// an unchanged file keeps its resource
+	Texture = Cache.Acquire(File.GetPath());
+	Cache.Flush();
+	CHECK(Counts.NumCreated == 1);
+	CHECK(Cache.GetState(Texture) == TEXTURE_READY);
+	Cache.Release(Texture);
+
+	// a changed one is recreated
+	File.Write(std::string(50, 'x'));
+	Texture = Cache.Acquire(File.GetPath());
+	Cache.Flush();
+	CHECK(Counts.NumCreated == 2);
+	CHECK(Counts.NumReleased == 1);
+	CHECK(GetContents(Cache, Texture) == std::string(50, 'x'));
+	CHECK(Cache.GetResidentBytes() == 50);
+	Cache.Release(Texture);
+
+	// evicted, then loaded again
+	Cache.SetBudget(0);
+	CHECK(Cache.GetNumEntries() == 0);
+	CHECK(Cache.GetResidentBytes() == 0);
+	Cache.SetBudget(100);
+	Texture = Cache.Acquire(File.GetPath());
+	Cache.Flush();
+	CHECK(Counts.NumCreated == 3);
+	CHECK(GetContents(Cache, Texture) == std::string(50, 'x'));
+	Cache.Release(Texture);
+}
+
+TEST(TextureCacheDropsFailedLoads)
+{
+	TestFile Broken("TextureCacheTest_broken.dds", "broken texture");
+	BackendCounts Counts;
+	TextureCache Cache(new StubTextureBackend(Counts));
+	TextureCache::Handle Missing = Cache.Acquire("TextureCacheTest_missing.dds");
+	TextureCache::Handle Undecodable = Cache.Acquire(Broken.GetPath());
+	Cache.Flush();
+	CHECK(Cache.GetState(Missing) == TEXTURE_FAILED);
+	CHECK(Cache.GetState(Undecodable) == TEXTURE_FAILED);
+	CHECK(Cache.GetResource(Missing) == NULL);
+	CHECK(Cache.GetNumEntries() == 2);
+	Cache.Release(Missing);
+	Cache.Release(Undecodable);
+	CHECK(Cache.GetNumEntries() == 0);
+
+	// released before the load fails
+	Cache.Release(Cache.Acquire("TextureCacheTest_missing.dds"));
+	Cache.Flush();
+	CHECK(Cache.GetNumEntries() == 0);
+
+	// fixing the file makes the next acquire succeed
+	Broken.Write("fixed texture");
+	Undecodable = Cache.Acquire(Broken.GetPath());
+	Cache.Flush();
+	CHECK(Cache.GetState(Undecodable) == TEXTURE_READY);
+	Cache.Release(Undecodable);
+	CHECK(Counts.NumCreated == 1);
+}
+
+TEST(TextureCacheSharesEqualContents)
+{
+	TestFile A("TextureCacheTest_a.dds", std::string(100, 'a'));
+	TestFile Copy("TextureCacheTest_copy.dds", std::string(100, 'a'));
+	BackendCounts Counts;
+	TextureCache Cache(new StubTextureBackend(Counts), 0);
+	TextureCache::Handle HandleA = Cache.Acquire(A.GetPath());
+	TextureCache::Handle HandleCopy = Cache.Acquire(Copy.GetPath());
+	Cache.Flush();
+	CHECK(HandleA != HandleCopy);
+	CHECK(Counts.NumCreated == 1);
+	CHECK(Cache.GetResource(HandleA) == Cache.GetResource(HandleCopy));
+	CHECK(Cache.GetResidentBytes() == 100);
+	CHECK(Cache.GetNumResident() == 1);
+
+	// the copy keeps the resource alive after the original's entry is evicted
+	Cache.Release(HandleA);
+	CHECK(Cache.GetNumEntries() == 1);
+	CHECK(Counts.NumReleased == 0);
+	CHECK(GetContents(Cache, HandleCopy) == std::string(100, 'a'));
+
+	// once the copy changes, each has its own
+	Cache.Release(HandleCopy);
+	Copy.Write(std::string(100, 'c'));
+	Cache.SetBudget(1000);
+	HandleCopy = Cache.Acquire(Copy.GetPath());
+	HandleA = Cache.Acquire(A.GetPath());
+	Cache.Flush();
+	CHECK(Counts.NumCreated == 3);
+	CHECK(Cache.GetNumResident() == 2);
+	CHECK(GetContents(Cache, HandleCopy) == std::string(100, 'c'));
+	CHECK(GetContents(Cache, HandleA) == std::string(100, 'a'));
+	Cache.Release(HandleA);
+	Cache.Release(HandleCopy);
+}
@@ -0,0 +1,196 @@
+#include "Test.h"
+#include "TexturePathResolver.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A directory tree below the working directory, removed again at the end of the test
+class TestTree
+{
+public:
+	explicit TestTree(const std::string& Root) : m_Root(Root)
+	{
+		AddDir("");
+	}
+	~TestTree()
+	{
+		for (size_t i = m_Files.size(); i > 0; i--)
+		{
+			remove(m_Files[i - 1].c_str());
+		}
+		for (size_t i = m_Dirs.size(); i > 0; i--)
+		{
+#ifdef _WIN32
+			_rmdir(m_Dirs[i - 1].c_str());
+#else
+			rmdir(m_Dirs[i - 1].c_str());
+#endif
+		}
+	}
+	void AddDir(const std::string& Dir)
+	{
+		const std::string Path = GetPath(Dir);
+#ifdef _WIN32
+		_mkdir(Path.c_str());
+#else
+		mkdir(Path.c_str(), 0755);
+#endif
+		m_Dirs.push_back(Path);
+	}
+	void AddFile(const std::string& File)
+	{
+		if (FILE* pFile = fopen(GetPath(File).c_str(), "wb"))
+		{
+			fclose(pFile);
+		}
+		TrackFile(File);
+	}
+	// a file written by the code under test
+	void TrackFile(const std::string& File)
+	{
+		m_Files.push_back(GetPath(File));
+	}
+	void RemoveFile(const std::string& File)
+	{
+		remove(GetPath(File).c_str());
+	}
+#ifndef _WIN32
+	void AddLink(const std::string& Link, const std::string& Target)
+	{
+		const std::string Path = GetPath(Link);
+		if (symlink(Target.c_str(), Path.c_str()) == 0)
+		{
+			m_Files.push_back(Path);
+		}
+	}
+#endif
+	// the path the resolver reports for a file of the tree
+	std::string GetPath(const std::string& File) const
+	{
+		return File.empty() ? m_Root : m_Root + "/" + File;
+	}
+	const std::string& GetRoot() const
+	{
+		return m_Root;
+	}
+
+private:
+	std::string m_Root;
+	std::vector<std::string> m_Files;
+	std::vector<std::string> m_Dirs;
+};
+
+// A model in models\ with textures next to it, in its tex\ and textures\ directories and
+// in a directory of its own
+static void AddTextures(TestTree& Tree)
+{
+	const char* Dirs[] = { "models", "models/sub", "models/tex", "models/textures", "models/textures/sub", "shared", "shared/deep" };
+	for (unsigned int i = 0; i < sizeof(Dirs) / sizeof(Dirs[0]); i++)
+	{
+		Tree.AddDir(Dirs[i]);
+	}
+	const char* Files[] = { "shared/given.png", "models/sub/relative.png", "models/textures/sub/relative.png",
+		"models/tex/diffuse.png", "models/textures/diffuse.png", "models/textures/normal.png",
+		"shared/stone.png", "shared/deep/stone.png", "models/wood_diffuse.png", "models/wood_diffuse.tga" };
+	for (unsigned int i = 0; i < sizeof(Files) / sizeof(Files[0]); i++)
+	{
+		Tree.AddFile(Files[i]);
+	}
+}
+
+static std::string Resolve(TexturePathResolver& Resolver, const TestTree& Tree, const std::string& Reference)
+{
+	std::string Resolved;
+	return Resolver.Resolve(Tree.GetPath("models/robot.obj"), Reference, Resolved) ? Resolved : std::string();
+}
+
+TEST(TexturePathsResolveInLookupOrder)
+{
+	TestTree Tree("TexturePathResolverTest");
+	AddTextures(Tree);
+	TexturePathResolver Resolver(Tree.GetRoot());
+
+	// as given, in any case and with either slash
+	CHECK(Resolve(Resolver, Tree, Tree.GetRoot() + "\\Shared\\GIVEN.png") == Tree.GetPath("shared/given.png"));
+	// relative to the model before its textures directory
+	CHECK(Resolve(Resolver, Tree, "sub\\relative.png") == Tree.GetPath("models/sub/relative.png"));
+	// the tex\ directory before the textures\ one
+	CHECK(Resolve(Resolver, Tree, "diffuse.png") == Tree.GetPath("models/tex/diffuse.png"));
+	CHECK(Resolve(Resolver, Tree, "normal.png") == Tree.GetPath("models/textures/normal.png"));
+	// by name anywhere below the root, the shortest path first
+	CHECK(Resolve(Resolver, Tree, "C:\\Art\\Stone.png") == Tree.GetPath("shared/stone.png"));
+	// a file of the same type in the model's directory whose name starts like the reference
+	CHECK(Resolve(Resolver, Tree, "wood.png") == Tree.GetPath("models/wood_diffuse.png"));
+	CHECK(Resolve(Resolver, Tree, "wood.dds").empty());
+	CHECK(Resolve(Resolver, Tree, "missing.png").empty());
+}
+
+TEST(TexturePathCacheSurvivesARestart)
+{
+	TestTree Tree("TexturePathResolverTest");
+	AddTextures(Tree);
+	const std::string CacheFile = Tree.GetPath("cache.txt");
+	Tree.TrackFile("cache.txt");
+	{
+		TexturePathResolver Resolver(Tree.GetRoot());
+		CHECK(Resolve(Resolver, Tree, "wood.png") == Tree.GetPath("models/wood_diffuse.png"));
+		CHECK(Resolve(Resolver, Tree, "normal.png") == Tree.GetPath("models/textures/normal.png"));
+		CHECK(Resolve(Resolver, Tree, "missing.png").empty());
+		REQUIRE(Resolver.SaveCache(CacheFile));
+	}
+
+	// rooted where nothing can be found, so only the cache resolves
+	TexturePathResolver Restarted(Tree.GetPath("empty"));
+	CHECK(Restarted.LoadCache(CacheFile));
+	CHECK(Resolve(Restarted, Tree, "wood.png") == Tree.GetPath("models/wood_diffuse.png"));
+	CHECK(Resolve(Restarted, Tree, "missing.png").empty());
+	// entries whose file is gone are dropped
+	Tree.RemoveFile("models/textures/normal.png");
+	CHECK(Resolve(Restarted, Tree, "normal.png").empty());
+	CHECK(!TexturePathResolver().LoadCache(Tree.GetPath("no_cache.txt")));
+}
+
+TEST(TexturePathsPreferTheBakedExtension)
+{
+	TestTree Tree("TexturePathResolverTest");
+	AddTextures(Tree);
+	const std::string CacheFile = Tree.GetPath("cache.txt");
+	Tree.TrackFile("cache.txt");
+	{
+		TexturePathResolver Resolver(Tree.GetRoot());
+		CHECK(Resolve(Resolver, Tree, "normal.png") == Tree.GetPath("models/textures/normal.png"));
+		REQUIRE(Resolver.SaveCache(CacheFile));
+	}
+	Tree.AddFile("models/textures/normal.dds");
+
+	TexturePathResolver Resolver(Tree.GetRoot());
+	Resolver.SetPreferredExtension(".dds");
+	CHECK(Resolve(Resolver, Tree, "normal.png") == Tree.GetPath("models/textures/normal.dds"));
+	// without a baked file the match stays
+	CHECK(Resolve(Resolver, Tree, "diffuse.png") == Tree.GetPath("models/tex/diffuse.png"));
+
+	// baked after the cache was saved
+	TexturePathResolver Restarted(Tree.GetPath("empty"));
+	Restarted.SetPreferredExtension(".dds");
+	CHECK(Restarted.LoadCache(CacheFile));
+	CHECK(Resolve(Restarted, Tree, "normal.png") == Tree.GetPath("models/textures/normal.dds"));
+}
+
+#ifndef _WIN32
+TEST(TexturePathIndexSkipsLinkLoops)
+{
+	TestTree Tree("TexturePathResolverTest");
+	AddTextures(Tree);
+	Tree.AddLink("models/loop", "..");
+	Tree.AddLink("shared/self", ".");
+	TexturePathResolver Resolver(Tree.GetRoot());
+	CHECK(Resolve(Resolver, Tree, "C:\\Art\\Stone.png") == Tree.GetPath("shared/stone.png"));
+	CHECK(Resolve(Resolver, Tree, "diffuse.png") == Tree.GetPath("models/tex/diffuse.png"));
+}
+#endif
@@ -0,0 +1,52 @@
+#include "Test.h"
+#include "Waves.h"
+
+TEST(WavesMatchReference)
+{
+	// 517 rows make up to eight bands, 263 columns leave a scalar tail in every row
+	const UINT ThreadCounts[] = { 1, 2, 3, 8 };
+	for (unsigned int t = 0; t < 4; t++)
+	{
+		CHECK(Waves::CompareWithReference(517, 263, 200, ThreadCounts[t]) == 0.0f);
+	}
+	// too narrow for the SIMD loops
+	CHECK(Waves::CompareWithReference(70, 5, 50, 1) == 0.0f);
+}
+
+TEST(WavesStepTheSameOnAnyThreadCount)
+{
+	// the threaded simulation keeps its workers over all steps while its band count changes
+	Waves Single, Threaded;
+	Single.SetThreadCount(1);
+	Single.Init(400, 300, 0.8f, 0.03f, 3.25f, 0.4f);
+	Threaded.Init(400, 300, 0.8f, 0.03f, 3.25f, 0.4f);
+	const UINT ThreadCounts[] = { 6, 2, 4, 1, 5 };
+	TestRandom Random;
+	for (unsigned int Step = 0; Step < 250; Step++)
+	{
+		if (Step % 50 == 0)
+		{
+			Threaded.SetThreadCount(ThreadCounts[Step / 50]);
+		}
+		const UINT i = 2 + Random.Next() % 396;
+		const UINT j = 2 + Random.Next() % 296;
+		const float Magnitude = Random.Uniform(0.25f, 0.5f);
+		Single.Disturb(i, j, Magnitude);
+		Threaded.Disturb(i, j, Magnitude);
+		// a full time step, so every update steps
+		Single.Update(0.03f);
+		Threaded.Update(0.03f);
+	}
+
+	unsigned int Mismatches = 0, Moved = 0;
+	for (unsigned int k = 0; k < Single.VertexCount(); k++)
+	{
+		const XMFLOAT3& a = Single.Normal(k);
+		const XMFLOAT3& b = Threaded.Normal(k);
+		Mismatches += Single[k].y != Threaded[k].y || a.x != b.x || a.y != b.y || a.z != b.z ||
+			Single.TangentX(k).y != Threaded.TangentX(k).y ? 1 : 0;
+		Moved += Single[k].y != 0.0f ? 1 : 0;
+	}
+	CHECK(Mismatches == 0);
+	CHECK(Moved > Single.VertexCount() / 2);
+}
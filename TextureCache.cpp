@@ -0,0 +1,371 @@
+#include "TextureCache.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <d3dx11.h>
+#endif
+
+// FNV-1a
+static unsigned long long HashBytes(const std::vector<unsigned char>& Data)
+{
+	unsigned long long Hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < Data.size(); i++)
+	{
+		Hash = (Hash ^ Data[i]) * 1099511628211ULL;
+	}
+	return Hash;
+}
+
+static bool ReadFileContents(const std::string& Path, std::vector<unsigned char>& Data)
+{
+	FILE* pFile = fopen(Path.c_str(), "rb");
+	if (!pFile)
+	{
+		return false;
+	}
+	fseek(pFile, 0, SEEK_END);
+	const long Size = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	Data.resize(Size > 0 ? Size : 0);
+	const bool Ret = Size > 0 && fread(&Data[0], 1, Data.size(), pFile) == Data.size();
+	fclose(pFile);
+	return Ret;
+}
+
+TextureCache::TextureCache(TextureBackend* pBackend, size_t BudgetBytes)
+{
+	m_pBackend = pBackend;
+	m_Budget = BudgetBytes;
+	m_ResidentBytes = 0;
+	m_ReleaseCounter = 0;
+	m_NumPendingJobs = 0;
+	m_Stop = false;
+	m_Worker = std::thread(&TextureCache::WorkerLoop, this);
+}
+
+TextureCache::~TextureCache()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_JobReady.notify_all();
+	m_Worker.join();
+	for (std::map<ContentKey, Resource>::iterator it = m_Resources.begin(); it != m_Resources.end(); ++it)
+	{
+		m_pBackend->Release(it->second.pResource);
+	}
+	delete m_pBackend;
+}
+
+TextureCache::Handle TextureCache::Acquire(const std::string& Path)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	std::map<std::string, Entry>::iterator it = m_Entries.find(Path);
+	if (it == m_Entries.end())
+	{
+		Entry& Texture = m_Entries[Path];
+		Texture.Path = Path;
+		Texture.pResource = NULL;
+		Texture.RefCount = 1;
+		Texture.PendingJobs = 0;
+		Texture.LastRelease = 0;
+		Texture.State = TEXTURE_PENDING;
+		Enqueue(Texture);
+		return &Texture;
+	}
+	Entry& Texture = it->second;
+	// the file may have changed while nobody used it
+	if (Texture.RefCount++ == 0 && Texture.PendingJobs == 0)
+	{
+		Enqueue(Texture);
+	}
+	return &Texture;
+}
+
+void TextureCache::Release(Handle Texture)
+{
+	if (!Texture)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	if (Texture->RefCount > 0 && --Texture->RefCount == 0)
+	{
+		Texture->LastRelease = ++m_ReleaseCounter;
+		if (!EraseIfEmpty(*Texture))
+		{
+			EvictOverBudget();
+		}
+	}
+}
+
+void* TextureCache::GetResource(Handle Texture) const
+{
+	if (!Texture)
+	{
+		return NULL;
+	}
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return Texture->pResource ? Texture->pResource->pResource : NULL;
+}
+
+TextureState TextureCache::GetState(Handle Texture) const
+{
+	if (!Texture)
+	{
+		return TEXTURE_FAILED;
+	}
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return Texture->State;
+}
+
+void TextureCache::Flush()
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_JobsDone.wait(Lock, [this] { return m_NumPendingJobs == 0; });
+}
+
+void TextureCache::SetBudget(size_t BudgetBytes)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_Budget = BudgetBytes;
+	EvictOverBudget();
+}
+
+size_t TextureCache::GetResidentBytes() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return m_ResidentBytes;
+}
+
+unsigned int TextureCache::GetNumResident() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return m_Resources.size();
+}
+
+unsigned int TextureCache::GetNumEntries() const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	return m_Entries.size();
+}
+
+void TextureCache::Enqueue(Entry& Texture)
+{
+	Texture.PendingJobs++;
+	m_NumPendingJobs++;
+	m_Jobs.push_back(&Texture);
+	m_JobReady.notify_one();
+}
+
+void TextureCache::SetResource(Entry& Texture, Resource* pResource)
+{
+	Resource* pPrevious = Texture.pResource;
+	if (pPrevious == pResource)
+	{
+		return;
+	}
+	if (pResource)
+	{
+		pResource->NumEntries++;
+	}
+	Texture.pResource = pResource;
+	if (pPrevious && --pPrevious->NumEntries == 0)
+	{
+		m_pBackend->Release(pPrevious->pResource);
+		m_ResidentBytes -= pPrevious->Bytes;
+		m_Resources.erase(pPrevious->Key);
+	}
+}
+
+bool TextureCache::EraseIfEmpty(Entry& Texture)
+{
+	if (Texture.RefCount || Texture.PendingJobs || Texture.pResource)
+	{
+		return false;
+	}
+	m_Entries.erase(m_Entries.find(Texture.Path));
+	return true;
+}
+
+void TextureCache::EvictOverBudget()
+{
+	// a linear scan per eviction, a scene holds a few hundred textures at most
+	while (m_ResidentBytes > m_Budget)
+	{
+		std::map<std::string, Entry>::iterator Oldest = m_Entries.end();
+		for (std::map<std::string, Entry>::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+		{
+			const Entry& Texture = it->second;
+			if (Texture.RefCount == 0 && Texture.PendingJobs == 0 && Texture.pResource &&
+				(Oldest == m_Entries.end() || Texture.LastRelease < Oldest->second.LastRelease))
+			{
+				Oldest = it;
+			}
+		}
+		if (Oldest == m_Entries.end())
+		{
+			// everything resident is in use
+			return;
+		}
+		// frees the resource unless a referenced path with the same contents shows it
+		SetResource(Oldest->second, NULL);
+		m_Entries.erase(Oldest);
+	}
+}
+
+void TextureCache::Load(Entry& Texture, std::unique_lock<std::mutex>& Lock)
+{
+	// Path never changes and the entry stays while a job is pending
+	Lock.unlock();
+	std::vector<unsigned char> Data;
+	const bool Read = ReadFileContents(Texture.Path, Data);
+	const ContentKey Key(Read ? HashBytes(Data) : 0, Data.size());
+	Lock.lock();
+	const bool Unchanged = Read && Texture.pResource && Texture.pResource->Key == Key;
+	// only the worker adds resources, none with Key can appear while Create runs unlocked
+	std::map<ContentKey, Resource>::iterator Shared = Read && !Unchanged ? m_Resources.find(Key) : m_Resources.end();
+	if (Read && !Unchanged && Shared == m_Resources.end())
+	{
+		Lock.unlock();
+		size_t Bytes = 0;
+		void* pResource = m_pBackend->Create(Texture.Path, Data, Bytes);
+		Lock.lock();
+		if (pResource)
+		{
+			Resource& Created = m_Resources[Key];
+			Created.Key = Key;
+			Created.pResource = pResource;
+			Created.Bytes = Bytes;
+			Created.NumEntries = 0;
+			m_ResidentBytes += Bytes;
+			Shared = m_Resources.find(Key);
+		}
+	}
+	if (!Unchanged && Shared == m_Resources.end())
+	{
+		printf("Error loading texture '%s'\n", Texture.Path.c_str());
+	}
+	if (Shared != m_Resources.end())
+	{
+		SetResource(Texture, &Shared->second);
+	}
+	// a changed file that fails to load leaves the previous content in place
+	Texture.State = Texture.pResource ? TEXTURE_READY : TEXTURE_FAILED;
+	Texture.PendingJobs--;
+	if (Texture.RefCount == 0)
+	{
+		Texture.LastRelease = ++m_ReleaseCounter;
+	}
+	if (!EraseIfEmpty(Texture))
+	{
+		EvictOverBudget();
+	}
+}
+
+void TextureCache::WorkerLoop()
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	for (;;)
+	{
+		m_JobReady.wait(Lock, [this] { return m_Stop || !m_Jobs.empty(); });
+		if (m_Stop)
+		{
+			return;
+		}
+		Entry* pTexture = m_Jobs.front();
+		m_Jobs.pop_front();
+		Load(*pTexture, Lock);
+		if (--m_NumPendingJobs == 0)
+		{
+			m_JobsDone.notify_all();
+		}
+	}
+}
+
+#ifdef _WIN32
+static unsigned int BitsPerPixel(DXGI_FORMAT Format)
+{
+	if ((Format >= DXGI_FORMAT_BC1_TYPELESS && Format <= DXGI_FORMAT_BC1_UNORM_SRGB) ||
+		(Format >= DXGI_FORMAT_BC4_TYPELESS && Format <= DXGI_FORMAT_BC4_SNORM))
+	{
+		return 4;
+	}
+	if ((Format >= DXGI_FORMAT_BC2_TYPELESS && Format <= DXGI_FORMAT_BC3_UNORM_SRGB) ||
+		(Format >= DXGI_FORMAT_BC5_TYPELESS && Format <= DXGI_FORMAT_BC5_SNORM) ||
+		(Format >= DXGI_FORMAT_BC6H_TYPELESS && Format <= DXGI_FORMAT_BC7_UNORM_SRGB))
+	{
+		return 8;
+	}
+	switch (Format)
+	{
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_A8_UNORM:
+		return 8;
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+		return 16;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+		return 64;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return 128;
+	default:
+		return 32;
+	}
+}
+
+static bool IsBlockCompressed(DXGI_FORMAT Format)
+{
+	return (Format >= DXGI_FORMAT_BC1_TYPELESS && Format <= DXGI_FORMAT_BC5_SNORM) ||
+		(Format >= DXGI_FORMAT_BC6H_TYPELESS && Format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+}
+
+D3D11TextureBackend::D3D11TextureBackend(ID3D11Device* device)
+{
+	m_Device = device;
+}
+
+void* D3D11TextureBackend::Create(const std::string& Path, const std::vector<unsigned char>& Data, size_t& Bytes)
+{
+	ID3D11ShaderResourceView* pSRV = NULL;
+	if (Data.empty() || FAILED(D3DX11CreateShaderResourceViewFromMemory(m_Device, &Data[0], Data.size(), NULL, NULL, &pSRV, NULL)))
+	{
+		return NULL;
+	}
+	ID3D11Resource* pResource = NULL;
+	pSRV->GetResource(&pResource);
+	D3D11_RESOURCE_DIMENSION Dimension;
+	pResource->GetType(&Dimension);
+	Bytes = Data.size();
+	if (Dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		D3D11_TEXTURE2D_DESC Desc;
+		static_cast<ID3D11Texture2D*>(pResource)->GetDesc(&Desc);
+		const bool Blocks = IsBlockCompressed(Desc.Format);
+		Bytes = 0;
+		for (UINT Mip = 0; Mip < Desc.MipLevels; Mip++)
+		{
+			UINT Width = Desc.Width >> Mip, Height = Desc.Height >> Mip;
+			Width = Width ? Width : 1;
+			Height = Height ? Height : 1;
+			if (Blocks)
+			{
+				Width = (Width + 3) & ~3u;
+				Height = (Height + 3) & ~3u;
+			}
+			Bytes += (size_t)Width * Height * BitsPerPixel(Desc.Format) / 8;
+		}
+		Bytes *= Desc.ArraySize;
+	}
+	pResource->Release();
+	return pSRV;
+}
+
+void D3D11TextureBackend::Release(void* pResource)
+{
+	static_cast<ID3D11ShaderResourceView*>(pResource)->Release();
+}
+#endif
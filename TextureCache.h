@@ -0,0 +1,126 @@
+#pragma once
+
+#ifndef TEXTURE_CACHE_H
+#define	TEXTURE_CACHE_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Turns the contents of texture files into resources. Create runs on the cache's worker
+// thread, Release on whichever thread gives the last reference up or evicts.
+class TextureBackend
+{
+public:
+	virtual ~TextureBackend() {}
+	// Bytes receives the memory the resource takes. NULL on failure.
+	virtual void* Create(const std::string& Path, const std::vector<unsigned char>& Data, size_t& Bytes) = 0;
+	virtual void Release(void* pResource) = 0;
+};
+
+enum TextureState
+{
+	TEXTURE_PENDING,
+	TEXTURE_READY,
+	TEXTURE_FAILED
+};
+
+// Textures shared by all meshes using the cache, one entry per resolved path. Acquire returns
+// at once, the file is read, hashed and handed to the backend on a worker thread. Paths whose
+// contents hash the same share one resource, so a copied atlas is created once. Entries are
+// reference counted. Unreferenced ones stay resident, so reloading a mesh costs nothing,
+// until the resident memory exceeds the budget; the least recently released go first then.
+// Reviving an unreferenced entry rereads the file in the background and only recreates the
+// resource if its content hash changed. Entries without a resource, failed loads, are dropped
+// as soon as nobody references them. Handles stay valid until released.
+class TextureCache
+{
+	struct Entry;
+public:
+	typedef Entry* Handle;
+
+	// Takes ownership of pBackend
+	explicit TextureCache(TextureBackend* pBackend, size_t BudgetBytes = 256 * 1024 * 1024);
+	~TextureCache();
+	Handle Acquire(const std::string& Path);
+	void Release(Handle Texture);
+	// NULL until the texture is ready, the previous content while a changed file reloads
+	void* GetResource(Handle Texture) const;
+	TextureState GetState(Handle Texture) const;
+	// Blocks until the worker has nothing left to do
+	void Flush();
+	void SetBudget(size_t BudgetBytes);
+	size_t GetResidentBytes() const;
+	// resources, fewer than the entries using them if contents repeat
+	unsigned int GetNumResident() const;
+	// paths known to the cache, referenced, loading or resident
+	unsigned int GetNumEntries() const;
+
+private:
+	// content hash and size of a file
+	typedef std::pair<unsigned long long, size_t> ContentKey;
+	struct Resource
+	{
+		ContentKey Key;
+		void* pResource;
+		size_t Bytes;
+		unsigned int NumEntries;	// entries showing it
+	};
+	struct Entry
+	{
+		std::string Path;
+		Resource* pResource;		// NULL until loaded, an element of m_Resources
+		unsigned int RefCount;
+		unsigned int PendingJobs;
+		unsigned long long LastRelease;
+		TextureState State;
+	};
+
+	TextureCache(const TextureCache& rhs);
+	TextureCache& operator=(const TextureCache& rhs);
+	void WorkerLoop();
+	// unlocks Lock while reading and creating
+	void Load(Entry& Texture, std::unique_lock<std::mutex>& Lock);
+	// callers hold m_Mutex
+	void EvictOverBudget();
+	void Enqueue(Entry& Texture);
+	void SetResource(Entry& Texture, Resource* pResource);
+	// drops an unreferenced entry that has nothing cached, true if it did
+	bool EraseIfEmpty(Entry& Texture);
+
+	TextureBackend* m_pBackend;
+	size_t m_Budget;
+	size_t m_ResidentBytes;
+	unsigned long long m_ReleaseCounter;
+	std::map<std::string, Entry> m_Entries;
+	std::map<ContentKey, Resource> m_Resources;
+	std::deque<Entry*> m_Jobs;
+	unsigned int m_NumPendingJobs; // queued and running
+	bool m_Stop;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_JobReady;
+	std::condition_variable m_JobsDone;
+	std::thread m_Worker;
+};
+
+#ifdef _WIN32
+struct ID3D11Device;
+
+// ID3D11ShaderResourceView for each texture through D3DX11, the device is free threaded
+class D3D11TextureBackend : public TextureBackend
+{
+public:
+	explicit D3D11TextureBackend(ID3D11Device* device);
+	virtual void* Create(const std::string& Path, const std::vector<unsigned char>& Data, size_t& Bytes);
+	virtual void Release(void* pResource);
+
+private:
+	ID3D11Device* m_Device;
+};
+#endif
+
+#endif
@@ -0,0 +1,351 @@
+#include "TexturePathResolver.h"
+#include <cstdio>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <set>
+#endif
+
+// Forward slashes, ASCII letters in lower case, "." and ".." segments folded
+static std::string NormalizePath(const std::string& Path)
+{
+	std::vector<std::string> Parts;
+	std::string Part;
+	for (size_t i = 0; i <= Path.size(); i++)
+	{
+		const char c = i < Path.size() ? Path[i] : '/';
+		if (c != '/' && c != '\\')
+		{
+			Part += (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+			continue;
+		}
+		if (Part == ".." && !Parts.empty() && Parts.back() != "..")
+		{
+			Parts.pop_back();
+		}
+		else if (!Part.empty() && Part != ".")
+		{
+			Parts.push_back(Part);
+		}
+		Part.clear();
+	}
+	std::string Ret = !Path.empty() && (Path[0] == '/' || Path[0] == '\\') ? "/" : "";
+	for (size_t i = 0; i < Parts.size(); i++)
+	{
+		Ret += i ? "/" + Parts[i] : Parts[i];
+	}
+	return Ret;
+}
+
+static std::string DirectoryOf(const std::string& Path)
+{
+	const size_t Slash = Path.rfind('/');
+	return Slash == std::string::npos ? "" : Path.substr(0, Slash);
+}
+
+static std::string FileNameOf(const std::string& Path)
+{
+	const size_t Slash = Path.rfind('/');
+	return Slash == std::string::npos ? Path : Path.substr(Slash + 1);
+}
+
+// Empty if Path has no extension
+static std::string ReplaceExtension(const std::string& Path, const std::string& Extension)
+{
+	const size_t Dot = Path.rfind('.');
+	const size_t Slash = Path.find_last_of("/\\");
+	if (Dot == std::string::npos || (Slash != std::string::npos && Dot < Slash))
+	{
+		return "";
+	}
+	return Path.substr(0, Dot) + Extension;
+}
+
+static std::string JoinPath(const std::string& Dir, const std::string& Path)
+{
+	return NormalizePath(Dir.empty() ? Path : Dir + "/" + Path);
+}
+
+static TexturePathResolver g_DefaultResolver;
+
+TexturePathResolver& DefaultTexturePathResolver()
+{
+	return g_DefaultResolver;
+}
+
+TexturePathResolver::TexturePathResolver(const std::string& Root)
+{
+	m_Root = Root.empty() ? "." : Root;
+	m_Indexed = false;
+}
+
+void TexturePathResolver::BuildIndex()
+{
+	std::vector<std::string> Pending(1, m_Root);
+#ifndef _WIN32
+	// directories reached through links are scanned once, a link to a parent would never end
+	std::set<std::pair<dev_t, ino_t> > Visited;
+#endif
+	while (!Pending.empty())
+	{
+		const std::string Dir = Pending.back();
+		Pending.pop_back();
+#ifndef _WIN32
+		struct stat DirInfo;
+		if (stat(Dir.c_str(), &DirInfo) != 0 || !Visited.insert(std::make_pair(DirInfo.st_dev, DirInfo.st_ino)).second)
+		{
+			continue;
+		}
+#endif
+		const std::string DirKey = NormalizePath(Dir);
+		std::vector<std::string>& Files = m_Dirs[DirKey];
+		auto AddEntry = [&](const std::string& Name, bool IsDir)
+		{
+			if (Name == "." || Name == "..")
+			{
+				return;
+			}
+			const std::string Path = Dir + "/" + Name;
+			if (IsDir)
+			{
+				Pending.push_back(Path);
+				return;
+			}
+			const std::string Key = NormalizePath(Path);
+			m_Paths[Key] = Path;
+			m_Names.insert(std::make_pair(FileNameOf(Key), Path));
+			Files.push_back(FileNameOf(Key));
+		};
+#ifdef _WIN32
+		WIN32_FIND_DATAA Info;
+		HANDLE h = FindFirstFileA((Dir + "\\*").c_str(), &Info);
+		if (h == INVALID_HANDLE_VALUE)
+		{
+			continue;
+		}
+		do
+		{
+			// junctions and directory links may point to a parent, they aren't followed
+			const DWORD LinkedDir = FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT;
+			if ((Info.dwFileAttributes & LinkedDir) != LinkedDir)
+			{
+				AddEntry(Info.cFileName, (Info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+			}
+		} while (FindNextFileA(h, &Info));
+		FindClose(h);
+#else
+		DIR* pDir = opendir(Dir.c_str());
+		if (!pDir)
+		{
+			continue;
+		}
+		while (const dirent* pEntry = readdir(pDir))
+		{
+			bool IsDir = pEntry->d_type == DT_DIR;
+			if (pEntry->d_type == DT_UNKNOWN || pEntry->d_type == DT_LNK)
+			{
+				struct stat Info;
+				IsDir = stat((Dir + "/" + pEntry->d_name).c_str(), &Info) == 0 && S_ISDIR(Info.st_mode);
+			}
+			AddEntry(pEntry->d_name, IsDir);
+		}
+		closedir(pDir);
+#endif
+	}
+	m_Indexed = true;
+}
+
+void TexturePathResolver::SetPreferredExtension(const std::string& Extension)
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	m_PreferredExtension = Extension;
+}
+
+void TexturePathResolver::PreferExtension(std::string& Path, bool Indexed) const
+{
+	const std::string Preferred = m_PreferredExtension.empty() ? "" : ReplaceExtension(Path, m_PreferredExtension);
+	if (Preferred.empty() || Preferred == Path)
+	{
+		return;
+	}
+	if (Indexed)
+	{
+		FindPath(NormalizePath(Preferred), Path);
+	}
+	else if (FILE* pFile = fopen(Preferred.c_str(), "rb"))
+	{
+		fclose(pFile);
+		Path = Preferred;
+	}
+}
+
+bool TexturePathResolver::FindPath(const std::string& Key, std::string& Resolved) const
+{
+	std::unordered_map<std::string, std::string>::const_iterator it = m_Paths.find(Key);
+	if (it == m_Paths.end())
+	{
+		return false;
+	}
+	Resolved = it->second;
+	return true;
+}
+
+bool TexturePathResolver::ResolveInIndex(const std::string& ModelDir, const std::string& Reference, std::string& Resolved) const
+{
+	const std::string Ref = NormalizePath(Reference);
+	if (FindPath(Ref, Resolved))
+	{
+		return true;
+	}
+	const std::string Relative = !Ref.empty() && Ref[0] == '/' ? Ref.substr(1) : Ref;
+	const char* SubDirs[] = { "", "tex/", "textures/" };
+	for (unsigned int i = 0; i < sizeof(SubDirs) / sizeof(SubDirs[0]); i++)
+	{
+		if (FindPath(JoinPath(ModelDir, SubDirs[i] + Relative), Resolved))
+		{
+			return true;
+		}
+	}
+
+	// same file name anywhere below the root, the shortest path wins a tie
+	const std::string Name = FileNameOf(Ref);
+	typedef std::unordered_multimap<std::string, std::string>::const_iterator NameIterator;
+	const std::pair<NameIterator, NameIterator> Range = m_Names.equal_range(Name);
+	const std::string* pBest = NULL;
+	for (NameIterator it = Range.first; it != Range.second; ++it)
+	{
+		if (DirectoryOf(NormalizePath(it->second)) == ModelDir)
+		{
+			Resolved = it->second;
+			return true;
+		}
+		if (!pBest || it->second.size() < pBest->size() || (it->second.size() == pBest->size() && it->second < *pBest))
+		{
+			pBest = &it->second;
+		}
+	}
+	if (pBest)
+	{
+		Resolved = *pBest;
+		return true;
+	}
+
+	// a file of the same type in the model's directory, one name starting with the other
+	const size_t Dot = Name.rfind('.');
+	std::unordered_map<std::string, std::vector<std::string> >::const_iterator Dir = m_Dirs.find(ModelDir);
+	if (Dot == std::string::npos || Dot == 0 || Dir == m_Dirs.end())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < Dir->second.size(); i++)
+	{
+		const std::string& File = Dir->second[i];
+		const size_t FileDot = File.rfind('.');
+		if (FileDot == std::string::npos || FileDot == 0 || File.compare(FileDot, std::string::npos, Name, Dot, std::string::npos) != 0)
+		{
+			continue;
+		}
+		const size_t Length = FileDot < Dot ? FileDot : Dot;
+		if (File.compare(0, Length, Name, 0, Length) == 0)
+		{
+			return FindPath(JoinPath(ModelDir, File), Resolved);
+		}
+	}
+	return false;
+}
+
+bool TexturePathResolver::Resolve(const std::string& ModelFile, const std::string& Reference, std::string& Resolved)
+{
+	const std::string ModelDir = DirectoryOf(NormalizePath(ModelFile));
+	const std::string Key = ModelDir + "|" + Reference;
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	std::map<std::string, std::string>::iterator it = m_Resolved.find(Key);
+	if (it != m_Resolved.end())
+	{
+		if (it->second.empty())
+		{
+			return false;
+		}
+		Resolved = it->second;
+		return true;
+	}
+	it = m_Loaded.find(Key);
+	if (it != m_Loaded.end())
+	{
+		std::string Path = it->second;
+		m_Loaded.erase(it);
+		if (FILE* pFile = fopen(Path.c_str(), "rb"))
+		{
+			fclose(pFile);
+			// baked since the cache was saved
+			PreferExtension(Path, false);
+			m_Resolved[Key] = Path;
+			Resolved = Path;
+			return true;
+		}
+	}
+	if (!m_Indexed)
+	{
+		BuildIndex();
+	}
+	std::string Path;
+	const bool Found = ResolveInIndex(ModelDir, Reference, Path);
+	if (Found)
+	{
+		PreferExtension(Path, true);
+	}
+	// misses are remembered as well, they are the expensive ones
+	m_Resolved[Key] = Path;
+	if (Found)
+	{
+		Resolved = Path;
+	}
+	return Found;
+}
+
+bool TexturePathResolver::LoadCache(const std::string& CacheFile)
+{
+	std::ifstream File(CacheFile.c_str());
+	if (!File)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	std::string Line;
+	while (std::getline(File, Line))
+	{
+		const size_t Tab = Line.find('\t');
+		if (Tab != std::string::npos && Tab + 1 < Line.size())
+		{
+			m_Loaded[Line.substr(0, Tab)] = Line.substr(Tab + 1);
+		}
+	}
+	return true;
+}
+
+bool TexturePathResolver::SaveCache(const std::string& CacheFile) const
+{
+	std::lock_guard<std::mutex> Lock(m_Mutex);
+	// entries of models not loaded this run are kept
+	std::map<std::string, std::string> Entries = m_Loaded;
+	for (std::map<std::string, std::string>::const_iterator it = m_Resolved.begin(); it != m_Resolved.end(); ++it)
+	{
+		if (!it->second.empty())
+		{
+			Entries[it->first] = it->second;
+		}
+	}
+	FILE* pFile = fopen(CacheFile.c_str(), "w");
+	if (!pFile)
+	{
+		return false;
+	}
+	for (std::map<std::string, std::string>::const_iterator it = Entries.begin(); it != Entries.end(); ++it)
+	{
+		fprintf(pFile, "%s\t%s\n", it->first.c_str(), it->second.c_str());
+	}
+	return fclose(pFile) == 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef TEXTURE_PATH_RESOLVER_H
+#define	TEXTURE_PATH_RESOLVER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Finds the files texture references of a model point to. The asset root is scanned once
+// into an index of lower-cased paths, file names and directories, so a reference costs a
+// few hash lookups instead of fopen probes and directory scans. A reference is tried
+//   as given, relative to the model, in the model's tex\ and textures\ directories,
+//   by file name anywhere below the root (the model's directory first), and finally as
+//   a file in the model's directory with the same extension whose name starts like it.
+// Results are cached per model directory and reference, SaveCache/LoadCache keep them
+// between runs so a warm start doesn't scan at all. Resolve may be called from several
+// loader threads.
+class TexturePathResolver
+{
+public:
+	explicit TexturePathResolver(const std::string& Root = ".");
+	// ModelFile is the model holding the reference. Returns false if nothing matches.
+	bool Resolve(const std::string& ModelFile, const std::string& Reference, std::string& Resolved);
+	// Lines of "model directory|reference<TAB>path". Entries whose file is gone are
+	// dropped when used.
+	bool LoadCache(const std::string& CacheFile);
+	bool SaveCache(const std::string& CacheFile) const;
+	// A file next to the match with the same name and Extension, e.g. ".dds" for the output
+	// of 'assimp bake', is returned instead of the match. Set it before the first Resolve.
+	void SetPreferredExtension(const std::string& Extension);
+
+private:
+	void BuildIndex();
+	bool ResolveInIndex(const std::string& ModelDir, const std::string& Reference, std::string& Resolved) const;
+	bool FindPath(const std::string& Key, std::string& Resolved) const;
+	void PreferExtension(std::string& Path, bool Indexed) const;
+
+	std::string m_Root;
+	std::string m_PreferredExtension;
+	bool m_Indexed;
+	std::unordered_map<std::string, std::string> m_Paths;				// lower-cased path -> path
+	std::unordered_multimap<std::string, std::string> m_Names;			// lower-cased file name -> path
+	std::unordered_map<std::string, std::vector<std::string> > m_Dirs;	// lower-cased directory -> lower-cased file names
+	std::map<std::string, std::string> m_Resolved;						// model directory|reference -> path, empty if missing
+	std::map<std::string, std::string> m_Loaded;						// from LoadCache, checked once before use
+	mutable std::mutex m_Mutex;
+};
+
+// Rooted at the working directory, used by meshes without a resolver of their own
+TexturePathResolver& DefaultTexturePathResolver();
+
+#endif
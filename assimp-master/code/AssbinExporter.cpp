@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/IOStream.hpp>
 #include <assimp/IOSystem.hpp>
 #include <assimp/Exporter.hpp>
+#include <assimp/config.h>
 #include "ProcessHelper.h"
 #include "Exceptional.h"
 
@@ -55,6 +56,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include <time.h>
+#include <memory>
+#include <vector>
 
 
 #ifndef ASSIMP_BUILD_NO_EXPORT
@@ -757,11 +760,461 @@ inline size_t WriteArray(IOStream * stream, const T* in, unsigned int size)
         }
     };
 
+    // ----------------------------------------------------------------------------------
+    /** @class  Assbin2Export
+     *  @brief  Writer for version 2 of the .assbin format
+     *
+     *  Every mesh, material, animation and texture goes to a chunk of its own,
+     *  which is optionally deflated. The table of contents written after the
+     *  header lets readers locate each chunk directly.
+     */
+    class Assbin2Export
+    {
+    private:
+        struct Chunk {
+            uint32_t type;
+            uint32_t index;
+            std::unique_ptr<AssbinChunkWriter> data;
+        };
+
+        std::vector<Chunk> chunks;
+        int compressionLevel;
+
+    protected:
+
+        // -----------------------------------------------------------------------------------
+        AssbinChunkWriter& AddChunk(uint32_t type, uint32_t index)
+        {
+            Chunk chunk;
+            chunk.type = type;
+            chunk.index = index;
+            chunk.data.reset(new AssbinChunkWriter( NULL, 0 ));
+            chunks.push_back(std::move(chunk));
+            return *chunks.back().data;
+        }
+
+        // -----------------------------------------------------------------------------------
+        // Pad with zeros up to the next ASSBIN2_ALIGNMENT boundary
+        static void Align(IOStream * stream)
+        {
+            static const uint8_t zeros[ASSBIN2_ALIGNMENT] = {0};
+            const size_t pad = (ASSBIN2_ALIGNMENT - stream->Tell() % ASSBIN2_ALIGNMENT) % ASSBIN2_ALIGNMENT;
+            if (pad) {
+                stream->Write(zeros,1,pad);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        // Write an aligned array of floats, in one go if ai_real is a float
+        static void WriteRealArray(IOStream * stream, const ai_real* in, size_t count)
+        {
+            Align(stream);
+            if (sizeof(ai_real) == sizeof(float)) {
+                stream->Write(in,sizeof(float),count);
+                return;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                Write<float>(stream,static_cast<float>(in[i]));
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        template <typename T>
+        static void WriteRealArray(IOStream * stream, const T* in, unsigned int size)
+        {
+            static_assert(sizeof(T) % sizeof(ai_real) == 0, "T must consist of ai_real members only");
+            WriteRealArray(stream,reinterpret_cast<const ai_real*>(in),static_cast<size_t>(size) * (sizeof(T) / sizeof(ai_real)));
+        }
+
+        // -----------------------------------------------------------------------------------
+        template <typename T>
+        static void WriteKeys(IOStream * stream, const T* keys, unsigned int size)
+        {
+            Align(stream);
+            for (unsigned int i = 0; i < size; ++i) {
+                Write<double>(stream,keys[i].mTime);
+            }
+            Align(stream);
+            for (unsigned int i = 0; i < size; ++i) {
+                WriteArray(stream,&keys[i].mValue,1);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteNode(IOStream * chunk, const aiNode* node)
+        {
+            Write<aiString>(chunk,node->mName);
+            Write<aiMatrix4x4>(chunk,node->mTransformation);
+            Write<unsigned int>(chunk,node->mNumChildren);
+            Write<unsigned int>(chunk,node->mNumMeshes);
+            WriteArray<unsigned int>(chunk,node->mMeshes,node->mNumMeshes);
+
+            for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+                WriteNode(chunk,node->mChildren[i]);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteLight(IOStream * chunk, const aiLight* l)
+        {
+            Write<aiString>(chunk,l->mName);
+            Write<unsigned int>(chunk,l->mType);
+            Write<aiVector3D>(chunk,l->mPosition);
+            Write<aiVector3D>(chunk,l->mDirection);
+            Write<aiVector3D>(chunk,l->mUp);
+            Write<float>(chunk,l->mAttenuationConstant);
+            Write<float>(chunk,l->mAttenuationLinear);
+            Write<float>(chunk,l->mAttenuationQuadratic);
+            Write<aiVector3D>(chunk,(const aiVector3D&)l->mColorDiffuse);
+            Write<aiVector3D>(chunk,(const aiVector3D&)l->mColorSpecular);
+            Write<aiVector3D>(chunk,(const aiVector3D&)l->mColorAmbient);
+            Write<float>(chunk,l->mAngleInnerCone);
+            Write<float>(chunk,l->mAngleOuterCone);
+            Write<float>(chunk,l->mSize.x);
+            Write<float>(chunk,l->mSize.y);
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteCamera(IOStream * chunk, const aiCamera* cam)
+        {
+            Write<aiString>(chunk,cam->mName);
+            Write<aiVector3D>(chunk,cam->mPosition);
+            Write<aiVector3D>(chunk,cam->mUp);
+            Write<aiVector3D>(chunk,cam->mLookAt);
+            Write<float>(chunk,cam->mHorizontalFOV);
+            Write<float>(chunk,cam->mClipPlaneNear);
+            Write<float>(chunk,cam->mClipPlaneFar);
+            Write<float>(chunk,cam->mAspect);
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteScene(const aiScene* scene)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AISCENE, 0 );
+
+            Write<unsigned int>(&chunk,scene->mFlags);
+            Write<unsigned int>(&chunk,scene->mNumMeshes);
+            Write<unsigned int>(&chunk,scene->mNumMaterials);
+            Write<unsigned int>(&chunk,scene->mNumAnimations);
+            Write<unsigned int>(&chunk,scene->mNumTextures);
+            Write<unsigned int>(&chunk,scene->mNumLights);
+            Write<unsigned int>(&chunk,scene->mNumCameras);
+
+            WriteNode(&chunk,scene->mRootNode);
+
+            for (unsigned int i = 0; i < scene->mNumLights; ++i) {
+                WriteLight(&chunk,scene->mLights[i]);
+            }
+            for (unsigned int i = 0; i < scene->mNumCameras; ++i) {
+                WriteCamera(&chunk,scene->mCameras[i]);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteMesh(const aiMesh* mesh, unsigned int index)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AIMESH, index );
+
+            unsigned int c = 0;
+            if (mesh->mVertices) {
+                c |= ASSBIN_MESH_HAS_POSITIONS;
+            }
+            if (mesh->mNormals) {
+                c |= ASSBIN_MESH_HAS_NORMALS;
+            }
+            if (mesh->mTangents && mesh->mBitangents) {
+                c |= ASSBIN_MESH_HAS_TANGENTS_AND_BITANGENTS;
+            }
+            for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS && mesh->mTextureCoords[n]; ++n) {
+                c |= ASSBIN_MESH_HAS_TEXCOORD(n);
+            }
+            for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_COLOR_SETS && mesh->mColors[n]; ++n) {
+                c |= ASSBIN_MESH_HAS_COLOR(n);
+            }
+
+            // faces of equal size, which is the common case after triangulation,
+            // don't need their index counts written
+            unsigned int numIndices = 0, faceSize = mesh->mNumFaces ? mesh->mFaces[0].mNumIndices : 0;
+            for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+                numIndices += mesh->mFaces[i].mNumIndices;
+                if (mesh->mFaces[i].mNumIndices != faceSize) {
+                    faceSize = 0;
+                }
+            }
+
+            Write<unsigned int>(&chunk,mesh->mPrimitiveTypes);
+            Write<unsigned int>(&chunk,mesh->mNumVertices);
+            Write<unsigned int>(&chunk,mesh->mNumFaces);
+            Write<unsigned int>(&chunk,mesh->mNumBones);
+            Write<unsigned int>(&chunk,mesh->mMaterialIndex);
+            Write<unsigned int>(&chunk,c);
+            Write<unsigned int>(&chunk,numIndices);
+            Write<unsigned int>(&chunk,faceSize);
+            Write<aiString>(&chunk,mesh->mName);
+            for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS && mesh->mTextureCoords[n]; ++n) {
+                Write<unsigned int>(&chunk,mesh->mNumUVComponents[n]);
+            }
+
+            if (c & ASSBIN_MESH_HAS_POSITIONS) {
+                WriteRealArray(&chunk,mesh->mVertices,mesh->mNumVertices);
+            }
+            if (c & ASSBIN_MESH_HAS_NORMALS) {
+                WriteRealArray(&chunk,mesh->mNormals,mesh->mNumVertices);
+            }
+            if (c & ASSBIN_MESH_HAS_TANGENTS_AND_BITANGENTS) {
+                WriteRealArray(&chunk,mesh->mTangents,mesh->mNumVertices);
+                WriteRealArray(&chunk,mesh->mBitangents,mesh->mNumVertices);
+            }
+            for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_COLOR_SETS && mesh->mColors[n]; ++n) {
+                WriteRealArray(&chunk,mesh->mColors[n],mesh->mNumVertices);
+            }
+            for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS && mesh->mTextureCoords[n]; ++n) {
+                WriteRealArray(&chunk,mesh->mTextureCoords[n],mesh->mNumVertices);
+            }
+
+            if (!faceSize) {
+                Align(&chunk);
+                for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+                    static_assert(AI_MAX_FACE_INDICES <= 0xffff, "AI_MAX_FACE_INDICES <= 0xffff");
+                    Write<uint16_t>(&chunk,mesh->mFaces[i].mNumIndices);
+                }
+            }
+
+            Align(&chunk);
+            for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+                const aiFace& f = mesh->mFaces[i];
+                if (mesh->mNumVertices < (1u<<16)) {
+                    for (unsigned int a = 0; a < f.mNumIndices; ++a) {
+                        Write<uint16_t>(&chunk,f.mIndices[a]);
+                    }
+                }
+                else WriteArray<unsigned int>(&chunk,f.mIndices,f.mNumIndices);
+            }
+
+            for (unsigned int a = 0; a < mesh->mNumBones; ++a) {
+                const aiBone* b = mesh->mBones[a];
+
+                Write<aiString>(&chunk,b->mName);
+                Write<unsigned int>(&chunk,b->mNumWeights);
+                WriteRealArray(&chunk,&b->mOffsetMatrix,1);
+
+                Align(&chunk);
+                WriteArray<aiVertexWeight>(&chunk,b->mWeights,b->mNumWeights);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteMeshlets(const aiMesh* mesh, unsigned int index)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AIMESHLETS, index );
+
+            const bool shortIndices = mesh->mNumVertices < (1u<<16);
+            Write<unsigned int>(&chunk,shortIndices ? 2 : 4);
+            Write<unsigned int>(&chunk,mesh->mNumMeshlets);
+            for (unsigned int i = 0; i < mesh->mNumMeshlets; ++i) {
+                const aiMeshlet& m = mesh->mMeshlets[i];
+                Write<unsigned int>(&chunk,m.mNumVertices);
+                Write<unsigned int>(&chunk,m.mNumTriangles);
+                Write<float>(&chunk,m.mCenter.x);
+                Write<float>(&chunk,m.mCenter.y);
+                Write<float>(&chunk,m.mCenter.z);
+                Write<float>(&chunk,m.mRadius);
+                Write<float>(&chunk,m.mConeAxis.x);
+                Write<float>(&chunk,m.mConeAxis.y);
+                Write<float>(&chunk,m.mConeAxis.z);
+                Write<float>(&chunk,m.mConeCutoff);
+            }
+
+            Align(&chunk);
+            for (unsigned int i = 0; i < mesh->mNumMeshlets; ++i) {
+                const aiMeshlet& m = mesh->mMeshlets[i];
+                if (shortIndices) {
+                    for (unsigned int a = 0; a < m.mNumVertices; ++a) {
+                        Write<uint16_t>(&chunk,m.mVertices[a]);
+                    }
+                }
+                else WriteArray<unsigned int>(&chunk,m.mVertices,m.mNumVertices);
+            }
+
+            Align(&chunk);
+            for (unsigned int i = 0; i < mesh->mNumMeshlets; ++i) {
+                const aiMeshlet& m = mesh->mMeshlets[i];
+                chunk.Write(m.mTriangles,1,m.mNumTriangles * 3);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteMaterial(const aiMaterial* mat, unsigned int index)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AIMATERIAL, index );
+
+            Write<unsigned int>(&chunk,mat->mNumProperties);
+            for (unsigned int i = 0; i < mat->mNumProperties; ++i) {
+                const aiMaterialProperty* prop = mat->mProperties[i];
+
+                Write<aiString>(&chunk,prop->mKey);
+                Write<unsigned int>(&chunk,prop->mSemantic);
+                Write<unsigned int>(&chunk,prop->mIndex);
+                Write<unsigned int>(&chunk,prop->mDataLength);
+                Write<unsigned int>(&chunk,(unsigned int)prop->mType);
+                chunk.Write(prop->mData,1,prop->mDataLength);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteAnimation(const aiAnimation* anim, unsigned int index)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AIANIMATION, index );
+
+            Write<aiString>(&chunk,anim->mName);
+            Write<double>(&chunk,anim->mDuration);
+            Write<double>(&chunk,anim->mTicksPerSecond);
+            Write<unsigned int>(&chunk,anim->mNumChannels);
+
+            for (unsigned int a = 0; a < anim->mNumChannels; ++a) {
+                const aiNodeAnim* nd = anim->mChannels[a];
+
+                Write<aiString>(&chunk,nd->mNodeName);
+                Write<unsigned int>(&chunk,nd->mNumPositionKeys);
+                Write<unsigned int>(&chunk,nd->mNumRotationKeys);
+                Write<unsigned int>(&chunk,nd->mNumScalingKeys);
+                Write<unsigned int>(&chunk,nd->mPreState);
+                Write<unsigned int>(&chunk,nd->mPostState);
+
+                WriteKeys(&chunk,nd->mPositionKeys,nd->mNumPositionKeys);
+                WriteKeys(&chunk,nd->mRotationKeys,nd->mNumRotationKeys);
+                WriteKeys(&chunk,nd->mScalingKeys,nd->mNumScalingKeys);
+            }
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteTexture(const aiTexture* tex, unsigned int index)
+        {
+            AssbinChunkWriter& chunk = AddChunk( ASSBIN_CHUNK_AITEXTURE, index );
+
+            Write<unsigned int>(&chunk,tex->mWidth);
+            Write<unsigned int>(&chunk,tex->mHeight);
+            chunk.Write( tex->achFormatHint, sizeof(char), 4 );
+
+            Align(&chunk);
+            chunk.Write( tex->pcData, 1, tex->mHeight ? tex->mWidth*tex->mHeight*4 : tex->mWidth );
+        }
+
+    public:
+        // -----------------------------------------------------------------------------------
+        /** @param compressionLevel zlib compression level for the chunks, 0 stores them. */
+        explicit Assbin2Export(int compressionLevel)
+            : compressionLevel(compressionLevel)
+        {
+        }
+
+        // -----------------------------------------------------------------------------------
+        void WriteBinaryDump(const char* pFile, IOSystem* pIOSystem, const aiScene* pScene)
+        {
+            chunks.clear();
+
+            WriteScene(pScene);
+            for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+                WriteMesh(pScene->mMeshes[i],i);
+                if (pScene->mMeshes[i]->HasMeshlets()) {
+                    WriteMeshlets(pScene->mMeshes[i],i);
+                }
+            }
+            for (unsigned int i = 0; i < pScene->mNumMaterials; ++i) {
+                WriteMaterial(pScene->mMaterials[i],i);
+            }
+            for (unsigned int i = 0; i < pScene->mNumAnimations; ++i) {
+                WriteAnimation(pScene->mAnimations[i],i);
+            }
+            for (unsigned int i = 0; i < pScene->mNumTextures; ++i) {
+                WriteTexture(pScene->mTextures[i],i);
+            }
+
+            // deflate chunks if requested, but keep those which don't get any smaller
+            std::vector< std::vector<uint8_t> > compressedChunks(chunks.size());
+            if (compressionLevel > 0) {
+                for (size_t i = 0; i < chunks.size(); ++i) {
+                    AssbinChunkWriter& chunk = *chunks[i].data;
+                    uLongf compressedSize = compressBound(static_cast<uLong>(chunk.Tell()));
+                    compressedChunks[i].resize(compressedSize);
+
+                    if (Z_OK != compress2(compressedChunks[i].data(), &compressedSize,
+                        static_cast<const Bytef*>(chunk.GetBufferPointer()), static_cast<uLong>(chunk.Tell()),
+                        std::min(compressionLevel,9)) || compressedSize >= chunk.Tell()) {
+                        compressedChunks[i].clear();
+                        continue;
+                    }
+                    compressedChunks[i].resize(compressedSize);
+                }
+            }
+
+            IOStream * out = pIOSystem->Open( pFile, "wb" );
+            if (!out) {
+                throw DeadlyExportError("could not open output .assbin file: " + std::string(pFile));
+            }
+
+            const uint64_t tocOffset = ASSBIN2_HEADER_LENGTH;
+            char magic[16] = {0};
+            strncpy(magic,ASSBIN2_MAGIC,sizeof(magic));
+            out->Write(magic,1,sizeof(magic));
+
+            Write<unsigned int>( out, ASSBIN2_VERSION_MAJOR );
+            Write<unsigned int>( out, ASSBIN2_VERSION_MINOR );
+            Write<unsigned int>( out, aiGetVersionRevision() );
+            Write<unsigned int>( out, aiGetCompileFlags() );
+            Write<unsigned int>( out, static_cast<unsigned int>(chunks.size()) );
+            Write<unsigned int>( out, 0u );
+            Write<uint64_t>( out, tocOffset );
+
+            uint8_t reserved[16] = {0};
+            out->Write(reserved,1,sizeof(reserved));
+            ai_assert( out->Tell() == ASSBIN2_HEADER_LENGTH );
+
+            // table of contents, chunks follow at aligned offsets
+            uint64_t offset = tocOffset + chunks.size() * ASSBIN2_TOC_ENTRY_LENGTH;
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                offset = (offset + ASSBIN2_ALIGNMENT - 1) & ~static_cast<uint64_t>(ASSBIN2_ALIGNMENT - 1);
+
+                const bool deflated = !compressedChunks[i].empty();
+                const size_t size = chunks[i].data->Tell();
+                const size_t stored = deflated ? compressedChunks[i].size() : size;
+
+                Write<unsigned int>( out, chunks[i].type );
+                Write<unsigned int>( out, chunks[i].index );
+                Write<uint64_t>( out, offset );
+                Write<unsigned int>( out, static_cast<unsigned int>(stored) );
+                Write<unsigned int>( out, static_cast<unsigned int>(size) );
+                Write<unsigned int>( out, deflated ? ASSBIN2_COMPRESSION_DEFLATE : ASSBIN2_COMPRESSION_NONE );
+                Write<unsigned int>( out, 0u );
+                offset += stored;
+            }
+
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                Align(out);
+                if (compressedChunks[i].empty()) {
+                    out->Write( chunks[i].data->GetBufferPointer(), 1, chunks[i].data->Tell() );
+                }
+                else {
+                    out->Write( compressedChunks[i].data(), 1, compressedChunks[i].size() );
+                }
+            }
+
+            pIOSystem->Close( out );
+            chunks.clear();
+        }
+    };
+
 void ExportSceneAssbin(const char* pFile, IOSystem* pIOSystem, const aiScene* pScene, const ExportProperties* pProperties)
 {
     AssbinExport exporter;
     exporter.WriteBinaryDump( pFile, pIOSystem, pScene );
 }
+
+void ExportSceneAssbin2(const char* pFile, IOSystem* pIOSystem, const aiScene* pScene, const ExportProperties* pProperties)
+{
+    Assbin2Export exporter( pProperties ? pProperties->GetPropertyInteger(AI_CONFIG_EXPORT_ASSBIN_COMPRESSION,0) : 0 );
+    exporter.WriteBinaryDump( pFile, pIOSystem, pScene );
+}
 } // end of namespace Assimp
 
 #endif // ASSIMP_BUILD_NO_ASSBIN_EXPORTER
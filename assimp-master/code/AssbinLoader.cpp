@@ -51,9 +51,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AssbinLoader.h"
 #include "assbin_chunks.h"
 #include "MemoryIOWrapper.h"
+#include "ThreadPool.h"
+#include "Exceptional.h"
 #include <assimp/mesh.h>
 #include <assimp/anim.h>
 #include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <assimp/config.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
 #ifdef ASSIMP_BUILD_NO_OWN_ZLIB
 #   include <zlib.h>
@@ -92,7 +100,13 @@ bool AssbinImporter::CanRead( const std::string& pFile, IOSystem* pIOHandler, bo
 
     pIOHandler->Close(in);
 
-    return strncmp( s, "ASSIMP.binary-dump.", 19 ) == 0;
+    return strncmp( s, "ASSIMP.binary-dump.", 19 ) == 0 ||
+        strncmp( s, ASSBIN2_MAGIC, sizeof(ASSBIN2_MAGIC) ) == 0;
+}
+
+void AssbinImporter::SetupProperties(const Importer* pImp)
+{
+    decodeThreads = static_cast<unsigned int>( std::max( 0, pImp->GetPropertyInteger( AI_CONFIG_IMPORT_ASSBIN_DECODE_THREADS, 0 ) ) );
 }
 
 template <typename T>
@@ -412,6 +426,7 @@ void AssbinImporter::ReadBinaryMaterial(IOStream * stream, aiMaterial* mat)
             mat->mProperties[i] = new aiMaterialProperty();
             ReadBinaryMaterialProperty( stream, mat->mProperties[i]);
         }
+        mat->UpdatePropertyIndex();
     }
 }
 
@@ -633,13 +648,828 @@ void AssbinImporter::ReadBinaryScene( IOStream * stream, aiScene* scene )
 
 }
 
+// ------------------------------------------------------------------------------------------------
+// Version 2 of the format
+// ------------------------------------------------------------------------------------------------
+
+namespace {
+
+// files holding less chunk data are decoded on the importing thread
+const size_t ParallelDecodeMinSize = 1024 * 1024;
+
+// ------------------------------------------------------------------------------------------------
+// Bounds-checked cursor over the data of a version 2 chunk
+class Assbin2Reader
+{
+public:
+    Assbin2Reader(const uint8_t* data, size_t size)
+        : begin(data), cursor(data), end(data + size)
+    {}
+
+    // ------------------------------------------------------------------------------------------------
+    const uint8_t* Take(size_t size)
+    {
+        if (size > static_cast<size_t>(end - cursor)) {
+            throw DeadlyImportError("ASSBIN: unexpected end of chunk");
+        }
+        const uint8_t* p = cursor;
+        cursor += size;
+        return p;
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    // Take count elements of elementSize bytes, guarding against overflows
+    const uint8_t* TakeArray(size_t count, size_t elementSize)
+    {
+        if (count > static_cast<size_t>(end - cursor) / elementSize) {
+            throw DeadlyImportError("ASSBIN: unexpected end of chunk");
+        }
+        return Take(count * elementSize);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    template <typename T>
+    T Get()
+    {
+        T t;
+        ::memcpy(&t,Take(sizeof(T)),sizeof(T));
+        return t;
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    aiString GetString()
+    {
+        const uint32_t length = Get<uint32_t>();
+        if (length >= MAXLEN) {
+            throw DeadlyImportError("ASSBIN: string exceeds MAXLEN");
+        }
+        aiString s;
+        ::memcpy(s.data,Take(length),length);
+        s.data[length] = 0;
+        s.length = length;
+        return s;
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    void Align()
+    {
+        Take((ASSBIN2_ALIGNMENT - (cursor - begin) % ASSBIN2_ALIGNMENT) % ASSBIN2_ALIGNMENT);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    // Read count unaligned floats
+    void GetReals(ai_real* out, size_t count)
+    {
+        CopyReals(out,TakeArray(count,sizeof(float)),count);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    // Allocate and fill an aligned array of objects consisting of floats only
+    template <typename T>
+    void GetRealArray(T*& out, unsigned int size)
+    {
+        static_assert(sizeof(T) % sizeof(ai_real) == 0, "T must consist of ai_real members only");
+        const size_t count = static_cast<size_t>(size) * (sizeof(T) / sizeof(ai_real));
+
+        Align();
+        const uint8_t* data = TakeArray(count,sizeof(float));
+        out = new T[size];
+        CopyReals(reinterpret_cast<ai_real*>(out),data,count);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    // Allocate and fill an animation key array, stored as an aligned array of
+    // times followed by an aligned array of values.
+    template <typename T>
+    void GetKeys(T*& out, unsigned int& num, unsigned int size)
+    {
+        const size_t components = sizeof(out->mValue) / sizeof(ai_real);
+
+        Align();
+        const uint8_t* times = TakeArray(size,sizeof(double));
+        Align();
+        const uint8_t* values = TakeArray(static_cast<size_t>(size) * components,sizeof(float));
+        if (!size) {
+            return;
+        }
+
+        out = new T[size];
+        num = size;
+        for (unsigned int i = 0; i < size; ++i) {
+            ::memcpy(&out[i].mTime,times + i * sizeof(double),sizeof(double));
+            CopyReals(reinterpret_cast<ai_real*>(&out[i].mValue),values + i * components * sizeof(float),components);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    size_t Remaining() const
+    {
+        return static_cast<size_t>(end - cursor);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void CopyReals(ai_real* out, const uint8_t* in, size_t count)
+    {
+        if (sizeof(ai_real) == sizeof(float)) {
+            ::memcpy(out,in,count * sizeof(float));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            float f;
+            ::memcpy(&f,in + i * sizeof(float),sizeof(float));
+            out[i] = f;
+        }
+    }
+
+private:
+    const uint8_t* const begin;
+    const uint8_t* cursor;
+    const uint8_t* const end;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Entry of the table of contents along with the chunk's data
+struct Assbin2Chunk
+{
+    uint32_t type;
+    uint32_t index;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t rawSize;
+    uint32_t compression;
+
+    // stored chunk data, either in the mapped file or in buffer
+    const uint8_t* stored;
+    std::vector<uint8_t> buffer;
+
+    // error description if the chunk was decoded on a worker thread
+    std::string error;
+};
+
+// ------------------------------------------------------------------------------------------------
+void ReadNode2(Assbin2Reader& reader, aiNode*& out, aiNode* parent)
+{
+    aiNode* node = out = new aiNode();
+    node->mParent = parent;
+    node->mName = reader.GetString();
+    reader.GetReals(&node->mTransformation.a1,16);
+
+    const unsigned int numChildren = reader.Get<uint32_t>();
+    const unsigned int numMeshes = reader.Get<uint32_t>();
+
+    const uint8_t* meshes = reader.TakeArray(numMeshes,sizeof(uint32_t));
+    if (numMeshes) {
+        node->mMeshes = new unsigned int[numMeshes];
+        node->mNumMeshes = numMeshes;
+        ::memcpy(node->mMeshes,meshes,numMeshes * sizeof(uint32_t));
+    }
+
+    if (numChildren) {
+        // each child takes at least 76 bytes, reject bogus counts before allocating
+        if (numChildren > reader.Remaining() / 76) {
+            throw DeadlyImportError("ASSBIN: invalid number of child nodes");
+        }
+        node->mChildren = new aiNode*[numChildren]();
+        node->mNumChildren = numChildren;
+        for (unsigned int i = 0; i < numChildren; ++i) {
+            ReadNode2(reader,node->mChildren[i],node);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+aiColor3D ReadColor2(Assbin2Reader& reader)
+{
+    aiColor3D c;
+    c.r = reader.Get<float>();
+    c.g = reader.Get<float>();
+    c.b = reader.Get<float>();
+    return c;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiVector3D ReadVector2(Assbin2Reader& reader)
+{
+    aiVector3D v;
+    reader.GetReals(&v.x,3);
+    return v;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadLight2(Assbin2Reader& reader, aiLight* l)
+{
+    l->mName = reader.GetString();
+    l->mType = (aiLightSourceType)reader.Get<uint32_t>();
+    l->mPosition = ReadVector2(reader);
+    l->mDirection = ReadVector2(reader);
+    l->mUp = ReadVector2(reader);
+    l->mAttenuationConstant = reader.Get<float>();
+    l->mAttenuationLinear = reader.Get<float>();
+    l->mAttenuationQuadratic = reader.Get<float>();
+    l->mColorDiffuse = ReadColor2(reader);
+    l->mColorSpecular = ReadColor2(reader);
+    l->mColorAmbient = ReadColor2(reader);
+    l->mAngleInnerCone = reader.Get<float>();
+    l->mAngleOuterCone = reader.Get<float>();
+    l->mSize.x = reader.Get<float>();
+    l->mSize.y = reader.Get<float>();
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadCamera2(Assbin2Reader& reader, aiCamera* cam)
+{
+    cam->mName = reader.GetString();
+    cam->mPosition = ReadVector2(reader);
+    cam->mUp = ReadVector2(reader);
+    cam->mLookAt = ReadVector2(reader);
+    cam->mHorizontalFOV = reader.Get<float>();
+    cam->mClipPlaneNear = reader.Get<float>();
+    cam->mClipPlaneFar = reader.Get<float>();
+    cam->mAspect = reader.Get<float>();
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadMesh2(Assbin2Reader& reader, aiMesh* mesh)
+{
+    mesh->mPrimitiveTypes = reader.Get<uint32_t>();
+    mesh->mNumVertices = reader.Get<uint32_t>();
+    const unsigned int numFaces = reader.Get<uint32_t>();
+    const unsigned int numBones = reader.Get<uint32_t>();
+    mesh->mMaterialIndex = reader.Get<uint32_t>();
+    const unsigned int c = reader.Get<uint32_t>();
+    const unsigned int numIndices = reader.Get<uint32_t>();
+    const unsigned int faceSize = reader.Get<uint32_t>();
+    mesh->mName = reader.GetString();
+
+    for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS && (c & ASSBIN_MESH_HAS_TEXCOORD(n)); ++n) {
+        mesh->mNumUVComponents[n] = reader.Get<uint32_t>();
+    }
+
+    if (c & ASSBIN_MESH_HAS_POSITIONS) {
+        reader.GetRealArray(mesh->mVertices,mesh->mNumVertices);
+    }
+    if (c & ASSBIN_MESH_HAS_NORMALS) {
+        reader.GetRealArray(mesh->mNormals,mesh->mNumVertices);
+    }
+    if (c & ASSBIN_MESH_HAS_TANGENTS_AND_BITANGENTS) {
+        reader.GetRealArray(mesh->mTangents,mesh->mNumVertices);
+        reader.GetRealArray(mesh->mBitangents,mesh->mNumVertices);
+    }
+    for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_COLOR_SETS && (c & ASSBIN_MESH_HAS_COLOR(n)); ++n) {
+        reader.GetRealArray(mesh->mColors[n],mesh->mNumVertices);
+    }
+    for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS && (c & ASSBIN_MESH_HAS_TEXCOORD(n)); ++n) {
+        reader.GetRealArray(mesh->mTextureCoords[n],mesh->mNumVertices);
+    }
+
+    // faces, with a single index count for all of them or one count per face
+    const uint8_t* sizes = NULL;
+    if (faceSize) {
+        if (static_cast<uint64_t>(faceSize) * numFaces != numIndices) {
+            throw DeadlyImportError("ASSBIN: face sizes don't match the number of indices");
+        }
+    }
+    else {
+        reader.Align();
+        sizes = reader.TakeArray(numFaces,sizeof(uint16_t));
+
+        uint64_t sum = 0;
+        for (unsigned int i = 0; i < numFaces; ++i) {
+            uint16_t n;
+            ::memcpy(&n,sizes + i * sizeof(uint16_t),sizeof(uint16_t));
+            sum += n;
+        }
+        if (sum != numIndices) {
+            throw DeadlyImportError("ASSBIN: face sizes don't match the number of indices");
+        }
+    }
+
+    const bool shortIndices = mesh->mNumVertices < (1u<<16);
+    reader.Align();
+    const uint8_t* indices = reader.TakeArray(numIndices,shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    if (numFaces) {
+        mesh->mFaces = new aiFace[numFaces];
+        mesh->mNumFaces = numFaces;
+        for (unsigned int i = 0; i < numFaces; ++i) {
+            aiFace& f = mesh->mFaces[i];
+
+            uint16_t n = static_cast<uint16_t>(faceSize);
+            if (sizes) {
+                ::memcpy(&n,sizes + i * sizeof(uint16_t),sizeof(uint16_t));
+            }
+            f.mIndices = new unsigned int[n];
+            f.mNumIndices = n;
+
+            if (shortIndices) {
+                for (unsigned int a = 0; a < n; ++a, indices += sizeof(uint16_t)) {
+                    uint16_t idx;
+                    ::memcpy(&idx,indices,sizeof(uint16_t));
+                    f.mIndices[a] = idx;
+                }
+            }
+            else {
+                ::memcpy(f.mIndices,indices,n * sizeof(uint32_t));
+                indices += n * sizeof(uint32_t);
+            }
+        }
+    }
+
+    if (numBones) {
+        // each bone takes at least 72 bytes, reject bogus counts before allocating
+        if (numBones > reader.Remaining() / 72) {
+            throw DeadlyImportError("ASSBIN: invalid number of bones");
+        }
+        mesh->mBones = new aiBone*[numBones]();
+        mesh->mNumBones = numBones;
+        for (unsigned int a = 0; a < numBones; ++a) {
+            aiBone* b = mesh->mBones[a] = new aiBone();
+            b->mName = reader.GetString();
+            const unsigned int numWeights = reader.Get<uint32_t>();
+            reader.Align();
+            reader.GetReals(&b->mOffsetMatrix.a1,16);
+
+            reader.Align();
+            const uint8_t* weights = reader.TakeArray(numWeights,sizeof(uint32_t) + sizeof(float));
+            if (numWeights) {
+                b->mWeights = new aiVertexWeight[numWeights];
+                b->mNumWeights = numWeights;
+                for (unsigned int i = 0; i < numWeights; ++i, weights += sizeof(uint32_t) + sizeof(float)) {
+                    float w;
+                    ::memcpy(&b->mWeights[i].mVertexId,weights,sizeof(uint32_t));
+                    ::memcpy(&w,weights + sizeof(uint32_t),sizeof(float));
+                    b->mWeights[i].mWeight = w;
+                }
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Meshlets have a chunk of their own, their vertex indices can only be checked
+// against the mesh once all chunks are decoded, see CheckMeshlets2.
+void ReadMeshlets2(Assbin2Reader& reader, aiMesh* mesh)
+{
+    static const size_t MeshletHeaderSize = 2 * sizeof(uint32_t) + 8 * sizeof(float);
+
+    const unsigned int indexSize = reader.Get<uint32_t>();
+    const unsigned int numMeshlets = reader.Get<uint32_t>();
+    if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) {
+        throw DeadlyImportError("ASSBIN: invalid meshlet index size");
+    }
+    Assbin2Reader headers(reader.TakeArray(numMeshlets,MeshletHeaderSize),numMeshlets * MeshletHeaderSize);
+    if (!numMeshlets) {
+        return;
+    }
+
+    mesh->mMeshlets = new aiMeshlet[numMeshlets];
+    mesh->mNumMeshlets = numMeshlets;
+    uint64_t numVertices = 0, numCorners = 0;
+    for (unsigned int i = 0; i < numMeshlets; ++i) {
+        aiMeshlet& m = mesh->mMeshlets[i];
+        m.mNumVertices = headers.Get<uint32_t>();
+        m.mNumTriangles = headers.Get<uint32_t>();
+        ai_real bounds[8];
+        headers.GetReals(bounds,8);
+        m.mCenter = aiVector3D(bounds[0],bounds[1],bounds[2]);
+        m.mRadius = bounds[3];
+        m.mConeAxis = aiVector3D(bounds[4],bounds[5],bounds[6]);
+        m.mConeCutoff = bounds[7];
+        numVertices += m.mNumVertices;
+        numCorners += static_cast<uint64_t>(m.mNumTriangles) * 3;
+    }
+    if (numVertices > reader.Remaining() || numCorners > reader.Remaining()) {
+        throw DeadlyImportError("ASSBIN: unexpected end of chunk");
+    }
+
+    reader.Align();
+    const uint8_t* vertices = reader.TakeArray(static_cast<size_t>(numVertices),indexSize);
+    reader.Align();
+    const uint8_t* corners = reader.TakeArray(static_cast<size_t>(numCorners),1);
+
+    for (unsigned int i = 0; i < numMeshlets; ++i) {
+        aiMeshlet& m = mesh->mMeshlets[i];
+        m.mVertices = new unsigned int[m.mNumVertices];
+        for (unsigned int a = 0; a < m.mNumVertices; ++a, vertices += indexSize) {
+            if (indexSize == sizeof(uint16_t)) {
+                uint16_t idx;
+                ::memcpy(&idx,vertices,sizeof(uint16_t));
+                m.mVertices[a] = idx;
+            }
+            else ::memcpy(&m.mVertices[a],vertices,sizeof(uint32_t));
+        }
+
+        m.mTriangles = new unsigned char[m.mNumTriangles * 3];
+        ::memcpy(m.mTriangles,corners,m.mNumTriangles * 3);
+        corners += m.mNumTriangles * 3;
+        for (unsigned int a = 0; a < m.mNumTriangles * 3; ++a) {
+            if (m.mTriangles[a] >= m.mNumVertices) {
+                throw DeadlyImportError("ASSBIN: meshlet triangle index out of range");
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void CheckMeshlets2(const aiMesh* mesh)
+{
+    for (unsigned int i = 0; i < mesh->mNumMeshlets; ++i) {
+        const aiMeshlet& m = mesh->mMeshlets[i];
+        for (unsigned int a = 0; a < m.mNumVertices; ++a) {
+            if (m.mVertices[a] >= mesh->mNumVertices) {
+                throw DeadlyImportError("ASSBIN: meshlet vertex index out of range");
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadMaterial2(Assbin2Reader& reader, aiMaterial* mat)
+{
+    const unsigned int numProperties = reader.Get<uint32_t>();
+    if (numProperties) {
+        // each property takes at least 20 bytes, reject bogus counts before allocating
+        if (numProperties > reader.Remaining() / 20) {
+            throw DeadlyImportError("ASSBIN: invalid number of material properties");
+        }
+        delete[] mat->mProperties;
+        mat->mProperties = new aiMaterialProperty*[numProperties];
+        mat->mNumAllocated = numProperties;
+        mat->mNumProperties = 0;
+
+        for (unsigned int i = 0; i < numProperties; ++i) {
+            aiMaterialProperty* prop = new aiMaterialProperty();
+            mat->mProperties[mat->mNumProperties++] = prop;
+
+            prop->mKey = reader.GetString();
+            prop->mSemantic = reader.Get<uint32_t>();
+            prop->mIndex = reader.Get<uint32_t>();
+            const unsigned int length = reader.Get<uint32_t>();
+            prop->mType = (aiPropertyTypeInfo)reader.Get<uint32_t>();
+
+            const uint8_t* data = reader.Take(length);
+            prop->mData = new char[length];
+            prop->mDataLength = length;
+            ::memcpy(prop->mData,data,length);
+        }
+    }
+    mat->UpdatePropertyIndex();
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadAnimation2(Assbin2Reader& reader, aiAnimation* anim)
+{
+    anim->mName = reader.GetString();
+    anim->mDuration = reader.Get<double>();
+    anim->mTicksPerSecond = reader.Get<double>();
+
+    const unsigned int numChannels = reader.Get<uint32_t>();
+    if (numChannels) {
+        // each channel takes at least 24 bytes, reject bogus counts before allocating
+        if (numChannels > reader.Remaining() / 24) {
+            throw DeadlyImportError("ASSBIN: invalid number of animation channels");
+        }
+        anim->mChannels = new aiNodeAnim*[numChannels]();
+        anim->mNumChannels = numChannels;
+
+        for (unsigned int a = 0; a < numChannels; ++a) {
+            aiNodeAnim* nd = anim->mChannels[a] = new aiNodeAnim();
+            nd->mNodeName = reader.GetString();
+            const unsigned int numPositionKeys = reader.Get<uint32_t>();
+            const unsigned int numRotationKeys = reader.Get<uint32_t>();
+            const unsigned int numScalingKeys = reader.Get<uint32_t>();
+            nd->mPreState = (aiAnimBehaviour)reader.Get<uint32_t>();
+            nd->mPostState = (aiAnimBehaviour)reader.Get<uint32_t>();
+
+            reader.GetKeys(nd->mPositionKeys,nd->mNumPositionKeys,numPositionKeys);
+            reader.GetKeys(nd->mRotationKeys,nd->mNumRotationKeys,numRotationKeys);
+            reader.GetKeys(nd->mScalingKeys,nd->mNumScalingKeys,numScalingKeys);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void ReadTexture2(Assbin2Reader& reader, aiTexture* tex)
+{
+    const unsigned int width = reader.Get<uint32_t>();
+    const unsigned int height = reader.Get<uint32_t>();
+    ::memcpy(tex->achFormatHint,reader.Take(4),4);
+
+    reader.Align();
+    if (height) {
+        const uint8_t* data = reader.TakeArray(static_cast<size_t>(width) * height,sizeof(aiTexel));
+        tex->pcData = new aiTexel[width * height];
+        ::memcpy(tex->pcData,data,static_cast<size_t>(width) * height * sizeof(aiTexel));
+    }
+    else {
+        // compressed texture data, mWidth is its size in bytes
+        const uint8_t* data = reader.Take(width);
+        tex->pcData = new aiTexel[width / sizeof(aiTexel) + 1];
+        ::memcpy(tex->pcData,data,width);
+    }
+    tex->mWidth = width;
+    tex->mHeight = height;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Get the uncompressed data of a chunk, which is inflated to buffer if needed
+const uint8_t* InflateChunk2(const Assbin2Chunk& chunk, std::vector<uint8_t>& buffer)
+{
+    if (chunk.compression == ASSBIN2_COMPRESSION_DEFLATE) {
+        // don't trust the file with the size of the buffer
+        if (chunk.rawSize / ASSBIN2_MAX_INFLATE_RATIO > chunk.size) {
+            throw DeadlyImportError("ASSBIN: invalid size of compressed chunk");
+        }
+        buffer.resize(chunk.rawSize);
+        uLongf size = chunk.rawSize;
+        if (Z_OK != uncompress(buffer.data(),&size,chunk.stored,chunk.size) || size != chunk.rawSize) {
+            throw DeadlyImportError("ASSBIN: failed to inflate chunk");
+        }
+        return buffer.data();
+    }
+    if (chunk.compression != ASSBIN2_COMPRESSION_NONE || chunk.size != chunk.rawSize) {
+        throw DeadlyImportError("ASSBIN: unsupported chunk compression");
+    }
+    return chunk.stored;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Decode a chunk into the object it belongs to
+void DecodeChunk2(const Assbin2Chunk& chunk, aiScene* scene)
+{
+    std::vector<uint8_t> buffer;
+    Assbin2Reader reader(InflateChunk2(chunk,buffer),chunk.rawSize);
+    switch (chunk.type)
+    {
+    case ASSBIN_CHUNK_AIMESH:
+        ReadMesh2(reader,scene->mMeshes[chunk.index]);
+        break;
+    case ASSBIN_CHUNK_AIMESHLETS:
+        ReadMeshlets2(reader,scene->mMeshes[chunk.index]);
+        break;
+    case ASSBIN_CHUNK_AIMATERIAL:
+        ReadMaterial2(reader,scene->mMaterials[chunk.index]);
+        break;
+    case ASSBIN_CHUNK_AIANIMATION:
+        ReadAnimation2(reader,scene->mAnimations[chunk.index]);
+        break;
+    case ASSBIN_CHUNK_AITEXTURE:
+        ReadTexture2(reader,scene->mTextures[chunk.index]);
+        break;
+    default:
+        // unknown chunk, skip it
+        break;
+    };
+}
+
+// ------------------------------------------------------------------------------------------------
+// Decode the scene chunk and create empty objects for all other chunks
+void DecodeSceneChunk2(const Assbin2Chunk& chunk, aiScene* scene, size_t numChunks)
+{
+    std::vector<uint8_t> buffer;
+    Assbin2Reader reader(InflateChunk2(chunk,buffer),chunk.rawSize);
+
+    scene->mFlags = reader.Get<uint32_t>();
+    const unsigned int numMeshes = reader.Get<uint32_t>();
+    const unsigned int numMaterials = reader.Get<uint32_t>();
+    const unsigned int numAnimations = reader.Get<uint32_t>();
+    const unsigned int numTextures = reader.Get<uint32_t>();
+    const unsigned int numLights = reader.Get<uint32_t>();
+    const unsigned int numCameras = reader.Get<uint32_t>();
+
+    // every mesh, material, animation and texture has a chunk of its own
+    if (static_cast<uint64_t>(numMeshes) + numMaterials + numAnimations + numTextures >= numChunks) {
+        throw DeadlyImportError("ASSBIN: table of contents is incomplete");
+    }
+
+    ReadNode2(reader,scene->mRootNode,NULL);
+
+    if (numMeshes) {
+        scene->mMeshes = new aiMesh*[numMeshes];
+        for (scene->mNumMeshes = 0; scene->mNumMeshes < numMeshes; ++scene->mNumMeshes) {
+            scene->mMeshes[scene->mNumMeshes] = new aiMesh();
+        }
+    }
+    if (numMaterials) {
+        scene->mMaterials = new aiMaterial*[numMaterials];
+        for (scene->mNumMaterials = 0; scene->mNumMaterials < numMaterials; ++scene->mNumMaterials) {
+            scene->mMaterials[scene->mNumMaterials] = new aiMaterial();
+        }
+    }
+    if (numAnimations) {
+        scene->mAnimations = new aiAnimation*[numAnimations];
+        for (scene->mNumAnimations = 0; scene->mNumAnimations < numAnimations; ++scene->mNumAnimations) {
+            scene->mAnimations[scene->mNumAnimations] = new aiAnimation();
+        }
+    }
+    if (numTextures) {
+        scene->mTextures = new aiTexture*[numTextures];
+        for (scene->mNumTextures = 0; scene->mNumTextures < numTextures; ++scene->mNumTextures) {
+            scene->mTextures[scene->mNumTextures] = new aiTexture();
+        }
+    }
+
+    // lights take at least 104 bytes, cameras 56
+    if (numLights > reader.Remaining() / 104 || numCameras > reader.Remaining() / 56) {
+        throw DeadlyImportError("ASSBIN: invalid number of lights or cameras");
+    }
+    if (numLights) {
+        scene->mLights = new aiLight*[numLights]();
+        scene->mNumLights = numLights;
+        for (unsigned int i = 0; i < numLights; ++i) {
+            ReadLight2(reader,scene->mLights[i] = new aiLight());
+        }
+    }
+    if (numCameras) {
+        scene->mCameras = new aiCamera*[numCameras]();
+        scene->mNumCameras = numCameras;
+        for (unsigned int i = 0; i < numCameras; ++i) {
+            ReadCamera2(reader,scene->mCameras[i] = new aiCamera());
+        }
+    }
+}
+
+} // Namespace
+
+// ------------------------------------------------------------------------------------------------
+void AssbinImporter::ReadBinaryScene2( IOStream * stream, aiScene* pScene )
+{
+    const size_t fileSize = stream->FileSize();
+
+    uint8_t header[ASSBIN2_HEADER_LENGTH];
+    stream->Seek( 0, aiOrigin_SET );
+    if (stream->Read( header, 1, sizeof(header) ) != sizeof(header)) {
+        throw DeadlyImportError("ASSBIN: file is too small");
+    }
+
+    Assbin2Reader reader( header + 16, sizeof(header) - 16 );
+    const unsigned int versionMajor = reader.Get<uint32_t>();
+    /*unsigned int versionMinor =*/ reader.Get<uint32_t>();
+    /*unsigned int versionRevision =*/ reader.Get<uint32_t>();
+    /*unsigned int compileFlags =*/ reader.Get<uint32_t>();
+    const unsigned int numEntries = reader.Get<uint32_t>();
+    /*unsigned int reserved =*/ reader.Get<uint32_t>();
+    const uint64_t tocOffset = reader.Get<uint64_t>();
+
+    if (versionMajor != ASSBIN2_VERSION_MAJOR) {
+        throw DeadlyImportError("ASSBIN: unsupported format version " + std::to_string(versionMajor));
+    }
+    if (!numEntries || tocOffset > fileSize || numEntries > (fileSize - tocOffset) / ASSBIN2_TOC_ENTRY_LENGTH) {
+        throw DeadlyImportError("ASSBIN: invalid table of contents");
+    }
+
+    // use the chunks in place if the file is in memory, read them otherwise
+    const uint8_t* contents = GetStreamContents(stream);
+
+    std::vector<uint8_t> tocBuffer;
+    const uint8_t* toc = contents ? contents + tocOffset : NULL;
+    if (!toc) {
+        tocBuffer.resize(numEntries * ASSBIN2_TOC_ENTRY_LENGTH);
+        stream->Seek( static_cast<size_t>(tocOffset), aiOrigin_SET );
+        if (stream->Read( tocBuffer.data(), 1, tocBuffer.size() ) != tocBuffer.size()) {
+            throw DeadlyImportError("ASSBIN: failed to read the table of contents");
+        }
+        toc = tocBuffer.data();
+    }
+
+    std::vector<Assbin2Chunk> chunks(numEntries);
+    Assbin2Reader tocReader( toc, numEntries * ASSBIN2_TOC_ENTRY_LENGTH );
+    size_t dataSize = 0;
+    for (Assbin2Chunk& chunk : chunks) {
+        chunk.type = tocReader.Get<uint32_t>();
+        chunk.index = tocReader.Get<uint32_t>();
+        chunk.offset = tocReader.Get<uint64_t>();
+        chunk.size = tocReader.Get<uint32_t>();
+        chunk.rawSize = tocReader.Get<uint32_t>();
+        chunk.compression = tocReader.Get<uint32_t>();
+        /*uint32_t reserved =*/ tocReader.Get<uint32_t>();
+
+        if (chunk.offset > fileSize || chunk.size > fileSize - chunk.offset) {
+            throw DeadlyImportError("ASSBIN: chunk exceeds the file size");
+        }
+
+        if (contents) {
+            chunk.stored = contents + chunk.offset;
+        }
+        else {
+            chunk.buffer.resize(chunk.size);
+            stream->Seek( static_cast<size_t>(chunk.offset), aiOrigin_SET );
+            if (stream->Read( chunk.buffer.data(), 1, chunk.size ) != chunk.size) {
+                throw DeadlyImportError("ASSBIN: failed to read chunk");
+            }
+            chunk.stored = chunk.buffer.data();
+        }
+        dataSize += chunk.rawSize;
+    }
+
+    if (chunks[0].type != ASSBIN_CHUNK_AISCENE) {
+        throw DeadlyImportError("ASSBIN: first chunk is not the scene");
+    }
+    DecodeSceneChunk2( chunks[0], pScene, chunks.size() );
+
+    // each object must be described by exactly one chunk
+    std::vector<bool> meshes(pScene->mNumMeshes), materials(pScene->mNumMaterials),
+        animations(pScene->mNumAnimations), textures(pScene->mNumTextures), meshlets(pScene->mNumMeshes);
+    size_t numObjects = 0;
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        std::vector<bool>* seen = NULL;
+        switch (chunks[i].type)
+        {
+        case ASSBIN_CHUNK_AIMESH:
+            seen = &meshes;
+            break;
+        case ASSBIN_CHUNK_AIMESHLETS:
+            seen = &meshlets;
+            break;
+        case ASSBIN_CHUNK_AIMATERIAL:
+            seen = &materials;
+            break;
+        case ASSBIN_CHUNK_AIANIMATION:
+            seen = &animations;
+            break;
+        case ASSBIN_CHUNK_AITEXTURE:
+            seen = &textures;
+            break;
+        default:
+            continue;
+        };
+        if (chunks[i].index >= seen->size() || (*seen)[chunks[i].index]) {
+            throw DeadlyImportError("ASSBIN: invalid or duplicate chunk index");
+        }
+        (*seen)[chunks[i].index] = true;
+
+        // meshlets are optional, they don't describe an object of their own
+        if (seen != &meshlets) {
+            ++numObjects;
+        }
+    }
+    if (numObjects != static_cast<size_t>(pScene->mNumMeshes) + pScene->mNumMaterials + pScene->mNumAnimations + pScene->mNumTextures) {
+        throw DeadlyImportError("ASSBIN: table of contents is incomplete");
+    }
+
+    unsigned int numThreads = decodeThreads;
+    if (!numThreads) {
+        numThreads = dataSize >= ParallelDecodeMinSize ? ThreadPool::GetHardwareThreadCount() : 1;
+    }
+    numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, numObjects));
+
+    if (numThreads <= 1) {
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            DecodeChunk2( chunks[i], pScene );
+        }
+    }
+    else {
+        // objects are independent of each other, so their chunks can be inflated
+        // and decoded in parallel. A mesh and its meshlets fill different members.
+        // Errors are reported once all tasks are done.
+        {
+            ThreadPool pool( numThreads );
+            for (size_t i = 1; i < chunks.size(); ++i) {
+                Assbin2Chunk* chunk = &chunks[i];
+                pool.Enqueue([chunk, pScene]() {
+                    try {
+                        DecodeChunk2( *chunk, pScene );
+                    }
+                    catch (const std::exception& e) {
+                        chunk->error = e.what();
+                    }
+                });
+            }
+        }
+        for (const Assbin2Chunk& chunk : chunks) {
+            if (!chunk.error.empty()) {
+                throw DeadlyImportError(chunk.error);
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+        CheckMeshlets2( pScene->mMeshes[i] );
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
 void AssbinImporter::InternReadFile( const std::string& pFile, aiScene* pScene, IOSystem* pIOHandler )
 {
     IOStream * stream = pIOHandler->Open(pFile,"rb");
     if (!stream)
         return;
 
-    stream->Seek( 44, aiOrigin_CUR ); // signature
+    char magic[16];
+    stream->Read( magic, 1, sizeof(magic) );
+    if (strncmp( magic, ASSBIN2_MAGIC, sizeof(ASSBIN2_MAGIC) ) == 0) {
+        try {
+            ReadBinaryScene2( stream, pScene );
+        }
+        catch (...) {
+            pIOHandler->Close(stream);
+            throw;
+        }
+        pIOHandler->Close(stream);
+        return;
+    }
+
+    stream->Seek( 44 - sizeof(magic), aiOrigin_CUR ); // signature
 
     /*unsigned int versionMajor =*/ Read<unsigned int>(stream);
     /*unsigned int versionMinor =*/ Read<unsigned int>(stream);
@@ -661,12 +1491,21 @@ void AssbinImporter::InternReadFile( const std::string& pFile, aiScene* pScene,
         uLongf uncompressedSize = Read<uint32_t>(stream);
         uLongf compressedSize = stream->FileSize() - stream->Tell();
 
-        unsigned char * compressedData = new unsigned char[ compressedSize ];
-        stream->Read( compressedData, 1, compressedSize );
+        // inflate directly from the stream contents if they are in memory
+        unsigned char * compressedData = NULL;
+        const uint8_t * compressedSource = GetStreamContents(stream);
+        if (compressedSource) {
+            compressedSource += stream->Tell();
+        }
+        else {
+            compressedData = new unsigned char[ compressedSize ];
+            stream->Read( compressedData, 1, compressedSize );
+            compressedSource = compressedData;
+        }
 
         unsigned char * uncompressedData = new unsigned char[ uncompressedSize ];
 
-        uncompress( uncompressedData, &uncompressedSize, compressedData, compressedSize );
+        uncompress( uncompressedData, &uncompressedSize, compressedSource, compressedSize );
 
         MemoryIOStream io( uncompressedData, uncompressedSize );
 
@@ -71,9 +71,11 @@ class AssbinImporter : public BaseImporter
 private:
   bool shortened;
   bool compressed;
+  unsigned int decodeThreads;
 protected:
 
 public:
+  virtual void SetupProperties(const Importer* pImp);
   virtual bool CanRead(
     const std::string& pFile,
     IOSystem* pIOHandler,
@@ -96,6 +98,9 @@ public:
   void ReadBinaryTexture(IOStream * stream, aiTexture* tex);
   void ReadBinaryLight( IOStream * stream, aiLight* l );
   void ReadBinaryCamera( IOStream * stream, aiCamera* cam );
+
+  // version 2 of the format
+  void ReadBinaryScene2( IOStream * stream, aiScene* pScene );
 };
 
 } // end of namespace Assimp
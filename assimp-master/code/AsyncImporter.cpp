@@ -0,0 +1,381 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file  AsyncImporter.cpp
+ *  @brief Implementation of the asynchronous import API
+ */
+
+#include <assimp/AsyncImporter.hpp>
+#include <assimp/Importer.hpp>
+#include <assimp/ProgressHandler.hpp>
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/scene.h>
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace Assimp {
+
+// ------------------------------------------------------------------------------------------------
+// Shared state of a single asynchronous import
+struct AsyncImportState
+{
+    AsyncImportState(const std::string& file, unsigned int flags, Importer* importer,
+        ProgressHandler* handler, const AsyncImporter::Continuation& continuation)
+        : mFile(file)
+        , mFlags(flags)
+        , mImporter(importer)
+        , mHandler(handler)
+        , mContinuation(continuation)
+        , mReady(false)
+        , mScene(NULL)
+        , mCancelled(false)
+        , mProgress(0.f)
+    {}
+
+    ~AsyncImportState() {
+        delete mScene;
+        delete mImporter;
+        delete mHandler;
+    }
+
+    // request, owned until the import starts
+    std::string mFile;
+    unsigned int mFlags;
+    Importer* mImporter;
+    ProgressHandler* mHandler;
+    AsyncImporter::Continuation mContinuation;
+
+    // completion, guarded by mMutex
+    std::mutex mMutex;
+    std::condition_variable mDone;
+    bool mReady;
+    aiScene* mScene;
+    std::string mError;
+
+    std::atomic<bool> mCancelled;
+    std::atomic<float> mProgress;
+};
+
+// ------------------------------------------------------------------------------------------------
+class AsyncImporterPimpl
+{
+public:
+    explicit AsyncImporterPimpl(unsigned int numThreads)
+        : mShutdown(false)
+        , mPool(numThreads)
+    {}
+
+    std::atomic<bool> mShutdown;
+
+    // declared last, so the workers are joined before anything else is destroyed
+    ThreadPool mPool;
+};
+
+} // Namespace Assimp
+
+using namespace Assimp;
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Progress handler installed into the importer of an asynchronous import. It records
+// the progress, aborts cancelled imports and forwards to the handler of the caller.
+class AsyncProgressHandler : public ProgressHandler
+{
+public:
+    explicit AsyncProgressHandler(AsyncImportState* state)
+        : mState(state)
+    {}
+
+    bool Update(float percentage) {
+        if (percentage >= 0.f) {
+            mState->mProgress = std::min(percentage, 1.f);
+        }
+        if (mState->mCancelled) {
+            return false;
+        }
+        return !mState->mHandler || mState->mHandler->Update(percentage);
+    }
+
+    void UpdateFileRead(int currentStep, int numberOfSteps) {
+        mState->mProgress = (numberOfSteps ? currentStep / (float)numberOfSteps : 1.0f) * 0.5f;
+        if (mState->mHandler) {
+            mState->mHandler->UpdateFileRead(currentStep, numberOfSteps);
+        }
+    }
+
+    void UpdatePostProcess(int currentStep, int numberOfSteps) {
+        mState->mProgress = (numberOfSteps ? currentStep / (float)numberOfSteps : 1.0f) * 0.5f + 0.5f;
+        if (mState->mHandler) {
+            mState->mHandler->UpdatePostProcess(currentStep, numberOfSteps);
+        }
+    }
+
+private:
+    AsyncImportState* mState;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Import a single file, executed by the workers
+void RunImport(const std::shared_ptr<AsyncImportState>& state, const std::atomic<bool>* shutdown)
+{
+    aiScene* scene = NULL;
+    std::string error;
+
+    if (*shutdown) {
+        state->mCancelled = true;
+    }
+
+    if (!state->mCancelled) {
+        Importer* importer = state->mImporter ? state->mImporter : new Importer();
+        state->mImporter = NULL;
+
+        try {
+            importer->SetProgressHandler(new AsyncProgressHandler(state.get()));
+            if (importer->ReadFile(state->mFile, state->mFlags)) {
+                scene = importer->GetOrphanedScene();
+            }
+            else {
+                error = importer->GetErrorString();
+            }
+
+            // prepare the scene for the caller, still on this thread
+            if (scene && state->mContinuation && !state->mCancelled && !state->mContinuation(scene)) {
+                error = "Post-import callback failed";
+            }
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        catch (...) {
+            error = "Unknown exception";
+        }
+        delete importer;
+    }
+
+    if (state->mCancelled || !error.empty()) {
+        delete scene;
+        scene = NULL;
+        if (state->mCancelled) {
+            error = "Import cancelled";
+        }
+        DefaultLogger::get()->info("Asynchronous import of " + state->mFile + " failed: " + error);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mMutex);
+        state->mScene = scene;
+        state->mError = error;
+        state->mReady = true;
+        state->mContinuation = AsyncImporter::Continuation();
+    }
+    state->mProgress = 1.f;
+    state->mDone.notify_all();
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport::AsyncImport()
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport::AsyncImport(const std::shared_ptr<AsyncImportState>& state)
+    : mState(state)
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport::~AsyncImport()
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport::AsyncImport(const AsyncImport& other)
+    : mState(other.mState)
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport& AsyncImport::operator=(const AsyncImport& other)
+{
+    mState = other.mState;
+    return *this;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool AsyncImport::IsValid() const
+{
+    return static_cast<bool>(mState);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool AsyncImport::IsReady() const
+{
+    if (!mState) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+    return mState->mReady;
+}
+
+// ------------------------------------------------------------------------------------------------
+void AsyncImport::Wait() const
+{
+    if (!mState) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mState->mMutex);
+    while (!mState->mReady) {
+        mState->mDone.wait(lock);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+bool AsyncImport::WaitFor(unsigned int pMilliseconds) const
+{
+    if (!mState) {
+        return false;
+    }
+    const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(pMilliseconds);
+
+    std::unique_lock<std::mutex> lock(mState->mMutex);
+    while (!mState->mReady) {
+        if (mState->mDone.wait_until(lock, until) == std::cv_status::timeout) {
+            return mState->mReady;
+        }
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+void AsyncImport::Cancel()
+{
+    if (mState) {
+        mState->mCancelled = true;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+bool AsyncImport::IsCancelled() const
+{
+    return mState && mState->mCancelled;
+}
+
+// ------------------------------------------------------------------------------------------------
+float AsyncImport::GetProgress() const
+{
+    return mState ? static_cast<float>(mState->mProgress) : 0.f;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* AsyncImport::GetScene()
+{
+    if (!mState) {
+        return NULL;
+    }
+    Wait();
+
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+    aiScene* scene = mState->mScene;
+    mState->mScene = NULL;
+    return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+const char* AsyncImport::GetErrorString() const
+{
+    if (!mState) {
+        return "";
+    }
+    Wait();
+    return mState->mError.c_str();
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImporter::AsyncImporter(unsigned int pNumThreads)
+    : pimpl(new AsyncImporterPimpl(pNumThreads))
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImporter::~AsyncImporter()
+{
+    // imports which have not started yet are dropped by the workers
+    pimpl->mShutdown = true;
+    delete pimpl;
+}
+
+// ------------------------------------------------------------------------------------------------
+AsyncImport AsyncImporter::ReadFile(const std::string& pFile,
+    unsigned int pFlags,
+    Importer* pImporter,
+    ProgressHandler* pHandler,
+    const Continuation& pContinuation)
+{
+    std::shared_ptr<AsyncImportState> state = std::make_shared<AsyncImportState>(pFile, pFlags,
+        pImporter, pHandler, pContinuation);
+
+    const std::atomic<bool>* shutdown = &pimpl->mShutdown;
+    pimpl->mPool.Enqueue([state, shutdown]() {
+        RunImport(state, shutdown);
+    });
+    return AsyncImport(state);
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int AsyncImporter::GetThreadCount() const
+{
+    return pimpl->mPool.GetThreadCount();
+}
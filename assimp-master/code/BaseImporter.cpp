@@ -45,6 +45,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "BaseImporter.h"
 #include "FileSystemFilter.h"
+#include "MappedIOStream.h"
+#include "MemoryIOWrapper.h"
 #include "Importer.h"
 #include "ByteSwapper.h"
 #include <assimp/scene.h>
@@ -460,6 +462,20 @@ void BaseImporter::TextFileToBuffer(IOStream* stream,
     data.push_back(0);
 }
 
+// ------------------------------------------------------------------------------------------------
+const uint8_t* BaseImporter::GetStreamContents(IOStream* stream)
+{
+    ai_assert(NULL != stream);
+
+    if (const MappedIOStream* mapped = dynamic_cast<const MappedIOStream*>(stream)) {
+        return mapped->GetData();
+    }
+    if (const MemoryIOStream* memory = dynamic_cast<const MemoryIOStream*>(stream)) {
+        return memory->GetBuffer();
+    }
+    return NULL;
+}
+
 // ------------------------------------------------------------------------------------------------
 namespace Assimp
 {
@@ -363,6 +363,19 @@ public: // static utilities
         std::vector<char>& data,
         TextFileMode mode = FORBID_EMPTY);
 
+    // -------------------------------------------------------------------
+    /** Utility for loaders which can parse a contiguous buffer in place.
+     *  Returns the complete contents of the stream without copying them
+     *  if the stream is backed by memory, i.e. a memory mapped file from
+     *  the #DefaultIOSystem or a buffer passed to ReadFileFromMemory().
+     *  @param stream Stream to query. The returned pointer is valid
+     *   until the stream is closed.
+     *  @return Pointer to stream->FileSize() bytes, or NULL if the
+     *   data must be read through the stream. The buffer is not
+     *   zero-terminated. */
+    static const uint8_t* GetStreamContents(
+        IOStream* stream);
+
     // -------------------------------------------------------------------
     /** Utility function to move a std::vector into a aiScene array
     *  @param vec The vector to be moved
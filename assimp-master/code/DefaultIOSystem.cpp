@@ -42,11 +42,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "DefaultIOSystem.h"
 #include "DefaultIOStream.h"
+#include "MappedIOStream.h"
 #include "StringComparison.h"
 
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/ai_assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #ifdef __unix__
@@ -89,6 +91,15 @@ IOStream* DefaultIOSystem::Open( const char* strFile, const char* strMode)
     ai_assert(NULL != strFile);
     ai_assert(NULL != strMode);
 
+    // read-only binary access is served from a memory mapping of the file, so
+    // loaders can parse the contents in place. Fall back to stdio otherwise.
+    if (0 == ::strcmp(strMode, "rb")) {
+        IOStream* mapped = MappedIOStream::Open(strFile);
+        if (NULL != mapped) {
+            return mapped;
+        }
+    }
+
     FILE* file = ::fopen( strFile, strMode);
     if( NULL == file)
         return NULL;
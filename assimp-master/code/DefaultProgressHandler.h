@@ -55,7 +55,7 @@ class DefaultProgressHandler
 
 
     virtual bool Update(float /*percentage*/) {
-        return false;
+        return true;
     }
 
 
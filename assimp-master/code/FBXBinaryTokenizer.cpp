@@ -107,6 +107,7 @@ Token::Token(const char* sbegin, const char* send, TokenType type, unsigned int
     , type(type)
     , line(offset)
     , column(BINARY_MARKER)
+    , decoded()
 {
     ai_assert(sbegin);
     ai_assert(send);
@@ -455,9 +455,14 @@ Converter::Converter( aiScene* out, const Document& doc )
     ConvertRootNode();
 
     if ( doc.Settings().readAllMaterials ) {
-        // unfortunately this means we have to evaluate all objects
+        // the object class is known without parsing, so only materials are evaluated
         for( const ObjectMap::value_type& v : doc.Objects() ) {
 
+            const Token& key = v.second->GetElement().KeyToken();
+            if ( key.end() - key.begin() != 8 || strncmp( key.begin(), "Material", 8 ) ) {
+                continue;
+            }
+
             const Object* ob = v.second->Get();
             if ( !ob ) {
                 continue;
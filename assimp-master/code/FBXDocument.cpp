@@ -85,25 +85,9 @@ static void dumpObjectClassInfo( const char* obtype, const std::string &classtag
 }
 
 // ------------------------------------------------------------------------------------------------
-const Object* LazyObject::Get(bool dieOnError)
+// read the name and class tag of an object
+static void ReadNameAndClassTag(const Element& element, std::string& name, std::string& classtag)
 {
-    if(IsBeingConstructed() || FailedToConstruct()) {
-        return NULL;
-    }
-
-    if (object.get()) {
-        return object.get();
-    }
-
-    // if this is the root object, we return a dummy since there
-    // is no root object int he fbx file - it is just referenced
-    // with id 0.
-    if(id == 0L) {
-        object.reset(new Object(id, element, "Model::RootNode"));
-        return object.get();
-    }
-
-    const Token& key = element.KeyToken();
     const TokenList& tokens = element.Tokens();
 
     if(tokens.size() < 3) {
@@ -111,7 +95,7 @@ const Object* LazyObject::Get(bool dieOnError)
     }
 
     const char* err;
-    std::string name = ParseTokenAsString(*tokens[1],err);
+    name = ParseTokenAsString(*tokens[1],err);
     if (err) {
         DOMError(err,&element);
     }
@@ -129,10 +113,88 @@ const Object* LazyObject::Get(bool dieOnError)
         }
     }
 
-    const std::string classtag = ParseTokenAsString(*tokens[2],err);
+    classtag = ParseTokenAsString(*tokens[2],err);
     if (err) {
         DOMError(err,&element);
     }
+}
+
+// ------------------------------------------------------------------------------------------------
+// check whether the import settings exclude an object, looking at as little of it as possible
+static bool IsFilteredOut(const ImportSettings& settings, const Element& element)
+{
+    const std::string obtype = element.KeyToken().StringContents();
+
+    if (obtype == "Geometry" || obtype == "Deformer") {
+        return !settings.readMeshes;
+    }
+    if (obtype == "Material") {
+        return !settings.readMaterials;
+    }
+    if (obtype == "Texture" || obtype == "LayeredTexture" || obtype == "Video") {
+        return !settings.readMaterials || !settings.readTextures;
+    }
+    if (obtype == "AnimationStack" || obtype == "AnimationLayer" ||
+        obtype == "AnimationCurveNode" || obtype == "AnimationCurve") {
+
+        if (!settings.readAnimations) {
+            return true;
+        }
+
+        // layers and curves are only reached through their stack
+        if (obtype != "AnimationStack" || settings.animationStacks.empty()) {
+            return false;
+        }
+
+        std::string name, classtag;
+        ReadNameAndClassTag(element,name,classtag);
+
+        // same naming as the animations converted from the stack
+        if (name.substr(0, 16) == "AnimationStack::") {
+            name = name.substr(16);
+        }
+        else if (name.substr(0, 11) == "AnimStack::") {
+            name = name.substr(11);
+        }
+        return settings.animationStacks.find(name) == settings.animationStacks.end();
+    }
+    if (obtype == "NodeAttribute" && (!settings.readCameras || !settings.readLights)) {
+        std::string name, classtag;
+        ReadNameAndClassTag(element,name,classtag);
+
+        if (classtag == "Camera" || classtag == "CameraSwitcher") {
+            return !settings.readCameras;
+        }
+        if (classtag == "Light") {
+            return !settings.readLights;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+const Object* LazyObject::Get(bool dieOnError)
+{
+    if(IsBeingConstructed() || FailedToConstruct() || IsSkipped()) {
+        return NULL;
+    }
+
+    if (object.get()) {
+        return object.get();
+    }
+
+    // if this is the root object, we return a dummy since there
+    // is no root object int he fbx file - it is just referenced
+    // with id 0.
+    if(id == 0L) {
+        object.reset(new Object(id, element, "Model::RootNode"));
+        return object.get();
+    }
+
+    const Token& key = element.KeyToken();
+
+    std::string name, classtag;
+    ReadNameAndClassTag(element,name,classtag);
 
     // prevent recursive calls
     flags |= BEING_CONSTRUCTED;
@@ -231,6 +293,20 @@ const Object* LazyObject::Get(bool dieOnError)
     return object.get();
 }
 
+// ------------------------------------------------------------------------------------------------
+bool LazyObject::IsSkipped()
+{
+    if (!(flags & SKIP_EVALUATED)) {
+        flags |= SKIP_EVALUATED;
+
+        // the root object (id 0) is a dummy and always present
+        if (id != 0L && IsFilteredOut(doc.Settings(),element)) {
+            flags |= SKIPPED;
+        }
+    }
+    return (flags & SKIPPED) != 0;
+}
+
 // ------------------------------------------------------------------------------------------------
 Object::Object(uint64_t id, const Element& element, const std::string& name)
 : element(element)
@@ -539,6 +615,9 @@ const std::vector<const AnimationStack*>& Document::AnimationStacks() const
     animationStacksResolved.reserve(animationStacks.size());
     for(uint64_t id : animationStacks) {
         LazyObject* const lazy = GetObject(id);
+        if(lazy && lazy->IsSkipped()) {
+            continue;
+        }
         const AnimationStack* stack;
         if(!lazy || !(stack = lazy->Get<AnimationStack>())) {
             DOMWarning("failed to read AnimationStack object");
@@ -569,8 +648,15 @@ std::vector<const Connection*> Document::GetConnectionsSequenced(uint64_t id,
     const std::pair<ConnectionMap::const_iterator,ConnectionMap::const_iterator> range =
         conns.equal_range(id);
 
+    // the other end of the connections
+    const bool is_src = &conns == &src_connections;
+
     temp.reserve(std::distance(range.first,range.second));
     for (ConnectionMap::const_iterator it = range.first; it != range.second; ++it) {
+        // objects excluded by the import settings are not linked to anything
+        if ((is_src ? (*it).second->LazyDestinationObject() : (*it).second->LazySourceObject()).IsSkipped()) {
+            continue;
+        }
         temp.push_back((*it).second);
     }
 
@@ -604,10 +690,10 @@ std::vector<const Connection*> Document::GetConnectionsSequenced(uint64_t id, bo
 
     temp.reserve(std::distance(range.first,range.second));
     for (ConnectionMap::const_iterator it = range.first; it != range.second; ++it) {
-        const Token& key = (is_src
+        LazyObject& other = is_src
             ? (*it).second->LazyDestinationObject()
-            : (*it).second->LazySourceObject()
-        ).GetElement().KeyToken();
+            : (*it).second->LazySourceObject();
+        const Token& key = other.GetElement().KeyToken();
 
         const char* obtype = key.begin();
 
@@ -619,7 +705,7 @@ std::vector<const Connection*> Document::GetConnectionsSequenced(uint64_t id, bo
             }
         }
 
-        if(obtype) {
+        if(obtype || other.IsSkipped()) {
             continue;
         }
 
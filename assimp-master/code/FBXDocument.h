@@ -107,6 +107,12 @@ public:
         return (flags & FAILED_TO_CONSTRUCT) != 0;
     }
 
+    /** Check whether the import settings exclude the object, i.e. it is
+     *  a camera while cameras are not read. Skipped objects are never
+     *  parsed, Get() returns NULL for them and connections to them are
+     *  not reported by the Document. */
+    bool IsSkipped();
+
     const Element& GetElement() const {
         return element;
     }
@@ -124,7 +130,9 @@ private:
 
     enum Flags {
         BEING_CONSTRUCTED = 0x1,
-        FAILED_TO_CONSTRUCT = 0x2
+        FAILED_TO_CONSTRUCT = 0x2,
+        SKIP_EVALUATED = 0x4,
+        SKIPPED = 0x8
     };
 
     unsigned int flags;
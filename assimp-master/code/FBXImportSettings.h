@@ -44,6 +44,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef INCLUDED_AI_FBX_IMPORTSETTINGS_H
 #define INCLUDED_AI_FBX_IMPORTSETTINGS_H
 
+#include <set>
+#include <string>
+
 namespace Assimp {
 namespace FBX {
 
@@ -59,9 +62,11 @@ struct ImportSettings
         , readCameras(true)
         , readLights(true)
         , readAnimations(true)
+        , readMeshes(true)
         , readWeights(true)
         , preservePivots(true)
         , optimizeEmptyAnimationCurves(true)
+        , inflateThreads(0)
     {}
 
 
@@ -106,6 +111,17 @@ struct ImportSettings
      *  skeleton is always imported). Default value is true. */
     bool readAnimations;
 
+    /** names of the animation stacks to import, without the
+     *  AnimStack:: prefix. All other stacks and their layers and
+     *  curves are never parsed. Empty to import all stacks, which
+     *  is the default. */
+    std::set<std::string> animationStacks;
+
+    /** import geometry and the deformers attached to it? Without
+     *  meshes, only the node hierarchy (including the skeleton)
+     *  and the animations are read. Default value is true. */
+    bool readMeshes;
+
     /** read bones (vertex weights and deform info).
      *  Default value is true. */
     bool readWeights;
@@ -136,6 +152,11 @@ struct ImportSettings
      *  values matching the corresponding node transformation.
      *  The default value is true. */
     bool optimizeEmptyAnimationCurves;
+
+    /** number of threads used to inflate compressed arrays in binary
+     *  files. 0 picks a value based on the amount of compressed data,
+     *  1 inflates each array on demand. The default value is 0. */
+    unsigned int inflateThreads;
 };
 
 
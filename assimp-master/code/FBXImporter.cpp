@@ -46,6 +46,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <exception>
 #include <iterator>
+#include <algorithm>
 
 #include "FBXImporter.h"
 
@@ -133,6 +134,21 @@ void FBXImporter::SetupProperties(const Importer* pImp)
     settings.strictMode = pImp->GetPropertyBool(AI_CONFIG_IMPORT_FBX_STRICT_MODE, false);
     settings.preservePivots = pImp->GetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, true);
     settings.optimizeEmptyAnimationCurves = pImp->GetPropertyBool(AI_CONFIG_IMPORT_FBX_OPTIMIZE_EMPTY_ANIMATION_CURVES, true);
+    settings.inflateThreads = static_cast<unsigned int>(std::max(0, pImp->GetPropertyInteger(AI_CONFIG_IMPORT_FBX_INFLATE_THREADS, 0)));
+    settings.readMeshes = pImp->GetPropertyBool(AI_CONFIG_IMPORT_FBX_READ_MESHES, true);
+
+    settings.animationStacks.clear();
+    const std::string stacks = pImp->GetPropertyString(AI_CONFIG_IMPORT_FBX_ANIMATION_STACKS, "");
+    for (std::string::size_type begin = 0; begin <= stacks.length(); ) {
+        std::string::size_type end = stacks.find(';', begin);
+        if (end == std::string::npos) {
+            end = stacks.length();
+        }
+        if (end > begin) {
+            settings.animationStacks.insert(stacks.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
 }
 
 
@@ -146,16 +162,25 @@ void FBXImporter::InternReadFile( const std::string& pFile,
         ThrowException("Could not open file for reading");
     }
 
-    // read entire file into memory - no streaming for this, fbx
+    // binary files are tokenized in place if the stream is backed by
+    // memory (i.e. a mapped file), tokens then point into the mapping.
+    // The stream must therefore stay open until the import is done.
+    const size_t fileSize = stream->FileSize();
+    const char* const mapped = reinterpret_cast<const char*>(GetStreamContents(stream.get()));
+    const bool is_binary_mapped = mapped && fileSize >= 18 && !memcmp(mapped,"Kaydara FBX Binary",18);
+
+    // otherwise read entire file into memory - no streaming for this, fbx
     // files can grow large, but the assimp output data structure
     // then becomes very large, too. Assimp doesn't support
     // streaming for its output data structures so the net win with
     // streaming input data would be very low.
     std::vector<char> contents;
-    contents.resize(stream->FileSize()+1);
-    stream->Read( &*contents.begin(), 1, contents.size()-1 );
-    contents[ contents.size() - 1 ] = 0;
-    const char* const begin = &*contents.begin();
+    if (!is_binary_mapped) {
+        contents.resize(fileSize+1);
+        stream->Read( &*contents.begin(), 1, contents.size()-1 );
+        contents[ contents.size() - 1 ] = 0;
+    }
+    const char* const begin = is_binary_mapped ? mapped : &*contents.begin();
 
     // broadphase tokenizing pass in which we identify the core
     // syntax elements of FBX (brackets, commas, key:value mappings)
@@ -163,7 +188,11 @@ void FBXImporter::InternReadFile( const std::string& pFile,
     try {
 
         bool is_binary = false;
-        if (!strncmp(begin,"Kaydara FBX Binary",18)) {
+        if (is_binary_mapped) {
+            is_binary = true;
+            TokenizeBinary(tokens,begin,fileSize);
+        }
+        else if (!strncmp(begin,"Kaydara FBX Binary",18)) {
             is_binary = true;
             TokenizeBinary(tokens,begin,contents.size());
         }
@@ -173,7 +202,7 @@ void FBXImporter::InternReadFile( const std::string& pFile,
 
         // use this information to construct a very rudimentary
         // parse-tree representing the FBX scope structure
-        Parser parser(tokens, is_binary);
+        Parser parser(tokens, is_binary, settings);
 
         // take the raw parse-tree and convert it to a FBX DOM
         Document doc(parser,settings);
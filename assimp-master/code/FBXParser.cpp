@@ -55,12 +55,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "FBXTokenizer.h"
 #include "FBXParser.h"
 #include "FBXUtil.h"
+#include "ThreadPool.h"
 
 #include "ParsingUtils.h"
 #include "fast_atof.h"
 #include "ByteSwapper.h"
 
 #include <iostream>
+#include <assimp/DefaultLogger.hpp>
 
 using namespace Assimp;
 using namespace Assimp::FBX;
@@ -214,13 +216,19 @@ Scope::~Scope()
 
 
 // ------------------------------------------------------------------------------------------------
-Parser::Parser (const TokenList& tokens, bool is_binary)
+Parser::Parser (const TokenList& tokens, bool is_binary, const ImportSettings& settings)
 : tokens(tokens)
 , last()
 , current()
 , cursor(tokens.begin())
 , is_binary(is_binary)
 {
+    // compressed arrays are inflated in the background while we build the
+    // scope hierarchy, the pool's destructor waits for them to complete.
+    std::unique_ptr<ThreadPool> pool;
+    if (is_binary && settings.inflateThreads != 1) {
+        pool.reset(DecodeBinaryArrays(settings));
+    }
     root.reset(new Scope(*this,true));
 }
 
@@ -522,10 +530,66 @@ void ReadBinaryDataArrayHead(const char*& data, const char* end, char& type, uin
 
 
 // ------------------------------------------------------------------------------------------------
-// read binary data array, assume cursor points to the 'compression mode' field (i.e. behind the header)
-void ReadBinaryDataArray(char type, uint32_t count, const char*& data, const char* end,
+// size in bytes of a single element of a binary data array, 0 for unsupported types
+uint32_t BinaryDataArrayStride(char type)
+{
+    switch(type)
+    {
+    case 'f':
+    case 'i':
+        return 4;
+
+    case 'd':
+    case 'l':
+        return 8;
+
+    default:
+        return 0;
+    };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// inflate a zlib-compressed array, returns an error description or NULL on success
+const char* InflateBinaryDataArray(const char* data, uint32_t comp_len, char* out, uint32_t full_length)
+{
+    // zlib/deflate, next comes ZIP head (0x78 0x01)
+    // see http://www.ietf.org/rfc/rfc1950.txt
+
+    z_stream zstream;
+    zstream.opaque = Z_NULL;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree  = Z_NULL;
+    zstream.data_type = Z_BINARY;
+
+    // http://hewgill.com/journal/entries/349-how-to-decompress-gzip-stream-with-zlib
+    if(Z_OK != inflateInit(&zstream)) {
+        return "failure initializing zlib";
+    }
+
+    zstream.next_in   = reinterpret_cast<Bytef*>( const_cast<char*>(data) );
+    zstream.avail_in  = comp_len;
+
+    zstream.avail_out = full_length;
+    zstream.next_out = reinterpret_cast<Bytef*>(out);
+    const int ret = inflate(&zstream, Z_FINISH);
+
+    // terminate zlib
+    inflateEnd(&zstream);
+
+    if (ret != Z_STREAM_END && ret != Z_OK) {
+        return "failure decompressing compressed data section";
+    }
+    return NULL;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// read binary data array, assume cursor points to the 'compression mode' field (i.e. behind the header).
+// Returns the decoded data, which is either stored in buff or was inflated ahead of time by the parser.
+const char* ReadBinaryDataArray(char type, uint32_t count, const char*& data, const char* end,
     std::vector<char>& buff,
-    const Element& /*el*/)
+    const Element& el)
 {
     BE_NCONST uint32_t encmode = SafeParse<uint32_t>(data, end);
     AI_SWAP4(encmode);
@@ -539,60 +603,30 @@ void ReadBinaryDataArray(char type, uint32_t count, const char*& data, const cha
     ai_assert(data + comp_len == end);
 
     // determine the length of the uncompressed data by looking at the type signature
-    uint32_t stride = 0;
-    switch(type)
-    {
-    case 'f':
-    case 'i':
-        stride = 4;
-        break;
-
-    case 'd':
-    case 'l':
-        stride = 8;
-        break;
-
-    default:
-        ai_assert(false);
-    };
+    const uint32_t stride = BinaryDataArrayStride(type);
+    ai_assert(stride);
 
     const uint32_t full_length = stride * count;
-    buff.resize(full_length);
 
     if(encmode == 0) {
         ai_assert(full_length == comp_len);
 
         // plain data, no compression
+        buff.resize(full_length);
         std::copy(data, end, buff.begin());
     }
     else if(encmode == 1) {
-        // zlib/deflate, next comes ZIP head (0x78 0x01)
-        // see http://www.ietf.org/rfc/rfc1950.txt
-
-        z_stream zstream;
-        zstream.opaque = Z_NULL;
-        zstream.zalloc = Z_NULL;
-        zstream.zfree  = Z_NULL;
-        zstream.data_type = Z_BINARY;
-
-        // http://hewgill.com/journal/entries/349-how-to-decompress-gzip-stream-with-zlib
-        if(Z_OK != inflateInit(&zstream)) {
-            ParseError("failure initializing zlib");
+        const char* const decoded = el.Tokens()[0]->DecodedArray();
+        if (decoded) {
+            data += comp_len;
+            return decoded;
         }
 
-        zstream.next_in   = reinterpret_cast<Bytef*>( const_cast<char*>(data) );
-        zstream.avail_in  = comp_len;
-
-        zstream.avail_out = buff.size();
-        zstream.next_out = reinterpret_cast<Bytef*>(&*buff.begin());
-        const int ret = inflate(&zstream, Z_FINISH);
-
-        if (ret != Z_STREAM_END && ret != Z_OK) {
-            ParseError("failure decompressing compressed data section");
+        buff.resize(full_length);
+        const char* const err = InflateBinaryDataArray(data, comp_len, &*buff.begin(), full_length);
+        if (err) {
+            ParseError(err, &el);
         }
-
-        // terminate zlib
-        inflateEnd(&zstream);
     }
 #ifdef ASSIMP_BUILD_DEBUG
     else {
@@ -603,11 +637,109 @@ void ReadBinaryDataArray(char type, uint32_t count, const char*& data, const cha
 
     data += comp_len;
     ai_assert(data == end);
+    return buff.empty() ? NULL : &buff[0];
 }
 
 } // !anon
 
 
+// ------------------------------------------------------------------------------------------------
+// start inflating all zlib-compressed arrays on a thread pool. Returns the pool or NULL if
+// there is nothing worth doing in parallel, in which case arrays are inflated on demand.
+ThreadPool* Parser::DecodeBinaryArrays(const ImportSettings& settings)
+{
+    // with automatic configuration, small files are not worth the thread overhead
+    static const size_t AutoThreshold = 1024 * 1024;
+
+    // arrays of objects which are not going to be read are left alone. Curves
+    // of unwanted animation stacks can't be told apart without connections,
+    // so with a stack filter all curves are inflated on demand.
+    const bool skip_geometry = !settings.readMeshes;
+    const bool skip_curves = !settings.readAnimations || !settings.animationStacks.empty();
+
+    TokenList arrays;
+    size_t total = 0;
+    unsigned int depth = 0;
+    bool in_objects = false, skip_object = false;
+    for(TokenPtr t : tokens) {
+        if (t->Type() == TokenType_OPEN_BRACKET) {
+            ++depth;
+            continue;
+        }
+        if (t->Type() == TokenType_CLOSE_BRACKET) {
+            --depth;
+            continue;
+        }
+        if (t->Type() == TokenType_KEY) {
+            if (depth == 0) {
+                in_objects = t->StringContents() == "Objects";
+                skip_object = false;
+            }
+            else if (depth == 1 && in_objects) {
+                const std::string key = t->StringContents();
+                skip_object = (skip_geometry && (key == "Geometry" || key == "Deformer")) ||
+                    (skip_curves && key == "AnimationCurve");
+            }
+            continue;
+        }
+        if (skip_object || t->Type() != TokenType_DATA || t->end() - t->begin() < 13) {
+            continue;
+        }
+        const char* data = t->begin();
+        if (!BinaryDataArrayStride(*data)) {
+            continue;
+        }
+
+        BE_NCONST uint32_t encmode = SafeParse<uint32_t>(data + 5, t->end());
+        AI_SWAP4(encmode);
+        if (encmode == 1) {
+            arrays.push_back(t);
+            total += t->end() - t->begin();
+        }
+    }
+
+    unsigned int num_threads = settings.inflateThreads;
+    if (!num_threads) {
+        num_threads = ThreadPool::GetHardwareThreadCount();
+        if (total < AutoThreshold) {
+            num_threads = 1;
+        }
+    }
+    num_threads = std::min(num_threads, static_cast<unsigned int>(arrays.size()));
+    if (num_threads <= 1) {
+        return NULL;
+    }
+
+    DefaultLogger::get()->debug((Formatter::format(),"FBX: inflating ",arrays.size(),
+        " arrays (",total," bytes) on ",num_threads," threads"));
+
+    ThreadPool* const pool = new ThreadPool(num_threads);
+    for(TokenPtr t : arrays) {
+        pool->Enqueue([t]() {
+            const char* data = t->begin();
+            BE_NCONST uint32_t count = SafeParse<uint32_t>(data + 1, t->end());
+            AI_SWAP4(count);
+            BE_NCONST uint32_t comp_len = SafeParse<uint32_t>(data + 9, t->end());
+            AI_SWAP4(comp_len);
+
+            const uint32_t full_length = BinaryDataArrayStride(*data) * count;
+            if (!full_length || data + 13 + comp_len != t->end()) {
+                return;
+            }
+
+            // on failure, ReadBinaryDataArray() inflates again and reports the error
+            char* const out = new char[full_length];
+            if (InflateBinaryDataArray(data + 13, comp_len, out, full_length)) {
+                delete[] out;
+                return;
+            }
+            t->decoded = out;
+        });
+    }
+    return pool;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // read an array of float3 tuples
 void ParseVectorDataArray(std::vector<aiVector3D>& out, const Element& el)
@@ -639,16 +771,16 @@ void ParseVectorDataArray(std::vector<aiVector3D>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * (type == 'd' ? 8 : 4));
+        ai_assert(buff.empty() || buff.size() == count * (type == 'd' ? 8 : 4));
 
         const uint32_t count3 = count / 3;
         out.reserve(count3);
 
         if (type == 'd') {
-            const double* d = reinterpret_cast<const double*>(&buff[0]);
+            const double* d = reinterpret_cast<const double*>(decoded);
             for (unsigned int i = 0; i < count3; ++i, d += 3) {
                 out.push_back(aiVector3D(static_cast<float>(d[0]),
                     static_cast<float>(d[1]),
@@ -663,7 +795,7 @@ void ParseVectorDataArray(std::vector<aiVector3D>& out, const Element& el)
             }*/
         }
         else if (type == 'f') {
-            const float* f = reinterpret_cast<const float*>(&buff[0]);
+            const float* f = reinterpret_cast<const float*>(decoded);
             for (unsigned int i = 0; i < count3; ++i, f += 3) {
                 out.push_back(aiVector3D(f[0],f[1],f[2]));
             }
@@ -726,16 +858,16 @@ void ParseVectorDataArray(std::vector<aiColor4D>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * (type == 'd' ? 8 : 4));
+        ai_assert(buff.empty() || buff.size() == count * (type == 'd' ? 8 : 4));
 
         const uint32_t count4 = count / 4;
         out.reserve(count4);
 
         if (type == 'd') {
-            const double* d = reinterpret_cast<const double*>(&buff[0]);
+            const double* d = reinterpret_cast<const double*>(decoded);
             for (unsigned int i = 0; i < count4; ++i, d += 4) {
                 out.push_back(aiColor4D(static_cast<float>(d[0]),
                     static_cast<float>(d[1]),
@@ -744,7 +876,7 @@ void ParseVectorDataArray(std::vector<aiColor4D>& out, const Element& el)
             }
         }
         else if (type == 'f') {
-            const float* f = reinterpret_cast<const float*>(&buff[0]);
+            const float* f = reinterpret_cast<const float*>(decoded);
             for (unsigned int i = 0; i < count4; ++i, f += 4) {
                 out.push_back(aiColor4D(f[0],f[1],f[2],f[3]));
             }
@@ -805,23 +937,23 @@ void ParseVectorDataArray(std::vector<aiVector2D>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * (type == 'd' ? 8 : 4));
+        ai_assert(buff.empty() || buff.size() == count * (type == 'd' ? 8 : 4));
 
         const uint32_t count2 = count / 2;
         out.reserve(count2);
 
         if (type == 'd') {
-            const double* d = reinterpret_cast<const double*>(&buff[0]);
+            const double* d = reinterpret_cast<const double*>(decoded);
             for (unsigned int i = 0; i < count2; ++i, d += 2) {
                 out.push_back(aiVector2D(static_cast<float>(d[0]),
                     static_cast<float>(d[1])));
             }
         }
         else if (type == 'f') {
-            const float* f = reinterpret_cast<const float*>(&buff[0]);
+            const float* f = reinterpret_cast<const float*>(decoded);
             for (unsigned int i = 0; i < count2; ++i, f += 2) {
                 out.push_back(aiVector2D(f[0],f[1]));
             }
@@ -877,14 +1009,14 @@ void ParseVectorDataArray(std::vector<int>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * 4);
+        ai_assert(buff.empty() || buff.size() == count * 4);
 
         out.reserve(count);
 
-        const int32_t* ip = reinterpret_cast<const int32_t*>(&buff[0]);
+        const int32_t* ip = reinterpret_cast<const int32_t*>(decoded);
         for (unsigned int i = 0; i < count; ++i, ++ip) {
             BE_NCONST int32_t val = *ip;
             AI_SWAP4(val);
@@ -935,19 +1067,19 @@ void ParseVectorDataArray(std::vector<float>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * (type == 'd' ? 8 : 4));
+        ai_assert(buff.empty() || buff.size() == count * (type == 'd' ? 8 : 4));
 
         if (type == 'd') {
-            const double* d = reinterpret_cast<const double*>(&buff[0]);
+            const double* d = reinterpret_cast<const double*>(decoded);
             for (unsigned int i = 0; i < count; ++i, ++d) {
                 out.push_back(static_cast<float>(*d));
             }
         }
         else if (type == 'f') {
-            const float* f = reinterpret_cast<const float*>(&buff[0]);
+            const float* f = reinterpret_cast<const float*>(decoded);
             for (unsigned int i = 0; i < count; ++i, ++f) {
                 out.push_back(*f);
             }
@@ -997,14 +1129,14 @@ void ParseVectorDataArray(std::vector<unsigned int>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * 4);
+        ai_assert(buff.empty() || buff.size() == count * 4);
 
         out.reserve(count);
 
-        const int32_t* ip = reinterpret_cast<const int32_t*>(&buff[0]);
+        const int32_t* ip = reinterpret_cast<const int32_t*>(decoded);
         for (unsigned int i = 0; i < count; ++i, ++ip) {
             BE_NCONST int32_t val = *ip;
             if(val < 0) {
@@ -1062,14 +1194,14 @@ void ParseVectorDataArray(std::vector<uint64_t>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * 8);
+        ai_assert(buff.empty() || buff.size() == count * 8);
 
         out.reserve(count);
 
-        const uint64_t* ip = reinterpret_cast<const uint64_t*>(&buff[0]);
+        const uint64_t* ip = reinterpret_cast<const uint64_t*>(decoded);
         for (unsigned int i = 0; i < count; ++i, ++ip) {
             BE_NCONST uint64_t val = *ip;
             AI_SWAP8(val);
@@ -1120,14 +1252,14 @@ void ParseVectorDataArray(std::vector<int64_t>& out, const Element& el)
         }
 
         std::vector<char> buff;
-        ReadBinaryDataArray(type, count, data, end, buff, el);
+        const char* const decoded = ReadBinaryDataArray(type, count, data, end, buff, el);
 
         ai_assert(data == end);
-        ai_assert(buff.size() == count * 8);
+        ai_assert(buff.empty() || buff.size() == count * 8);
 
         out.reserve(count);
 
-        const int64_t* ip = reinterpret_cast<const int64_t*>(&buff[0]);
+        const int64_t* ip = reinterpret_cast<const int64_t*>(decoded);
         for (unsigned int i = 0; i < count; ++i, ++ip) {
             BE_NCONST int64_t val = *ip;
             AI_SWAP8(val);
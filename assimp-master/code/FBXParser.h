@@ -51,8 +51,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "FBXCompileConfig.h"
 #include "FBXTokenizer.h"
+#include "FBXImportSettings.h"
 
 namespace Assimp {
+class ThreadPool;
+
 namespace FBX {
 
 class Scope;
@@ -157,8 +160,12 @@ class Parser
 public:
 
     /** Parse given a token list. Does not take ownership of the tokens -
-     *  the objects must persist during the entire parser lifetime */
-    Parser (const TokenList& tokens,bool is_binary);
+     *  the objects must persist during the entire parser lifetime
+     *
+     *  For binary files, compressed arrays are inflated on
+     *  settings.inflateThreads worker threads while the scope hierarchy
+     *  is built, skipping objects the settings exclude from the import.*/
+    Parser (const TokenList& tokens,bool is_binary, const ImportSettings& settings = ImportSettings());
     ~Parser();
 
 public:
@@ -180,6 +187,8 @@ private:
     TokenPtr LastToken() const;
     TokenPtr CurrentToken() const;
 
+    ThreadPool* DecodeBinaryArrays(const ImportSettings& settings);
+
 
 private:
     const TokenList& tokens;
@@ -67,6 +67,7 @@ Token::Token(const char* sbegin, const char* send, TokenType type, unsigned int
     , type(type)
     , line(line)
     , column(column)
+    , decoded()
 {
     ai_assert(sbegin);
     ai_assert(send);
@@ -79,6 +80,7 @@ Token::Token(const char* sbegin, const char* send, TokenType type, unsigned int
 // ------------------------------------------------------------------------------------------------
 Token::~Token()
 {
+    delete[] decoded;
 }
 
 
@@ -138,7 +138,14 @@ public:
         return column;
     }
 
+    /** Inflated payload of a zlib-compressed binary array, or NULL
+     *  if the parser did not decode it ahead of time. */
+    const char* DecodedArray() const {
+        return decoded;
+    }
+
 private:
+    friend class Parser;
 
 #ifdef DEBUG
     // full string copy for the sole purpose that it nicely appears
@@ -156,6 +163,9 @@ private:
         unsigned int offset;
     };
     const unsigned int column;
+
+    // owned, filled in by Parser::DecodeBinaryArrays()
+    mutable char* decoded;
 };
 
 // XXX should use C++11's unique_ptr - but assimp's need to keep working with 03
@@ -45,15 +45,61 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "FindInstancesProcess.h"
+#include "ThreadPool.h"
+#include "Exceptional.h"
+#include "Hash.h"
+#include <assimp/instances.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 
 using namespace Assimp;
 
+namespace {
+
+// scenes with less meshes are processed on the calling thread
+const unsigned int ParallelMinMeshes = 256;
+
+// ------------------------------------------------------------------------------------------------
+template <typename T>
+uint32_t HashArray(const T* data, unsigned int num, uint32_t hash)
+{
+    if (!data || !num) {
+        return hash;
+    }
+    return SuperFastHash(reinterpret_cast<const char*>(data), static_cast<uint32_t>(sizeof(T) * num), hash);
+}
+
+} // Namespace
+
+// ------------------------------------------------------------------------------------------------
+uint32_t Assimp::GetMeshContentHash(const aiMesh* in)
+{
+    ai_assert(NULL != in);
+
+    uint32_t hash = HashArray(in->mVertices, in->mNumVertices, 0);
+    hash = HashArray(in->mNormals, in->mNumVertices, hash);
+    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++i) {
+        hash = HashArray(in->mTextureCoords[i], in->mNumVertices, hash);
+    }
+    for (unsigned int i = 0; i < in->mNumBones; ++i) {
+        const aiBone* bone = in->mBones[i];
+        hash = HashArray(bone->mName.data, bone->mName.length, hash);
+        hash = HashArray(&bone->mOffsetMatrix, 1, hash);
+        hash = HashArray(bone->mWeights, bone->mNumWeights, hash);
+    }
+    return hash;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Constructor to be privately used by Importer
 FindInstancesProcess::FindInstancesProcess()
 :   configSpeedFlag (false)
+,   configThreads   (0)
 {}
 
 // ------------------------------------------------------------------------------------------------
@@ -76,6 +122,7 @@ void FindInstancesProcess::SetupProperties(const Importer* pImp)
 {
     // AI_CONFIG_FAVOUR_SPEED
     configSpeedFlag = (0 != pImp->GetPropertyInteger(AI_CONFIG_FAVOUR_SPEED,0));
+    configThreads = static_cast<unsigned int>(std::max(0,pImp->GetPropertyInteger(AI_CONFIG_PP_FI_THREADS,0)));
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -87,14 +134,15 @@ bool CompareBones(const aiMesh* orig, const aiMesh* inst)
         aiBone* oha = inst->mBones[i];
 
         if (aha->mNumWeights   != oha->mNumWeights   ||
-            aha->mOffsetMatrix != oha->mOffsetMatrix) {
+            aha->mOffsetMatrix != oha->mOffsetMatrix ||
+            aha->mName         != oha->mName) {
             return false;
         }
 
         // compare weight per weight ---
         for (unsigned int n = 0; n < aha->mNumWeights;++n) {
             if  (aha->mWeights[n].mVertexId != oha->mWeights[n].mVertexId ||
-                (aha->mWeights[n].mWeight - oha->mWeights[n].mWeight) < 10e-3f) {
+                std::fabs(aha->mWeights[n].mWeight - oha->mWeights[n].mWeight) >= 10e-3f) {
                 return false;
             }
         }
@@ -113,6 +161,89 @@ void UpdateMeshIndices(aiNode* node, unsigned int* lookup)
         UpdateMeshIndices(node->mChildren[n],lookup);
 }
 
+// ------------------------------------------------------------------------------------------------
+// Full comparison of two meshes with equal hashes
+bool FindInstancesProcess::CompareMeshes(const aiMesh* orig, const aiMesh* inst) const
+{
+    // check for hash collision .. we needn't check
+    // the vertex format, it *must* match due to the
+    // (brilliant) construction of the hash
+    if (orig->mNumBones       != inst->mNumBones      ||
+        orig->mNumFaces       != inst->mNumFaces      ||
+        orig->mNumVertices    != inst->mNumVertices   ||
+        orig->mMaterialIndex  != inst->mMaterialIndex ||
+        orig->mPrimitiveTypes != inst->mPrimitiveTypes)
+        return false;
+
+    // up to now the meshes are equal. find an appropriate
+    // epsilon to compare position differences against
+    float epsilon = ComputePositionEpsilon(inst);
+    epsilon *= epsilon;
+
+    // now compare vertex positions, normals,
+    // tangents and bitangents using this epsilon.
+    if (orig->HasPositions()) {
+        if(!CompareArrays(orig->mVertices,inst->mVertices,orig->mNumVertices,epsilon))
+            return false;
+    }
+    if (orig->HasNormals()) {
+        if(!CompareArrays(orig->mNormals,inst->mNormals,orig->mNumVertices,epsilon))
+            return false;
+    }
+    if (orig->HasTangentsAndBitangents()) {
+        if (!CompareArrays(orig->mTangents,inst->mTangents,orig->mNumVertices,epsilon) ||
+            !CompareArrays(orig->mBitangents,inst->mBitangents,orig->mNumVertices,epsilon))
+            return false;
+    }
+
+    // use a constant epsilon for colors and UV coordinates
+    static const float uvEpsilon = 10e-4f;
+    for (unsigned int i = 0, end = orig->GetNumUVChannels(); i < end; ++i) {
+        if (orig->mTextureCoords[i] &&
+            !CompareArrays(orig->mTextureCoords[i],inst->mTextureCoords[i],orig->mNumVertices,uvEpsilon)) {
+            return false;
+        }
+    }
+    for (unsigned int i = 0, end = orig->GetNumColorChannels(); i < end; ++i) {
+        if (orig->mColors[i] &&
+            !CompareArrays(orig->mColors[i],inst->mColors[i],orig->mNumVertices,uvEpsilon)) {
+            return false;
+        }
+    }
+
+    // These two checks are actually quite expensive and almost *never* required.
+    // Almost. That's why they're still here. But there's no reason to do them
+    // in speed-targeted imports.
+    if (!configSpeedFlag) {
+
+        // It seems to be strange, but we really need to check whether the
+        // bones are identical too. Although it's extremely unprobable
+        // that they're not if control reaches here, we need to deal
+        // with unprobable cases, too. It could still be that there are
+        // equal shapes which are deformed differently.
+        if (!CompareBones(orig,inst))
+            return false;
+
+        // For completeness ... compare even the index buffers for equality
+        // face order & winding order doesn't care. Input data is in verbose format.
+        std::unique_ptr<unsigned int[]> ftbl_orig(new unsigned int[orig->mNumVertices]);
+        std::unique_ptr<unsigned int[]> ftbl_inst(new unsigned int[orig->mNumVertices]);
+
+        for (unsigned int tt = 0; tt < orig->mNumFaces;++tt) {
+            aiFace& f = orig->mFaces[tt];
+            for (unsigned int nn = 0; nn < f.mNumIndices;++nn)
+                ftbl_orig[f.mIndices[nn]] = tt;
+
+            aiFace& f2 = inst->mFaces[tt];
+            for (unsigned int nn = 0; nn < f2.mNumIndices;++nn)
+                ftbl_inst[f2.mIndices[nn]] = tt;
+        }
+        if (0 != ::memcmp(ftbl_inst.get(),ftbl_orig.get(),orig->mNumVertices*sizeof(unsigned int)))
+            return false;
+    }
+    return true;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Executes the post processing step on the given imported data.
 void FindInstancesProcess::Execute( aiScene* pScene)
@@ -120,145 +251,128 @@ void FindInstancesProcess::Execute( aiScene* pScene)
     DefaultLogger::get()->debug("FindInstancesProcess begin");
     if (pScene->mNumMeshes) {
 
-        // use a pseudo hash for all meshes in the scene to quickly find
-        // the ones which are possibly equal. This step is executed early
-        // in the pipeline, so we could, depending on the file format,
-        // have several thousand small meshes. That's too much for a brute
-        // everyone-against-everyone check involving up to 10 comparisons
-        // each.
-        std::unique_ptr<uint64_t[]> hashes (new uint64_t[pScene->mNumMeshes]);
-        std::unique_ptr<unsigned int[]> remapping (new unsigned int[pScene->mNumMeshes]);
+        // hash all meshes in the scene to quickly find the ones which are
+        // possibly equal. This step is executed early in the pipeline, so
+        // we could, depending on the file format, have several thousand
+        // small meshes. That's too much for a brute everyone-against-everyone
+        // check, so only meshes with equal structural hashes are compared.
+        // The content hash is over the exact bits of the vertex data, it can
+        // not bucket meshes which are equal within the epsilons of
+        // CompareMeshes. It only decides which candidates are tried first.
+        const unsigned int numMeshes = pScene->mNumMeshes;
+        std::vector<uint64_t> hashes(numMeshes);
+        std::vector<uint32_t> contentHashes(numMeshes);
+        std::vector<unsigned int> original(numMeshes);
+
+        unsigned int numThreads = configThreads;
+        if (!numThreads) {
+            numThreads = numMeshes >= ParallelMinMeshes ? ThreadPool::GetHardwareThreadCount() : 1;
+        }
+        std::unique_ptr<ThreadPool> pool;
+        if (numThreads > 1) {
+            pool.reset(new ThreadPool(numThreads));
+        }
 
-        unsigned int numMeshesOut = 0;
-        for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
-
-            aiMesh* inst = pScene->mMeshes[i];
-            hashes[i] = GetMeshHash(inst);
-
-            for (int a = i-1; a >= 0; --a) {
-                if (hashes[i] == hashes[a])
-                {
-                    aiMesh* orig = pScene->mMeshes[a];
-                    if (!orig)
-                        continue;
-
-                    // check for hash collision .. we needn't check
-                    // the vertex format, it *must* match due to the
-                    // (brilliant) construction of the hash
-                    if (orig->mNumBones       != inst->mNumBones      ||
-                        orig->mNumFaces       != inst->mNumFaces      ||
-                        orig->mNumVertices    != inst->mNumVertices   ||
-                        orig->mMaterialIndex  != inst->mMaterialIndex ||
-                        orig->mPrimitiveTypes != inst->mPrimitiveTypes)
-                        continue;
-
-                    // up to now the meshes are equal. find an appropriate
-                    // epsilon to compare position differences against
-                    float epsilon = ComputePositionEpsilon(inst);
-                    epsilon *= epsilon;
-
-                    // now compare vertex positions, normals,
-                    // tangents and bitangents using this epsilon.
-                    if (orig->HasPositions()) {
-                        if(!CompareArrays(orig->mVertices,inst->mVertices,orig->mNumVertices,epsilon))
-                            continue;
-                    }
-                    if (orig->HasNormals()) {
-                        if(!CompareArrays(orig->mNormals,inst->mNormals,orig->mNumVertices,epsilon))
-                            continue;
-                    }
-                    if (orig->HasTangentsAndBitangents()) {
-                        if (!CompareArrays(orig->mTangents,inst->mTangents,orig->mNumVertices,epsilon) ||
-                            !CompareArrays(orig->mBitangents,inst->mBitangents,orig->mNumVertices,epsilon))
-                            continue;
-                    }
+        // hashing touches all vertex data, split it into chunks of meshes
+        const auto hashMeshes = [&hashes, &contentHashes, pScene](unsigned int begin, unsigned int end) {
+            for (unsigned int i = begin; i < end; ++i) {
+                aiMesh* mesh = pScene->mMeshes[i];
+                hashes[i] = GetMeshHash(mesh);
+                contentHashes[i] = GetMeshContentHash(mesh);
+            }
+        };
+        if (pool) {
+            const unsigned int chunk = std::max(1u, numMeshes / (numThreads * 4));
+            for (unsigned int i = 0; i < numMeshes; i += chunk) {
+                const unsigned int end = std::min(numMeshes, i + chunk);
+                pool->Enqueue([hashMeshes, i, end]() {
+                    hashMeshes(i, end);
+                });
+            }
+            pool->WaitIdle();
+        }
+        else {
+            hashMeshes(0, numMeshes);
+        }
 
-                    // use a constant epsilon for colors and UV coordinates
-                    static const float uvEpsilon = 10e-4f;
-                    {
-                        unsigned int i, end = orig->GetNumUVChannels();
-                        for(i = 0; i < end; ++i) {
-                            if (!orig->mTextureCoords[i]) {
-                                continue;
-                            }
-                            if(!CompareArrays(orig->mTextureCoords[i],inst->mTextureCoords[i],orig->mNumVertices,uvEpsilon)) {
-                                break;
-                            }
-                        }
-                        if (i != end) {
-                            continue;
-                        }
-                    }
-                    {
-                        unsigned int i, end = orig->GetNumColorChannels();
-                        for(i = 0; i < end; ++i) {
-                            if (!orig->mColors[i]) {
-                                continue;
-                            }
-                            if(!CompareArrays(orig->mColors[i],inst->mColors[i],orig->mNumVertices,uvEpsilon)) {
-                                break;
-                            }
-                        }
-                        if (i != end) {
-                            continue;
-                        }
-                    }
+        // bucket the meshes by hash, each bucket lists its meshes in ascending order
+        std::unordered_map<uint64_t, std::vector<unsigned int> > buckets;
+        buckets.reserve(numMeshes);
+        for (unsigned int i = 0; i < numMeshes; ++i) {
+            buckets[hashes[i]].push_back(i);
+            original[i] = i;
+        }
 
-                    // These two checks are actually quite expensive and almost *never* required.
-                    // Almost. That's why they're still here. But there's no reason to do them
-                    // in speed-targeted imports.
-                    if (!configSpeedFlag) {
-
-                        // It seems to be strange, but we really need to check whether the
-                        // bones are identical too. Although it's extremely unprobable
-                        // that they're not if control reaches here, we need to deal
-                        // with unprobable cases, too. It could still be that there are
-                        // equal shapes which are deformed differently.
-                        if (!CompareBones(orig,inst))
-                            continue;
-
-                        // For completeness ... compare even the index buffers for equality
-                        // face order & winding order doesn't care. Input data is in verbose format.
-                        std::unique_ptr<unsigned int[]> ftbl_orig(new unsigned int[orig->mNumVertices]);
-                        std::unique_ptr<unsigned int[]> ftbl_inst(new unsigned int[orig->mNumVertices]);
-
-                        for (unsigned int tt = 0; tt < orig->mNumFaces;++tt) {
-                            aiFace& f = orig->mFaces[tt];
-                            for (unsigned int nn = 0; nn < f.mNumIndices;++nn)
-                                ftbl_orig[f.mIndices[nn]] = tt;
-
-                            aiFace& f2 = inst->mFaces[tt];
-                            for (unsigned int nn = 0; nn < f2.mNumIndices;++nn)
-                                ftbl_inst[f2.mIndices[nn]] = tt;
+        // within a bucket, every mesh is compared to the meshes of the bucket
+        // which have not been found to be instances. Buckets are independent.
+        std::vector<const std::vector<unsigned int>*> work;
+        for (const auto& bucket : buckets) {
+            if (bucket.second.size() > 1) {
+                work.push_back(&bucket.second);
+            }
+        }
+        std::string error;
+        const auto compareBucket = [this, &original, &contentHashes, pScene](const std::vector<unsigned int>& bucket) {
+            std::vector<unsigned int> originals;
+            for (unsigned int i : bucket) {
+                // bitwise copies are the common case, so try the originals
+                // with the same content first and the others afterwards
+                for (int pass = 0; pass < 2 && original[i] == i; ++pass) {
+                    for (unsigned int a : originals) {
+                        if ((contentHashes[a] == contentHashes[i]) == (pass == 0) &&
+                            CompareMeshes(pScene->mMeshes[a], pScene->mMeshes[i])) {
+                            original[i] = a;
+                            break;
                         }
-                        if (0 != ::memcmp(ftbl_inst.get(),ftbl_orig.get(),orig->mNumVertices*sizeof(unsigned int)))
-                            continue;
                     }
-
-                    // We're still here. Or in other words: 'inst' is an instance of 'orig'.
-                    // Place a marker in our list that we can easily update mesh indices.
-                    remapping[i] = remapping[a];
-
-                    // Delete the instanced mesh, we don't need it anymore
-                    delete inst;
-                    pScene->mMeshes[i] = NULL;
-                    break;
+                }
+                if (original[i] == i) {
+                    originals.push_back(i);
                 }
             }
-
-            // If we didn't find a match for the current mesh: keep it
-            if (pScene->mMeshes[i]) {
-                remapping[i] = numMeshesOut++;
+        };
+        if (pool) {
+            std::mutex errorMutex;
+            for (const std::vector<unsigned int>* bucket : work) {
+                pool->Enqueue([compareBucket, bucket, &error, &errorMutex]() {
+                    try {
+                        compareBucket(*bucket);
+                    }
+                    catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        error = e.what();
+                    }
+                });
             }
+            pool->WaitIdle();
+        }
+        else {
+            for (const std::vector<unsigned int>* bucket : work) {
+                compareBucket(*bucket);
+            }
+        }
+        if (!error.empty()) {
+            throw DeadlyImportError("FindInstancesProcess: " + error);
         }
-        ai_assert(0 != numMeshesOut);
-        if (numMeshesOut != pScene->mNumMeshes) {
 
-            // Collapse the meshes array by removing all NULL entries
-            for (unsigned int real = 0, i = 0; real < numMeshesOut; ++i) {
-                if (pScene->mMeshes[i])
-                    pScene->mMeshes[real++] = pScene->mMeshes[i];
+        // 'original' always points to a smaller index, so a single pass
+        // is sufficient to build the lookup table for the node graph.
+        std::unique_ptr<unsigned int[]> remapping (new unsigned int[numMeshes]);
+        unsigned int numMeshesOut = 0;
+        for (unsigned int i = 0; i < numMeshes; ++i) {
+            if (original[i] == i) {
+                remapping[i] = numMeshesOut;
+                pScene->mMeshes[numMeshesOut++] = pScene->mMeshes[i];
+            }
+            else {
+                // 'inst' is an instance of 'orig', we don't need it anymore
+                remapping[i] = remapping[original[i]];
+                delete pScene->mMeshes[i];
+                pScene->mMeshes[i] = NULL;
             }
+        }
+        ai_assert(0 != numMeshesOut);
+        if (numMeshesOut != numMeshes) {
 
             // And update the node graph with our nice lookup table
             UpdateMeshIndices(pScene->mRootNode,remapping.get());
@@ -267,7 +381,7 @@ void FindInstancesProcess::Execute( aiScene* pScene)
             if (!DefaultLogger::isNullLogger()) {
 
                 char buffer[512];
-                ::ai_snprintf(buffer,512,"FindInstancesProcess finished. Found %i instances",pScene->mNumMeshes-numMeshesOut);
+                ::ai_snprintf(buffer,512,"FindInstancesProcess finished. Found %i instances",numMeshes-numMeshesOut);
                 DefaultLogger::get()->info(buffer);
             }
             pScene->mNumMeshes = numMeshesOut;
@@ -275,3 +389,55 @@ void FindInstancesProcess::Execute( aiScene* pScene)
         else DefaultLogger::get()->debug("FindInstancesProcess finished. No instanced meshes found");
     }
 }
+
+// ------------------------------------------------------------------------------------------------
+unsigned int aiGetNumMeshInstances(const aiScene* pScene)
+{
+    ai_assert(NULL != pScene);
+
+    unsigned int num = 0;
+    std::vector<const aiNode*> stack(1, pScene->mRootNode);
+    while (!stack.empty()) {
+        const aiNode* node = stack.back();
+        stack.pop_back();
+        if (!node) {
+            continue;
+        }
+        num += node->mNumMeshes;
+        stack.insert(stack.end(), node->mChildren, node->mChildren + node->mNumChildren);
+    }
+    return num;
+}
+
+// ------------------------------------------------------------------------------------------------
+static void CollectMeshInstances(const aiNode* node, const aiMatrix4x4& parent, std::vector<aiMeshInstance>& out)
+{
+    const aiMatrix4x4 transformation = parent * node->mTransformation;
+    for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+        aiMeshInstance instance;
+        instance.mMesh = node->mMeshes[i];
+        instance.mNode = node;
+        instance.mTransformation = transformation;
+        out.push_back(instance);
+    }
+    for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+        CollectMeshInstances(node->mChildren[i], transformation, out);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void aiGetMeshInstances(const aiScene* pScene, aiMeshInstance* pOut)
+{
+    ai_assert(NULL != pScene);
+    ai_assert(NULL != pOut);
+
+    if (!pScene->mRootNode) {
+        return;
+    }
+    std::vector<aiMeshInstance> instances;
+    CollectMeshInstances(pScene->mRootNode, aiMatrix4x4(), instances);
+    std::stable_sort(instances.begin(), instances.end(), [](const aiMeshInstance& a, const aiMeshInstance& b) {
+        return a.mMesh < b.mMesh;
+    });
+    std::copy(instances.begin(), instances.end(), pOut);
+}
@@ -102,10 +102,27 @@ inline bool CompareArrays(const aiColor4D* first, const aiColor4D* second,
     return true;
 }
 
+// -------------------------------------------------------------------------------
+/** @brief Get a hash of the vertex data of a mesh.
+ *
+ *  Covers positions, normals, texture coordinates and bones (names, offset
+ *  matrices and weights). Meshes which are equal within the epsilons used
+ *  by #FindInstancesProcess but not bitwise equal get different hashes,
+ *  so the hash must not be used to rule out instances.
+ *  @param in Input mesh
+ *  @return Hash.
+ */
+ASSIMP_API uint32_t GetMeshContentHash(const aiMesh* in);
+
 // ---------------------------------------------------------------------------
 /** @brief A post-processing steps to search for instanced meshes
+ *
+ *  Meshes are bucketed by #GetMeshHash, only meshes within a bucket are
+ *  compared with each other. Inside a bucket, candidates with an equal
+ *  #GetMeshContentHash are tried first. Buckets are independent and
+ *  compared in parallel.
 */
-class FindInstancesProcess : public BaseProcess
+class ASSIMP_API FindInstancesProcess : public BaseProcess
 {
 public:
 
@@ -127,7 +144,12 @@ public:
 
 private:
 
+    // -------------------------------------------------------------------
+    // Full comparison of two meshes with equal hashes
+    bool CompareMeshes(const aiMesh* orig, const aiMesh* inst) const;
+
     bool configSpeedFlag;
+    unsigned int configThreads;
 
 }; // ! end class FindInstancesProcess
 }  // ! end namespace Assimp
@@ -0,0 +1,738 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file Implementation of the post processing step to generate simplified
+ *  levels of detail.
+ */
+
+#include "GenLODsProcess.h"
+#include "ThreadPool.h"
+#include "Exceptional.h"
+#include "StringUtils.h"
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits.h>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+
+using namespace Assimp;
+
+namespace {
+
+// scenes with less faces in total are processed on the calling thread
+const unsigned int ParallelMinFaces = 1u << 16;
+
+// meshes with less faces are not simplified
+const unsigned int MinFaces = 8;
+
+// ------------------------------------------------------------------------------------------------
+// Symmetric 4x4 matrix measuring the squared distance to a set of planes
+struct Quadric
+{
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+    Quadric()
+        : a2(), ab(), ac(), ad(), b2(), bc(), bd(), c2(), cd(), d2()
+    {}
+
+    Quadric(double a, double b, double c, double d, double w)
+        : a2(w*a*a), ab(w*a*b), ac(w*a*c), ad(w*a*d)
+        , b2(w*b*b), bc(w*b*c), bd(w*b*d)
+        , c2(w*c*c), cd(w*c*d)
+        , d2(w*d*d)
+    {}
+
+    Quadric& operator += (const Quadric& o) {
+        a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+        b2 += o.b2; bc += o.bc; bd += o.bd;
+        c2 += o.c2; cd += o.cd;
+        d2 += o.d2;
+        return *this;
+    }
+
+    double Evaluate(const aiVector3D& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        return a2*x*x + 2*ab*x*y + 2*ac*x*z + 2*ad*x
+            + b2*y*y + 2*bc*y*z + 2*bd*y
+            + c2*z*z + 2*cd*z
+            + d2;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// A candidate collapse of vertex 'from' onto vertex 'to'
+struct Collapse
+{
+    float cost;
+    unsigned int from, to, version;
+
+    // std::priority_queue is a max-heap
+    bool operator < (const Collapse& o) const {
+        return cost > o.cost;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Greedy half-edge collapse simplification of a triangle mesh. The state is
+// kept between calls to Simplify(), so a chain of LODs is built incrementally.
+class Simplifier
+{
+public:
+    explicit Simplifier(const aiMesh* mesh);
+
+    // Collapse edges until at most 'target' faces are left or no valid
+    // collapse remains. Returns the number of faces left.
+    unsigned int Simplify(unsigned int target);
+
+    // Build a mesh from the current state
+    aiMesh* Extract(unsigned int level) const;
+
+private:
+    void Classify();
+    void Push(unsigned int from, unsigned int to);
+    bool IsValid(const Collapse& c);
+    void Apply(unsigned int from, unsigned int to);
+
+    const aiMesh* mMesh;
+    std::vector<unsigned int> mIndices;
+    std::vector<bool> mDeadFaces;
+    unsigned int mNumFaces;
+
+    std::vector<std::vector<unsigned int> > mVertexFaces;
+    std::vector<Quadric> mQuadrics;
+    std::vector<unsigned int> mVersions;
+    std::vector<bool> mLocked, mDeadVertices;
+    std::vector<int> mDominantBone;
+    std::priority_queue<Collapse> mQueue;
+
+    // scratch space
+    std::vector<unsigned int> mRing, mRingTo;
+};
+
+// ------------------------------------------------------------------------------------------------
+Simplifier::Simplifier(const aiMesh* mesh)
+    : mMesh(mesh)
+    , mIndices(mesh->mNumFaces * 3)
+    , mDeadFaces(mesh->mNumFaces, false)
+    , mNumFaces(mesh->mNumFaces)
+    , mVertexFaces(mesh->mNumVertices)
+    , mQuadrics(mesh->mNumVertices)
+    , mVersions(mesh->mNumVertices, 0)
+    , mLocked(mesh->mNumVertices, false)
+    , mDeadVertices(mesh->mNumVertices, false)
+    , mDominantBone(mesh->mNumVertices, -1)
+{
+    const aiVector3D* const vertices = mesh->mVertices;
+    for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+        unsigned int* tri = &mIndices[i * 3];
+        std::copy(mesh->mFaces[i].mIndices, mesh->mFaces[i].mIndices + 3, tri);
+        for (unsigned int c = 0; c < 3; ++c) {
+            mVertexFaces[tri[c]].push_back(i);
+        }
+
+        // plane quadric of the face, weighted by its area
+        aiVector3D n = (vertices[tri[1]] - vertices[tri[0]]) ^ (vertices[tri[2]] - vertices[tri[0]]);
+        const float length = n.Length();
+        if (length > 0.f) {
+            n /= length;
+            const Quadric q(n.x, n.y, n.z, -(n * vertices[tri[0]]), length * 0.5);
+            for (unsigned int c = 0; c < 3; ++c) {
+                mQuadrics[tri[c]] += q;
+            }
+        }
+    }
+
+    // the dominant bone of each vertex, vertices are only collapsed
+    // onto vertices which follow the same bone
+    std::vector<float> weights(mesh->mNumVertices, 0.f);
+    for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+        const aiBone* bone = mesh->mBones[b];
+        for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+            const aiVertexWeight& weight = bone->mWeights[w];
+            if (weight.mVertexId < mesh->mNumVertices && weight.mWeight > weights[weight.mVertexId]) {
+                weights[weight.mVertexId] = weight.mWeight;
+                mDominantBone[weight.mVertexId] = static_cast<int>(b);
+            }
+        }
+    }
+
+    Classify();
+
+    for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+        const unsigned int* tri = &mIndices[i * 3];
+        for (unsigned int c = 0; c < 3; ++c) {
+            Push(tri[c], tri[(c + 1) % 3]);
+            Push(tri[(c + 1) % 3], tri[c]);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Lock vertices sharing their position with other vertices (attribute seams)
+// and vertices on open borders.
+void Simplifier::Classify()
+{
+    const aiVector3D* const vertices = mMesh->mVertices;
+    const unsigned int numVertices = mMesh->mNumVertices;
+
+    // group vertices by position, 'group' maps each vertex to the first one
+    std::vector<unsigned int> order(numVertices), group(numVertices);
+    for (unsigned int i = 0; i < numVertices; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [vertices](unsigned int a, unsigned int b) {
+        return vertices[a] < vertices[b] || (vertices[a] == vertices[b] && a < b);
+    });
+    for (unsigned int i = 0; i < numVertices; ) {
+        unsigned int end = i + 1;
+        while (end < numVertices && vertices[order[end]] == vertices[order[i]]) {
+            ++end;
+        }
+        for (unsigned int k = i; k < end; ++k) {
+            group[order[k]] = order[i];
+            mLocked[order[k]] = end - i > 1;
+        }
+        i = end;
+    }
+
+    // edges used by a single face in position space are borders
+    std::unordered_map<uint64_t, unsigned int> edges;
+    edges.reserve(mMesh->mNumFaces * 3);
+    const auto edgeKey = [&group](unsigned int a, unsigned int b) -> uint64_t {
+        const unsigned int ga = group[a], gb = group[b];
+        return ((uint64_t)std::min(ga, gb) << 32u) | std::max(ga, gb);
+    };
+    for (unsigned int i = 0; i < mMesh->mNumFaces * 3; ++i) {
+        ++edges[edgeKey(mIndices[i], mIndices[i - i % 3 + (i + 1) % 3])];
+    }
+    for (unsigned int i = 0; i < mMesh->mNumFaces * 3; ++i) {
+        const unsigned int a = mIndices[i], b = mIndices[i - i % 3 + (i + 1) % 3];
+        if (edges[edgeKey(a, b)] == 1) {
+            mLocked[a] = mLocked[b] = true;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void Simplifier::Push(unsigned int from, unsigned int to)
+{
+    if (from == to || mLocked[from] || mDominantBone[from] != mDominantBone[to]) {
+        return;
+    }
+    Collapse c;
+    c.cost = static_cast<float>(mQuadrics[from].Evaluate(mMesh->mVertices[to]));
+    c.from = from;
+    c.to = to;
+    c.version = mVersions[from];
+    mQueue.push(c);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Simplifier::IsValid(const Collapse& c)
+{
+    if (mDeadVertices[c.from] || mDeadVertices[c.to] || c.version != mVersions[c.from]) {
+        return false;
+    }
+
+    // collect the one-rings of both vertices and check they're still connected
+    const aiVector3D* const vertices = mMesh->mVertices;
+    mRing.clear();
+    mRingTo.clear();
+    unsigned int shared = 0;
+    for (unsigned int f : mVertexFaces[c.from]) {
+        if (mDeadFaces[f]) {
+            continue;
+        }
+        const unsigned int* tri = &mIndices[f * 3];
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+            ++shared;
+            continue;
+        }
+
+        // the face must neither flip nor degenerate when 'from' moves onto 'to',
+        // a normal turning by more than ~75 degrees is treated alike
+        aiVector3D p[3];
+        for (unsigned int k = 0; k < 3; ++k) {
+            p[k] = vertices[tri[k]];
+            mRing.push_back(tri[k]);
+        }
+        const aiVector3D before = (p[1] - p[0]) ^ (p[2] - p[0]);
+        for (unsigned int k = 0; k < 3; ++k) {
+            if (tri[k] == c.from) {
+                p[k] = vertices[c.to];
+            }
+        }
+        const aiVector3D after = (p[1] - p[0]) ^ (p[2] - p[0]);
+        if (before * after <= 0.25f * before.Length() * after.Length()) {
+            return false;
+        }
+    }
+    if (!shared) {
+        return false;
+    }
+    for (unsigned int f : mVertexFaces[c.to]) {
+        if (!mDeadFaces[f]) {
+            mRingTo.insert(mRingTo.end(), &mIndices[f * 3], &mIndices[f * 3] + 3);
+        }
+    }
+
+    // link condition: the rings may only share the opposite vertices of the
+    // faces adjacent to the edge, otherwise the result is non-manifold
+    std::sort(mRing.begin(), mRing.end());
+    mRing.erase(std::unique(mRing.begin(), mRing.end()), mRing.end());
+    std::sort(mRingTo.begin(), mRingTo.end());
+    mRingTo.erase(std::unique(mRingTo.begin(), mRingTo.end()), mRingTo.end());
+    unsigned int common = 0;
+    for (std::vector<unsigned int>::const_iterator a = mRing.begin(), b = mRingTo.begin(); a != mRing.end() && b != mRingTo.end(); ) {
+        if (*a < *b) {
+            ++a;
+        }
+        else if (*b < *a) {
+            ++b;
+        }
+        else {
+            if (*a != c.from && *a != c.to) {
+                ++common;
+            }
+            ++a;
+            ++b;
+        }
+    }
+    return common <= shared;
+}
+
+// ------------------------------------------------------------------------------------------------
+void Simplifier::Apply(unsigned int from, unsigned int to)
+{
+    std::vector<unsigned int> neighbours;
+    for (unsigned int f : mVertexFaces[from]) {
+        if (mDeadFaces[f]) {
+            continue;
+        }
+        unsigned int* tri = &mIndices[f * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            mDeadFaces[f] = true;
+            --mNumFaces;
+            continue;
+        }
+        for (unsigned int k = 0; k < 3; ++k) {
+            if (tri[k] == from) {
+                tri[k] = to;
+            }
+            else {
+                neighbours.push_back(tri[k]);
+            }
+        }
+        mVertexFaces[to].push_back(f);
+    }
+    mVertexFaces[from].clear();
+    mDeadVertices[from] = true;
+    mQuadrics[to] += mQuadrics[from];
+    ++mVersions[to];
+
+    // drop references to dead faces now and then
+    std::vector<unsigned int>& faces = mVertexFaces[to];
+    faces.erase(std::remove_if(faces.begin(), faces.end(), [this](unsigned int f) {
+        return mDeadFaces[f];
+    }), faces.end());
+
+    // new candidates for the merged vertex and its new neighbours
+    for (unsigned int f : faces) {
+        const unsigned int* tri = &mIndices[f * 3];
+        for (unsigned int k = 0; k < 3; ++k) {
+            Push(to, tri[k]);
+        }
+    }
+    for (unsigned int n : neighbours) {
+        Push(n, to);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int Simplifier::Simplify(unsigned int target)
+{
+    while (mNumFaces > target && !mQueue.empty()) {
+        const Collapse c = mQueue.top();
+        mQueue.pop();
+        if (IsValid(c)) {
+            Apply(c.from, c.to);
+        }
+    }
+    return mNumFaces;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Copy the entries of a per-vertex array which survived the simplification
+template <typename T>
+T* CopyVertexArray(const T* in, const std::vector<unsigned int>& remap, unsigned int numVertices)
+{
+    if (!in) {
+        return NULL;
+    }
+    T* out = new T[numVertices];
+    for (unsigned int i = 0; i < remap.size(); ++i) {
+        if (remap[i] != UINT_MAX) {
+            out[remap[i]] = in[i];
+        }
+    }
+    return out;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiMesh* Simplifier::Extract(unsigned int level) const
+{
+    const aiMesh* src = mMesh;
+
+    // keep the relative order of the remaining vertices
+    std::vector<unsigned int> remap(src->mNumVertices, UINT_MAX);
+    for (unsigned int i = 0; i < src->mNumFaces; ++i) {
+        if (!mDeadFaces[i]) {
+            for (unsigned int k = 0; k < 3; ++k) {
+                remap[mIndices[i * 3 + k]] = 0;
+            }
+        }
+    }
+    unsigned int numVertices = 0;
+    for (unsigned int i = 0; i < src->mNumVertices; ++i) {
+        if (remap[i] != UINT_MAX) {
+            remap[i] = numVertices++;
+        }
+    }
+
+    aiMesh* dest = new aiMesh();
+    dest->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    dest->mMaterialIndex = src->mMaterialIndex;
+    dest->mName = src->mName;
+    char suffix[32];
+    ai_snprintf(suffix, 32, "_LOD%u", level);
+    dest->mName.Append(suffix);
+
+    dest->mNumFaces = mNumFaces;
+    dest->mFaces = new aiFace[mNumFaces];
+    for (unsigned int i = 0, out = 0; i < src->mNumFaces; ++i) {
+        if (mDeadFaces[i]) {
+            continue;
+        }
+        aiFace& face = dest->mFaces[out++];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        for (unsigned int k = 0; k < 3; ++k) {
+            face.mIndices[k] = remap[mIndices[i * 3 + k]];
+        }
+    }
+
+    dest->mNumVertices = numVertices;
+    dest->mVertices = CopyVertexArray(src->mVertices, remap, numVertices);
+    dest->mNormals = CopyVertexArray(src->mNormals, remap, numVertices);
+    dest->mTangents = CopyVertexArray(src->mTangents, remap, numVertices);
+    dest->mBitangents = CopyVertexArray(src->mBitangents, remap, numVertices);
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+        dest->mColors[c] = CopyVertexArray(src->mColors[c], remap, numVertices);
+    }
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+        dest->mTextureCoords[c] = CopyVertexArray(src->mTextureCoords[c], remap, numVertices);
+        dest->mNumUVComponents[c] = src->mNumUVComponents[c];
+    }
+
+    // bones which lost all their weights are dropped
+    std::vector<aiBone*> bones;
+    for (unsigned int b = 0; b < src->mNumBones; ++b) {
+        const aiBone* bone = src->mBones[b];
+        std::vector<aiVertexWeight> weights;
+        for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+            const aiVertexWeight& weight = bone->mWeights[w];
+            if (weight.mVertexId < src->mNumVertices && remap[weight.mVertexId] != UINT_MAX) {
+                weights.push_back(aiVertexWeight(remap[weight.mVertexId], weight.mWeight));
+            }
+        }
+        if (weights.empty()) {
+            continue;
+        }
+        aiBone* out = new aiBone();
+        out->mName = bone->mName;
+        out->mOffsetMatrix = bone->mOffsetMatrix;
+        out->mNumWeights = static_cast<unsigned int>(weights.size());
+        out->mWeights = new aiVertexWeight[weights.size()];
+        std::copy(weights.begin(), weights.end(), out->mWeights);
+        bones.push_back(out);
+    }
+    if (!bones.empty()) {
+        dest->mNumBones = static_cast<unsigned int>(bones.size());
+        dest->mBones = new aiBone*[bones.size()];
+        std::copy(bones.begin(), bones.end(), dest->mBones);
+    }
+    return dest;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Parse a list of face ratios, invalid values are dropped
+std::vector<float> ParseRatios(const std::string& in)
+{
+    std::vector<float> ratios;
+    std::istringstream stream(in);
+    float ratio;
+    while (stream >> ratio) {
+        if (ratio > 0.f && ratio < 1.f) {
+            ratios.push_back(ratio);
+        }
+    }
+
+    // in order of decreasing detail
+    std::sort(ratios.begin(), ratios.end(), std::greater<float>());
+    ratios.erase(std::unique(ratios.begin(), ratios.end()), ratios.end());
+    return ratios;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Append entries to the metadata of a node
+void AppendMetadata(aiNode* node, const std::vector<std::pair<std::string, int32_t> >& entries)
+{
+    aiMetadata* old = node->mMetaData;
+    const unsigned int numOld = old ? old->mNumProperties : 0;
+
+    aiMetadata* data = new aiMetadata();
+    data->mNumProperties = numOld + static_cast<unsigned int>(entries.size());
+    data->mKeys = new aiString[data->mNumProperties];
+    data->mValues = new aiMetadataEntry[data->mNumProperties];
+    for (unsigned int i = 0; i < numOld; ++i) {
+        data->mKeys[i] = old->mKeys[i];
+        data->mValues[i] = old->mValues[i];
+    }
+    for (unsigned int i = 0; i < entries.size(); ++i) {
+        data->Set(numOld + i, entries[i].first, entries[i].second);
+    }
+
+    // the values have been moved, don't free them twice
+    if (old) {
+        delete[] old->mValues;
+        old->mValues = NULL;
+        old->mNumProperties = 0;
+        delete old;
+    }
+    node->mMetaData = data;
+}
+
+} // Namespace
+
+// ------------------------------------------------------------------------------------------------
+// Constructor to be privately used by Importer
+GenLODsProcess::GenLODsProcess()
+    : configRatios(ParseRatios(AI_LOD_DEFAULT_RATIOS))
+    , configThreads(0)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+// Destructor, private as well
+GenLODsProcess::~GenLODsProcess()
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+// Returns whether the processing step is present in the given flag field.
+bool GenLODsProcess::IsActive( unsigned int pFlags) const
+{
+    return (pFlags & aiProcess_GenLODs) != 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Setup configuration properties
+void GenLODsProcess::SetupProperties(const Importer* pImp)
+{
+    configRatios = ParseRatios(pImp->GetPropertyString(AI_CONFIG_PP_LOD_RATIOS,AI_LOD_DEFAULT_RATIOS));
+    configThreads = static_cast<unsigned int>(std::max(0,pImp->GetPropertyInteger(AI_CONFIG_PP_LOD_THREADS,0)));
+}
+
+// ------------------------------------------------------------------------------------------------
+void GenLODsProcess::SetRatios(const std::vector<float>& ratios)
+{
+    std::ostringstream stream;
+    for (std::vector<float>::const_iterator it = ratios.begin(); it != ratios.end(); ++it) {
+        stream << *it << ' ';
+    }
+    configRatios = ParseRatios(stream.str());
+}
+
+// ------------------------------------------------------------------------------------------------
+// Builds the LOD chain of a single mesh
+void GenLODsProcess::GenMeshLODs( const aiMesh* pMesh, std::vector<aiMesh*>& pOut) const
+{
+    ai_assert(NULL != pMesh);
+
+    if (pMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE || !pMesh->HasPositions() ||
+        pMesh->mNumFaces < MinFaces || configRatios.empty()) {
+        return;
+    }
+
+    // every level continues from the previous one
+    Simplifier simplifier(pMesh);
+    unsigned int numFaces = pMesh->mNumFaces;
+    for (std::vector<float>::const_iterator it = configRatios.begin(); it != configRatios.end(); ++it) {
+        const unsigned int target = std::max(1u, static_cast<unsigned int>(pMesh->mNumFaces * *it));
+        const unsigned int reached = simplifier.Simplify(target);
+        if (reached == numFaces) {
+            // no valid collapses left
+            break;
+        }
+        numFaces = reached;
+        pOut.push_back(simplifier.Extract(static_cast<unsigned int>(pOut.size()) + 1));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Adds the metadata linking the meshes of a node to their LODs
+void GenLODsProcess::LinkLODs( aiNode* pNode, const std::vector<std::vector<unsigned int> >& lods) const
+{
+    std::vector<std::pair<std::string, int32_t> > entries;
+    for (unsigned int i = 0; i < pNode->mNumMeshes; ++i) {
+        const std::vector<unsigned int>& levels = lods[pNode->mMeshes[i]];
+        for (unsigned int k = 0; k < levels.size(); ++k) {
+            char key[64];
+            ai_snprintf(key, 64, AI_METADATA_LOD_KEY, i, k + 1);
+            entries.push_back(std::make_pair(std::string(key), static_cast<int32_t>(levels[k])));
+        }
+    }
+    if (!entries.empty()) {
+        AppendMetadata(pNode, entries);
+    }
+
+    for (unsigned int i = 0; i < pNode->mNumChildren; ++i) {
+        LinkLODs(pNode->mChildren[i], lods);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Executes the post processing step on the given imported data.
+void GenLODsProcess::Execute( aiScene* pScene)
+{
+    DefaultLogger::get()->debug("GenLODsProcess begin");
+
+    // meshes are independent of each other, simplify them in parallel
+    // if there is enough work.
+    const unsigned int numMeshes = pScene->mNumMeshes;
+    std::vector<std::vector<aiMesh*> > results(numMeshes);
+    std::vector<std::string> errors(numMeshes);
+    unsigned int numThreads = configThreads;
+    if (!numThreads) {
+        unsigned int numFaces = 0;
+        for (unsigned int a = 0; a < numMeshes; ++a) {
+            numFaces += pScene->mMeshes[a]->mNumFaces;
+        }
+        numThreads = numFaces >= ParallelMinFaces ? ThreadPool::GetHardwareThreadCount() : 1;
+    }
+    numThreads = std::min(numThreads, numMeshes);
+
+    if (numThreads > 1) {
+        ThreadPool pool(numThreads);
+        for (unsigned int a = 0; a < numMeshes; ++a) {
+            const aiMesh* mesh = pScene->mMeshes[a];
+            std::vector<aiMesh*>* result = &results[a];
+            std::string* error = &errors[a];
+            pool.Enqueue([this, mesh, result, error]() {
+                try {
+                    GenMeshLODs(mesh, *result);
+                }
+                catch (const std::exception& e) {
+                    *error = e.what();
+                }
+            });
+        }
+    }
+    else {
+        for (unsigned int a = 0; a < numMeshes; ++a) {
+            GenMeshLODs(pScene->mMeshes[a], results[a]);
+        }
+    }
+
+    for (unsigned int a = 0; a < numMeshes; ++a) {
+        if (!errors[a].empty()) {
+            for (unsigned int b = 0; b < numMeshes; ++b) {
+                for (aiMesh* mesh : results[b]) {
+                    delete mesh;
+                }
+            }
+            throw DeadlyImportError("GenLODsProcess: " + errors[a]);
+        }
+    }
+
+    // append the LODs behind the original meshes
+    std::vector<std::vector<unsigned int> > lods(numMeshes);
+    std::vector<aiMesh*> meshes(pScene->mMeshes, pScene->mMeshes + numMeshes);
+    for (unsigned int a = 0; a < numMeshes; ++a) {
+        for (aiMesh* mesh : results[a]) {
+            lods[a].push_back(static_cast<unsigned int>(meshes.size()));
+            meshes.push_back(mesh);
+
+            if (!DefaultLogger::isNullLogger()) {
+                char szBuff[128]; // should be sufficiently large in every case
+                ai_snprintf(szBuff,128,"Mesh %u: LOD %u has %u of %u faces",a,
+                    static_cast<unsigned int>(lods[a].size()),mesh->mNumFaces,pScene->mMeshes[a]->mNumFaces);
+                DefaultLogger::get()->debug(szBuff);
+            }
+        }
+    }
+    if (meshes.size() == numMeshes) {
+        DefaultLogger::get()->debug("GenLODsProcess finished. No mesh could be simplified");
+        return;
+    }
+
+    delete[] pScene->mMeshes;
+    pScene->mNumMeshes = static_cast<unsigned int>(meshes.size());
+    pScene->mMeshes = new aiMesh*[meshes.size()];
+    std::copy(meshes.begin(), meshes.end(), pScene->mMeshes);
+
+    if (pScene->mRootNode) {
+        LinkLODs(pScene->mRootNode, lods);
+    }
+
+    if (!DefaultLogger::isNullLogger()) {
+        char szBuff[128]; // should be sufficiently large in every case
+        ai_snprintf(szBuff,128,"GenLODsProcess finished. Added %u LOD meshes",
+            static_cast<unsigned int>(meshes.size()) - numMeshes);
+        DefaultLogger::get()->info(szBuff);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file Defines a post processing step to generate simplified levels of detail */
+#ifndef AI_GENLODSPROCESS_H_INC
+#define AI_GENLODSPROCESS_H_INC
+
+#include "BaseProcess.h"
+#include <assimp/mesh.h>
+#include <vector>
+
+struct aiNode;
+
+namespace Assimp
+{
+
+// ---------------------------------------------------------------------------
+/** The GenLODsProcess builds a chain of simplified versions of each triangle
+ *  mesh by quadric error metric edge collapses (Garland and Heckbert, 1997).
+ *
+ *  Collapses move a vertex onto one of its neighbours, so the remaining
+ *  vertices keep their attributes and bone weights. Vertices on UV or normal
+ *  seams and on open borders are never moved, and vertices are only
+ *  collapsed onto vertices with the same dominant bone. The LOD meshes are
+ *  appended to aiScene::mMeshes and referenced from the metadata of the
+ *  nodes using the original mesh.
+*/
+class ASSIMP_API GenLODsProcess : public BaseProcess
+{
+public:
+
+    GenLODsProcess();
+    ~GenLODsProcess();
+
+public:
+    // -------------------------------------------------------------------
+    /** Returns whether the processing step is present in the given flag field.
+    * @param pFlags The processing flags the importer was called with. A bitwise
+    *   combination of #aiPostProcessSteps.
+    * @return true if the process is present in this flag fields, false if not.
+    */
+    bool IsActive( unsigned int pFlags) const;
+
+    // -------------------------------------------------------------------
+    /** Called prior to ExecuteOnScene().
+    * The function is a request to the process to update its configuration
+    * basing on the Importer's configuration property list.
+    */
+    void SetupProperties(const Importer* pImp);
+
+    // -------------------------------------------------------------------
+    /** Executes the post processing step on the given imported data.
+    * @param pScene The imported data to work at.
+    */
+    void Execute( aiScene* pScene);
+
+    // -------------------------------------------------------------------
+    /** Builds the LOD chain of a single mesh.
+    * @param pMesh Mesh to simplify, must consist of triangles only.
+    * @param pOut Receives one new mesh per level which reduced the
+    *   face count of the previous level, in order of decreasing detail.
+    */
+    void GenMeshLODs( const aiMesh* pMesh, std::vector<aiMesh*>& pOut) const;
+
+    //! Set the face ratios of the levels - needed for unit testing
+    void SetRatios(const std::vector<float>& ratios);
+
+private:
+    // -------------------------------------------------------------------
+    // Adds the metadata linking the meshes of a node to their LODs
+    void LinkLODs( aiNode* pNode, const std::vector<std::vector<unsigned int> >& lods) const;
+
+    std::vector<float> configRatios;
+    unsigned int configThreads;
+};
+
+} // end of namespace Assimp
+
+#endif // !!AI_GENLODSPROCESS_H_INC
@@ -0,0 +1,291 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file Implementation of the post processing step to partition meshes
+ *  into meshlets.
+ */
+
+#include "GenMeshletsProcess.h"
+#include "StringUtils.h"
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+#include <vector>
+
+using namespace Assimp;
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Bounding sphere of the vertices of a meshlet after Ritter, not minimal
+// but within a few percent of it.
+void ComputeBoundingSphere(const aiMesh* pMesh, aiMeshlet& meshlet)
+{
+    const aiVector3D* const vertices = pMesh->mVertices;
+    const unsigned int* const begin = meshlet.mVertices, *const end = begin + meshlet.mNumVertices;
+
+    // start with the two points farthest apart along a search from the first one
+    const auto farthest = [&](const aiVector3D& from) -> const aiVector3D& {
+        const unsigned int* best = begin;
+        float bestDist = -1.f;
+        for (const unsigned int* it = begin; it != end; ++it) {
+            const float dist = (vertices[*it] - from).SquareLength();
+            if (dist > bestDist) {
+                bestDist = dist;
+                best = it;
+            }
+        }
+        return vertices[*best];
+    };
+    const aiVector3D& a = farthest(vertices[*begin]);
+    const aiVector3D& b = farthest(a);
+
+    aiVector3D center = (a + b) * 0.5f;
+    float radius = (b - a).Length() * 0.5f;
+
+    // then grow the sphere to enclose all points
+    for (const unsigned int* it = begin; it != end; ++it) {
+        const aiVector3D& p = vertices[*it];
+        const float dist = (p - center).Length();
+        if (dist > radius) {
+            const float newRadius = (radius + dist) * 0.5f;
+            center += (p - center) * ((newRadius - radius) / dist);
+            radius = newRadius;
+        }
+    }
+
+    // compensate for rounding errors, the sphere must be conservative
+    meshlet.mCenter = center;
+    meshlet.mRadius = radius * (1.f + 1e-5f);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Cone around the average triangle normal which encloses all triangle normals
+void ComputeNormalCone(const aiMesh* pMesh, aiMeshlet& meshlet)
+{
+    const aiVector3D* const vertices = pMesh->mVertices;
+
+    std::vector<aiVector3D> normals;
+    normals.reserve(meshlet.mNumTriangles);
+    aiVector3D axis;
+    for (unsigned int i = 0; i < meshlet.mNumTriangles; ++i) {
+        const unsigned char* tri = meshlet.mTriangles + i * 3;
+        const aiVector3D& a = vertices[meshlet.mVertices[tri[0]]];
+        const aiVector3D& b = vertices[meshlet.mVertices[tri[1]]];
+        const aiVector3D& c = vertices[meshlet.mVertices[tri[2]]];
+        aiVector3D n = (b - a) ^ (c - a);
+        const float length = n.Length();
+
+        // degenerate triangles are never visible and don't restrict the cone
+        if (length <= 1e-20f) {
+            continue;
+        }
+        n /= length;
+        normals.push_back(n);
+        axis += n;
+    }
+
+    meshlet.mConeAxis = aiVector3D();
+    meshlet.mConeCutoff = 1.f;
+    const float axisLength = axis.Length();
+    if (normals.empty() || axisLength <= 1e-6f) {
+        return;
+    }
+    axis /= axisLength;
+
+    float minDot = 1.f;
+    for (std::vector<aiVector3D>::const_iterator it = normals.begin(); it != normals.end(); ++it) {
+        minDot = std::min(minDot, *it * axis);
+    }
+
+    // a cone wider than a hemisphere can't be culled
+    meshlet.mConeAxis = axis;
+    if (minDot > 0.f) {
+        meshlet.mConeCutoff = std::min(1.f, sqrtf(1.f - minDot * minDot));
+    }
+}
+
+} // Namespace
+
+// ------------------------------------------------------------------------------------------------
+// Constructor to be privately used by Importer
+GenMeshletsProcess::GenMeshletsProcess()
+    : configMaxVertices(AI_ML_DEFAULT_MAX_VERTICES)
+    , configMaxTriangles(AI_ML_DEFAULT_MAX_TRIANGLES)
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+// Destructor, private as well
+GenMeshletsProcess::~GenMeshletsProcess()
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+// Returns whether the processing step is present in the given flag field.
+bool GenMeshletsProcess::IsActive( unsigned int pFlags) const
+{
+    return (pFlags & aiProcess_GenMeshlets) != 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Setup configuration properties
+void GenMeshletsProcess::SetupProperties(const Importer* pImp)
+{
+    SetLimits(pImp->GetPropertyInteger(AI_CONFIG_PP_ML_MAX_VERTICES,AI_ML_DEFAULT_MAX_VERTICES),
+        pImp->GetPropertyInteger(AI_CONFIG_PP_ML_MAX_TRIANGLES,AI_ML_DEFAULT_MAX_TRIANGLES));
+}
+
+// ------------------------------------------------------------------------------------------------
+void GenMeshletsProcess::SetLimits(unsigned int maxVertices, unsigned int maxTriangles)
+{
+    // meshlet triangles use 8 bit indices
+    configMaxVertices = std::max(3u, std::min(maxVertices, 256u));
+    configMaxTriangles = std::max(1u, maxTriangles);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Executes the post processing step on the given imported data.
+void GenMeshletsProcess::Execute( aiScene* pScene)
+{
+    DefaultLogger::get()->debug("GenMeshletsProcess begin");
+
+    unsigned int numMeshlets = 0, numTriangles = 0;
+    for( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
+        aiMesh* mesh = pScene->mMeshes[a];
+        if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE || !mesh->HasPositions()) {
+            DefaultLogger::get()->debug("GenMeshletsProcess: Skipping mesh which is no pure triangle mesh");
+            continue;
+        }
+        GenMeshMeshlets(mesh);
+        numMeshlets += mesh->mNumMeshlets;
+        numTriangles += mesh->mNumFaces;
+    }
+
+    if (!DefaultLogger::isNullLogger()) {
+        char szBuff[128]; // should be sufficiently large in every case
+        ai_snprintf(szBuff,128,"GenMeshletsProcess finished. Built %u meshlets, %.1f triangles on average",
+            numMeshlets,numMeshlets ? (float)numTriangles / numMeshlets : 0.f);
+        DefaultLogger::get()->info(szBuff);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Partitions a single mesh
+void GenMeshletsProcess::GenMeshMeshlets( aiMesh* pMesh) const
+{
+    ai_assert(NULL != pMesh);
+
+    delete[] pMesh->mMeshlets;
+    pMesh->mMeshlets = NULL;
+    pMesh->mNumMeshlets = 0;
+    if (!pMesh->mNumFaces) {
+        return;
+    }
+
+    // Gather consecutive faces until one of the limits would be exceeded.
+    // 'local' maps mesh vertices to their index in the current meshlet.
+    struct Range {
+        unsigned int firstFace, numFaces, numVertices;
+    };
+    std::vector<Range> ranges;
+    std::vector<unsigned int> local(pMesh->mNumVertices, UINT_MAX);
+    std::vector<unsigned int> vertices;
+    std::vector<unsigned char> triangles;
+    vertices.reserve(pMesh->mNumVertices);
+    triangles.reserve(pMesh->mNumFaces * 3);
+
+    Range current = { 0, 0, 0 };
+    const auto flush = [&]() {
+        for (unsigned int i = vertices.size() - current.numVertices; i < vertices.size(); ++i) {
+            local[vertices[i]] = UINT_MAX;
+        }
+        ranges.push_back(current);
+        current.firstFace += current.numFaces;
+        current.numFaces = current.numVertices = 0;
+    };
+
+    for (unsigned int i = 0; i < pMesh->mNumFaces; ++i) {
+        const unsigned int* idx = pMesh->mFaces[i].mIndices;
+        unsigned int added = 0;
+        for (unsigned int c = 0; c < 3; ++c) {
+            added += (local[idx[c]] == UINT_MAX && (c < 1 || idx[c] != idx[0]) && (c < 2 || idx[c] != idx[1])) ? 1 : 0;
+        }
+        if (current.numVertices + added > configMaxVertices || current.numFaces == configMaxTriangles) {
+            flush();
+        }
+        for (unsigned int c = 0; c < 3; ++c) {
+            unsigned int& l = local[idx[c]];
+            if (l == UINT_MAX) {
+                l = current.numVertices++;
+                vertices.push_back(idx[c]);
+            }
+            triangles.push_back(static_cast<unsigned char>(l));
+        }
+        ++current.numFaces;
+    }
+    flush();
+
+    pMesh->mNumMeshlets = static_cast<unsigned int>(ranges.size());
+    pMesh->mMeshlets = new aiMeshlet[ranges.size()];
+    const unsigned int* vertexIter = vertices.data();
+    const unsigned char* triangleIter = triangles.data();
+    for (unsigned int i = 0; i < pMesh->mNumMeshlets; ++i) {
+        aiMeshlet& meshlet = pMesh->mMeshlets[i];
+        meshlet.mNumVertices = ranges[i].numVertices;
+        meshlet.mVertices = new unsigned int[meshlet.mNumVertices];
+        std::copy(vertexIter, vertexIter + meshlet.mNumVertices, meshlet.mVertices);
+        vertexIter += meshlet.mNumVertices;
+
+        meshlet.mNumTriangles = ranges[i].numFaces;
+        meshlet.mTriangles = new unsigned char[meshlet.mNumTriangles * 3];
+        std::copy(triangleIter, triangleIter + meshlet.mNumTriangles * 3, meshlet.mTriangles);
+        triangleIter += meshlet.mNumTriangles * 3;
+
+        ComputeBoundingSphere(pMesh, meshlet);
+        ComputeNormalCone(pMesh, meshlet);
+    }
+}
@@ -43,14 +43,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/types.h>
 #include <assimp/IOStream.hpp>
 #include "ParsingUtils.h"
+#include "BaseImporter.h"
 
 #include <iostream>
+#include <algorithm>
 
 namespace Assimp {
 
 // ---------------------------------------------------------------------------
 /**
  *  Implementation of a cached stream buffer.
+ *
+ *  If the stream is backed by memory (i.e. a memory mapped file) the blocks
+ *  are taken directly from the stream contents and no cache is allocated.
  */
 template<class T>
 class IOStreamBuffer {
@@ -94,8 +99,14 @@ public:
     /// @return The current file pos.
     size_t getFilePos() const;
 
+    /// @brief  Returns the stream contents if the stream is backed by memory.
+    /// @return The contents, nullptr if they are read block-wise.
+    const T *getMappedData() const;
+
     /// @brief  Will read the next line.
-    /// @param  buffer      The buffer for the next line.
+    /// @param  buffer      The buffer for the next line, filled with '\n'
+    ///                     behind the line. Pass it unmodified to the next call,
+    ///                     only the previous line is cleared then.
     /// @return true if successful.
     bool getNextLine( std::vector<T> &buffer );
 
@@ -106,6 +117,8 @@ private:
     size_t m_numBlocks;
     size_t m_blockIdx;
     std::vector<T> m_cache;
+    const T *m_mapped;
+    const T *m_block;
     size_t m_cachePos;
     size_t m_filePos;
 };
@@ -118,10 +131,11 @@ IOStreamBuffer<T>::IOStreamBuffer( size_t cache )
 , m_cacheSize( cache )
 , m_numBlocks( 0 )
 , m_blockIdx( 0 )
+, m_mapped( nullptr )
+, m_block( nullptr )
 , m_cachePos( 0 )
 , m_filePos( 0 ) {
-    m_cache.resize( cache );
-    std::fill( m_cache.begin(), m_cache.end(), '\n' );
+    // empty, the cache is allocated on demand
 }
 
 template<class T>
@@ -157,6 +171,12 @@ bool IOStreamBuffer<T>::open( IOStream *stream ) {
         m_numBlocks++;
     }
 
+    m_mapped = reinterpret_cast<const T*>( BaseImporter::GetStreamContents( m_stream ) );
+    if ( nullptr == m_mapped ) {
+        m_cache.resize( m_cacheSize );
+        std::fill( m_cache.begin(), m_cache.end(), '\n' );
+    }
+
     return true;
 }
 
@@ -169,6 +189,8 @@ bool IOStreamBuffer<T>::close() {
 
     // init counters and state vars
     m_stream    = nullptr;
+    m_mapped    = nullptr;
+    m_block     = nullptr;
     m_filesize  = 0;
     m_numBlocks = 0;
     m_blockIdx  = 0;
@@ -193,8 +215,15 @@ size_t IOStreamBuffer<T>::cacheSize() const {
 template<class T>
 inline
 bool IOStreamBuffer<T>::readNextBlock() {
-    m_stream->Seek( m_filePos, aiOrigin_SET );
-    size_t readLen = m_stream->Read( &m_cache[ 0 ], sizeof( T ), m_cacheSize );
+    size_t readLen( 0 );
+    if ( nullptr != m_mapped ) {
+        readLen = std::min( m_cacheSize, m_filesize / sizeof( T ) - m_filePos );
+        m_block = m_mapped + m_filePos;
+    } else {
+        m_stream->Seek( m_filePos, aiOrigin_SET );
+        readLen = m_stream->Read( &m_cache[ 0 ], sizeof( T ), m_cacheSize );
+        m_block = &m_cache[ 0 ];
+    }
     if ( readLen == 0 ) {
         return false;
     }
@@ -226,11 +255,24 @@ size_t IOStreamBuffer<T>::getFilePos() const {
     return m_filePos;
 }
 
+template<class T>
+inline
+const T *IOStreamBuffer<T>::getMappedData() const {
+    return m_mapped;
+}
+
 template<class T>
 inline
 bool IOStreamBuffer<T>::getNextLine( std::vector<T> &buffer ) {
-    buffer.resize( m_cacheSize );
-    ::memset( &buffer[ 0 ], '\n', m_cacheSize );
+    if ( buffer.size() != m_cacheSize ) {
+        buffer.assign( m_cacheSize, '\n' );
+    } else {
+        // the previous line is the only content which is not '\n', clearing
+        // the whole buffer for every line would be quadratic in the file size
+        for ( size_t i = 0; i < m_cacheSize && !IsLineEnd( buffer[ i ] ); ++i ) {
+            buffer[ i ] = '\n';
+        }
+    }
 
     if ( m_cachePos == m_cacheSize || 0 == m_filePos ) {
         if ( !readNextBlock() ) {
@@ -238,8 +280,8 @@ bool IOStreamBuffer<T>::getNextLine( std::vector<T> &buffer ) {
         }
     }
     size_t i = 0;
-    while ( !IsLineEnd( m_cache[ m_cachePos ] ) ) {
-        buffer[ i ] = m_cache[ m_cachePos ];
+    while ( !IsLineEnd( m_block[ m_cachePos ] ) ) {
+        buffer[ i ] = m_block[ m_cachePos ];
         m_cachePos++;
         i++;
         if ( m_cachePos >= m_cacheSize ) {
@@ -645,6 +645,9 @@ void SetupMapping (aiMaterial* mat, aiTextureMapping mode, const aiVector3D& axi
     }
     mat->mNumProperties = (unsigned int)p.size();
     ::memcpy(mat->mProperties,&p[0],sizeof(void*)*mat->mNumProperties);
+
+    // the list may have kept its address and length
+    mat->UpdatePropertyIndex();
 }
 
 // ------------------------------------------------------------------------------------------------
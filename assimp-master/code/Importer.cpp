@@ -76,7 +76,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Profiler.h"
 #include "TinyFormatter.h"
 #include "Exceptional.h"
-#include "Profiler.h"
 #include <set>
 #include <memory>
 #include <cctype>
@@ -158,6 +157,8 @@ Importer::Importer()
     pimpl->mProgressHandler = new DefaultProgressHandler();
     pimpl->mIsDefaultProgressHandler = true;
 
+    pimpl->mProfiler = NULL;
+
     GetImporterInstanceList(pimpl->mImporter);
     GetPostProcessingStepInstanceList(pimpl->mPostProcessingSteps);
 
@@ -192,6 +193,9 @@ Importer::~Importer()
     // Delete shared post-processing data
     delete pimpl->mPPShared;
 
+    // Delete the profile of the last import
+    delete pimpl->mProfiler;
+
     // and finally the pimpl itself
     delete pimpl;
 }
@@ -420,6 +424,33 @@ void Importer::SetExtraVerbose(bool bDo)
     pimpl->bExtraVerbose = bDo;
 }
 
+// ------------------------------------------------------------------------------------------------
+// Get the number of regions recorded by the profiler
+unsigned int Importer::GetProfileEntryCount() const
+{
+    return pimpl->mProfiler ? static_cast<unsigned int>(pimpl->mProfiler->GetEntries().size()) : 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Get a single region recorded by the profiler
+const aiProfileEntry* Importer::GetProfileEntry(unsigned int index) const
+{
+    if (index >= GetProfileEntryCount()) {
+        return NULL;
+    }
+    return &pimpl->mProfiler->GetEntries()[index];
+}
+
+// ------------------------------------------------------------------------------------------------
+// Serialize the profile of the last import
+std::string Importer::GetProfileReport(aiProfileFormat pFormat) const
+{
+    if (!pimpl->mProfiler) {
+        return std::string();
+    }
+    return pimpl->mProfiler->GetReport(pFormat);
+}
+
 // ------------------------------------------------------------------------------------------------
 // Get the current scene
 const aiScene* Importer::GetScene() const
@@ -578,6 +609,84 @@ void WriteLogOpening(const std::string& file)
         );
 }
 
+// ------------------------------------------------------------------------------------------------
+// Get the profiler for post-processing. Steps applied after ReadFile() append
+// their regions to the profile of that import.
+static Profiler* AcquireProfiler(Importer* pImp)
+{
+    ImporterPimpl* pimpl = pImp->Pimpl();
+    if (!pImp->GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)) {
+        return NULL;
+    }
+    if (!pimpl->mProfiler) {
+        pimpl->mProfiler = new Profiler();
+    }
+    return pimpl->mProfiler;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Report progress and ask the progress handler whether to go on. If it requests to abort
+// the import, the current scene is released.
+static bool ContinueImport(Importer* pImp, float percentage)
+{
+    ImporterPimpl* pimpl = pImp->Pimpl();
+    if (pimpl->mProgressHandler->Update(percentage)) {
+        return true;
+    }
+
+    pimpl->mErrorString = "Import aborted by the progress handler";
+    DefaultLogger::get()->info(pimpl->mErrorString);
+    delete pimpl->mScene;
+    pimpl->mScene = NULL;
+    return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Get a readable name for a post-processing step, used to label its profile region.
+static const char* GetStepName(const BaseProcess* process, unsigned int pFlags)
+{
+    static const struct {
+        unsigned int flag;
+        const char* name;
+    } names[] = {
+        { aiProcess_CalcTangentSpace,         "CalcTangentSpace" },
+        { aiProcess_JoinIdenticalVertices,    "JoinIdenticalVertices" },
+        { aiProcess_MakeLeftHanded,           "MakeLeftHanded" },
+        { aiProcess_Triangulate,              "Triangulate" },
+        { aiProcess_RemoveComponent,          "RemoveComponent" },
+        { aiProcess_GenNormals,               "GenNormals" },
+        { aiProcess_GenSmoothNormals,         "GenSmoothNormals" },
+        { aiProcess_SplitLargeMeshes,         "SplitLargeMeshes" },
+        { aiProcess_PreTransformVertices,     "PreTransformVertices" },
+        { aiProcess_LimitBoneWeights,         "LimitBoneWeights" },
+        { aiProcess_ValidateDataStructure,    "ValidateDataStructure" },
+        { aiProcess_ImproveCacheLocality,     "ImproveCacheLocality" },
+        { aiProcess_RemoveRedundantMaterials, "RemoveRedundantMaterials" },
+        { aiProcess_FixInfacingNormals,       "FixInfacingNormals" },
+        { aiProcess_SortByPType,              "SortByPType" },
+        { aiProcess_FindDegenerates,          "FindDegenerates" },
+        { aiProcess_FindInvalidData,          "FindInvalidData" },
+        { aiProcess_GenUVCoords,              "GenUVCoords" },
+        { aiProcess_TransformUVCoords,        "TransformUVCoords" },
+        { aiProcess_FindInstances,            "FindInstances" },
+        { aiProcess_OptimizeMeshes,           "OptimizeMeshes" },
+        { aiProcess_OptimizeGraph,            "OptimizeGraph" },
+        { aiProcess_FlipUVs,                  "FlipUVs" },
+        { aiProcess_FlipWindingOrder,         "FlipWindingOrder" },
+        { aiProcess_SplitByBoneCount,         "SplitByBoneCount" },
+        { aiProcess_Debone,                   "Debone" },
+        { aiProcess_GenMeshlets,              "GenMeshlets" },
+        { aiProcess_GenLODs,                  "GenLODs" }
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if ((pFlags & names[i].flag) && process->IsActive(names[i].flag)) {
+            return names[i].name;
+        }
+    }
+    return "Unknown";
+}
+
 // ------------------------------------------------------------------------------------------------
 // Reads the given file and returns its contents if successful.
 const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
@@ -605,6 +714,11 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             FreeScene();
         }
 
+        // Start a fresh profile for this import, if requested
+        delete pimpl->mProfiler;
+        pimpl->mProfiler = GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0) ? new Profiler() : NULL;
+        Profiler* profiler = pimpl->mProfiler;
+
         // First check if the file is accessible at all
         if( !pimpl->mIOHandler->Exists( pFile)) {
 
@@ -613,7 +727,6 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             return NULL;
         }
 
-        std::unique_ptr<Profiler> profiler(GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)?new Profiler():NULL);
         if (profiler) {
             profiler->BeginRegion("total");
         }
@@ -645,6 +758,9 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             if( !imp)   {
                 pimpl->mErrorString = "No suitable reader found for the file format of file \"" + pFile + "\".";
                 DefaultLogger::get()->error(pimpl->mErrorString);
+                if (profiler) {
+                    profiler->EndRegion("total");
+                }
                 return NULL;
             }
         }
@@ -666,6 +782,12 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
         }
         DefaultLogger::get()->info("Found a matching importer for this file format: " + ext + "." );
         pimpl->mProgressHandler->UpdateFileRead( 0, fileSize );
+        if (!ContinueImport(this, 0.f)) {
+            if (profiler) {
+                profiler->EndRegion("total");
+            }
+            return NULL;
+        }
 
         if (profiler) {
             profiler->BeginRegion("import");
@@ -678,6 +800,9 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             profiler->EndRegion("import");
         }
 
+        // Give the progress handler the chance to abort before post-processing
+        const bool aborted = pimpl->mScene && !ContinueImport(this, 0.5f);
+
         // If successful, apply all active post processing steps to the imported data
         if( pimpl->mScene)  {
 
@@ -685,9 +810,20 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             // The ValidateDS process is an exception. It is executed first, even before ScenePreprocessor is called.
             if (pFlags & aiProcess_ValidateDataStructure)
             {
+                if (profiler) {
+                    profiler->BeginRegion("validate");
+                }
+
                 ValidateDSProcess ds;
                 ds.ExecuteOnScene (this);
+
+                if (profiler) {
+                    profiler->EndRegion("validate");
+                }
                 if (!pimpl->mScene) {
+                    if (profiler) {
+                        profiler->EndRegion("total");
+                    }
                     return NULL;
                 }
             }
@@ -709,7 +845,7 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             ApplyPostProcessing(pFlags & (~aiProcess_ValidateDataStructure));
         }
         // if failed, extract the error string
-        else if( !pimpl->mScene) {
+        else if( !aborted) {
             pimpl->mErrorString = imp->GetErrorText();
         }
 
@@ -732,6 +868,9 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
 
         DefaultLogger::get()->error(pimpl->mErrorString);
         delete pimpl->mScene; pimpl->mScene = NULL;
+        if (pimpl->mProfiler) {
+            pimpl->mProfiler->EndRegion("total");
+        }
     }
 #endif // ! ASSIMP_CATCH_GLOBAL_EXCEPTIONS
 
@@ -786,21 +925,31 @@ const aiScene* Importer::ApplyPostProcessing(unsigned int pFlags)
     }
 #endif // ! DEBUG
 
-    std::unique_ptr<Profiler> profiler(GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)?new Profiler():NULL);
+    Profiler* profiler = AcquireProfiler(this);
+    if (profiler) {
+        profiler->BeginRegion("postprocess");
+    }
+
     for( unsigned int a = 0; a < pimpl->mPostProcessingSteps.size(); a++)   {
 
         BaseProcess* process = pimpl->mPostProcessingSteps[a];
         pimpl->mProgressHandler->UpdatePostProcess( a, pimpl->mPostProcessingSteps.size() );
         if( process->IsActive( pFlags)) {
 
+            // Stop here if the progress handler asks us to
+            if (!ContinueImport(this, 0.5f + 0.5f * a / pimpl->mPostProcessingSteps.size())) {
+                break;
+            }
+
+            const std::string region = profiler ? std::string("postprocess/") + GetStepName(process, pFlags) : std::string();
             if (profiler) {
-                profiler->BeginRegion("postprocess");
+                profiler->BeginRegion(region);
             }
 
             process->ExecuteOnScene ( this );
 
             if (profiler) {
-                profiler->EndRegion("postprocess");
+                profiler->EndRegion(region);
             }
         }
         if( !pimpl->mScene) {
@@ -827,6 +976,10 @@ const aiScene* Importer::ApplyPostProcessing(unsigned int pFlags)
     }
     pimpl->mProgressHandler->UpdatePostProcess( pimpl->mPostProcessingSteps.size(), pimpl->mPostProcessingSteps.size() );
 
+    if (profiler) {
+        profiler->EndRegion("postprocess");
+    }
+
     // update private scene flags
   if( pimpl->mScene )
     ScenePriv(pimpl->mScene)->mPPStepsApplied |= pFlags;
@@ -881,20 +1034,22 @@ const aiScene* Importer::ApplyCustomizedPostProcessing( BaseProcess *rootProcess
     }
 #endif // ! DEBUG
 
-    std::unique_ptr<Profiler> profiler( GetPropertyInteger( AI_CONFIG_GLOB_MEASURE_TIME, 0 ) ? new Profiler() : NULL );
+    Profiler* profiler = AcquireProfiler( this );
 
     if ( profiler ) {
         profiler->BeginRegion( "postprocess" );
     }
 
-    rootProcess->ExecuteOnScene( this );
+    if ( ContinueImport( this, 0.5f ) ) {
+        rootProcess->ExecuteOnScene( this );
+    }
 
     if ( profiler ) {
         profiler->EndRegion( "postprocess" );
     }
 
     // If the extra verbose mode is active, execute the ValidateDataStructureStep again - after each step
-    if ( pimpl->bExtraVerbose || requestValidation  ) {
+    if ( pimpl->mScene && ( pimpl->bExtraVerbose || requestValidation ) ) {
         DefaultLogger::get()->debug( "Verbose Import: revalidating data structures" );
 
         ValidateDSProcess ds;
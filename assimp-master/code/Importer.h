@@ -56,6 +56,10 @@ namespace Assimp    {
     class BaseProcess;
     class SharedPostProcessInfo;
 
+    namespace Profiling {
+        class Profiler;
+    }
+
 
 //! @cond never
 // ---------------------------------------------------------------------------
@@ -119,6 +123,10 @@ public:
 
     /** Used by post-process steps to share data */
     SharedPostProcessInfo* mPPShared;
+
+    /** Timings and memory statistics of the last import, NULL if
+     *  #AI_CONFIG_GLOB_MEASURE_TIME was not set. */
+    Profiling::Profiler* mProfiler;
 };
 //! @endcond
 
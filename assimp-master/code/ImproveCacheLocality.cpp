@@ -41,9 +41,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 /** @file Implementation of the post processing step to improve the cache locality of a mesh.
  * <br>
- * The algorithm is roughly basing on this paper:
+ * The default algorithm is roughly basing on this paper:
  * http://www.cs.princeton.edu/gfx/pubs/Sander_2007_%3ETR/tipsy.pdf
  *   .. although overdraw rduction isn't implemented yet ...
+ * <br>
+ * The alternative is Tom Forsyth's 'Linear-Speed Vertex Cache Optimisation':
+ * https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
  */
 
 
@@ -52,18 +55,42 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ImproveCacheLocality.h"
 #include "VertexTriangleAdjacency.h"
 #include "StringUtils.h"
+#include "ThreadPool.h"
+#include "Exceptional.h"
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <assimp/DefaultLogger.hpp>
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
 #include <stack>
+#include <vector>
 
 using namespace Assimp;
 
+namespace {
+
+// meshes with less faces in total are processed on the calling thread
+const unsigned int ParallelMinFaces = 1u << 16;
+
+// scoring parameters of Forsyth's algorithm, as given in his paper
+const float ForsythCacheDecayPower = 1.5f;
+const float ForsythLastTriScore = 0.75f;
+const float ForsythValenceBoostScale = 2.0f;
+const float ForsythValenceBoostPower = 0.5f;
+const unsigned int ForsythMaxValence = 64;
+
+} // Namespace
+
 // ------------------------------------------------------------------------------------------------
 // Constructor to be privately used by Importer
-ImproveCacheLocalityProcess::ImproveCacheLocalityProcess() {
-    configCacheDepth = PP_ICL_PTCACHE_SIZE;
+ImproveCacheLocalityProcess::ImproveCacheLocalityProcess()
+    : configCacheDepth(PP_ICL_PTCACHE_SIZE)
+    , configAlgorithm(aiCacheLocalityAlgorithm_Tipsify)
+    , configReorderVertices(false)
+    , configThreads(0)
+{
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -86,6 +113,9 @@ void ImproveCacheLocalityProcess::SetupProperties(const Importer* pImp)
 {
     // AI_CONFIG_PP_ICL_PTCACHE_SIZE controls the target cache size for the optimizer
     configCacheDepth = pImp->GetPropertyInteger(AI_CONFIG_PP_ICL_PTCACHE_SIZE,PP_ICL_PTCACHE_SIZE);
+    configAlgorithm = pImp->GetPropertyInteger(AI_CONFIG_PP_ICL_ALGORITHM,aiCacheLocalityAlgorithm_Tipsify);
+    configReorderVertices = pImp->GetPropertyBool(AI_CONFIG_PP_ICL_REORDER_VERTICES,false);
+    configThreads = static_cast<unsigned int>(std::max(0,pImp->GetPropertyInteger(AI_CONFIG_PP_ICL_THREADS,0)));
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -99,96 +129,178 @@ void ImproveCacheLocalityProcess::Execute( aiScene* pScene)
 
     DefaultLogger::get()->debug("ImproveCacheLocalityProcess begin");
 
-    float out = 0.f;
-    unsigned int numf = 0, numm = 0;
-    for( unsigned int a = 0; a < pScene->mNumMeshes; a++){
-        const float res = ProcessMesh( pScene->mMeshes[a],a);
-        if (res) {
-            numf += pScene->mMeshes[a]->mNumFaces;
-            out  += res;
-            ++numm;
+    // meshes are independent of each other, process them in parallel if
+    // there is enough work. Logging is left to this thread.
+    std::vector<MeshReport> reports(pScene->mNumMeshes);
+    unsigned int numThreads = configThreads;
+    if (!numThreads) {
+        unsigned int numFaces = 0;
+        for( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
+            numFaces += pScene->mMeshes[a]->mNumFaces;
+        }
+        numThreads = numFaces >= ParallelMinFaces ? ThreadPool::GetHardwareThreadCount() : 1;
+    }
+    numThreads = std::min(numThreads,pScene->mNumMeshes);
+
+    if (numThreads > 1) {
+        ThreadPool pool(numThreads);
+        for( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
+            aiMesh* mesh = pScene->mMeshes[a];
+            MeshReport* report = &reports[a];
+            pool.Enqueue([this, mesh, report]() {
+                try {
+                    ProcessMesh(mesh,*report);
+                }
+                catch (const std::exception& e) {
+                    report->error = e.what();
+                }
+            });
+        }
+    }
+    else {
+        for( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
+            ProcessMesh(pScene->mMeshes[a],reports[a]);
         }
     }
+
+    unsigned int numf = 0, numv = 0, numm = 0, misses = 0;
+    for( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
+        const MeshReport& report = reports[a];
+        const aiMesh* mesh = pScene->mMeshes[a];
+        if (!report.error.empty()) {
+            throw DeadlyImportError("ImproveCacheLocalityProcess: " + report.error);
+        }
+
+        char szBuff[128]; // should be sufficiently large in every case
+        switch (report.status)
+        {
+        case MeshReport::NotTriangulated:
+            DefaultLogger::get()->error("This algorithm works on triangle meshes only");
+            break;
+
+        case MeshReport::Unsuitable:
+            // the JoinIdenticalVertices process has not been executed on this
+            // mesh, otherwise the input ACMR would normally be at least minimally
+            // smaller than 3.0 ...
+            ai_snprintf(szBuff,128,"Mesh %u: Not suitable for vcache optimization",a);
+            DefaultLogger::get()->warn(szBuff);
+            break;
+
+        case MeshReport::Optimized:
+            if (!DefaultLogger::isNullLogger()) {
+                const float acmrIn = (float)report.missesIn / mesh->mNumFaces, acmrOut = (float)report.missesOut / mesh->mNumFaces;
+                ai_snprintf(szBuff,128,"Mesh %u | ACMR in: %f out: %f | ATVR in: %f out: %f | ~%.1f%%",a,acmrIn,acmrOut,
+                    (float)report.missesIn / mesh->mNumVertices,(float)report.missesOut / mesh->mNumVertices,
+                    ((acmrIn - acmrOut) / acmrIn) * 100.f);
+                DefaultLogger::get()->debug(szBuff);
+
+                numf += mesh->mNumFaces;
+                numv += mesh->mNumVertices;
+                misses += report.missesOut;
+                ++numm;
+            }
+            break;
+
+        default:
+            break;
+        };
+    }
     if (!DefaultLogger::isNullLogger()) {
         char szBuff[128]; // should be sufficiently large in every case
-        ai_snprintf(szBuff,128,"Cache relevant are %u meshes (%u faces). Average output ACMR is %f",
-            numm,numf,out/numf);
+        ai_snprintf(szBuff,128,"Cache relevant are %u meshes (%u faces). Average output ACMR is %f, ATVR is %f",
+            numm,numf,(float)misses/numf,(float)misses/numv);
 
         DefaultLogger::get()->info(szBuff);
         DefaultLogger::get()->debug("ImproveCacheLocalityProcess finished. ");
     }
 }
 
+// ------------------------------------------------------------------------------------------------
+// Count the cache misses of a FIFO cache
+unsigned int ImproveCacheLocalityProcess::CountCacheMisses(const aiMesh* pMesh, unsigned int cacheSize)
+{
+    ai_assert(NULL != pMesh);
+
+    // per-vertex time stamps replace a search of the FIFO: a vertex is still
+    // cached if less than cacheSize misses happened since it was loaded
+    std::vector<unsigned int> stamps(pMesh->mNumVertices,0);
+    unsigned int iCacheMisses = 0;
+    for (unsigned int i = 0; i < pMesh->mNumFaces; ++i) {
+        const aiFace& face = pMesh->mFaces[i];
+        for (unsigned int qq = 0; qq < face.mNumIndices; ++qq) {
+            unsigned int& stamp = stamps[face.mIndices[qq]];
+            if (!stamp || iCacheMisses - stamp >= cacheSize) {
+                stamp = ++iCacheMisses;
+            }
+        }
+    }
+    return iCacheMisses;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Improves the cache coherency of a specific mesh
-float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int meshNum)
+void ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, MeshReport& report) const
 {
-    // TODO: rewrite this to use std::vector or boost::shared_array
     ai_assert(NULL != pMesh);
 
     // Check whether the input data is valid
     // - there must be vertices and faces
     // - all faces must be triangulated or we can't operate on them
     if (!pMesh->HasFaces() || !pMesh->HasPositions())
-        return 0.f;
+        return;
 
     if (pMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE) {
-        DefaultLogger::get()->error("This algorithm works on triangle meshes only");
-        return 0.f;
+        report.status = MeshReport::NotTriangulated;
+        return;
     }
 
     if(pMesh->mNumVertices <= configCacheDepth) {
-        return 0.f;
+        return;
     }
 
-    float fACMR = 3.f;
-    const aiFace* const pcEnd = pMesh->mFaces+pMesh->mNumFaces;
-
     // Input ACMR is for logging purposes only
-    if (!DefaultLogger::isNullLogger())     {
-
-        unsigned int* piFIFOStack = new unsigned int[configCacheDepth];
-        memset(piFIFOStack,0xff,configCacheDepth*sizeof(unsigned int));
-        unsigned int* piCur = piFIFOStack;
-        const unsigned int* const piCurEnd = piFIFOStack + configCacheDepth;
+    const bool statistics = !DefaultLogger::isNullLogger();
+    if (statistics) {
+        report.missesIn = CountCacheMisses(pMesh,configCacheDepth);
+        if (report.missesIn == pMesh->mNumFaces * 3) {
+            report.status = MeshReport::Unsuitable;
+            return;
+        }
+    }
 
-        // count the number of cache misses
-        unsigned int iCacheMisses = 0;
-        for (const aiFace* pcFace = pMesh->mFaces;pcFace != pcEnd;++pcFace) {
+    // allocate an empty output index buffer. We store the output indices in one large array.
+    // Since the number of triangles won't change the input faces can be reused. This is how
+    // we save thousands of redundant mini allocations for aiFace::mIndices
+    std::vector<unsigned int> piIBOutput(pMesh->mNumFaces*3);
+    if (configAlgorithm == aiCacheLocalityAlgorithm_Forsyth) {
+        OptimizeForsyth(pMesh,piIBOutput.data());
+    }
+    else {
+        OptimizeTipsify(pMesh,piIBOutput.data());
+    }
 
-            for (unsigned int qq = 0; qq < 3;++qq) {
-                bool bInCache = false;
+    // sort the output index buffer back to the input array
+    const unsigned int* piCSIter = piIBOutput.data();
+    for (aiFace* pcFace = pMesh->mFaces, *pcEnd = pMesh->mFaces+pMesh->mNumFaces; pcFace != pcEnd;++pcFace)  {
+        pcFace->mIndices[0] = *piCSIter++;
+        pcFace->mIndices[1] = *piCSIter++;
+        pcFace->mIndices[2] = *piCSIter++;
+    }
 
-                for (unsigned int* pp = piFIFOStack;pp < piCurEnd;++pp) {
-                    if (*pp == pcFace->mIndices[qq])    {
-                        // the vertex is in cache
-                        bInCache = true;
-                        break;
-                    }
-                }
-                if (!bInCache)  {
-                    ++iCacheMisses;
-                    if (piCurEnd == piCur) {
-                        piCur = piFIFOStack;
-                    }
-                    *piCur++ = pcFace->mIndices[qq];
-                }
-            }
-        }
-        delete[] piFIFOStack;
-        fACMR = (float)iCacheMisses / pMesh->mNumFaces;
-        if (3.0 == fACMR)   {
-            char szBuff[128]; // should be sufficiently large in every case
+    if (configReorderVertices) {
+        ReorderVertices(pMesh);
+    }
 
-            // the JoinIdenticalVertices process has not been executed on this
-            // mesh, otherwise this value would normally be at least minimally
-            // smaller than 3.0 ...
-            ai_snprintf(szBuff,128,"Mesh %u: Not suitable for vcache optimization",meshNum);
-            DefaultLogger::get()->warn(szBuff);
-            return 0.f;
-        }
+    report.status = MeshReport::Optimized;
+    if (statistics) {
+        report.missesOut = CountCacheMisses(pMesh,configCacheDepth);
     }
+}
 
+// ------------------------------------------------------------------------------------------------
+// Reorders the faces of a mesh with the tipsify algorithm
+void ImproveCacheLocalityProcess::OptimizeTipsify( aiMesh* pMesh, unsigned int* piIBOutput) const
+{
     // first we need to build a vertex-triangle adjacency list
     VertexTriangleAdjacency adj(pMesh->mFaces,pMesh->mNumFaces, pMesh->mNumVertices,true);
 
@@ -196,11 +308,6 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
     unsigned int* const piCachingStamps = new unsigned int[pMesh->mNumVertices];
     memset(piCachingStamps,0x0,pMesh->mNumVertices*sizeof(unsigned int));
 
-    // allocate an empty output index buffer. We store the output indices in one large array.
-    // Since the number of triangles won't change the input faces can be reused. This is how
-    // we save thousands of redundant mini allocations for aiFace::mIndices
-    const unsigned int iIdxCnt = pMesh->mNumFaces*3;
-    unsigned int* const piIBOutput = new unsigned int[iIdxCnt];
     unsigned int* piCSIter = piIBOutput;
 
     // allocate the flag array to hold the information
@@ -223,7 +330,6 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
         }
     }
     unsigned int* piCandidates = new unsigned int[iMaxRefTris*3];
-    unsigned int iCacheMisses = 0;
 
     // ...................................................................................
     /** PSEUDOCODE for the algorithm
@@ -294,7 +400,6 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
                     // if the vertex is not yet in cache, set its cache count
                     if (iStampCnt-piCachingStamps[dp] > configCacheDepth) {
                         piCachingStamps[dp] = iStampCnt++;
-                        ++iCacheMisses;
                     }
                 }
                 // flag triangle as emitted
@@ -354,33 +459,220 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
             }
         }
     }
-    float fACMR2 = 0.0f;
-    if (!DefaultLogger::isNullLogger()) {
-        fACMR2 = (float)iCacheMisses / pMesh->mNumFaces;
+    // delete temporary storage
+    delete[] piCachingStamps;
+    delete[] piCandidates;
+}
 
-        // very intense verbose logging ... prepare for much text if there are many meshes
-        if ( DefaultLogger::get()->getLogSeverity() == Logger::VERBOSE) {
-            char szBuff[128]; // should be sufficiently large in every case
+// ------------------------------------------------------------------------------------------------
+// Reorders the faces of a mesh with Forsyth's algorithm. The vertex cache is modelled as LRU
+// cache. Each vertex is scored by its position in the cache and the number of triangles still
+// using it, the triangle with the highest total score among those using cached vertices is
+// emitted next.
+void ImproveCacheLocalityProcess::OptimizeForsyth( aiMesh* pMesh, unsigned int* piIBOutput) const
+{
+    const unsigned int numFaces = pMesh->mNumFaces, numVertices = pMesh->mNumVertices;
+    const unsigned int cacheSize = std::max(configCacheDepth,4u);
+
+    // precompute the score tables
+    std::vector<float> cacheScores(cacheSize);
+    for (unsigned int i = 0; i < cacheSize; ++i) {
+        // the vertices of the last triangle get a fixed score, so it isn't
+        // favoured to use them all again
+        cacheScores[i] = i < 3 ? ForsythLastTriScore :
+            powf(1.f - (float)(i - 3) / (cacheSize - 3),ForsythCacheDecayPower);
+    }
+    float valenceScores[ForsythMaxValence];
+    for (unsigned int i = 1; i < ForsythMaxValence; ++i) {
+        valenceScores[i] = ForsythValenceBoostScale * powf((float)i,-ForsythValenceBoostPower);
+    }
 
-            ai_snprintf(szBuff,128,"Mesh %u | ACMR in: %f out: %f | ~%.1f%%",meshNum,fACMR,fACMR2,
-                ((fACMR - fACMR2) / fACMR) * 100.f);
-            DefaultLogger::get()->debug(szBuff);
+    // the adjacency lists are kept sorted into live and emitted triangles
+    VertexTriangleAdjacency adj(pMesh->mFaces,numFaces,numVertices,true);
+    unsigned int* const piLiveTris = adj.mLiveTriangles;
+
+    std::vector<int> cachePos(numVertices,-1);
+    std::vector<float> scores(numVertices);
+    const auto vertexScore = [&](unsigned int v) -> float {
+        const unsigned int live = piLiveTris[v];
+        if (!live) {
+            return -1.f;
         }
+        const float cached = cachePos[v] < 0 ? 0.f : cacheScores[cachePos[v]];
+        return cached + (live < ForsythMaxValence ? valenceScores[live] :
+            ForsythValenceBoostScale * powf((float)live,-ForsythValenceBoostPower));
+    };
+    const auto triangleScore = [&](unsigned int t) -> float {
+        const unsigned int* idx = pMesh->mFaces[t].mIndices;
+        return scores[idx[0]] + scores[idx[1]] + scores[idx[2]];
+    };
+
+    for (unsigned int v = 0; v < numVertices; ++v) {
+        scores[v] = vertexScore(v);
+    }
 
-        fACMR2 *= pMesh->mNumFaces;
+    // start with the best triangle of the whole mesh
+    int best = 0;
+    float bestScore = -1.f;
+    for (unsigned int t = 0; t < numFaces; ++t) {
+        const float score = triangleScore(t);
+        if (score > bestScore) {
+            bestScore = score;
+            best = t;
+        }
     }
-    // sort the output index buffer back to the input array
-    piCSIter = piIBOutput;
-    for (aiFace* pcFace = pMesh->mFaces; pcFace != pcEnd;++pcFace)  {
-        pcFace->mIndices[0] = *piCSIter++;
-        pcFace->mIndices[1] = *piCSIter++;
-        pcFace->mIndices[2] = *piCSIter++;
+
+    std::vector<bool> abEmitted(numFaces,false);
+    std::vector<unsigned int> cache, newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+    unsigned int cursor = 0;
+
+    for (unsigned int emitted = 0; emitted < numFaces; ++emitted) {
+        if (best < 0) {
+            // no cached vertex has live triangles left, continue with the
+            // next triangle in input order
+            while (abEmitted[cursor]) {
+                ++cursor;
+            }
+            best = cursor;
+        }
+
+        const unsigned int* idx = pMesh->mFaces[best].mIndices;
+        abEmitted[best] = true;
+        newCache.clear();
+        for (unsigned int i = 0; i < 3; ++i) {
+            const unsigned int v = idx[i];
+            *piIBOutput++ = v;
+            newCache.push_back(v);
+
+            // move the triangle to the emitted part of the adjacency list
+            unsigned int* list = adj.GetAdjacentTriangles(v);
+            unsigned int& live = piLiveTris[v];
+            for (unsigned int* p = list; p != list + live; ++p) {
+                if (*p == (unsigned int)best) {
+                    std::swap(*p,list[--live]);
+                    break;
+                }
+            }
+        }
+
+        // the triangle's vertices move to the front of the LRU cache
+        for (unsigned int v : cache) {
+            if (v != idx[0] && v != idx[1] && v != idx[2]) {
+                newCache.push_back(v);
+            }
+        }
+        for (unsigned int i = 0; i < newCache.size(); ++i) {
+            const unsigned int v = newCache[i];
+            cachePos[v] = i < cacheSize ? (int)i : -1;
+            scores[v] = vertexScore(v);
+        }
+        if (newCache.size() > cacheSize) {
+            newCache.resize(cacheSize);
+        }
+        cache.swap(newCache);
+
+        // pick the next triangle among those using cached vertices
+        best = -1;
+        bestScore = -1.f;
+        for (unsigned int v : cache) {
+            const unsigned int* list = adj.GetAdjacentTriangles(v);
+            for (const unsigned int* p = list; p != list + piLiveTris[v]; ++p) {
+                const float score = triangleScore(*p);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = *p;
+                }
+            }
+        }
     }
+}
 
-    // delete temporary storage
-    delete[] piCachingStamps;
-    delete[] piIBOutput;
-    delete[] piCandidates;
+// ------------------------------------------------------------------------------------------------
+// Apply a vertex permutation to a per-vertex array
+template <typename T>
+static void PermuteVertexArray(T*& pArray, const std::vector<unsigned int>& remap)
+{
+    if (!pArray) {
+        return;
+    }
+    T* out = new T[remap.size()];
+    for (unsigned int i = 0; i < remap.size(); ++i) {
+        out[remap[i]] = pArray[i];
+    }
+    delete[] pArray;
+    pArray = out;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Renumbers the vertices in the order of first use
+void ImproveCacheLocalityProcess::ReorderVertices(aiMesh* pMesh)
+{
+    ai_assert(NULL != pMesh);
+
+    std::vector<unsigned int> remap(pMesh->mNumVertices,UINT_MAX);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < pMesh->mNumFaces; ++i) {
+        const aiFace& face = pMesh->mFaces[i];
+        for (unsigned int a = 0; a < face.mNumIndices; ++a) {
+            unsigned int& target = remap[face.mIndices[a]];
+            if (UINT_MAX == target) {
+                target = next++;
+            }
+        }
+    }
+
+    bool identity = true;
+    for (unsigned int i = 0; i < pMesh->mNumVertices; ++i) {
+        if (UINT_MAX == remap[i]) {
+            remap[i] = next++;
+        }
+        identity = identity && remap[i] == i;
+    }
+    if (identity) {
+        return;
+    }
 
-    return fACMR2;
+    for (unsigned int i = 0; i < pMesh->mNumFaces; ++i) {
+        const aiFace& face = pMesh->mFaces[i];
+        for (unsigned int a = 0; a < face.mNumIndices; ++a) {
+            face.mIndices[a] = remap[face.mIndices[a]];
+        }
+    }
+
+    PermuteVertexArray(pMesh->mVertices,remap);
+    PermuteVertexArray(pMesh->mNormals,remap);
+    PermuteVertexArray(pMesh->mTangents,remap);
+    PermuteVertexArray(pMesh->mBitangents,remap);
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+        PermuteVertexArray(pMesh->mColors[c],remap);
+    }
+    for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+        PermuteVertexArray(pMesh->mTextureCoords[c],remap);
+    }
+
+    for (unsigned int i = 0; i < pMesh->mNumBones; ++i) {
+        aiBone* bone = pMesh->mBones[i];
+        for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+            bone->mWeights[w].mVertexId = remap[bone->mWeights[w].mVertexId];
+        }
+    }
+
+    for (unsigned int i = 0; i < pMesh->mNumAnimMeshes; ++i) {
+        aiAnimMesh* anim = pMesh->mAnimMeshes[i];
+        if (anim->mNumVertices != pMesh->mNumVertices) {
+            continue;
+        }
+        PermuteVertexArray(anim->mVertices,remap);
+        PermuteVertexArray(anim->mNormals,remap);
+        PermuteVertexArray(anim->mTangents,remap);
+        PermuteVertexArray(anim->mBitangents,remap);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+            PermuteVertexArray(anim->mColors[c],remap);
+        }
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+            PermuteVertexArray(anim->mTextureCoords[c],remap);
+        }
+    }
 }
@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "BaseProcess.h"
 #include <assimp/types.h>
+#include <string>
 
 struct aiMesh;
 
@@ -56,9 +57,14 @@ namespace Assimp
  *  cache locality. It tries to arrange all faces to fans and to render
  *  faces which share vertices directly one after the other.
  *
+ *  Two algorithms are available, see #AI_CONFIG_PP_ICL_ALGORITHM. The
+ *  vertices can be renumbered in the order they are first used afterwards,
+ *  which improves the locality of vertex fetches. Meshes are processed in
+ *  parallel.
+ *
  *  @note This step expects triagulated input data.
  */
-class ImproveCacheLocalityProcess : public BaseProcess
+class ASSIMP_API ImproveCacheLocalityProcess : public BaseProcess
 {
 public:
 
@@ -79,18 +85,82 @@ public:
     // Configures the pp step
     void SetupProperties(const Importer* pImp);
 
+    // -------------------------------------------------------------------
+    /** Simulates a FIFO post-transform vertex cache on a triangle mesh.
+     * @param pMesh The mesh, rendered in face order.
+     * @param cacheSize Number of vertices the cache holds.
+     * @return Number of cache misses. Divided by the number of faces, this
+     *   is the ACMR (average cache miss ratio, 0.5 to 3). Divided by the
+     *   number of vertices, it is the ATVR (average transformed vertex
+     *   ratio, 1 is optimal).
+     */
+    static unsigned int CountCacheMisses(const aiMesh* pMesh, unsigned int cacheSize);
+
+    // -------------------------------------------------------------------
+    /** Renumbers the vertices of a mesh in the order they are first
+     *  referenced by its faces. Unreferenced vertices are moved to the end.
+     *  All per-vertex data, bone weights and animation meshes are
+     *  reordered accordingly.
+     * @param pMesh The mesh to process.
+     */
+    static void ReorderVertices(aiMesh* pMesh);
+
 protected:
+    //! Outcome of processing a single mesh, logged by Execute()
+    struct MeshReport {
+        enum Status {
+            Skipped,
+            NotTriangulated,
+            Unsuitable,
+            Optimized
+        };
+
+        MeshReport()
+            : status(Skipped), missesIn(), missesOut()
+        {}
+
+        Status status;
+        unsigned int missesIn;
+        unsigned int missesOut;
+        std::string error;
+    };
+
     // -------------------------------------------------------------------
     /** Executes the postprocessing step on the given mesh
      * @param pMesh The mesh to process.
-     * @param meshNum Index of the mesh to process
+     * @param report Receives the outcome and the cache statistics, which
+     *   are only computed if logging is enabled.
      */
-    float ProcessMesh( aiMesh* pMesh, unsigned int meshNum);
+    void ProcessMesh( aiMesh* pMesh, MeshReport& report) const;
+
+    // -------------------------------------------------------------------
+    /** Reorders faces with the 'tipsify' algorithm
+     * @param pMesh The mesh to process, remains unchanged.
+     * @param piIBOutput Receives the reordered indices, three per face.
+     */
+    void OptimizeTipsify( aiMesh* pMesh, unsigned int* piIBOutput) const;
+
+    // -------------------------------------------------------------------
+    /** Reorders faces with Tom Forsyth's linear-speed algorithm
+     * @param pMesh The mesh to process, remains unchanged.
+     * @param piIBOutput Receives the reordered indices, three per face.
+     */
+    void OptimizeForsyth( aiMesh* pMesh, unsigned int* piIBOutput) const;
 
 private:
     //! Configuration parameter: specifies the size of the cache to
     //! optimize the vertex data for.
     unsigned int configCacheDepth;
+
+    //! Configuration parameter: the algorithm to use,
+    //! one of the #aiCacheLocalityAlgorithm values.
+    int configAlgorithm;
+
+    //! Configuration parameter: renumber vertices in the order of use.
+    bool configReorderVertices;
+
+    //! Configuration parameter: number of threads, 0 for automatic.
+    unsigned int configThreads;
 };
 
 } // end of namespace Assimp
@@ -0,0 +1,239 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+/** @file  MappedIOStream.cpp
+ *  @brief Memory mapped file I/O implementation for #DefaultIOSystem
+ */
+
+#include <assimp/ai_assert.h>
+#include "MappedIOStream.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined( _WIN32 )
+#   include <windows.h>
+#   define AI_MAPPEDIO_SUPPORTED
+#elif defined( __unix__ ) || defined( __APPLE__ )
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define AI_MAPPEDIO_SUPPORTED
+#endif
+
+using namespace Assimp;
+
+// ----------------------------------------------------------------------------------
+MappedIOStream::MappedIOStream()
+    : mData (NULL)
+    , mSize (0)
+    , mPos  (0)
+#ifdef _WIN32
+    , mFile (NULL)
+    , mMapping (NULL)
+#endif
+{
+    // empty
+}
+
+// ----------------------------------------------------------------------------------
+MappedIOStream::~MappedIOStream()
+{
+#if defined( _WIN32 )
+    if (mData) {
+        ::UnmapViewOfFile(mData);
+    }
+    if (mMapping) {
+        ::CloseHandle(mMapping);
+    }
+    if (mFile) {
+        ::CloseHandle(mFile);
+    }
+#elif defined( AI_MAPPEDIO_SUPPORTED )
+    if (mData) {
+        ::munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+#endif
+}
+
+// ----------------------------------------------------------------------------------
+MappedIOStream* MappedIOStream::Open(const char* strFile)
+{
+    ai_assert(NULL != strFile);
+
+#if defined( _WIN32 )
+    HANDLE file = ::CreateFileA(strFile, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0 || static_cast<ULONGLONG>(size.QuadPart) > SIZE_MAX) {
+        ::CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = ::CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        ::CloseHandle(file);
+        return NULL;
+    }
+
+    const void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return NULL;
+    }
+
+    MappedIOStream* stream = new MappedIOStream();
+    stream->mData = static_cast<const uint8_t*>(data);
+    stream->mSize = static_cast<size_t>(size.QuadPart);
+    stream->mFile = file;
+    stream->mMapping = mapping;
+    return stream;
+
+#elif defined( AI_MAPPEDIO_SUPPORTED )
+    const int fd = ::open(strFile, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // empty files cannot be mapped, directories must not
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        return NULL;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+#   ifdef MADV_SEQUENTIAL
+    ::madvise(data, size, MADV_SEQUENTIAL);
+#   endif
+
+    MappedIOStream* stream = new MappedIOStream();
+    stream->mData = static_cast<const uint8_t*>(data);
+    stream->mSize = size;
+    return stream;
+
+#else
+    (void)strFile;
+    return NULL;
+#endif
+}
+
+// ----------------------------------------------------------------------------------
+size_t MappedIOStream::Read(void* pvBuffer,
+    size_t pSize,
+    size_t pCount)
+{
+    ai_assert(NULL != pvBuffer && 0 != pSize && 0 != pCount);
+
+    const size_t cnt = std::min(pCount, (mSize - mPos) / pSize), ofs = pSize * cnt;
+    ::memcpy(pvBuffer, mData + mPos, ofs);
+    mPos += ofs;
+
+    return cnt;
+}
+
+// ----------------------------------------------------------------------------------
+size_t MappedIOStream::Write(const void* /*pvBuffer*/,
+    size_t /*pSize*/,
+    size_t /*pCount*/)
+{
+    return 0;
+}
+
+// ----------------------------------------------------------------------------------
+aiReturn MappedIOStream::Seek(size_t pOffset,
+     aiOrigin pOrigin)
+{
+    // like fseek(), positioning the cursor at the end of the file is allowed
+    size_t pos;
+    switch (pOrigin) {
+    case aiOrigin_SET:
+        pos = pOffset;
+        break;
+    case aiOrigin_CUR:
+        pos = mPos + pOffset;
+        break;
+    case aiOrigin_END:
+        if (pOffset > mSize) {
+            return AI_FAILURE;
+        }
+        pos = mSize - pOffset;
+        break;
+    default:
+        return AI_FAILURE;
+    }
+
+    if (pos > mSize) {
+        return AI_FAILURE;
+    }
+    mPos = pos;
+    return AI_SUCCESS;
+}
+
+// ----------------------------------------------------------------------------------
+size_t MappedIOStream::Tell() const
+{
+    return mPos;
+}
+
+// ----------------------------------------------------------------------------------
+size_t MappedIOStream::FileSize() const
+{
+    return mSize;
+}
+
+// ----------------------------------------------------------------------------------
+void MappedIOStream::Flush()
+{
+    // read-only, nothing to do
+}
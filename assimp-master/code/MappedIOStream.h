@@ -0,0 +1,131 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+
+/** @file MappedIOStream.h
+ *  @brief Read-only file stream backed by a memory mapping of the file
+ */
+#ifndef AI_MAPPEDIOSTREAM_H_INC
+#define AI_MAPPEDIOSTREAM_H_INC
+
+#include <assimp/IOStream.hpp>
+#include <stdint.h>
+#include <string>
+#include "Defines.h"
+
+namespace Assimp    {
+
+// ----------------------------------------------------------------------------------
+//! @class  MappedIOStream
+//! @brief  Read-only stream which maps the whole file into the address space.
+//!
+//! Reading from the stream is a plain memcpy from the mapping. Loaders which can
+//! parse a contiguous buffer can use GetData() to access the file contents without
+//! copying them first, see BaseImporter::GetStreamContents().
+//! @note   The mapping is not zero-terminated. Text parsers relying on a
+//!         terminating zero must still copy the data.
+class ASSIMP_API MappedIOStream : public IOStream
+{
+protected:
+    MappedIOStream();
+
+public:
+    /** Destructor public to allow simple deletion to unmap the file. */
+    ~MappedIOStream ();
+
+    // -------------------------------------------------------------------
+    /** Map a file into memory.
+     *  @param strFile Path to the file
+     *  @return The stream or NULL if the file does not exist, is empty
+     *    or mapping files is not supported on this platform. */
+    static MappedIOStream* Open(const char* strFile);
+
+    // -------------------------------------------------------------------
+    /// Read from stream
+    size_t Read(void* pvBuffer,
+        size_t pSize,
+        size_t pCount);
+
+    // -------------------------------------------------------------------
+    /// Write to stream, always fails as mappings are read-only
+    size_t Write(const void* pvBuffer,
+        size_t pSize,
+        size_t pCount);
+
+    // -------------------------------------------------------------------
+    /// Seek specific position
+    aiReturn Seek(size_t pOffset,
+        aiOrigin pOrigin);
+
+    // -------------------------------------------------------------------
+    /// Get current seek position
+    size_t Tell() const;
+
+    // -------------------------------------------------------------------
+    /// Get size of file
+    size_t FileSize() const;
+
+    // -------------------------------------------------------------------
+    /// Flush file contents, nothing to do for read-only streams
+    void Flush();
+
+    // -------------------------------------------------------------------
+    /// Get the mapped contents of the file, FileSize() bytes
+    const uint8_t* GetData() const {
+        return mData;
+    }
+
+private:
+    //  Start of the mapping
+    const uint8_t* mData;
+    //  Length of the mapping in bytes
+    size_t mSize;
+    //  Read cursor
+    size_t mPos;
+#ifdef _WIN32
+    //  Handles of the file and the file mapping object
+    void* mFile;
+    void* mMapping;
+#endif
+};
+
+} // ns assimp
+
+#endif //!!AI_MAPPEDIOSTREAM_H_INC
@@ -52,9 +52,161 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/material.h>
 #include <assimp/DefaultLogger.hpp>
 #include "Macros.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 using namespace Assimp;
 
+// ------------------------------------------------------------------------------------------------
+// Open addressing hash table from (key, semantic, index) to the position of the
+// property in aiMaterial::mProperties. Every change to the list marks it dirty, the
+// next lookup through aiGetMaterialProperty() rebuilds it. Lists which have been
+// modified without the setters are detected by their address and length.
+struct aiMaterial::PropertyIndex
+{
+    struct Slot {
+        uint32_t hash;
+        unsigned int position; // UINT_MAX for empty slots
+    };
+
+    std::vector<Slot> slots; // the size is a power of two
+
+    // the list the slots were built for, published after the slots
+    std::atomic<const aiMaterialProperty* const*> properties;
+    std::atomic<unsigned int> numProperties;
+    std::atomic<bool> dirty;
+
+    // serializes lazy rebuilds by concurrent readers of a const material
+    std::mutex rebuildMutex;
+
+    PropertyIndex()
+        : properties(NULL)
+        , numProperties(0)
+        , dirty(true)
+    {}
+
+    static uint32_t Hash(const char* key, unsigned int type, unsigned int index) {
+        uint32_t hash = SuperFastHash(key, (uint32_t)::strlen(key));
+        hash = SuperFastHash((const char*)&type, sizeof(unsigned int), hash);
+        return SuperFastHash((const char*)&index, sizeof(unsigned int), hash);
+    }
+
+    static bool Matches(const aiMaterialProperty* prop, const char* key, unsigned int type, unsigned int index) {
+        return prop && prop->mSemantic == type && prop->mIndex == index && 0 == strcmp(prop->mKey.data, key);
+    }
+
+    bool IsValidFor(const aiMaterial& mat) const {
+        return !dirty.load(std::memory_order_acquire)
+            && properties.load(std::memory_order_acquire) == mat.mProperties
+            && numProperties.load(std::memory_order_acquire) == mat.mNumProperties;
+    }
+
+    void Invalidate() {
+        dirty.store(true, std::memory_order_release);
+    }
+
+    // Rebuilds the table unless it is up to date. Safe to call from several
+    // threads reading the same material.
+    void Refresh(const aiMaterial& mat) {
+        if (IsValidFor(mat)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(rebuildMutex);
+        if (!IsValidFor(mat)) {
+            Rebuild(mat);
+        }
+    }
+
+    // Position of the first matching property, UINT_MAX if there is none.
+    // The table must be valid for mat.
+    unsigned int Find(const aiMaterial& mat, uint32_t hash, const char* key, unsigned int type, unsigned int index) const {
+        if (slots.empty()) {
+            return UINT_MAX;
+        }
+        const size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask; UINT_MAX != slots[i].position; i = (i + 1) & mask) {
+            if (slots[i].hash == hash && Matches(mat.mProperties[slots[i].position], key, type, index)) {
+                return slots[i].position;
+            }
+        }
+        return UINT_MAX;
+    }
+
+    // Records the property just appended to a list the table was valid for
+    void Add(const aiMaterial& mat, uint32_t hash) {
+        ai_assert(mat.mNumProperties == numProperties + 1);
+        if (slots.size() < 2 * mat.mNumProperties) {
+            Invalidate();
+            return;
+        }
+        Insert(hash, mat.mNumProperties - 1);
+        Publish(mat);
+    }
+
+private:
+    void Rebuild(const aiMaterial& mat) {
+        // invalid while the slots change
+        properties.store(NULL, std::memory_order_release);
+
+        // keep the load factor at 50% at most
+        size_t size = 8;
+        while (size < 2 * mat.mNumProperties) {
+            size *= 2;
+        }
+        const Slot empty = { 0, UINT_MAX };
+        slots.assign(size, empty);
+
+        for (unsigned int i = 0; i < mat.mNumProperties; ++i) {
+            const aiMaterialProperty* prop = mat.mProperties[i];
+            if (!prop) {
+                continue;
+            }
+            // the first of several equal properties wins, like in a linear search
+            const uint32_t hash = Hash(prop->mKey.data, prop->mSemantic, prop->mIndex);
+            if (UINT_MAX == Find(mat, hash, prop->mKey.data, prop->mSemantic, prop->mIndex)) {
+                Insert(hash, i);
+            }
+        }
+        Publish(mat);
+    }
+
+    void Publish(const aiMaterial& mat) {
+        numProperties.store(mat.mNumProperties, std::memory_order_release);
+        properties.store(mat.mProperties, std::memory_order_release);
+        dirty.store(false, std::memory_order_release);
+    }
+
+    void Insert(uint32_t hash, unsigned int position) {
+        const size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (UINT_MAX != slots[i].position) {
+            i = (i + 1) & mask;
+        }
+        slots[i].hash = hash;
+        slots[i].position = position;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Position of the first property matching exactly, UINT_MAX if there is none. Uses the
+// index if it is up to date and searches linearly otherwise, so a series of changes
+// doesn't rebuild the index after each one.
+static unsigned int FindPropertyPosition(const aiMaterial* pMat, const char* pKey,
+    unsigned int type, unsigned int index)
+{
+    const aiMaterial::PropertyIndex* propIndex = pMat->mPropertyIndex;
+    if (propIndex && propIndex->IsValidFor(*pMat)) {
+        return propIndex->Find(*pMat, aiMaterial::PropertyIndex::Hash(pKey, type, index), pKey, type, index);
+    }
+    for (unsigned int i = 0; i < pMat->mNumProperties; ++i) {
+        if (aiMaterial::PropertyIndex::Matches(pMat->mProperties[i], pKey, type, index)) {
+            return i;
+        }
+    }
+    return UINT_MAX;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Get a specific property from a material
 aiReturn aiGetMaterialProperty(const aiMaterial* pMat,
@@ -67,10 +219,21 @@ aiReturn aiGetMaterialProperty(const aiMaterial* pMat,
     ai_assert (pKey != NULL);
     ai_assert (pPropOut != NULL);
 
+    // Exact queries go to the hashed index, which is rebuilt here if the list changed
+    aiMaterial::PropertyIndex* propIndex = pMat->mPropertyIndex;
+    if (propIndex && UINT_MAX != type && UINT_MAX != index) {
+        propIndex->Refresh(*pMat);
+        const unsigned int i = propIndex->Find(*pMat, aiMaterial::PropertyIndex::Hash(pKey, type, index), pKey, type, index);
+        if (UINT_MAX != i) {
+            *pPropOut = pMat->mProperties[i];
+            return AI_SUCCESS;
+        }
+        *pPropOut = NULL;
+        return AI_FAILURE;
+    }
+
     /*  Just search for a property with exactly this name ..
-     *  could be improved by hashing, but it's possibly
-     *  no worth the effort (we're bound to C structures,
-     *  thus std::map or derivates are not applicable. */
+     *  (a wildcard is used) */
     for (unsigned int i = 0; i < pMat->mNumProperties;++i) {
         aiMaterialProperty* prop = pMat->mProperties[i];
 
@@ -389,6 +552,9 @@ aiMaterial::aiMaterial()
     mNumProperties = 0;
     mNumAllocated = 5;
     mProperties = new aiMaterialProperty*[5];
+
+    // the index is created by the first property added and built by the first lookup
+    mPropertyIndex = NULL;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -397,6 +563,16 @@ aiMaterial::~aiMaterial()
     Clear();
 
     delete[] mProperties;
+    delete mPropertyIndex;
+}
+
+// ------------------------------------------------------------------------------------------------
+void aiMaterial::UpdatePropertyIndex()
+{
+    if (!mPropertyIndex) {
+        mPropertyIndex = new PropertyIndex();
+    }
+    mPropertyIndex->Invalidate();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -410,6 +586,9 @@ void aiMaterial::Clear()
     mNumProperties = 0;
 
     // The array remains allocated, we just invalidated its contents
+    if (mPropertyIndex) {
+        mPropertyIndex->Invalidate();
+    }
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -419,25 +598,24 @@ aiReturn aiMaterial::RemoveProperty (const char* pKey,unsigned int type,
 {
     ai_assert(NULL != pKey);
 
-    for (unsigned int i = 0; i < mNumProperties;++i) {
-        aiMaterialProperty* prop = mProperties[i];
+    // no rebuild of the index here, so removing many properties stays linear per call
+    const unsigned int i = FindPropertyPosition(this, pKey, type, index);
+    if (UINT_MAX == i) {
+        return AI_FAILURE;
+    }
 
-        if (prop && !strcmp( prop->mKey.data, pKey ) &&
-            prop->mSemantic == type && prop->mIndex == index)
-        {
-            // Delete this entry
-            delete mProperties[i];
+    // Delete this entry
+    delete mProperties[i];
 
-            // collapse the array behind --.
-            --mNumProperties;
-            for (unsigned int a = i; a < mNumProperties;++a)    {
-                mProperties[a] = mProperties[a+1];
-            }
-            return AI_SUCCESS;
-        }
+    // collapse the array behind --.
+    --mNumProperties;
+    for (unsigned int a = i; a < mNumProperties;++a)    {
+        mProperties[a] = mProperties[a+1];
     }
 
-    return AI_FAILURE;
+    // the positions behind have changed
+    UpdatePropertyIndex();
+    return AI_SUCCESS;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -453,17 +631,16 @@ aiReturn aiMaterial::AddBinaryProperty (const void* pInput,
     ai_assert (pKey != NULL);
     ai_assert (0 != pSizeInBytes);
 
-    // first search the list whether there is already an entry with this key
-    unsigned int iOutIndex = UINT_MAX;
-    for (unsigned int i = 0; i < mNumProperties;++i)    {
-        aiMaterialProperty* prop = mProperties[i];
-
-        if (prop /* just for safety */ && !strcmp( prop->mKey.data, pKey ) &&
-            prop->mSemantic == type && prop->mIndex == index){
-
-            delete mProperties[i];
-            iOutIndex = i;
-        }
+    // first search the list whether there is already an entry with this key,
+    // this is a lookup like any other and rebuilds the index if it is dirty
+    if (!mPropertyIndex) {
+        mPropertyIndex = new PropertyIndex();
+    }
+    mPropertyIndex->Refresh(*this);
+    const uint32_t hash = PropertyIndex::Hash(pKey, type, index);
+    const unsigned int iOutIndex = mPropertyIndex->Find(*this, hash, pKey, type, index);
+    if (UINT_MAX != iOutIndex) {
+        delete mProperties[iOutIndex];
     }
 
     // Allocate a new material property
@@ -484,6 +661,7 @@ aiReturn aiMaterial::AddBinaryProperty (const void* pInput,
 
     if (UINT_MAX != iOutIndex)  {
         mProperties[iOutIndex] = pcNew;
+        UpdatePropertyIndex();
         return AI_SUCCESS;
     }
 
@@ -508,6 +686,9 @@ aiReturn aiMaterial::AddBinaryProperty (const void* pInput,
     }
     // push back ...
     mProperties[mNumProperties++] = pcNew;
+
+    // recording an append is cheaper than a rebuild, unless the table has to grow
+    mPropertyIndex->Add(*this, hash);
     return AI_SUCCESS;
 }
 
@@ -617,5 +798,6 @@ void aiMaterial::CopyPropertyList(aiMaterial* pcDest,
         prop->mData = new char[propSrc->mDataLength];
         memcpy(prop->mData,propSrc->mData,prop->mDataLength);
     }
+    pcDest->UpdatePropertyIndex();
     return;
 }
@@ -135,6 +135,12 @@ public:
         ai_assert(false); // won't be needed
     }
 
+    // -------------------------------------------------------------------
+    // Get the underlying buffer, FileSize() bytes
+    const uint8_t* GetBuffer() const {
+        return buffer;
+    }
+
 private:
     const uint8_t* buffer;
     size_t length,pos;
@@ -47,6 +47,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ObjFileData.h"
 #include "IOStreamBuffer.h"
 #include <memory>
+#include <algorithm>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/ai_assert.h>
@@ -76,7 +77,8 @@ using namespace std;
 ObjFileImporter::ObjFileImporter() :
     m_Buffer(),
     m_pRootObject( NULL ),
-    m_strAbsPath( "" )
+    m_strAbsPath( "" ),
+    m_parseThreads( 0 )
 {
     DefaultIOSystem io;
     m_strAbsPath = io.getOsSeparator();
@@ -111,6 +113,13 @@ const aiImporterDesc* ObjFileImporter::GetInfo () const
     return &desc;
 }
 
+// ------------------------------------------------------------------------------------------------
+//  Setup configuration properties for the loader
+void ObjFileImporter::SetupProperties(const Importer* pImp)
+{
+    m_parseThreads = static_cast<unsigned int>( std::max( 0, pImp->GetPropertyInteger( AI_CONFIG_IMPORT_OBJ_PARSE_THREADS, 0 ) ) );
+}
+
 // ------------------------------------------------------------------------------------------------
 //  Obj-file import implementation
 void ObjFileImporter::InternReadFile( const std::string &file, aiScene* pScene, IOSystem* pIOHandler) {
@@ -179,7 +188,7 @@ void ObjFileImporter::InternReadFile( const std::string &file, aiScene* pScene,
     m_progress->UpdateFileRead(1, 3);
 
     // parse the file into a temporary representation
-    ObjFileParser parser( streamedBuffer, modelName, pIOHandler, m_progress, file);
+    ObjFileParser parser( streamedBuffer, modelName, pIOHandler, m_progress, file, m_parseThreads );
 
     // And create the proper return structures out of it
     CreateDataFromImport(parser.GetModel(), pScene);
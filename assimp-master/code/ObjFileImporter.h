@@ -75,6 +75,9 @@ private:
     //! \brief  Appends the supported extension.
     const aiImporterDesc* GetInfo () const;
 
+    //! \brief  Setup configuration properties for the loader.
+    void SetupProperties(const Importer* pImp);
+
     //! \brief  File import implementation.
     void InternReadFile(const std::string& pFile, aiScene* pScene, IOSystem* pIOHandler);
 
@@ -112,6 +115,8 @@ private:
     ObjFile::Object *m_pRootObject;
     //! Absolute pathname of model in file system
     std::string m_strAbsPath;
+    //! Number of parser threads, see AI_CONFIG_IMPORT_OBJ_PARSE_THREADS
+    unsigned int m_parseThreads;
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -47,27 +47,122 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ParsingUtils.h"
 #include "DefaultIOSystem.h"
 #include "BaseImporter.h"
+#include "ThreadPool.h"
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/material.h>
 #include <assimp/Importer.hpp>
 #include <cstdlib>
+#include <algorithm>
+#include <memory>
 
 namespace Assimp {
 
 const std::string ObjFileParser::DEFAULT_MATERIAL = AI_DEFAULT_MATERIAL_NAME;
 
+// Files from this size on are parsed on all hardware threads by default
+static const size_t ParallelParseMinSize = 1024 * 1024;
+
+// -------------------------------------------------------------------
+//  Appends the elements [pos, count) of src to dest.
+template<class T>
+static void appendRange( std::vector<T> &dest, const std::vector<T> &src, size_t &pos, size_t count ) {
+    dest.insert( dest.end(), src.begin() + pos, src.begin() + count );
+    pos = count;
+}
+
+// -------------------------------------------------------------------
+//  A range of the file parsed on a worker thread. The vertex data goes
+//  into the model of the chunk parser, all other statements are recorded
+//  with the vertex counts at their position so the serial pass can merge
+//  the vertex data and replay them in file order.
+struct ObjFileParser::Chunk {
+    struct Line {
+        const char *data;
+        size_t length;
+        size_t numVertices;
+        size_t numColors;
+        size_t numTexCoords;
+        size_t numNormals;
+        //! Face parsed in advance, NULL if the line is replayed
+        ObjFile::Face *face;
+        bool hasNormal;
+    };
+
+    Chunk( const char *fileBegin_, const char *fileEnd_, const char *begin_, const char *end_,
+            size_t cacheSize_, const std::string &originalObjFileName ) :
+        fileBegin( fileBegin_ ),
+        fileEnd( fileEnd_ ),
+        begin( begin_ ),
+        end( end_ ),
+        cacheSize( cacheSize_ ),
+        vertexBase( 0 ),
+        texCoordBase( 0 ),
+        normalBase( 0 ),
+        parser( originalObjFileName )
+    {
+        // empty
+    }
+
+    ~Chunk() {
+        for ( std::vector<Line>::iterator it = lines.begin(); it != lines.end(); ++it ) {
+            delete it->face;
+        }
+    }
+
+    void addLine( const char *data, size_t length, const ObjFile::Model *model ) {
+        Line line;
+        line.data = data;
+        line.length = length;
+        line.numVertices = model->m_Vertices.size();
+        line.numColors = model->m_VertexColors.size();
+        line.numTexCoords = model->m_TextureCoord.size();
+        line.numNormals = model->m_Normals.size();
+        line.face = NULL;
+        line.hasNormal = false;
+        lines.push_back( line );
+    }
+
+    //  Size of the buffer IOStreamBuffer::getNextLine() passes for a line,
+    //  it shrinks to the size of the last block once that has been read.
+    size_t getLineBufferSize( const char *line ) const {
+        const size_t fileSize = fileEnd - fileBegin;
+        const size_t lastBlockSize = fileSize % cacheSize;
+        if ( lastBlockSize > 0 && size_t( line - fileBegin ) > fileSize - lastBlockSize ) {
+            return lastBlockSize;
+        }
+        return cacheSize;
+    }
+
+    const char *fileBegin;
+    const char *fileEnd;
+    //! The chunk holds the lines starting in [begin, end)
+    const char *begin;
+    const char *end;
+    size_t cacheSize;
+    //! Vertex counts of the preceding chunks
+    size_t vertexBase;
+    size_t texCoordBase;
+    size_t normalBase;
+    std::vector<Line> lines;
+    ObjFileParser parser;
+};
+
 // -------------------------------------------------------------------
 //  Constructor with loaded data and directories.
 ObjFileParser::ObjFileParser( IOStreamBuffer<char> &streamBuffer, const std::string &modelName, 
                               IOSystem *io, ProgressHandler* progress,
-                              const std::string &originalObjFileName) :
+                              const std::string &originalObjFileName,
+                              unsigned int numThreads ) :
     m_DataIt(),
     m_DataItEnd(),
     m_pModel(NULL),
     m_uiLine(0),
     m_pIO( io ),
     m_progress(progress),
-    m_originalObjFileName(originalObjFileName)
+    m_originalObjFileName(originalObjFileName),
+    m_lineBuffer(),
+    m_isChunkParser(false),
+    m_hasErrors(false)
 {
     std::fill_n(m_buffer,Buffersize,0);
 
@@ -82,7 +177,33 @@ ObjFileParser::ObjFileParser( IOStreamBuffer<char> &streamBuffer, const std::str
     m_pModel->m_MaterialMap[ DEFAULT_MATERIAL ] = m_pModel->m_pDefaultMaterial;
 
     // Start parsing the file
-    parseFile( streamBuffer );
+    if ( 0 == numThreads ) {
+        numThreads = streamBuffer.size() >= ParallelParseMinSize ? ThreadPool::GetHardwareThreadCount() : 1;
+    }
+    if ( numThreads > 1 && NULL != streamBuffer.getMappedData() ) {
+        parseFileParallel( streamBuffer, numThreads );
+    } else {
+        parseFile( streamBuffer );
+    }
+}
+
+// -------------------------------------------------------------------
+//  Constructor for the parsers of the chunks of a parallel parse.
+ObjFileParser::ObjFileParser( const std::string &originalObjFileName ) :
+    m_DataIt(),
+    m_DataItEnd(),
+    m_pModel(NULL),
+    m_uiLine(0),
+    m_pIO( NULL ),
+    m_progress( NULL ),
+    m_originalObjFileName(originalObjFileName),
+    m_lineBuffer(),
+    m_isChunkParser(true),
+    m_hasErrors(false)
+{
+    std::fill_n(m_buffer,Buffersize,0);
+
+    m_pModel = new ObjFile::Model();
 }
 
 // -------------------------------------------------------------------
@@ -129,102 +250,275 @@ void ObjFileParser::parseFile( IOStreamBuffer<char> &streamBuffer ) {
             m_progress->UpdateFileRead( progressOffset + processed * 2, progressTotal );
         }
 
-        // parse line
-        switch (*m_DataIt)
-        {
-        case 'v': // Parse a vertex texture coordinate
-            {
-                ++m_DataIt;
-                if (*m_DataIt == ' ' || *m_DataIt == '\t') {
-                    size_t numComponents = getNumComponentsInLine();
-                    if (numComponents == 3) {
-                        // read in vertex definition
-                        getVector3(m_pModel->m_Vertices);
-                    } else if (numComponents == 4) {
-                        // read in vertex definition (homogeneous coords)
-                        getHomogeneousVector3(m_pModel->m_Vertices);
-                    } else if (numComponents == 6) {
-                        // read vertex and vertex-color
-                        getTwoVectors3(m_pModel->m_Vertices, m_pModel->m_VertexColors);
-                    }
-                } else if (*m_DataIt == 't') {
-                    // read in texture coordinate ( 2D or 3D )
-                    ++m_DataIt;
-                    getVector( m_pModel->m_TextureCoord );
-                } else if (*m_DataIt == 'n') {
-                    // Read in normal vector definition
-                    ++m_DataIt;
-                    getVector3( m_pModel->m_Normals );
-                }
+        parseLine();
+    }
+}
+
+// -------------------------------------------------------------------
+//  File parsing method for memory backed streams. The vertex data and
+//  the faces are parsed in chunks on several threads, the remaining
+//  statements are replayed in file order to build the exact same model
+//  as parseFile().
+void ObjFileParser::parseFileParallel( IOStreamBuffer<char> &streamBuffer, unsigned int numThreads ) {
+    const char *data = streamBuffer.getMappedData();
+    const size_t size = streamBuffer.size();
+    const unsigned int progressTotal = 3 * size;
+    const unsigned int progressOffset = size;
+
+    // a few chunks per thread even out the differing costs of the statements
+    const size_t numChunks = std::min<size_t>( size, numThreads * 4 );
+    std::vector<std::unique_ptr<Chunk> > chunks;
+    chunks.reserve( numChunks );
+    for ( size_t i = 0; i < numChunks; ++i ) {
+        chunks.push_back( std::unique_ptr<Chunk>( new Chunk( data, data + size,
+            data + size * i / numChunks, data + size * ( i + 1 ) / numChunks,
+            streamBuffer.cacheSize(), m_originalObjFileName ) ) );
+    }
+
+    {
+        ThreadPool pool( numThreads );
+        for ( size_t i = 0; i < numChunks; ++i ) {
+            Chunk *chunk = chunks[ i ].get();
+            pool.Enqueue( [chunk]() { chunk->parser.parseChunkVertices( *chunk ); } );
+        }
+        pool.WaitIdle();
+
+        // the faces need the vertex counts of the whole file up to their position
+        size_t numVertices = 0, numTexCoords = 0, numNormals = 0;
+        for ( size_t i = 0; i < numChunks; ++i ) {
+            Chunk *chunk = chunks[ i ].get();
+            chunk->vertexBase = numVertices;
+            chunk->texCoordBase = numTexCoords;
+            chunk->normalBase = numNormals;
+            numVertices += chunk->parser.m_pModel->m_Vertices.size();
+            numTexCoords += chunk->parser.m_pModel->m_TextureCoord.size();
+            numNormals += chunk->parser.m_pModel->m_Normals.size();
+            pool.Enqueue( [chunk]() { chunk->parser.parseChunkFaces( *chunk ); } );
+        }
+        m_pModel->m_Vertices.reserve( numVertices );
+        m_pModel->m_TextureCoord.reserve( numTexCoords );
+        m_pModel->m_Normals.reserve( numNormals );
+        pool.WaitIdle();
+    }
+
+    for ( size_t i = 0; i < numChunks; ++i ) {
+        Chunk &chunk = *chunks[ i ];
+        const ObjFile::Model *model = chunk.parser.m_pModel;
+        size_t numVertices = 0, numColors = 0, numTexCoords = 0, numNormals = 0;
+        for ( std::vector<Chunk::Line>::iterator it = chunk.lines.begin(); it != chunk.lines.end(); ++it ) {
+            appendRange( m_pModel->m_Vertices, model->m_Vertices, numVertices, it->numVertices );
+            appendRange( m_pModel->m_VertexColors, model->m_VertexColors, numColors, it->numColors );
+            appendRange( m_pModel->m_TextureCoord, model->m_TextureCoord, numTexCoords, it->numTexCoords );
+            appendRange( m_pModel->m_Normals, model->m_Normals, numNormals, it->numNormals );
+
+            if ( NULL != it->face ) {
+                storeFace( it->face, it->hasNormal );
+                it->face = NULL;
+            } else {
+                setLine( m_lineBuffer, it->data, it->length, chunk.getLineBufferSize( it->data ) );
+                parseLine();
+            }
+        }
+        appendRange( m_pModel->m_Vertices, model->m_Vertices, numVertices, model->m_Vertices.size() );
+        appendRange( m_pModel->m_VertexColors, model->m_VertexColors, numColors, model->m_VertexColors.size() );
+        appendRange( m_pModel->m_TextureCoord, model->m_TextureCoord, numTexCoords, model->m_TextureCoord.size() );
+        appendRange( m_pModel->m_Normals, model->m_Normals, numNormals, model->m_Normals.size() );
+
+        m_progress->UpdateFileRead( progressOffset + ( chunk.end - data ) * 2, progressTotal );
+        chunks[ i ].reset();
+    }
+}
+
+// -------------------------------------------------------------------
+//  Parses the vertex data of a chunk into the model of this chunk parser.
+void ObjFileParser::parseChunkVertices( Chunk &chunk ) {
+    // skip the tail of the line the previous chunk holds
+    const char *line = chunk.begin;
+    if ( line != chunk.fileBegin ) {
+        while ( line < chunk.end && !IsLineEnd( line[ -1 ] ) ) {
+            ++line;
+        }
+    }
+
+    while ( line < chunk.end ) {
+        const char *lineEnd = line;
+        while ( lineEnd != chunk.fileEnd && !IsLineEnd( *lineEnd ) ) {
+            ++lineEnd;
+        }
+        if ( lineEnd == chunk.fileEnd ) {
+            // IOStreamBuffer drops a last line without line end
+            break;
+        }
+        const size_t length = lineEnd - line;
+
+        switch ( *line ) {
+        case 'v':
+            setLine( m_lineBuffer, line, length, chunk.getLineBufferSize( line ) );
+            try {
+                parseLine();
+            } catch ( const std::exception & ) {
+                // replay the statement to raise the error at its position
+                chunk.addLine( line, length, m_pModel );
             }
             break;
 
-        case 'p': // Parse a face, line or point statement
+        case 'p':
         case 'l':
         case 'f':
-            {
-                getFace(*m_DataIt == 'f' ? aiPrimitiveType_POLYGON : (*m_DataIt == 'l'
-                    ? aiPrimitiveType_LINE : aiPrimitiveType_POINT));
-            }
+        case 'u':
+        case 'm':
+        case 'g':
+        case 's':
+        case 'o':
+            chunk.addLine( line, length, m_pModel );
             break;
 
-        case '#': // Parse a comment
-            {
-                getComment();
-            }
+        default:
+            // comments and unknown statements have no effect
             break;
+        }
+        line = lineEnd + 1;
+    }
+}
 
-        case 'u': // Parse a material desc. setter
-            {
-                getMaterialDesc();
+// -------------------------------------------------------------------
+//  Parses the faces of a chunk, faces which report errors are replayed.
+void ObjFileParser::parseChunkFaces( Chunk &chunk ) {
+    for ( std::vector<Chunk::Line>::iterator it = chunk.lines.begin(); it != chunk.lines.end(); ++it ) {
+        const char type = *it->data;
+        if ( type != 'f' && type != 'l' && type != 'p' ) {
+            continue;
+        }
+
+        setLine( m_lineBuffer, it->data, it->length, chunk.getLineBufferSize( it->data ) );
+        it->face = parseFace( type == 'f' ? aiPrimitiveType_POLYGON : ( type == 'l'
+            ? aiPrimitiveType_LINE : aiPrimitiveType_POINT ),
+            int( chunk.vertexBase + it->numVertices ),
+            int( chunk.texCoordBase + it->numTexCoords ),
+            int( chunk.normalBase + it->numNormals ), it->hasNormal );
+        if ( m_hasErrors ) {
+            delete it->face;
+            it->face = NULL;
+            m_hasErrors = false;
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+void ObjFileParser::setLine( DataArray &buffer, const char *line, size_t length, size_t bufferSize ) {
+    // clear the previous line
+    for ( DataArrayIt it = buffer.begin(); it != buffer.end() && !IsLineEnd( *it ); ++it ) {
+        *it = '\n';
+    }
+
+    // the statements never look further than a helper buffer behind the line
+    const size_t size = std::max( std::min( bufferSize, length + Buffersize + 1 ), length + 1 );
+    if ( buffer.size() < size ) {
+        buffer.resize( size, '\n' );
+    }
+    std::copy( line, line + length, buffer.begin() );
+    m_DataIt = buffer.begin();
+    m_DataItEnd = buffer.begin() + size;
+}
+
+// -------------------------------------------------------------------
+//  Line parsing method.
+void ObjFileParser::parseLine() {
+    // parse line
+    switch (*m_DataIt)
+    {
+    case 'v': // Parse a vertex texture coordinate
+        {
+            ++m_DataIt;
+            if (*m_DataIt == ' ' || *m_DataIt == '\t') {
+                size_t numComponents = getNumComponentsInLine();
+                if (numComponents == 3) {
+                    // read in vertex definition
+                    getVector3(m_pModel->m_Vertices);
+                } else if (numComponents == 4) {
+                    // read in vertex definition (homogeneous coords)
+                    getHomogeneousVector3(m_pModel->m_Vertices);
+                } else if (numComponents == 6) {
+                    // read vertex and vertex-color
+                    getTwoVectors3(m_pModel->m_Vertices, m_pModel->m_VertexColors);
+                }
+            } else if (*m_DataIt == 't') {
+                // read in texture coordinate ( 2D or 3D )
+                ++m_DataIt;
+                getVector( m_pModel->m_TextureCoord );
+            } else if (*m_DataIt == 'n') {
+                // Read in normal vector definition
+                ++m_DataIt;
+                getVector3( m_pModel->m_Normals );
             }
-            break;
+        }
+        break;
 
-        case 'm': // Parse a material library or merging group ('mg')
-            {
-                std::string name;
+    case 'p': // Parse a face, line or point statement
+    case 'l':
+    case 'f':
+        {
+            getFace(*m_DataIt == 'f' ? aiPrimitiveType_POLYGON : (*m_DataIt == 'l'
+                ? aiPrimitiveType_LINE : aiPrimitiveType_POINT));
+        }
+        break;
+
+    case '#': // Parse a comment
+        {
+            getComment();
+        }
+        break;
+
+    case 'u': // Parse a material desc. setter
+        {
+            getMaterialDesc();
+        }
+        break;
+
+    case 'm': // Parse a material library or merging group ('mg')
+        {
+            std::string name;
 
-                getName(m_DataIt, m_DataItEnd, name);
+            getName(m_DataIt, m_DataItEnd, name);
 
-                size_t nextSpace = name.find(" ");
-                if (nextSpace != std::string::npos)
-                    name = name.substr(0, nextSpace);
+            size_t nextSpace = name.find(" ");
+            if (nextSpace != std::string::npos)
+                name = name.substr(0, nextSpace);
 
-                if (name == "mg")
-                    getGroupNumberAndResolution();
-                else if(name == "mtllib")
-                    getMaterialLib();
+            if (name == "mg")
+                getGroupNumberAndResolution();
+            else if(name == "mtllib")
+                getMaterialLib();
 				else
 					goto pf_skip_line;
-            }
-            break;
+        }
+        break;
 
-        case 'g': // Parse group name
-            {
-                getGroupName();
-            }
-            break;
+    case 'g': // Parse group name
+        {
+            getGroupName();
+        }
+        break;
 
-        case 's': // Parse group number
-            {
-                getGroupNumber();
-            }
-            break;
+    case 's': // Parse group number
+        {
+            getGroupNumber();
+        }
+        break;
 
-        case 'o': // Parse object name
-            {
-                getObjectName();
-            }
-            break;
+    case 'o': // Parse object name
+        {
+            getObjectName();
+        }
+        break;
 
-        default:
-            {
+    default:
+        {
 pf_skip_line:
 
-                m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
-            }
-            break;
+            m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
         }
+        break;
     }
 }
 
@@ -404,25 +698,32 @@ static const std::string DefaultObjName = "defaultobject";
 // -------------------------------------------------------------------
 //  Get values for a new face instance
 void ObjFileParser::getFace(aiPrimitiveType type) {
+    bool hasNormal = false;
+    ObjFile::Face *face = parseFace( type, m_pModel->m_Vertices.size(), m_pModel->m_TextureCoord.size(),
+        m_pModel->m_Normals.size(), hasNormal );
+    if ( NULL != face ) {
+        storeFace( face, hasNormal );
+    }
+}
+
+// -------------------------------------------------------------------
+//  Parse a face, relative indices refer to the given vertex counts.
+ObjFile::Face *ObjFileParser::parseFace(aiPrimitiveType type, int vSize, int vtSize, int vnSize, bool &hasNormal) {
     copyNextLine(m_buffer, Buffersize);
     char *pPtr = m_buffer;
     char *pEnd = &pPtr[Buffersize];
     pPtr = getNextToken<char*>(pPtr, pEnd);
     if ( pPtr == pEnd || *pPtr == '\0' ) {
-        return;
+        return NULL;
     }
 
     std::vector<unsigned int> *pIndices = new std::vector<unsigned int>;
     std::vector<unsigned int> *pTexID = new std::vector<unsigned int>;
     std::vector<unsigned int> *pNormalID = new std::vector<unsigned int>;
-    bool hasNormal = false;
+    hasNormal = false;
 
-    const int vSize = m_pModel->m_Vertices.size();
-    const int vtSize = m_pModel->m_TextureCoord.size();
-    const int vnSize = m_pModel->m_Normals.size();
-
-    const bool vt = (!m_pModel->m_TextureCoord.empty());
-    const bool vn = (!m_pModel->m_Normals.empty());
+    const bool vt = (vtSize > 0);
+    const bool vn = (vnSize > 0);
     int iStep = 0, iPos = 0;
     while (pPtr != pEnd) {
         iStep = 1;
@@ -433,7 +734,7 @@ void ObjFileParser::getFace(aiPrimitiveType type) {
 
         if (*pPtr=='/' ) {
             if (type == aiPrimitiveType_POINT) {
-                DefaultLogger::get()->error("Obj: Separator unexpected in point statement");
+                reportError("Obj: Separator unexpected in point statement");
             }
             if (iPos == 0) {
                 //if there are no texture coordinates in the file, but normals
@@ -505,18 +806,25 @@ void ObjFileParser::getFace(aiPrimitiveType type) {
     }
 
     if ( pIndices->empty() ) {
-        DefaultLogger::get()->error("Obj: Ignoring empty face");
+        reportError("Obj: Ignoring empty face");
         // skip line and clean up
         m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
         delete pNormalID;
         delete pTexID;
         delete pIndices;
 
-        return;
+        return NULL;
     }
 
-    ObjFile::Face *face = new ObjFile::Face( pIndices, pNormalID, pTexID, type );
+    // Skip the rest of the line
+    m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
+
+    return new ObjFile::Face( pIndices, pNormalID, pTexID, type );
+}
 
+// -------------------------------------------------------------------
+//  Store a face in the current mesh
+void ObjFileParser::storeFace(ObjFile::Face *face, bool hasNormal) {
     // Set active material, if one set
     if( NULL != m_pModel->m_pCurrentMaterial ) {
         face->m_pMaterial = m_pModel->m_pCurrentMaterial;
@@ -541,8 +849,6 @@ void ObjFileParser::getFace(aiPrimitiveType type) {
     if( !m_pModel->m_pCurrentMesh->m_hasNormals && hasNormal ) {
         m_pModel->m_pCurrentMesh->m_hasNormals = true;
     }
-    // Skip the rest of the line
-    m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
 }
 
 // -------------------------------------------------------------------
@@ -889,7 +1195,19 @@ bool ObjFileParser::needsNewMesh( const std::string &materialName )
 void ObjFileParser::reportErrorTokenInFace()
 {
     m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
-    DefaultLogger::get()->error("OBJ: Not supported token in face description detected");
+    reportError("OBJ: Not supported token in face description detected");
+}
+
+// -------------------------------------------------------------------
+//  Logs an error, chunk parsers only flag it so the statement is replayed
+//  by the serial pass and the log keeps the file order.
+void ObjFileParser::reportError(const std::string &message)
+{
+    if ( m_isChunkParser ) {
+        m_hasErrors = true;
+    } else {
+        DefaultLogger::get()->error(message);
+    }
 }
 
 // -------------------------------------------------------------------
@@ -52,6 +52,7 @@ namespace Assimp {
 
 namespace ObjFile {
     struct Model;
+    struct Face;
     struct Object;
     struct Material;
     struct Point3;
@@ -73,15 +74,29 @@ public:
 
 public:
     /// \brief  Constructor with data array.
-    ObjFileParser( IOStreamBuffer<char> &streamBuffer, const std::string &strModelName, IOSystem* io, ProgressHandler* progress, const std::string &originalObjFileName);
+    /// \param  numThreads  Number of threads parsing a memory backed stream,
+    ///                     0 picks the hardware threads for large files.
+    ObjFileParser( IOStreamBuffer<char> &streamBuffer, const std::string &strModelName, IOSystem* io, ProgressHandler* progress, const std::string &originalObjFileName, unsigned int numThreads = 1);
     /// \brief  Destructor
     ~ObjFileParser();
     /// \brief  Model getter.
     ObjFile::Model *GetModel() const;
 
 private:
+    struct Chunk;
+
     /// Parse the loaded file
     void parseFile( IOStreamBuffer<char> &streamBuffer );
+    /// Parse the loaded file in chunks on several threads
+    void parseFileParallel( IOStreamBuffer<char> &streamBuffer, unsigned int numThreads );
+    /// Parse the vertex data of a chunk and collect the remaining statements
+    void parseChunkVertices( Chunk &chunk );
+    /// Parse the faces of a chunk
+    void parseChunkFaces( Chunk &chunk );
+    /// Parse the current line
+    void parseLine();
+    /// Load a line into a line buffer the way IOStreamBuffer::getNextLine does
+    void setLine( DataArray &buffer, const char *line, size_t length, size_t bufferSize );
     /// Method to copy the new delimited word in the current line.
     void copyNextWord(char *pBuffer, size_t length);
     /// Method to copy the new line.
@@ -98,6 +113,10 @@ private:
     void getVector2(std::vector<aiVector2D> &point2d_array);
     /// Stores the following face.
     void getFace(aiPrimitiveType type);
+    /// Parses the following face, NULL if it is ignored.
+    ObjFile::Face *parseFace(aiPrimitiveType type, int vSize, int vtSize, int vnSize, bool &hasNormal);
+    /// Stores a face in the current mesh.
+    void storeFace(ObjFile::Face *face, bool hasNormal);
     /// Reads the material description.
     void getMaterialDesc();
     /// Gets a comment.
@@ -124,6 +143,8 @@ private:
     bool needsNewMesh( const std::string &rMaterialName );
     /// Error report in token
     void reportErrorTokenInFace();
+    /// Error report, deferred to the serial pass for chunk parsers.
+    void reportError(const std::string &message);
     /// Get the number of components in a line.
     size_t getNumComponentsInLine();
 
@@ -133,6 +154,9 @@ private:
     ObjFileParser(const ObjFileParser& rhs);
     ObjFileParser& operator=(const ObjFileParser& rhs);
 
+    /// Constructor for the parsers of the chunks of a parallel parse
+    explicit ObjFileParser(const std::string &originalObjFileName);
+
     /// Default material name
     static const std::string DEFAULT_MATERIAL;
     //! Iterator to current position in buffer
@@ -152,6 +176,12 @@ private:
     /// Path to the current model
     // name of the obj file where the buffer comes from
     const std::string& m_originalObjFileName;
+    //! Line buffer of a chunk parser
+    DataArray m_lineBuffer;
+    //! True for the parsers of the chunks of a parallel parse
+    bool m_isChunkParser;
+    //! Set by reportError() on chunk parsers
+    bool m_hasErrors;
 };
 
 }   // Namespace Assimp
@@ -84,6 +84,29 @@ namespace
 
         return props[idx];
     }
+
+    // ------------------------------------------------------------------------------------------------
+    // Checks whether a buffer holds a complete binary PLY header. The header
+    // search is bounded, so the buffer needs not be zero-terminated.
+    bool IsBinaryPLY(const char* buffer, size_t size)
+    {
+        static const char token[] = "end_header";
+        const size_t tokenLen = sizeof(token) - 1;
+
+        bool binary = false;
+        for (size_t i = 0; i + tokenLen <= size; ++i) {
+            if (buffer[i] == '\0') {
+                return false;
+            }
+            if (i + 14 <= size && !::memcmp(buffer + i, "format binary_", 14)) {
+                binary = true;
+            }
+            else if (!::memcmp(buffer + i, token, tokenLen)) {
+                return binary;
+            }
+        }
+        return false;
+    }
 }
 
 
@@ -154,10 +177,19 @@ void PLYImporter::InternReadFile( const std::string& pFile,
         throw DeadlyImportError( "Failed to open PLY file " + pFile + ".");
     }
 
-    // allocate storage and copy the contents of the file to a memory buffer
+    // binary files are parsed in place if the stream is backed by memory,
+    // otherwise allocate storage and copy the contents of the file to a
+    // memory buffer
     std::vector<char> mBuffer2;
-    TextFileToBuffer(file.get(),mBuffer2);
-    mBuffer = (unsigned char*)&mBuffer2[0];
+    const char* mapped = reinterpret_cast<const char*>(GetStreamContents(file.get()));
+    if (mapped && file->FileSize() > 3 && IsBinaryPLY(mapped, file->FileSize())) {
+        // the parser never writes to the buffer
+        mBuffer = (unsigned char*)mapped;
+    }
+    else {
+        TextFileToBuffer(file.get(),mBuffer2);
+        mBuffer = (unsigned char*)&mBuffer2[0];
+    }
 
     // the beginning of the file must be PLY - magic, magic
     if ((mBuffer[0] != 'P' && mBuffer[0] != 'p') ||
@@ -120,6 +120,12 @@ corresponding preprocessor flag to selectively disable steps.
 #ifndef ASSIMP_BUILD_NO_DEBONE_PROCESS
 #   include "DeboneProcess.h"
 #endif
+#ifndef ASSIMP_BUILD_NO_GENMESHLETS_PROCESS
+#   include "GenMeshletsProcess.h"
+#endif
+#ifndef ASSIMP_BUILD_NO_GENLODS_PROCESS
+#   include "GenLODsProcess.h"
+#endif
 
 namespace Assimp {
 
@@ -221,9 +227,15 @@ void GetPostProcessingStepInstanceList(std::vector< BaseProcess* >& out)
 #if (!defined ASSIMP_BUILD_NO_LIMITBONEWEIGHTS_PROCESS)
     out.push_back( new LimitBoneWeightsProcess());
 #endif
+#if (!defined ASSIMP_BUILD_NO_GENLODS_PROCESS)
+    out.push_back( new GenLODsProcess());
+#endif
 #if (!defined ASSIMP_BUILD_NO_IMPROVECACHELOCALITY_PROCESS)
     out.push_back( new ImproveCacheLocalityProcess());
 #endif
+#if (!defined ASSIMP_BUILD_NO_GENMESHLETS_PROCESS)
+    out.push_back( new GenMeshletsProcess());
+#endif
 }
 
 }
@@ -0,0 +1,287 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+
+/** @file  Profiler.cpp
+ *  @brief Implementation of the import profiler and its memory sampling
+ */
+
+#include "Profiler.h"
+
+#include <sstream>
+#include <iomanip>
+#include <locale>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef ASSIMP_BUILD_PROFILE_ALLOCATIONS
+#   include <atomic>
+#endif
+
+#if defined( _WIN32 )
+#   include <windows.h>
+#   include <psapi.h>
+#   ifdef _MSC_VER
+#       pragma comment( lib, "psapi.lib" )
+#   endif
+#elif defined( __unix__ ) || defined( __APPLE__ )
+#   include <sys/resource.h>
+#   define AI_PROFILER_HAS_RUSAGE
+#endif
+
+using namespace Assimp;
+using namespace Assimp::Profiling;
+
+#ifdef ASSIMP_BUILD_PROFILE_ALLOCATIONS
+
+// ------------------------------------------------------------------------------------------------
+// Counting replacements for the global allocation functions. Replacing them
+// is process-wide: if assimp is linked statically, or the dynamic linker lets
+// these definitions interpose the C++ runtime's, every operator new of the
+// host application and of other threads is counted as well. The per-region
+// numbers are therefore only attributable to assimp while nothing else
+// allocates during the import. Memory is obtained from malloc(), so blocks
+// released by the application's operator delete stay compatible.
+// ------------------------------------------------------------------------------------------------
+namespace {
+    std::atomic<size_t> s_allocations( 0 );
+    std::atomic<size_t> s_allocatedBytes( 0 );
+
+    void* CountedAlloc( size_t num_bytes ) {
+        s_allocations.fetch_add( 1, std::memory_order_relaxed );
+        s_allocatedBytes.fetch_add( num_bytes, std::memory_order_relaxed );
+        return ::malloc( num_bytes ? num_bytes : 1 );
+    }
+}
+
+void* operator new( size_t num_bytes ) {
+    void* p = CountedAlloc( num_bytes );
+    if ( !p ) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[]( size_t num_bytes ) {
+    return operator new( num_bytes );
+}
+
+void* operator new( size_t num_bytes, const std::nothrow_t& ) throw() {
+    return CountedAlloc( num_bytes );
+}
+
+void* operator new[]( size_t num_bytes, const std::nothrow_t& ) throw() {
+    return CountedAlloc( num_bytes );
+}
+
+void operator delete( void* data ) throw() {
+    ::free( data );
+}
+
+void operator delete[]( void* data ) throw() {
+    ::free( data );
+}
+
+#endif // ASSIMP_BUILD_PROFILE_ALLOCATIONS
+
+// ------------------------------------------------------------------------------------------------
+void Assimp::Profiling::SampleMemory(MemorySample& out)
+{
+#ifdef ASSIMP_BUILD_PROFILE_ALLOCATIONS
+    out.allocations    = s_allocations.load( std::memory_order_relaxed );
+    out.allocatedBytes = s_allocatedBytes.load( std::memory_order_relaxed );
+#else
+    out.allocations    = 0;
+    out.allocatedBytes = 0;
+#endif
+
+    out.peakResident = 0;
+#if defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ) {
+        out.peakResident = counters.PeakWorkingSetSize;
+    }
+#elif defined( AI_PROFILER_HAS_RUSAGE )
+    struct rusage usage;
+    if ( 0 == getrusage( RUSAGE_SELF, &usage ) ) {
+#   ifdef __APPLE__
+        out.peakResident = static_cast<size_t>( usage.ru_maxrss );
+#   else
+        // Linux and the BSDs report kilobytes
+        out.peakResident = static_cast<size_t>( usage.ru_maxrss ) * 1024;
+#   endif
+    }
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+Profiler::Profiler()
+    : epoch( Clock::now() )
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+void Profiler::BeginRegion(const std::string& region)
+{
+    OpenRegion& open = regions[region];
+    open.entry = entries.size();
+
+    aiProfileEntry entry;
+    entry.mName.Set( region );
+    entry.mDepth = static_cast<unsigned int>( regions.size() - 1 );
+    entries.push_back( entry );
+
+    SampleMemory( open.memory );
+    open.start = Clock::now();
+    entries.back().mStart = std::chrono::duration<double, std::milli>( open.start - epoch ).count();
+
+    DefaultLogger::get()->debug((format("START `"),region,"`"));
+}
+
+// ------------------------------------------------------------------------------------------------
+void Profiler::EndRegion(const std::string& region)
+{
+    RegionMap::iterator it = regions.find(region);
+    if (it == regions.end()) {
+        return;
+    }
+
+    const Clock::time_point end = Clock::now();
+    MemorySample memory;
+    SampleMemory( memory );
+
+    aiProfileEntry& entry = entries[ it->second.entry ];
+    entry.mDuration = std::chrono::duration<double, std::milli>( end - it->second.start ).count();
+    entry.mAllocations = memory.allocations - it->second.memory.allocations;
+    entry.mAllocatedBytes = memory.allocatedBytes - it->second.memory.allocatedBytes;
+    entry.mPeakResidentMemory = memory.peakResident;
+    regions.erase(it);
+
+    DefaultLogger::get()->debug((format("END   `"),region,"`, dt= ", entry.mDuration / 1000.0," s"));
+}
+
+// ------------------------------------------------------------------------------------------------
+std::string Profiler::GetReport(aiProfileFormat format) const
+{
+    switch (format) {
+    case aiProfileFormat_ChromeTrace:
+        return ToChromeTrace();
+    default:
+        return ToJSON();
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Write a string literal with JSON escaping applied
+static void WriteJSONString(std::ostream& out, const char* str)
+{
+    out << '\"';
+    for (const char* c = str; *c; ++c) {
+        switch (*c) {
+        case '\"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<unsigned int>(static_cast<unsigned char>(*c))
+                    << std::dec << std::setfill(' ');
+            }
+            else {
+                out << *c;
+            }
+        }
+    }
+    out << '\"';
+}
+
+// ------------------------------------------------------------------------------------------------
+std::string Profiler::ToJSON() const
+{
+    std::ostringstream out;
+    out.imbue( std::locale::classic() );
+    out << std::fixed << std::setprecision( 3 );
+
+    size_t peak = 0;
+    out << "{\n  \"regions\": [";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const aiProfileEntry& e = entries[i];
+        peak = std::max( peak, e.mPeakResidentMemory );
+
+        out << (i ? ",\n" : "\n") << "    { \"name\": ";
+        WriteJSONString( out, e.mName.C_Str() );
+        out << ", \"depth\": " << e.mDepth
+            << ", \"start_ms\": " << e.mStart
+            << ", \"duration_ms\": " << e.mDuration
+            << ", \"allocations\": " << e.mAllocations
+            << ", \"allocated_bytes\": " << e.mAllocatedBytes
+            << ", \"peak_rss_bytes\": " << e.mPeakResidentMemory << " }";
+    }
+    out << "\n  ],\n  \"peak_rss_bytes\": " << peak << "\n}\n";
+    return out.str();
+}
+
+// ------------------------------------------------------------------------------------------------
+std::string Profiler::ToChromeTrace() const
+{
+    std::ostringstream out;
+    out.imbue( std::locale::classic() );
+    out << std::fixed << std::setprecision( 3 );
+
+    // 'X' denotes complete events, timestamps are given in microseconds
+    out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const aiProfileEntry& e = entries[i];
+
+        out << (i ? ",\n" : "\n") << "    { \"name\": ";
+        WriteJSONString( out, e.mName.C_Str() );
+        out << ", \"cat\": \"assimp\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+            << ", \"ts\": " << e.mStart * 1000.0
+            << ", \"dur\": " << e.mDuration * 1000.0
+            << ", \"args\": { \"allocations\": " << e.mAllocations
+            << ", \"allocated_bytes\": " << e.mAllocatedBytes
+            << ", \"peak_rss_bytes\": " << e.mPeakResidentMemory << " } }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
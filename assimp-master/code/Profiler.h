@@ -46,51 +46,83 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <chrono>
 #include <assimp/DefaultLogger.hpp>
+#include <assimp/importprofile.h>
 #include "TinyFormatter.h"
 
 #include <map>
+#include <string>
+#include <vector>
 
 namespace Assimp {
     namespace Profiling {
 
         using namespace Formatter;
 
+// ------------------------------------------------------------------------------------------------
+/** Snapshot of the process-wide memory counters. Allocation counts are only
+ *  maintained if the library was built with ASSIMP_BUILD_PROFILE_ALLOCATIONS.
+ */
+struct MemorySample
+{
+    size_t allocations;
+    size_t allocatedBytes;
+    size_t peakResident;
+};
 
 // ------------------------------------------------------------------------------------------------
-/** Simple wrapper around boost::timer to simplify reporting. Timings are automatically
- *  dumped to the log file.
+/** Fill a #MemorySample with the current counters of this process */
+void SampleMemory(MemorySample& out);
+
+// ------------------------------------------------------------------------------------------------
+/** Records the wall time and the memory statistics of named, possibly nested
+ *  regions. The timings are also dumped to the log file. After profiling, the
+ *  regions can be queried as #aiProfileEntry or serialized to JSON or to the
+ *  Chrome trace event format.
  */
 class Profiler
 {
 
 public:
 
-    Profiler() {}
+    Profiler();
 
 public:
 
     /** Start a named timer */
-    void BeginRegion(const std::string& region) {
-        regions[region] = std::chrono::system_clock::now();
-        DefaultLogger::get()->debug((format("START `"),region,"`"));
-    }
-
+    void BeginRegion(const std::string& region);
 
     /** End a specific named timer and write its end time to the log */
-    void EndRegion(const std::string& region) {
-        RegionMap::const_iterator it = regions.find(region);
-        if (it == regions.end()) {
-            return;
-        }
-
-        auto elapsedSeconds = std::chrono::system_clock::now() - regions[region];
-        DefaultLogger::get()->debug((format("END   `"),region,"`, dt= ", elapsedSeconds.count()," s"));
+    void EndRegion(const std::string& region);
+
+    /** Get all regions recorded so far, in the order they were entered */
+    const std::vector<aiProfileEntry>& GetEntries() const {
+        return entries;
     }
 
+    /** Serialize all recorded regions */
+    std::string GetReport(aiProfileFormat format) const;
+
+private:
+
+    std::string ToJSON() const;
+    std::string ToChromeTrace() const;
+
 private:
 
-    typedef std::map<std::string,std::chrono::time_point<std::chrono::system_clock>> RegionMap;
+    typedef std::chrono::steady_clock Clock;
+
+    struct OpenRegion
+    {
+        Clock::time_point start;
+        size_t entry;
+        MemorySample memory;
+    };
+
+    typedef std::map<std::string,OpenRegion> RegionMap;
     RegionMap regions;
+
+    std::vector<aiProfileEntry> entries;
+    Clock::time_point epoch;
 };
 
     }
@@ -180,13 +180,20 @@ void STLImporter::InternReadFile( const std::string& pFile,
 
     fileSize = (unsigned int)file->FileSize();
 
-    // allocate storage and copy the contents of the file to a memory buffer
-    // (terminate it with zero)
+    // binary files are parsed in place if the stream is backed by memory,
+    // otherwise allocate storage and copy the contents of the file to a
+    // memory buffer (terminate it with zero)
     std::vector<char> mBuffer2;
-    TextFileToBuffer(file.get(),mBuffer2);
+    const char* mapped = reinterpret_cast<const char*>(GetStreamContents(file.get()));
+    if (mapped && IsBinarySTL(mapped, fileSize)) {
+        this->mBuffer = mapped;
+    }
+    else {
+        TextFileToBuffer(file.get(),mBuffer2);
+        this->mBuffer = &mBuffer2[0];
+    }
 
     this->pScene = pScene;
-    this->mBuffer = &mBuffer2[0];
 
     // the default vertex color is light gray.
     clrColorDefault.r = clrColorDefault.g = clrColorDefault.b = clrColorDefault.a = 0.6;
@@ -1066,6 +1066,15 @@ void SceneCombiner::Copy     (aiMesh** _dest, const aiMesh* src)
         aiFace& f = dest->mFaces[i];
         GetArrayCopy(f.mIndices,f.mNumIndices);
     }
+
+    // and of all meshlets
+    GetArrayCopy(dest->mMeshlets,dest->mNumMeshlets);
+    for (unsigned int i = 0; i < dest->mNumMeshlets;++i)
+    {
+        aiMeshlet& m = dest->mMeshlets[i];
+        GetArrayCopy(m.mVertices,m.mNumVertices);
+        GetArrayCopy(m.mTriangles,m.mNumTriangles*3);
+    }
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1096,6 +1105,7 @@ void SceneCombiner::Copy (aiMaterial** _dest, const aiMaterial* src)
         prop->mKey      = sprop->mKey;
         prop->mType     = sprop->mType;
     }
+    dest->UpdatePropertyIndex();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -190,6 +190,8 @@ void SplitByBoneCountProcess::SplitMesh( const aiMesh* pMesh, std::vector<aiMesh
                 continue;
 
             const aiFace& face = pMesh->mFaces[a];
+            // bones of a face left out before must not count for this one
+            newBonesAtCurrentFace.clear();
             // check every vertex if its bones would still fit into the current submesh
             for( unsigned int b = 0; b < face.mNumIndices; ++b )
             {
@@ -207,9 +209,13 @@ void SplitByBoneCountProcess::SplitMesh( const aiMesh* pMesh, std::vector<aiMesh
                 }
             }
 
-            // leave out the face if the new bones required for this face don't fit the bone count limit anymore
-            if( numBones + newBonesAtCurrentFace.size() > mMaxBoneCount )
+            // leave out the face if the new bones required for this face don't fit the bone count limit anymore.
+            // A face exceeding the limit on its own still gets a submesh for itself, the loop would never end otherwise.
+            if( numBones + newBonesAtCurrentFace.size() > mMaxBoneCount && !(subMeshFaces.empty() && numBones == 0) )
                 continue;
+            if( numBones + newBonesAtCurrentFace.size() > mMaxBoneCount )
+                DefaultLogger::get()->warn( format() << "SplitByBoneCountProcess: face " << a << " of mesh " << pMesh->mName.C_Str()
+                    << " references " << newBonesAtCurrentFace.size() << " bones, more than the limit of " << mMaxBoneCount );
 
             // mark all new bones as necessary
             while( !newBonesAtCurrentFace.empty() )
@@ -391,7 +397,7 @@ void SplitByBoneCountProcess::UpdateNode( aiNode* pNode) const
             newMeshList.insert( newMeshList.end(), replaceMeshes.begin(), replaceMeshes.end());
         }
 
-        delete pNode->mMeshes;
+        delete [] pNode->mMeshes;
         pNode->mNumMeshes = static_cast<unsigned int>(newMeshList.size());
         pNode->mMeshes = new unsigned int[pNode->mNumMeshes];
         std::copy( newMeshList.begin(), newMeshList.end(), pNode->mMeshes);
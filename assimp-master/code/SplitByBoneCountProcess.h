@@ -49,6 +49,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/mesh.h>
 #include <assimp/scene.h>
 
+class SplitByBoneCountTest;
+
 namespace Assimp
 {
 
@@ -59,8 +61,10 @@ namespace Assimp
  * Applied BEFORE the JoinVertices-Step occurs.
  * Returns NON-UNIQUE vertices, splits by bone count.
 */
-class SplitByBoneCountProcess : public BaseProcess
+class ASSIMP_API SplitByBoneCountProcess : public BaseProcess
 {
+    friend class ::SplitByBoneCountTest;
+
 public:
 
     SplitByBoneCountProcess();
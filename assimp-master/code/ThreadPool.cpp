@@ -0,0 +1,130 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+
+/** @file  ThreadPool.cpp
+ *  @brief Implementation of the worker thread pool
+ */
+
+#include "ThreadPool.h"
+#include <assimp/ai_assert.h>
+
+using namespace Assimp;
+
+// ------------------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned int numThreads)
+    : mBusy(0)
+    , mShutdown(false)
+{
+    if (!numThreads) {
+        numThreads = GetHardwareThreadCount();
+    }
+    mThreads.reserve(numThreads);
+    for (unsigned int i = 0; i < numThreads; ++i) {
+        mThreads.push_back(std::thread(&ThreadPool::Run, this));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShutdown = true;
+    }
+    mWakeUp.notify_all();
+    for (std::vector<std::thread>::iterator it = mThreads.begin(); it != mThreads.end(); ++it) {
+        it->join();
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void ThreadPool::Enqueue(const Task& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ai_assert(!mShutdown);
+        mQueue.push_back(task);
+    }
+    mWakeUp.notify_one();
+}
+
+// ------------------------------------------------------------------------------------------------
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mQueue.empty() || mBusy) {
+        mIdle.wait(lock);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int ThreadPool::GetHardwareThreadCount()
+{
+    const unsigned int count = std::thread::hardware_concurrency();
+    return count ? count : 1;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ThreadPool::Run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        while (mQueue.empty() && !mShutdown) {
+            mWakeUp.wait(lock);
+        }
+        // drain the queue before shutting down
+        if (mQueue.empty()) {
+            return;
+        }
+
+        Task task = mQueue.front();
+        mQueue.pop_front();
+        ++mBusy;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        if (!--mBusy && mQueue.empty()) {
+            mIdle.notify_all();
+        }
+    }
+}
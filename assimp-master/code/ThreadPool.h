@@ -0,0 +1,109 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+
+/** @file ThreadPool.h
+ *  @brief Fixed-size pool of worker threads
+ */
+#ifndef AI_THREADPOOL_H_INC
+#define AI_THREADPOOL_H_INC
+
+#include <assimp/defs.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Assimp    {
+
+// ---------------------------------------------------------------------------
+/** Simple pool of worker threads executing queued tasks in FIFO order.
+ *
+ *  Tasks must not throw. Destroying the pool runs all tasks still in the
+ *  queue and joins the workers.
+ */
+class ASSIMP_API ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // -------------------------------------------------------------------
+    /** @param numThreads Number of worker threads, 0 picks the number of
+     *    hardware threads. */
+    explicit ThreadPool(unsigned int numThreads = 0);
+    ~ThreadPool();
+
+    // -------------------------------------------------------------------
+    /** Queue a task for execution on one of the workers. */
+    void Enqueue(const Task& task);
+
+    // -------------------------------------------------------------------
+    /** Block until the queue is empty and no task is running. */
+    void WaitIdle();
+
+    // -------------------------------------------------------------------
+    unsigned int GetThreadCount() const {
+        return static_cast<unsigned int>(mThreads.size());
+    }
+
+    // -------------------------------------------------------------------
+    /** Number of hardware threads, at least 1. */
+    static unsigned int GetHardwareThreadCount();
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void Run();
+
+    std::vector<std::thread> mThreads;
+    std::deque<Task> mQueue;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mIdle;
+    unsigned int mBusy;
+    bool mShutdown;
+};
+
+} // Namespace Assimp
+
+#endif // AI_THREADPOOL_H_INC
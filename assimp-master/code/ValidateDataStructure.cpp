@@ -455,6 +455,38 @@ void ValidateDSProcess::Validate( const aiMesh* pMesh)
             }
     }
 
+    // meshlets must reference valid vertices and cover all faces
+    if (pMesh->mNumMeshlets)
+    {
+        if (!pMesh->mMeshlets)
+        {
+            ReportError("aiMesh::mMeshlets is NULL (aiMesh::mNumMeshlets is %i)",
+                pMesh->mNumMeshlets);
+        }
+        unsigned int numTriangles = 0;
+        for (unsigned int i = 0; i < pMesh->mNumMeshlets;++i)
+        {
+            const aiMeshlet& meshlet = pMesh->mMeshlets[i];
+            for (unsigned int a = 0; a < meshlet.mNumVertices;++a)
+            {
+                if (meshlet.mVertices[a] >= pMesh->mNumVertices) {
+                    ReportError("aiMesh::mMeshlets[%i]::mVertices[%i] is out of range",i,a);
+                }
+            }
+            for (unsigned int a = 0; a < meshlet.mNumTriangles*3;++a)
+            {
+                if (meshlet.mTriangles[a] >= meshlet.mNumVertices) {
+                    ReportError("aiMesh::mMeshlets[%i]::mTriangles[%i] is out of range",i,a);
+                }
+            }
+            numTriangles += meshlet.mNumTriangles;
+        }
+        if (numTriangles != pMesh->mNumFaces) {
+            ReportError("aiMesh::mMeshlets hold %u triangles, but the mesh has %u faces",
+                numTriangles,pMesh->mNumFaces);
+        }
+    }
+
 
     // now validate all bones
     if (pMesh->mNumBones)
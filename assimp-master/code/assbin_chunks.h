@@ -4,6 +4,9 @@
 #define ASSBIN_VERSION_MAJOR 1
 #define ASSBIN_VERSION_MINOR 0
 
+#define ASSBIN2_VERSION_MAJOR 2
+#define ASSBIN2_VERSION_MINOR 1
+
 /**
 @page assfile .ASS File formats
 
@@ -165,6 +168,122 @@ The general 'rule' to get from Assimp headers to the serialized layout is:
    - mNumAllocated is omitted, for obvious reasons :-)
 
 
+ @endverbatim
+
+@section assbin2 Binary file format, version 2
+
+Version 2 of the binary format is meant to be used as a cache for imported
+scenes. Each mesh, material, animation and texture is stored in a chunk of its
+own, and a table of contents lists all chunks. Readers can map the file and
+locate any chunk without walking the file, or read only the chunks they need.
+All vertex and key arrays start at 16-byte boundaries, so uncompressed chunks
+can be used in place. Chunks can be compressed one by one with DEFLATE.
+
+@verbatim
+
+-------------------------------------------------------------------------------
+1. File structure:
+-------------------------------------------------------------------------------
+
+----------------------
+| Header (64 bytes)  |
+----------------------
+| Table of contents  |
+----------------------
+| Chunks             |
+----------------------
+
+Integers and floats are stored as in version 1, in addition
+long    is eight bytes wide, stored in little-endian byte order.
+align   is zero padding up to the next multiple of 16 bytes, relative
+        to the start of the chunk.
+
+-------------------------------------------------------------------------------
+2. Header:
+-------------------------------------------------------------------------------
+
+byte[16]    Magic identification string, 'ASSIMP.assbin2', zero padded
+integer     Major version of the format, ASSBIN2_VERSION_MAJOR
+integer     Minor version of the format, ASSBIN2_VERSION_MINOR
+integer     Revision of the Assimp library which wrote the file
+integer     Assimp compile flags
+integer     Number of entries in the table of contents
+integer     Reserved, 0
+long        Offset of the table of contents
+byte[16]    Reserved, 0
+---> Total length: 64 bytes
+
+-------------------------------------------------------------------------------
+3. Table of contents:
+-------------------------------------------------------------------------------
+
+One entry per chunk, 32 bytes each:
+
+integer     Chunk type (ASSBIN_CHUNK_XXX), unknown types are skipped
+integer     Index of the object in the respective aiScene array
+long        Offset of the chunk data, a multiple of 16
+integer     Size of the chunk data as stored in the file
+integer     Size of the chunk data after decompression
+integer     ASSBIN2_COMPRESSION_XXX
+integer     Reserved, 0
+
+The first entry is always the ASSBIN_CHUNK_AISCENE chunk.
+
+-------------------------------------------------------------------------------
+4. Chunks:
+-------------------------------------------------------------------------------
+
+Chunks are not nested. The layout follows version 1 with these differences:
+
+[[aiScene]]
+
+   - Counts, followed by all nodes in depth-first order, all lights and all
+     cameras. Meshes, materials, animations and textures have chunks of
+     their own.
+
+[[aiNode]]
+
+   - mName, mTransformation, mNumChildren, mNumMeshes, mMeshes
+
+[[aiLight]], [[aiCamera]]
+
+   - All members in order of declaration.
+
+[[aiMesh]]
+
+   - mPrimitiveTypes, mNumVertices, mNumFaces, mNumBones, mMaterialIndex,
+     ASSBIN_MESH_HAS_xxx bits, total number of face indices, number of
+     indices per face or 0 if the faces differ in size, mName and
+     mNumUVComponents of each texture coordinate set.
+   - Each vertex array is preceded by align.
+   - Faces: align, short[mNumFaces] index counts, present only if the faces
+     differ in size. align, indices of all faces as short if mNumVertices <
+     65536, otherwise as integer.
+   - Bones: mName, mNumWeights, align, mOffsetMatrix, align, mWeights.
+
+[[aiMeshlet]]
+
+   - One ASSBIN_CHUNK_AIMESHLETS chunk per mesh with meshlets, the index is
+     the one of the mesh. Added in minor version 1, older readers skip it.
+   - Size of a vertex index, 2 if the mesh has less than 65536 vertices,
+     otherwise 4. mNumMeshlets, then per meshlet mNumVertices,
+     mNumTriangles, mCenter, mRadius, mConeAxis, mConeCutoff.
+   - align, mVertices of all meshlets as short or integer.
+   - align, mTriangles of all meshlets as bytes.
+
+[[aiAnimation]]
+
+   - mName, mDuration, mTicksPerSecond, mNumChannels followed by the channels.
+
+[[aiNodeAnim]]
+
+   - mNodeName, key counts, mPreState, mPostState. Each key array is split
+     into align, double[n] times, align, values.
+
+[[aiTexture]]
+
+   - mWidth, mHeight, achFormatHint, align, pcData
+
  @endverbatim*/
 
 
@@ -182,6 +301,19 @@ The general 'rule' to get from Assimp headers to the serialized layout is:
 #define ASSBIN_CHUNK_AINODE                     0x123c
 #define ASSBIN_CHUNK_AIMATERIAL                 0x123d
 #define ASSBIN_CHUNK_AIMATERIALPROPERTY         0x123e
+#define ASSBIN_CHUNK_AIMESHLETS                 0x123f
+
+#define ASSBIN2_MAGIC                           "ASSIMP.assbin2"
+#define ASSBIN2_HEADER_LENGTH                   64
+#define ASSBIN2_TOC_ENTRY_LENGTH                32
+#define ASSBIN2_ALIGNMENT                       16
+
+// compression of a version 2 chunk
+#define ASSBIN2_COMPRESSION_NONE                0
+#define ASSBIN2_COMPRESSION_DEFLATE             1
+
+// deflate can't expand data by more than this factor
+#define ASSBIN2_MAX_INFLATE_RATIO               1032
 
 #define ASSBIN_MESH_HAS_POSITIONS                   0x1
 #define ASSBIN_MESH_HAS_NORMALS                     0x2
@@ -64,6 +64,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #   include <memory>
 #   include "DefaultIOSystem.h"
 #   include "ByteSwapper.h"
+#   include "BaseImporter.h"
 #else
 #   include <memory>
 #   define AI_SWAP4(p)
@@ -441,6 +442,10 @@ namespace glTF
                 return GetValue<unsigned int>(i);
             }
 
+            //! Accesses the values [first, first + count) in one pass
+            template<class T>
+            void GetValues(size_t first, size_t count, T* outData);
+
             inline bool IsValid() const
             {
                 return data != 0;
@@ -544,6 +549,15 @@ namespace glTF
 
         bool LoadFromStream(IOStream& stream, size_t length = 0, size_t baseOffset = 0);
 
+        /// \fn bool MapStream(const shared_ptr<IOStream>& stream, size_t length, size_t baseOffset)
+        /// Use the contents of a memory backed stream (a memory mapped file or a memory buffer) in place
+        /// instead of reading them into an own copy. The buffer keeps the stream alive, its data must not be modified then.
+        /// \param [in] stream - stream to use.
+        /// \param [in] length - length of the data, 0 for the rest of the stream.
+        /// \param [in] baseOffset - offset of the data in the stream.
+        /// \return true - if the data is used in place, false if the stream is not memory backed or too short.
+        bool MapStream(const shared_ptr<IOStream>& stream, size_t length = 0, size_t baseOffset = 0);
+
 		/// \fn void EncodedRegion_Mark(const size_t pOffset, const size_t pEncodedData_Length, uint8_t* pDecodedData, const size_t pDecodedData_Length, const std::string& pID)
 		/// Mark region of "bufferView" as encoded. When data is request from such region then "bufferView" use decoded data.
 		/// \param [in] pOffset - offset from begin of "bufferView" to encoded region, in bytes.
@@ -308,10 +308,9 @@ inline void Buffer::Read(Value& obj, Asset& r)
     }
     else { // Local file
         if (byteLength > 0) {
-            IOStream* file = r.OpenFile(uri, "rb");
+            shared_ptr<IOStream> file(r.OpenFile(uri, "rb"));
             if (file) {
-                bool ok = LoadFromStream(*file, byteLength);
-                delete file;
+                bool ok = MapStream(file, byteLength) || LoadFromStream(*file, byteLength);
 
                 if (!ok)
                     throw DeadlyImportError("GLTF: error while reading referenced file \"" + std::string(uri) + "\"" );
@@ -339,6 +338,29 @@ inline bool Buffer::LoadFromStream(IOStream& stream, size_t length, size_t baseO
     return true;
 }
 
+inline bool Buffer::MapStream(const shared_ptr<IOStream>& stream, size_t length, size_t baseOffset)
+{
+#ifdef ASSIMP_API
+    const uint8_t* contents = Assimp::BaseImporter::GetStreamContents(stream.get());
+    const size_t fileSize = stream->FileSize();
+    if (!contents || baseOffset > fileSize) {
+        return false;
+    }
+
+    const size_t available = fileSize - baseOffset;
+    if (length > available) {
+        return false;
+    }
+    byteLength = length ? length : available;
+
+    // share the ownership of the stream, the contents live as long as it does
+    mData = shared_ptr<uint8_t>(stream, const_cast<uint8_t*>(contents + baseOffset));
+    return true;
+#else
+    return false;
+#endif
+}
+
 inline void Buffer::EncodedRegion_Mark(const size_t pOffset, const size_t pEncodedData_Length, uint8_t* pDecodedData, const size_t pDecodedData_Length, const std::string& pID)
 {
 	// Check pointer to data
@@ -501,6 +523,44 @@ inline uint8_t* Accessor::GetPointer()
 }
 
 namespace {
+    //! Copies N bytes per element, N is known at compile time so the copy of
+    //! an element boils down to a few moves
+    template<size_t N>
+    inline void CopyElements(size_t count, const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(dst, src, N);
+            src += src_stride;
+            dst += dst_stride;
+        }
+    }
+
+    //! Copies count elements of elemSize bytes between strided arrays
+    inline void CopyStrided(size_t count, size_t elemSize,
+            const uint8_t* src, size_t src_stride,
+                  uint8_t* dst, size_t dst_stride)
+    {
+        if (src_stride == elemSize && dst_stride == elemSize) {
+            memcpy(dst, src, count * elemSize);
+            return;
+        }
+
+        switch (elemSize) {
+            case 1:  CopyElements<1>(count, src, src_stride, dst, dst_stride); break;
+            case 2:  CopyElements<2>(count, src, src_stride, dst, dst_stride); break;
+            case 4:  CopyElements<4>(count, src, src_stride, dst, dst_stride); break;
+            case 8:  CopyElements<8>(count, src, src_stride, dst, dst_stride); break;
+            case 12: CopyElements<12>(count, src, src_stride, dst, dst_stride); break;
+            case 16: CopyElements<16>(count, src, src_stride, dst, dst_stride); break;
+            default:
+                for (size_t i = 0; i < count; ++i) {
+                    memcpy(dst, src, elemSize);
+                    src += src_stride;
+                    dst += dst_stride;
+                }
+        }
+    }
+
     inline void CopyData(size_t count,
             const uint8_t* src, size_t src_stride,
                   uint8_t* dst, size_t dst_stride)
@@ -543,9 +603,7 @@ bool Accessor::ExtractData(T*& outData)
         memcpy(outData, data, totalSize);
     }
     else {
-        for (size_t i = 0; i < count; ++i) {
-            memcpy(outData + i, data + i*stride, elemSize);
-        }
+        CopyStrided(count, elemSize, data, stride, reinterpret_cast<uint8_t*>(outData), targetElemSize);
     }
 
     return true;
@@ -588,6 +646,20 @@ T Accessor::Indexer::GetValue(int i)
     return value;
 }
 
+//! Accesses the values [first, first + count) in one pass
+template<class T>
+void Accessor::Indexer::GetValues(size_t first, size_t count, T* outData)
+{
+    if (!count) return;
+    ai_assert(data);
+    ai_assert(elemSize <= sizeof(T));
+    ai_assert((first + count - 1) * stride + elemSize <= accessor.bufferView->byteLength);
+
+    // the values are zero extended like in GetValue()
+    std::fill(outData, outData + count, T());
+    CopyStrided(count, elemSize, data + first * stride, stride, reinterpret_cast<uint8_t*>(outData), sizeof(T));
+}
+
 inline Image::Image()
     : width(0)
     , height(0)
@@ -1329,9 +1401,11 @@ inline void Asset::Load(const std::string& pFile, bool isBinary)
         throw DeadlyImportError("GLTF: JSON document root must be a JSON object");
     }
 
-    // Fill the buffer instance for the current file embedded contents
+    // Fill the buffer instance for the current file embedded contents,
+    // mapped files and memory buffers are used in place
     if (mBodyLength > 0) {
-        if (!mBodyBuffer->LoadFromStream(*stream, mBodyLength, mBodyOffset)) {
+        if (!mBodyBuffer->MapStream(stream, mBodyLength, mBodyOffset) &&
+            !mBodyBuffer->LoadFromStream(*stream, mBodyLength, mBodyOffset)) {
             throw DeadlyImportError("GLTF: Unable to read gltf file");
         }
     }
@@ -354,12 +354,16 @@ void glTFImporter::ImportMeshes(glTF::Asset& r)
                 Accessor::Indexer data = prim.indices->GetIndexer();
                 ai_assert(data.IsValid());
 
+                // read all indices at once instead of one by one per face
+                std::vector<unsigned int> indices(count);
+                data.GetValues(0, count, indices.data());
+
                 switch (prim.mode) {
                     case PrimitiveMode_POINTS: {
                         nFaces = count;
                         faces = new aiFace[nFaces];
                         for (unsigned int i = 0; i < count; ++i) {
-                            SetFace(faces[i], data.GetUInt(i));
+                            SetFace(faces[i], indices[i]);
                         }
                         break;
                     }
@@ -367,8 +371,8 @@ void glTFImporter::ImportMeshes(glTF::Asset& r)
                     case PrimitiveMode_LINES: {
                         nFaces = count / 2;
                         faces = new aiFace[nFaces];
-                        for (unsigned int i = 0; i < count; i += 2) {
-                            SetFace(faces[i / 2], data.GetUInt(i), data.GetUInt(i + 1));
+                        for (unsigned int i = 0; i + 1 < count; i += 2) {
+                            SetFace(faces[i / 2], indices[i], indices[i + 1]);
                         }
                         break;
                     }
@@ -377,9 +381,9 @@ void glTFImporter::ImportMeshes(glTF::Asset& r)
                     case PrimitiveMode_LINE_STRIP: {
                         nFaces = count - ((prim.mode == PrimitiveMode_LINE_STRIP) ? 1 : 0);
                         faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1));
+                        SetFace(faces[0], indices[0], indices[1]);
                         for (unsigned int i = 2; i < count; ++i) {
-                            SetFace(faces[i - 1], faces[i - 2].mIndices[1], data.GetUInt(i));
+                            SetFace(faces[i - 1], faces[i - 2].mIndices[1], indices[i]);
                         }
                         if (prim.mode == PrimitiveMode_LINE_LOOP) { // close the loop
                             SetFace(faces[count - 1], faces[count - 2].mIndices[1], faces[0].mIndices[0]);
@@ -390,26 +394,26 @@ void glTFImporter::ImportMeshes(glTF::Asset& r)
                     case PrimitiveMode_TRIANGLES: {
                         nFaces = count / 3;
                         faces = new aiFace[nFaces];
-                        for (unsigned int i = 0; i < count; i += 3) {
-                            SetFace(faces[i / 3], data.GetUInt(i), data.GetUInt(i + 1), data.GetUInt(i + 2));
+                        for (unsigned int i = 0; i + 2 < count; i += 3) {
+                            SetFace(faces[i / 3], indices[i], indices[i + 1], indices[i + 2]);
                         }
                         break;
                     }
                     case PrimitiveMode_TRIANGLE_STRIP: {
                         nFaces = count - 2;
                         faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1), data.GetUInt(2));
+                        SetFace(faces[0], indices[0], indices[1], indices[2]);
                         for (unsigned int i = 3; i < count; ++i) {
-                            SetFace(faces[i - 2], faces[i - 1].mIndices[1], faces[i - 1].mIndices[2], data.GetUInt(i));
+                            SetFace(faces[i - 2], faces[i - 1].mIndices[1], faces[i - 1].mIndices[2], indices[i]);
                         }
                         break;
                     }
                     case PrimitiveMode_TRIANGLE_FAN:
                         nFaces = count - 2;
                         faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1), data.GetUInt(2));
+                        SetFace(faces[0], indices[0], indices[1], indices[2]);
                         for (unsigned int i = 3; i < count; ++i) {
-                            SetFace(faces[i - 2], faces[0].mIndices[0], faces[i - 1].mIndices[2], data.GetUInt(i));
+                            SetFace(faces[i - 2], faces[0].mIndices[0], faces[i - 1].mIndices[2], indices[i]);
                         }
                         break;
                 }
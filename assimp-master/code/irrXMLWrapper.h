@@ -78,8 +78,19 @@ public:
     //! Construction from an existing IOStream
     explicit CIrrXML_IOStreamReader(IOStream* _stream)
         : stream (_stream)
+        , mapped (NULL)
+        , mappedSize (0)
         , t (0)
     {
+        // Plain UTF8 files without embedded null characters are served directly
+        // from memory if the stream allows, i.e. if the file has been mapped.
+        const char* contents = reinterpret_cast<const char*>(BaseImporter::GetStreamContents(stream));
+        const size_t fileSize = stream->FileSize();
+        if (contents && !HasByteOrderMark(contents, fileSize) && !memchr(contents, '\0', fileSize)) {
+            mapped = contents;
+            mappedSize = fileSize;
+            return;
+        }
 
         // Map the buffer into memory and convert it to UTF8. IrrXML provides its
         // own conversion, which is merely a cast from uintNN_t to uint8_t. Thus,
@@ -87,7 +98,7 @@ public:
         // gets the buffer. Sadly, this forces us to map the whole file into
         // memory.
 
-        data.resize(stream->FileSize());
+        data.resize(fileSize);
         stream->Read(&data[0],data.size(),1);
 
         // Remove null characters from the input sequence otherwise the parsing will utterly fail
@@ -116,11 +127,13 @@ public:
         if(sizeToRead<0) {
             return 0;
         }
-        if(t+sizeToRead>data.size()) {
-            sizeToRead = data.size()-t;
+        const char* src = mapped ? mapped : &data.front();
+        const size_t size = mapped ? mappedSize : data.size();
+        if(t+sizeToRead>size) {
+            sizeToRead = size-t;
         }
 
-        memcpy(buffer,&data.front()+t,sizeToRead);
+        memcpy(buffer,src+t,sizeToRead);
 
         t += sizeToRead;
         return sizeToRead;
@@ -129,12 +142,24 @@ public:
     // ----------------------------------------------------------------------------------
     //! Returns size of file in bytes
     virtual int getSize()   {
-        return (int)data.size();
+        return (int)(mapped ? mappedSize : data.size());
     }
 
 private:
+    // ----------------------------------------------------------------------------------
+    //! Checks for the UTF8/16/32 byte order marks handled by ConvertToUTF8()
+    static bool HasByteOrderMark(const char* contents, size_t size) {
+        const unsigned char* c = reinterpret_cast<const unsigned char*>(contents);
+        if (size >= 3 && c[0] == 0xef && c[1] == 0xbb && c[2] == 0xbf) {
+            return true;
+        }
+        return size >= 2 && ((c[0] == 0xff && c[1] == 0xfe) || (c[0] == 0xfe && c[1] == 0xff));
+    }
+
     IOStream* stream;
     std::vector<char> data;
+    const char* mapped;
+    size_t mappedSize;
     size_t t;
 
 }; // ! class CIrrXML_IOStreamReader
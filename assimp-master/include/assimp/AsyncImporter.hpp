@@ -0,0 +1,199 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file  AsyncImporter.hpp
+ *  @brief Defines the asynchronous C++-API to load files on worker threads.
+ */
+#pragma once
+#ifndef AI_ASYNCIMPORTER_HPP_INC
+#define AI_ASYNCIMPORTER_HPP_INC
+
+#ifndef __cplusplus
+#   error This header requires C++ to be used.
+#endif // __cplusplus
+
+#include <assimp/types.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+struct aiScene;
+
+namespace Assimp    {
+
+class Importer;
+class ProgressHandler;
+struct AsyncImportState;
+class AsyncImporterPimpl;
+
+// ----------------------------------------------------------------------------------
+/** Handle to an import running on an #AsyncImporter, similar to std::future.
+ *
+ *  Handles are cheap to copy, all copies refer to the same import. The
+ *  import itself keeps running if all handles are gone; its scene is
+ *  released then.
+ */
+class ASSIMP_API AsyncImport
+{
+public:
+    /** Creates an empty handle, IsValid() returns false. */
+    AsyncImport();
+    ~AsyncImport();
+
+    AsyncImport(const AsyncImport& other);
+    AsyncImport& operator=(const AsyncImport& other);
+
+    // -------------------------------------------------------------------
+    /** Returns true if the handle refers to an import. */
+    bool IsValid() const;
+
+    // -------------------------------------------------------------------
+    /** Returns true if the import has finished, successfully or not. */
+    bool IsReady() const;
+
+    // -------------------------------------------------------------------
+    /** Blocks until the import has finished. */
+    void Wait() const;
+
+    // -------------------------------------------------------------------
+    /** Blocks until the import has finished or the timeout has passed.
+     *  @return true if the import has finished. */
+    bool WaitFor(unsigned int pMilliseconds) const;
+
+    // -------------------------------------------------------------------
+    /** Requests the import to be aborted.
+     *
+     *  Imports which have not started yet are dropped. Running imports
+     *  stop at the next call to ProgressHandler::Update(). This does
+     *  not block, use Wait() to wait for the import to wind down. */
+    void Cancel();
+
+    // -------------------------------------------------------------------
+    /** Returns true if Cancel() has been called. */
+    bool IsCancelled() const;
+
+    // -------------------------------------------------------------------
+    /** Returns the last progress reported by the importer, in [0,1]. */
+    float GetProgress() const;
+
+    // -------------------------------------------------------------------
+    /** Waits for the import and takes the resulting scene.
+     *
+     *  The caller owns the scene and must delete it. Subsequent calls
+     *  return NULL.
+     *  @return The scene or NULL if the import failed, was cancelled
+     *    or the scene has already been taken. */
+    aiScene* GetScene();
+
+    // -------------------------------------------------------------------
+    /** Waits for the import and returns its error description.
+     *  @return Empty string if the import was successful. The pointer
+     *    is valid as long as the handle exists. */
+    const char* GetErrorString() const;
+
+private:
+    friend class AsyncImporter;
+    explicit AsyncImport(const std::shared_ptr<AsyncImportState>& state);
+
+    std::shared_ptr<AsyncImportState> mState;
+};
+
+// ----------------------------------------------------------------------------------
+/** Loads files on a pool of worker threads.
+ *
+ *  Each file is imported by its own #Importer instance, so any number of
+ *  imports may run concurrently. Imports are started in the order they
+ *  were requested.
+ *
+ *  Destroying the AsyncImporter cancels all imports which have not
+ *  started yet and waits for the running ones.
+ */
+class ASSIMP_API AsyncImporter
+{
+public:
+    /** Work to run on the worker thread after a successful import, for
+     *  example to prepare vertex buffers. Returning false fails the
+     *  import with the error string "Post-import callback failed". */
+    typedef std::function<bool(const aiScene*)> Continuation;
+
+    // -------------------------------------------------------------------
+    /** @param pNumThreads Number of worker threads, 0 picks the number
+     *    of hardware threads. */
+    explicit AsyncImporter(unsigned int pNumThreads = 0);
+    ~AsyncImporter();
+
+    // -------------------------------------------------------------------
+    /** Queues a file for import, see Importer::ReadFile().
+     *
+     *  @param pFile Path of the file to be imported.
+     *  @param pFlags Post-processing steps to be executed.
+     *  @param pImporter Optional, preconfigured importer to use, i.e. to
+     *    apply properties or a custom IOSystem. Ownership is transferred,
+     *    the importer must not be used by the caller afterwards. Its
+     *    progress handler is replaced.
+     *  @param pHandler Optional progress handler receiving the progress
+     *    of this import, it is called from the worker thread. Returning
+     *    false from ProgressHandler::Update() aborts the import.
+     *    Ownership is transferred.
+     *  @param pContinuation Optional work to run on the worker thread
+     *    once the scene is ready.
+     *  @return Handle to the import. */
+    AsyncImport ReadFile(const std::string& pFile,
+        unsigned int pFlags,
+        Importer* pImporter = NULL,
+        ProgressHandler* pHandler = NULL,
+        const Continuation& pContinuation = Continuation());
+
+    // -------------------------------------------------------------------
+    /** Returns the number of worker threads. */
+    unsigned int GetThreadCount() const;
+
+private:
+    AsyncImporter(const AsyncImporter&);
+    AsyncImporter& operator=(const AsyncImporter&);
+
+    // Just because we don't want you to know how we're hacking around.
+    AsyncImporterPimpl* pimpl;
+};
+
+} // Namespace Assimp
+
+#endif // AI_ASYNCIMPORTER_HPP_INC
@@ -53,6 +53,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Public ASSIMP data structures
 #include <assimp/types.h>
 #include <assimp/config.h>
+#include <assimp/importprofile.h>
 
 namespace Assimp    {
     // =======================================================================
@@ -615,6 +616,33 @@ public:
      *   is (naturally) not included.*/
     void GetMemoryRequirements(aiMemoryInfo& in) const;
 
+    // -------------------------------------------------------------------
+    /** Returns the number of regions recorded by the import profiler.
+     *
+     * Profiling is enabled by setting #AI_CONFIG_GLOB_MEASURE_TIME before
+     * calling ReadFile(). Every import starts a new profile, post-processing
+     * applied later via ApplyPostProcessing() is appended to it.
+     * @return Number of recorded regions, 0 if profiling was disabled. */
+    unsigned int GetProfileEntryCount() const;
+
+    // -------------------------------------------------------------------
+    /** Returns a single region recorded by the import profiler.
+     *
+     * For the declaration of #aiProfileEntry, include <assimp/importprofile.h>.
+     * @param index Index to query, must be within [0,GetProfileEntryCount())
+     * @return The region. The pointer remains valid until the next call
+     *   to ReadFile() or ApplyPostProcessing(). NULL if the index does
+     *   not exist. */
+    const aiProfileEntry* GetProfileEntry(unsigned int index) const;
+
+    // -------------------------------------------------------------------
+    /** Serializes the profile of the last import.
+     *
+     * @param pFormat Output format, either a plain JSON document or the
+     *   Chrome trace event format.
+     * @return The report. An empty string if profiling was disabled. */
+    std::string GetProfileReport(aiProfileFormat pFormat = aiProfileFormat_JSON) const;
+
     // -------------------------------------------------------------------
     /** Enables "extra verbose" mode.
      *
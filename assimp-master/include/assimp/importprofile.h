@@ -0,0 +1,125 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file importprofile.h
+ *  @brief #aiProfileEntry and #aiProfileFormat, the data recorded by the
+ *    import profiler (see #AI_CONFIG_GLOB_MEASURE_TIME).
+ */
+#pragma once
+#ifndef AI_IMPORTPROFILE_H_INC
+#define AI_IMPORTPROFILE_H_INC
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------------------------------------------------------------------
+/** Output formats supported by Importer::GetProfileReport() */
+enum aiProfileFormat
+{
+    /** A JSON document with one object per profiled region. */
+    aiProfileFormat_JSON = 0x0,
+
+    /** The Trace Event format understood by chrome://tracing and Perfetto. */
+    aiProfileFormat_ChromeTrace = 0x1,
+
+    /** This value is not used. It is just there to force the
+     *  compiler to map this enum to a 32 Bit integer. */
+#ifndef SWIG
+    _aiProfileFormat_Force32Bit = INT_MAX
+#endif
+};
+
+// ---------------------------------------------------------------------------
+/** A single profiled region of an import, e.g. the loader phase or one
+ *  post-processing step.
+ *
+ *  Regions are stored in the order they were entered. Nested regions
+ *  (a post-processing step inside the 'postprocess' region) have a
+ *  greater #mDepth than their parent.
+ */
+struct aiProfileEntry
+{
+    /** Name of the region, e.g. "import" or "postprocess/Triangulate" */
+    C_STRUCT aiString mName;
+
+    /** Nesting level of the region, 0 for the outermost region */
+    unsigned int mDepth;
+
+    /** Start time in milliseconds, relative to the start of ReadFile() */
+    double mStart;
+
+    /** Wall time spent in the region, in milliseconds */
+    double mDuration;
+
+    /** Number of heap allocations performed inside the region. Only
+     *  recorded if assimp was built with ASSIMP_BUILD_PROFILE_ALLOCATIONS,
+     *  zero otherwise. The counters hook the global operator new, so
+     *  allocations of the application and of other threads made while
+     *  the region is open are included. */
+    size_t mAllocations;
+
+    /** Number of bytes requested by these allocations. */
+    size_t mAllocatedBytes;
+
+    /** Peak resident set size of the process at the end of the region,
+     *  in bytes. Zero if the platform doesn't provide this information. */
+    size_t mPeakResidentMemory;
+
+#ifdef __cplusplus
+    aiProfileEntry()
+        : mDepth( 0 )
+        , mStart( 0.0 )
+        , mDuration( 0.0 )
+        , mAllocations( 0 )
+        , mAllocatedBytes( 0 )
+        , mPeakResidentMemory( 0 )
+    {}
+#endif
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AI_IMPORTPROFILE_H_INC
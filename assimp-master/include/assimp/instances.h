@@ -0,0 +1,112 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file instances.h
+ *  @brief #aiMeshInstance, a flat table of all placements of the meshes
+ *    in a scene, e.g. to build instanced draw calls.
+ */
+#pragma once
+#ifndef AI_INSTANCES_H_INC
+#define AI_INSTANCES_H_INC
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct aiNode;
+struct aiScene;
+
+// ---------------------------------------------------------------------------
+/** A single placement of a mesh in the node graph.
+ *
+ *  Run #aiProcess_FindInstances before querying the table, so that
+ *  duplicated meshes are collapsed into one mesh with several placements.
+ */
+struct aiMeshInstance
+{
+    /** Index of the mesh in aiScene::mMeshes */
+    unsigned int mMesh;
+
+    /** The node referencing the mesh */
+    const C_STRUCT aiNode* mNode;
+
+    /** Transformation of the node relative to the root node */
+    C_STRUCT aiMatrix4x4 mTransformation;
+
+#ifdef __cplusplus
+    aiMeshInstance()
+        : mMesh( 0 )
+        , mNode( NULL )
+    {}
+#endif
+};
+
+// ---------------------------------------------------------------------------
+/** Returns the number of mesh placements in a scene, i.e. the sum of
+ *  aiNode::mNumMeshes over all nodes.
+ *
+ *  @param pScene Scene to query.
+ *  @return Number of entries aiGetMeshInstances() writes.
+ */
+ASSIMP_API unsigned int aiGetNumMeshInstances(
+    const C_STRUCT aiScene* pScene);
+
+// ---------------------------------------------------------------------------
+/** Collects all mesh placements of a scene.
+ *
+ *  The table is sorted by mesh index, so the placements of a mesh are
+ *  adjacent and can be drawn with a single instanced draw call. Placements
+ *  of the same mesh keep the order of a depth-first traversal of the graph.
+ *
+ *  @param pScene Scene to query.
+ *  @param pOut Receives aiGetNumMeshInstances() entries.
+ */
+ASSIMP_API void aiGetMeshInstances(
+    const C_STRUCT aiScene* pScene,
+    C_STRUCT aiMeshInstance* pOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AI_INSTANCES_H_INC
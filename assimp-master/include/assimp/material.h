@@ -866,6 +866,18 @@ public:
     static void CopyPropertyList(aiMaterial* pcDest,
         const aiMaterial* pcSrc);
 
+    // ------------------------------------------------------------------------------
+    /** @brief Marks the hashed lookup index of the property list as out of date.
+     *
+     *  The index is rebuilt by the next lookup. The setters call this on
+     *  every change, and lists which change their length or address are
+     *  detected. Code which replaces entries of #mProperties in place must
+     *  call this function afterwards. */
+    void UpdatePropertyIndex();
+
+    //! @cond AI_INTERNAL
+    struct PropertyIndex;
+    //! @endcond
 
 #endif
 
@@ -877,6 +889,14 @@ public:
 
      /** Storage allocated */
     unsigned int mNumAllocated;
+
+#ifdef __cplusplus
+    //! @cond AI_INTERNAL
+    /** Hashed lookup index of #mProperties. C only sees the members above,
+     *  their layout is the same as without the index. */
+    PropertyIndex* mPropertyIndex;
+    //! @endcond
+#endif
 };
 
 // Go back to extern "C" again
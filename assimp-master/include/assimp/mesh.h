@@ -447,6 +447,82 @@ struct aiAnimMesh
 };
 
 
+// ---------------------------------------------------------------------------
+/** @brief A small cluster of triangles of a mesh, as produced by the
+ *  #aiProcess_GenMeshlets step.
+ *
+ *  Meshlets reference the vertices of their host mesh through a local
+ *  vertex list, their triangles index into this list. Each meshlet carries
+ *  a bounding sphere and a cone bounding the normals of its triangles,
+ *  which allows to cull whole meshlets against the view frustum or if
+ *  they face away from the viewer.
+ */
+struct aiMeshlet
+{
+    /** Number of vertices referenced by the meshlet. */
+    unsigned int mNumVertices;
+
+    /** Indices into the vertex arrays of the host mesh.
+     *  Holds mNumVertices entries. */
+    unsigned int* mVertices;
+
+    /** Number of triangles in the meshlet. */
+    unsigned int mNumTriangles;
+
+    /** Corners of the triangles as indices into mVertices.
+     *  Holds 3 * mNumTriangles entries. */
+    unsigned char* mTriangles;
+
+    /** Center of the bounding sphere, in mesh space. */
+    C_STRUCT aiVector3D mCenter;
+
+    /** Radius of the bounding sphere. */
+    float mRadius;
+
+    /** Unit axis of the cone bounding the triangle normals. The normal of
+     *  a triangle (a,b,c) is taken as cross(b - a, c - a). */
+    C_STRUCT aiVector3D mConeAxis;
+
+    /** Sine of the half-angle of the normal cone. 1 if the cone is wider
+     *  than a hemisphere, in which case the meshlet is never backfacing. */
+    float mConeCutoff;
+
+#ifdef __cplusplus
+
+    aiMeshlet()
+        : mNumVertices( 0 )
+        , mVertices( NULL )
+        , mNumTriangles( 0 )
+        , mTriangles( NULL )
+        , mRadius( 0.f )
+        , mConeCutoff( 1.f )
+    {}
+
+    ~aiMeshlet()
+    {
+        delete [] mVertices;
+        delete [] mTriangles;
+    }
+
+    /** Check whether all triangles of the meshlet face away from a
+     *  viewer at the given position (in mesh space). Conservative, a
+     *  result of false doesn't mean that any triangle is visible. */
+    bool IsBackFacing( const aiVector3D& pEye) const
+    {
+        if (mConeCutoff >= 1.f) {
+            return false;
+        }
+        const aiVector3D dir = mCenter - pEye;
+        return dir * mConeAxis >= mConeCutoff * dir.Length() + mRadius * (1.f + mConeCutoff);
+    }
+
+private:
+    aiMeshlet( const aiMeshlet& );
+    aiMeshlet& operator=( const aiMeshlet& );
+
+#endif // __cplusplus
+};
+
 // ---------------------------------------------------------------------------
 /** @brief A mesh represents a geometry or model with a single material.
 *
@@ -608,6 +684,14 @@ struct aiMesh
      *  mesh'es vertex components (usually positions, normals). */
     C_STRUCT aiAnimMesh** mAnimMeshes;
 
+    /** The number of meshlets in the mesh. Zero unless the
+     *  #aiProcess_GenMeshlets step has been executed. */
+    unsigned int mNumMeshlets;
+
+    /** Meshlets partitioning the faces of this mesh, mNumMeshlets
+     *  entries. Together they cover every face exactly once. */
+    C_STRUCT aiMeshlet* mMeshlets;
+
 
 #ifdef __cplusplus
 
@@ -626,6 +710,8 @@ struct aiMesh
         , mMaterialIndex( 0 )
         , mNumAnimMeshes( 0 )
         , mAnimMeshes( NULL )
+        , mNumMeshlets( 0 )
+        , mMeshlets( NULL )
     {
         for( unsigned int a = 0; a < AI_MAX_NUMBER_OF_TEXTURECOORDS; a++)
         {
@@ -666,6 +752,7 @@ struct aiMesh
             delete [] mAnimMeshes;
         }
 
+        delete [] mMeshlets;
         delete [] mFaces;
     }
 
@@ -730,6 +817,10 @@ struct aiMesh
     inline bool HasBones() const
         { return mBones != NULL && mNumBones > 0; }
 
+    //! Check whether the mesh has been partitioned into meshlets
+    inline bool HasMeshlets() const
+        { return mMeshlets != NULL && mNumMeshlets > 0; }
+
 #endif // __cplusplus
 };
 
@@ -271,11 +271,14 @@ enum aiPostProcessSteps
      * miss ratio) for all meshes. The implementation runs in O(n) and is
      * roughly based on the 'tipsify' algorithm (see <a href="
      * http://www.cs.princeton.edu/gfx/pubs/Sander_2007_%3ETR/tipsy.pdf">this
-     * paper</a>).
+     * paper</a>). Forsyth's linear-speed algorithm can be selected instead
+     * via <tt>#AI_CONFIG_PP_ICL_ALGORITHM</tt>.
      *
      * If you intend to render huge models in hardware, this step might
      * be of interest to you. The <tt>#AI_CONFIG_PP_ICL_PTCACHE_SIZE</tt>
-     * importer property can be used to fine-tune the cache optimization.
+     * importer property can be used to fine-tune the cache optimization,
+     * <tt>#AI_CONFIG_PP_ICL_REORDER_VERTICES</tt> additionally renumbers
+     * the vertices for vertex fetch locality.
      */
     aiProcess_ImproveCacheLocality = 0x800,
 
@@ -427,6 +430,9 @@ enum aiPostProcessSteps
      *  assignment to meshes, which means that identical meshes with
      *  different materials are currently *not* joined, although this is
      *  planned for future versions.
+     *
+     *  Use aiGetMeshInstances() (see <tt>instances.h</tt>) to obtain the
+     *  placements of each remaining mesh for instanced rendering.
      */
     aiProcess_FindInstances = 0x100000,
 
@@ -524,7 +530,38 @@ enum aiPostProcessSteps
      *  Use <tt>#AI_CONFIG_PP_DB_ALL_OR_NONE</tt> if you want bones removed if and
      *  only if all bones within the scene qualify for removal.
     */
-    aiProcess_Debone  = 0x4000000
+    aiProcess_Debone  = 0x4000000,
+
+    // -------------------------------------------------------------------------
+    /** <hr>This step partitions triangle meshes into meshlets, small clusters
+     *  of triangles with a bounding sphere and a normal cone each.
+     *
+     *  The meshlets are stored in aiMesh::mMeshlets and allow to cull parts of
+     *  a mesh on the CPU or to feed mesh shaders. Meshlets are built from
+     *  consecutive faces, so they are most compact if
+     *  #aiProcess_ImproveCacheLocality is executed as well.
+     *
+     *  Use <tt>#AI_CONFIG_PP_ML_MAX_VERTICES</tt> and
+     *  <tt>#AI_CONFIG_PP_ML_MAX_TRIANGLES</tt> to control the meshlet size.
+     *  Meshes which aren't pure triangle meshes are left untouched.
+    */
+    aiProcess_GenMeshlets = 0x8000000,
+
+    // -------------------------------------------------------------------------
+    /** <hr>This step generates simplified levels of detail for all triangle
+     *  meshes by quadric error metric edge collapses.
+     *
+     *  The LOD meshes are appended to aiScene::mMeshes and aren't referenced
+     *  by any node. Instead, the nodes referencing the original mesh receive
+     *  metadata entries (see <tt>#AI_METADATA_LOD_KEY</tt>) with the indices
+     *  of the LOD meshes. Vertices keep their attributes and bone weights, UV
+     *  seams and open borders are preserved. Use it together with
+     *  #aiProcess_JoinIdenticalVertices, otherwise no vertices are shared and
+     *  nothing can be simplified.
+     *
+     *  Use <tt>#AI_CONFIG_PP_LOD_RATIOS</tt> to specify the levels.
+    */
+    aiProcess_GenLODs = 0x10000000
 
     // aiProcess_GenEntityMeshes = 0x100000,
     // aiProcess_OptimizeAnimations = 0x200000
@@ -0,0 +1,136 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+#pragma once
+
+#include <assimp/mesh.h>
+
+#include <math.h>
+
+// Builds the procedural meshes shared by the post-processing tests
+class TestModelFactory {
+public:
+    enum GridFlags {
+        // faces in a scrambled order instead of row order
+        Grid_Scrambled = 0x1,
+        // normals whose z holds the original vertex index, to trace reordering
+        Grid_IndexNormals = 0x2,
+        // uv channel 0 spanning [0,1] over the grid
+        Grid_TexCoords = 0x4,
+        // the vertex column in the middle is duplicated with different UVs,
+        // like the border between two UV islands; implies Grid_TexCoords
+        Grid_UVSeam = 0x8,
+        // the left and right half follow different bones
+        Grid_Bones = 0x10
+    };
+
+    // A grid of dim x dim quads, two triangles each. 'height' scales a
+    // sine wave in z, 0 keeps the grid flat.
+    static aiMesh* CreateGrid(unsigned int dim, unsigned int flags = 0, float height = 0.f) {
+        const bool seam = (flags & Grid_UVSeam) != 0;
+        const bool uvs = seam || (flags & Grid_TexCoords) != 0;
+        const unsigned int row = dim + 1, mid = dim / 2;
+        const unsigned int numShared = row * row;
+        aiMesh* mesh = new aiMesh();
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        mesh->mNumVertices = numShared + (seam ? row : 0);
+        mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+        if (flags & Grid_IndexNormals) {
+            mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+        }
+        if (uvs) {
+            mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+            mesh->mNumUVComponents[0] = 2;
+        }
+        for (unsigned int v = 0; v < mesh->mNumVertices; ++v) {
+            // the seam column follows the shared vertices
+            const unsigned int x = v < numShared ? v % row : mid;
+            const unsigned int y = v < numShared ? v / row : v - numShared;
+            mesh->mVertices[v] = aiVector3D((float)x, (float)y, height * sinf(x * 0.4f) * cosf(y * 0.3f));
+            if (mesh->mNormals) {
+                mesh->mNormals[v] = aiVector3D(0.f, 0.f, (float)v);
+            }
+            if (uvs) {
+                mesh->mTextureCoords[0][v] = aiVector3D(v < numShared ? x / (float)dim : 0.f, y / (float)dim, 0.f);
+            }
+        }
+
+        // the right half uses the duplicated column
+        const auto index = [=](unsigned int x, unsigned int y, bool right) {
+            return seam && right && x == mid ? numShared + y : y * row + x;
+        };
+        mesh->mNumFaces = dim * dim * 2;
+        mesh->mFaces = new aiFace[mesh->mNumFaces];
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
+            // 7919 is prime, so the scrambled order still visits every quad exactly once
+            const unsigned int quad = flags & Grid_Scrambled ? ((f / 2) * 7919) % (dim * dim) : f / 2;
+            const unsigned int x = quad % dim, y = quad / dim;
+            const bool right = x >= mid;
+            aiFace& face = mesh->mFaces[f];
+            face.mNumIndices = 3;
+            face.mIndices = new unsigned int[3];
+            if (f & 1) {
+                face.mIndices[0] = index(x + 1, y, right);
+                face.mIndices[1] = index(x + 1, y + 1, right);
+                face.mIndices[2] = index(x, y + 1, right);
+            }
+            else {
+                face.mIndices[0] = index(x, y, right);
+                face.mIndices[1] = index(x + 1, y, right);
+                face.mIndices[2] = index(x, y + 1, right);
+            }
+        }
+
+        if (flags & Grid_Bones) {
+            mesh->mNumBones = 2;
+            mesh->mBones = new aiBone*[2];
+            for (unsigned int b = 0; b < 2; ++b) {
+                aiBone* bone = mesh->mBones[b] = new aiBone();
+                bone->mName.Set(b ? "right" : "left");
+                bone->mNumWeights = mesh->mNumVertices;
+                bone->mWeights = new aiVertexWeight[mesh->mNumVertices];
+                for (unsigned int v = 0; v < mesh->mNumVertices; ++v) {
+                    const bool isRight = mesh->mVertices[v].x > mid;
+                    bone->mWeights[v] = aiVertexWeight(v, isRight == (b == 1) ? 0.75f : 0.25f);
+                }
+            }
+        }
+        return mesh;
+    }
+};
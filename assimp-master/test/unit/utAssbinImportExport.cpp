@@ -0,0 +1,425 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/Exporter.hpp>
+#include <assimp/scene.h>
+#include <assimp/config.h>
+#include <assimp/postprocess.h>
+
+#include <string.h>
+#include <vector>
+
+#ifndef ASSIMP_BUILD_NO_EXPORT
+
+using namespace ::Assimp;
+
+static const char* const SkinnedModel = ASSIMP_TEST_MODELS_DIR "/X/BCN_Epileptic.X";
+static const char* const LightsModel = ASSIMP_TEST_MODELS_DIR "/Collada/lights.dae";
+static const char* const CamerasModel = ASSIMP_TEST_MODELS_DIR "/Collada/cameras.dae";
+
+class utAssbinImportExport : public ::testing::Test
+{
+protected:
+    // ------------------------------------------------------------------------------------------------
+    // Export a scene as version 2 .assbin file to memory
+    std::vector<char> Export(const aiScene* scene, int compression = 0)
+    {
+        ExportProperties props;
+        props.SetPropertyInteger(AI_CONFIG_EXPORT_ASSBIN_COMPRESSION, compression);
+
+        Exporter exporter;
+        const aiExportDataBlob* blob = exporter.ExportToBlob(scene, "assbin2", 0, &props);
+        EXPECT_TRUE(NULL != blob);
+        if (!blob) {
+            return std::vector<char>();
+        }
+        const char* data = static_cast<const char*>(blob->data);
+        return std::vector<char>(data, data + blob->size);
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void ExpectSameNodes(const aiNode* a, const aiNode* b)
+    {
+        ASSERT_TRUE(NULL != b);
+        EXPECT_STREQ(a->mName.C_Str(), b->mName.C_Str());
+        EXPECT_TRUE(a->mTransformation == b->mTransformation);
+        ASSERT_EQ(a->mNumMeshes, b->mNumMeshes);
+        if (a->mNumMeshes) {
+            EXPECT_EQ(0, memcmp(a->mMeshes, b->mMeshes, a->mNumMeshes * sizeof(unsigned int)));
+        }
+        ASSERT_EQ(a->mNumChildren, b->mNumChildren);
+        for (unsigned int i = 0; i < a->mNumChildren; ++i) {
+            EXPECT_EQ(b, b->mChildren[i]->mParent);
+            ExpectSameNodes(a->mChildren[i], b->mChildren[i]);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    template <typename T>
+    static void ExpectSameArray(const T* a, const T* b, unsigned int size)
+    {
+        ASSERT_EQ(NULL == a, NULL == b);
+        if (a) {
+            EXPECT_EQ(0, memcmp(a, b, size * sizeof(T)));
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void ExpectSameMesh(const aiMesh* a, const aiMesh* b)
+    {
+        EXPECT_STREQ(a->mName.C_Str(), b->mName.C_Str());
+        EXPECT_EQ(a->mPrimitiveTypes, b->mPrimitiveTypes);
+        EXPECT_EQ(a->mMaterialIndex, b->mMaterialIndex);
+        ASSERT_EQ(a->mNumVertices, b->mNumVertices);
+        ExpectSameArray(a->mVertices, b->mVertices, a->mNumVertices);
+        ExpectSameArray(a->mNormals, b->mNormals, a->mNumVertices);
+        ExpectSameArray(a->mTangents, b->mTangents, a->mNumVertices);
+        ExpectSameArray(a->mBitangents, b->mBitangents, a->mNumVertices);
+        for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_COLOR_SETS; ++n) {
+            ExpectSameArray(a->mColors[n], b->mColors[n], a->mNumVertices);
+        }
+        for (unsigned int n = 0; n < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++n) {
+            ExpectSameArray(a->mTextureCoords[n], b->mTextureCoords[n], a->mNumVertices);
+            EXPECT_EQ(a->mNumUVComponents[n], b->mNumUVComponents[n]);
+        }
+
+        ASSERT_EQ(a->mNumFaces, b->mNumFaces);
+        for (unsigned int i = 0; i < a->mNumFaces; ++i) {
+            ASSERT_EQ(a->mFaces[i].mNumIndices, b->mFaces[i].mNumIndices);
+            ExpectSameArray(a->mFaces[i].mIndices, b->mFaces[i].mIndices, a->mFaces[i].mNumIndices);
+        }
+
+        ASSERT_EQ(a->mNumBones, b->mNumBones);
+        for (unsigned int i = 0; i < a->mNumBones; ++i) {
+            const aiBone* ba = a->mBones[i];
+            const aiBone* bb = b->mBones[i];
+            EXPECT_STREQ(ba->mName.C_Str(), bb->mName.C_Str());
+            EXPECT_TRUE(ba->mOffsetMatrix == bb->mOffsetMatrix);
+            ASSERT_EQ(ba->mNumWeights, bb->mNumWeights);
+            for (unsigned int w = 0; w < ba->mNumWeights; ++w) {
+                EXPECT_EQ(ba->mWeights[w].mVertexId, bb->mWeights[w].mVertexId);
+                EXPECT_EQ(ba->mWeights[w].mWeight, bb->mWeights[w].mWeight);
+            }
+        }
+
+        ASSERT_EQ(a->mNumMeshlets, b->mNumMeshlets);
+        for (unsigned int i = 0; i < a->mNumMeshlets; ++i) {
+            const aiMeshlet& ma = a->mMeshlets[i];
+            const aiMeshlet& mb = b->mMeshlets[i];
+            ASSERT_EQ(ma.mNumVertices, mb.mNumVertices);
+            ASSERT_EQ(ma.mNumTriangles, mb.mNumTriangles);
+            ExpectSameArray(ma.mVertices, mb.mVertices, ma.mNumVertices);
+            ExpectSameArray(ma.mTriangles, mb.mTriangles, ma.mNumTriangles * 3);
+            EXPECT_TRUE(ma.mCenter == mb.mCenter);
+            EXPECT_EQ(ma.mRadius, mb.mRadius);
+            EXPECT_TRUE(ma.mConeAxis == mb.mConeAxis);
+            EXPECT_EQ(ma.mConeCutoff, mb.mConeCutoff);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void ExpectSameMaterial(const aiMaterial* a, const aiMaterial* b)
+    {
+        ASSERT_EQ(a->mNumProperties, b->mNumProperties);
+        for (unsigned int i = 0; i < a->mNumProperties; ++i) {
+            const aiMaterialProperty* pa = a->mProperties[i];
+            const aiMaterialProperty* pb = b->mProperties[i];
+            EXPECT_STREQ(pa->mKey.C_Str(), pb->mKey.C_Str());
+            EXPECT_EQ(pa->mSemantic, pb->mSemantic);
+            EXPECT_EQ(pa->mIndex, pb->mIndex);
+            EXPECT_EQ(pa->mType, pb->mType);
+            ASSERT_EQ(pa->mDataLength, pb->mDataLength);
+            EXPECT_EQ(0, memcmp(pa->mData, pb->mData, pa->mDataLength));
+        }
+
+        // the property index must be usable after loading
+        aiString name;
+        EXPECT_EQ(a->Get(AI_MATKEY_NAME, name), b->Get(AI_MATKEY_NAME, name));
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    template <typename T>
+    static void ExpectSameKeys(const T* a, const T* b, unsigned int size)
+    {
+        for (unsigned int i = 0; i < size; ++i) {
+            EXPECT_EQ(a[i].mTime, b[i].mTime);
+            EXPECT_TRUE(a[i].mValue == b[i].mValue);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void ExpectSameAnimation(const aiAnimation* a, const aiAnimation* b)
+    {
+        EXPECT_STREQ(a->mName.C_Str(), b->mName.C_Str());
+        EXPECT_EQ(a->mDuration, b->mDuration);
+        EXPECT_EQ(a->mTicksPerSecond, b->mTicksPerSecond);
+        ASSERT_EQ(a->mNumChannels, b->mNumChannels);
+        for (unsigned int i = 0; i < a->mNumChannels; ++i) {
+            const aiNodeAnim* ca = a->mChannels[i];
+            const aiNodeAnim* cb = b->mChannels[i];
+            EXPECT_STREQ(ca->mNodeName.C_Str(), cb->mNodeName.C_Str());
+            EXPECT_EQ(ca->mPreState, cb->mPreState);
+            EXPECT_EQ(ca->mPostState, cb->mPostState);
+            ASSERT_EQ(ca->mNumPositionKeys, cb->mNumPositionKeys);
+            ASSERT_EQ(ca->mNumRotationKeys, cb->mNumRotationKeys);
+            ASSERT_EQ(ca->mNumScalingKeys, cb->mNumScalingKeys);
+            ExpectSameKeys(ca->mPositionKeys, cb->mPositionKeys, ca->mNumPositionKeys);
+            ExpectSameKeys(ca->mRotationKeys, cb->mRotationKeys, ca->mNumRotationKeys);
+            ExpectSameKeys(ca->mScalingKeys, cb->mScalingKeys, ca->mNumScalingKeys);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------
+    static void ExpectSameScene(const aiScene* a, const aiScene* b)
+    {
+        ASSERT_TRUE(NULL != b);
+        ExpectSameNodes(a->mRootNode, b->mRootNode);
+        EXPECT_TRUE(NULL == b->mRootNode->mParent);
+
+        ASSERT_EQ(a->mNumMeshes, b->mNumMeshes);
+        for (unsigned int i = 0; i < a->mNumMeshes; ++i) {
+            ExpectSameMesh(a->mMeshes[i], b->mMeshes[i]);
+        }
+        ASSERT_EQ(a->mNumMaterials, b->mNumMaterials);
+        for (unsigned int i = 0; i < a->mNumMaterials; ++i) {
+            ExpectSameMaterial(a->mMaterials[i], b->mMaterials[i]);
+        }
+        ASSERT_EQ(a->mNumAnimations, b->mNumAnimations);
+        for (unsigned int i = 0; i < a->mNumAnimations; ++i) {
+            ExpectSameAnimation(a->mAnimations[i], b->mAnimations[i]);
+        }
+        ASSERT_EQ(a->mNumLights, b->mNumLights);
+        for (unsigned int i = 0; i < a->mNumLights; ++i) {
+            const aiLight* la = a->mLights[i];
+            const aiLight* lb = b->mLights[i];
+            EXPECT_STREQ(la->mName.C_Str(), lb->mName.C_Str());
+            EXPECT_EQ(la->mType, lb->mType);
+            EXPECT_TRUE(la->mPosition == lb->mPosition);
+            EXPECT_TRUE(la->mDirection == lb->mDirection);
+            EXPECT_TRUE(la->mColorDiffuse == lb->mColorDiffuse);
+            EXPECT_EQ(la->mAngleOuterCone, lb->mAngleOuterCone);
+        }
+        ASSERT_EQ(a->mNumCameras, b->mNumCameras);
+        for (unsigned int i = 0; i < a->mNumCameras; ++i) {
+            const aiCamera* ca = a->mCameras[i];
+            const aiCamera* cb = b->mCameras[i];
+            EXPECT_STREQ(ca->mName.C_Str(), cb->mName.C_Str());
+            EXPECT_TRUE(ca->mLookAt == cb->mLookAt);
+            EXPECT_EQ(ca->mHorizontalFOV, cb->mHorizontalFOV);
+            EXPECT_EQ(ca->mAspect, cb->mAspect);
+        }
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, roundTripSkinnedModel)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    ASSERT_LT(0u, scene->mNumAnimations);
+
+    const std::vector<char> data = Export(scene);
+    ASSERT_FALSE(data.empty());
+
+    Importer importer;
+    const aiScene* loaded = importer.ReadFileFromMemory(&data[0], data.size(), 0, "assbin");
+    ExpectSameScene(scene, loaded);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, roundTripLightsAndCameras)
+{
+    const char* const models[] = { LightsModel, CamerasModel };
+    for (const char* model : models) {
+        Importer source;
+        const aiScene* scene = source.ReadFile(model, 0);
+        ASSERT_TRUE(NULL != scene);
+
+        const std::vector<char> data = Export(scene);
+        Importer importer;
+        ExpectSameScene(scene, importer.ReadFileFromMemory(&data[0], data.size(), 0, "assbin"));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, roundTripMeshlets)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, aiProcess_Triangulate | aiProcess_GenMeshlets);
+    ASSERT_TRUE(NULL != scene);
+    ASSERT_TRUE(scene->mMeshes[0]->HasMeshlets());
+
+    const int compression[] = { 0, 6 };
+    for (int level : compression) {
+        const std::vector<char> data = Export(scene, level);
+        ASSERT_FALSE(data.empty());
+
+        Importer importer;
+        ExpectSameScene(scene, importer.ReadFileFromMemory(&data[0], data.size(), 0, "assbin"));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, chunksAreAligned)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    const std::vector<char> data = Export(scene);
+    ASSERT_LT(64u, data.size());
+    EXPECT_EQ(0, strcmp(&data[0], "ASSIMP.assbin2"));
+
+    uint32_t numEntries;
+    uint64_t tocOffset;
+    memcpy(&numEntries, &data[32], sizeof(numEntries));
+    memcpy(&tocOffset, &data[40], sizeof(tocOffset));
+    EXPECT_EQ(1 + scene->mNumMeshes + scene->mNumMaterials + scene->mNumAnimations + scene->mNumTextures, numEntries);
+
+    for (uint32_t i = 0; i < numEntries; ++i) {
+        uint64_t offset;
+        memcpy(&offset, &data[static_cast<size_t>(tocOffset) + i * 32 + 8], sizeof(offset));
+        EXPECT_EQ(0u, offset % 16);
+        EXPECT_LE(offset, data.size());
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, compressedChunksMatchUncompressed)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    const std::vector<char> stored = Export(scene);
+    const std::vector<char> compressed = Export(scene, 9);
+    ASSERT_FALSE(compressed.empty());
+    EXPECT_LT(compressed.size(), stored.size());
+
+    Importer importer;
+    ExpectSameScene(scene, importer.ReadFileFromMemory(&compressed[0], compressed.size(), 0, "assbin"));
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, parallelDecodeMatchesSerial)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    const std::vector<char> data = Export(scene, 1);
+    for (int threads = 1; threads <= 4; threads += 3) {
+        Importer importer;
+        importer.SetPropertyInteger(AI_CONFIG_IMPORT_ASSBIN_DECODE_THREADS, threads);
+        ExpectSameScene(scene, importer.ReadFileFromMemory(&data[0], data.size(), 0, "assbin"));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, truncatedFileIsRejected)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    const std::vector<char> data = Export(scene, 9);
+    for (int threads = 1; threads <= 4; threads += 3) {
+        Importer importer;
+        importer.SetPropertyInteger(AI_CONFIG_IMPORT_ASSBIN_DECODE_THREADS, threads);
+        EXPECT_TRUE(NULL == importer.ReadFileFromMemory(&data[0], data.size() - 17, 0, "assbin"));
+        EXPECT_TRUE(NULL == importer.ReadFileFromMemory(&data[0], 80, 0, "assbin"));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, oversizedChunkIsRejected)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    std::vector<char> data = Export(scene, 9);
+    uint32_t numEntries;
+    uint64_t tocOffset;
+    memcpy(&numEntries, &data[32], sizeof(numEntries));
+    memcpy(&tocOffset, &data[40], sizeof(tocOffset));
+
+    // claim a size no deflated chunk can expand to
+    bool patched = false;
+    for (uint32_t i = 0; i < numEntries && !patched; ++i) {
+        char* entry = &data[static_cast<size_t>(tocOffset) + i * 32];
+        uint32_t compression;
+        memcpy(&compression, entry + 24, sizeof(compression));
+        if (compression == 1) {
+            const uint32_t rawSize = 0xfffffff0;
+            memcpy(entry + 20, &rawSize, sizeof(rawSize));
+            patched = true;
+        }
+    }
+    ASSERT_TRUE(patched);
+
+    Importer importer;
+    EXPECT_TRUE(NULL == importer.ReadFileFromMemory(&data[0], data.size(), 0, "assbin"));
+    EXPECT_NE(std::string::npos, std::string(importer.GetErrorString()).find("invalid size"));
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAssbinImportExport, version1StillLoads)
+{
+    Importer source;
+    const aiScene* scene = source.ReadFile(SkinnedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    Exporter exporter;
+    const aiExportDataBlob* blob = exporter.ExportToBlob(scene, "assbin");
+    ASSERT_TRUE(NULL != blob);
+
+    Importer importer;
+    const aiScene* loaded = importer.ReadFileFromMemory(blob->data, blob->size, 0, "assbin");
+    ASSERT_TRUE(NULL != loaded);
+    ASSERT_EQ(scene->mNumMeshes, loaded->mNumMeshes);
+    EXPECT_EQ(scene->mMeshes[0]->mNumVertices, loaded->mMeshes[0]->mNumVertices);
+}
+
+#endif // ASSIMP_BUILD_NO_EXPORT
@@ -0,0 +1,195 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/AsyncImporter.hpp>
+#include <assimp/Importer.hpp>
+#include <assimp/ProgressHandler.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace ::Assimp;
+
+static const char* const AsyncModel = ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae";
+
+// ------------------------------------------------------------------------------------------------
+// Aborts the import on the first call
+class AbortingProgressHandler : public ProgressHandler
+{
+public:
+    bool Update(float) {
+        return false;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Blocks the worker until released by the test
+class BlockingProgressHandler : public ProgressHandler
+{
+public:
+    explicit BlockingProgressHandler(std::atomic<bool>* release)
+        : mRelease(release) {
+    }
+
+    bool Update(float) {
+        while (!*mRelease) {
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+private:
+    std::atomic<bool>* mRelease;
+};
+
+class utAsyncImporter : public ::testing::Test
+{
+    // empty
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAsyncImporter, importerHonorsProgressHandler)
+{
+    Importer imp;
+    imp.SetProgressHandler(new AbortingProgressHandler());
+    EXPECT_TRUE(NULL == imp.ReadFile(AsyncModel, aiProcess_Triangulate));
+    EXPECT_STRNE("", imp.GetErrorString());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAsyncImporter, importsOnWorker)
+{
+    AsyncImporter async(2);
+    EXPECT_EQ(2U, async.GetThreadCount());
+
+    AsyncImport handle = async.ReadFile(AsyncModel, aiProcess_Triangulate);
+    ASSERT_TRUE(handle.IsValid());
+    EXPECT_TRUE(handle.WaitFor(60 * 1000));
+    EXPECT_TRUE(handle.IsReady());
+    EXPECT_FLOAT_EQ(1.f, handle.GetProgress());
+    EXPECT_STREQ("", handle.GetErrorString());
+
+    aiScene* scene = handle.GetScene();
+    ASSERT_TRUE(NULL != scene);
+    EXPECT_LT(0U, scene->mNumMeshes);
+    delete scene;
+
+    // the scene is handed out only once
+    EXPECT_TRUE(NULL == handle.GetScene());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAsyncImporter, runsContinuationOnWorker)
+{
+    AsyncImporter async(1);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id worker = caller;
+    unsigned int numMeshes = 0;
+
+    AsyncImport handle = async.ReadFile(AsyncModel, aiProcess_Triangulate, NULL, NULL,
+        [&](const aiScene* scene) {
+            worker = std::this_thread::get_id();
+            numMeshes = scene->mNumMeshes;
+            return true;
+        });
+
+    aiScene* scene = handle.GetScene();
+    ASSERT_TRUE(NULL != scene);
+    EXPECT_NE(caller, worker);
+    EXPECT_EQ(scene->mNumMeshes, numMeshes);
+    delete scene;
+
+    AsyncImport failing = async.ReadFile(AsyncModel, 0, NULL, NULL,
+        [](const aiScene*) { return false; });
+    EXPECT_TRUE(NULL == failing.GetScene());
+    EXPECT_STRNE("", failing.GetErrorString());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAsyncImporter, cancelsImports)
+{
+    std::atomic<bool> release(false);
+    AsyncImporter async(1);
+
+    // the first import occupies the only worker, so the second one is still queued
+    AsyncImport blocking = async.ReadFile(AsyncModel, 0, NULL, new BlockingProgressHandler(&release));
+    AsyncImport queued = async.ReadFile(AsyncModel, 0);
+    queued.Cancel();
+    EXPECT_TRUE(queued.IsCancelled());
+    EXPECT_FALSE(blocking.IsCancelled());
+
+    release = true;
+    aiScene* scene = blocking.GetScene();
+    EXPECT_TRUE(NULL != scene);
+    delete scene;
+
+    EXPECT_TRUE(NULL == queued.GetScene());
+    EXPECT_STREQ("Import cancelled", queued.GetErrorString());
+
+    // the progress handler of the caller can abort the import, too
+    AsyncImport aborted = async.ReadFile(AsyncModel, 0, NULL, new AbortingProgressHandler());
+    EXPECT_TRUE(NULL == aborted.GetScene());
+    EXPECT_STRNE("", aborted.GetErrorString());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utAsyncImporter, usesPreconfiguredImporter)
+{
+    AsyncImporter async(1);
+    Importer* imp = new Importer();
+
+    AsyncImport handle = async.ReadFile(AsyncModel, aiProcess_Triangulate, imp);
+    aiScene* scene = handle.GetScene();
+    ASSERT_TRUE(NULL != scene);
+    delete scene;
+
+    // handles outliving the importer keep their results
+    AsyncImport pending;
+    {
+        AsyncImporter shortLived(1);
+        pending = shortLived.ReadFile(AsyncModel, 0);
+    }
+    EXPECT_TRUE(pending.IsReady());
+}
@@ -0,0 +1,146 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/config.h>
+#include <assimp/scene.h>
+
+#include <string.h>
+
+using namespace ::Assimp;
+
+static const char* const BinaryModel = ASSIMP_TEST_MODELS_DIR "/../models-nonbsd/FBX/2013_BINARY/duck.fbx";
+static const char* const AsciiModel = ASSIMP_TEST_MODELS_DIR "/../models-nonbsd/FBX/2013_ASCII/duck.fbx";
+
+// ------------------------------------------------------------------------------------------------
+static void ExpectSameMeshes(const aiScene* a, const aiScene* b)
+{
+    ASSERT_EQ(a->mNumMeshes, b->mNumMeshes);
+    for (unsigned int i = 0; i < a->mNumMeshes; ++i) {
+        const aiMesh* ma = a->mMeshes[i];
+        const aiMesh* mb = b->mMeshes[i];
+        ASSERT_EQ(ma->mNumVertices, mb->mNumVertices);
+        ASSERT_EQ(ma->mNumFaces, mb->mNumFaces);
+        EXPECT_EQ(0, memcmp(ma->mVertices, mb->mVertices, ma->mNumVertices * sizeof(aiVector3D)));
+        ASSERT_EQ(ma->HasNormals(), mb->HasNormals());
+        if (ma->HasNormals()) {
+            EXPECT_EQ(0, memcmp(ma->mNormals, mb->mNormals, ma->mNumVertices * sizeof(aiVector3D)));
+        }
+        ASSERT_EQ(ma->HasTextureCoords(0), mb->HasTextureCoords(0));
+        if (ma->HasTextureCoords(0)) {
+            EXPECT_EQ(0, memcmp(ma->mTextureCoords[0], mb->mTextureCoords[0], ma->mNumVertices * sizeof(aiVector3D)));
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utFBXImporter, parallelInflateMatchesSerial)
+{
+    Importer serial;
+    serial.SetPropertyInteger(AI_CONFIG_IMPORT_FBX_INFLATE_THREADS, 1);
+    const aiScene* reference = serial.ReadFile(BinaryModel, 0);
+    ASSERT_TRUE(NULL != reference);
+
+    Importer parallel;
+    parallel.SetPropertyInteger(AI_CONFIG_IMPORT_FBX_INFLATE_THREADS, 4);
+    const aiScene* scene = parallel.ReadFile(BinaryModel, 0);
+    ASSERT_TRUE(NULL != scene);
+
+    ExpectSameMeshes(reference, scene);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utFBXImporter, inflateThreadsIgnoredForAscii)
+{
+    Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_IMPORT_FBX_INFLATE_THREADS, 4);
+    const aiScene* scene = importer.ReadFile(AsciiModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    EXPECT_LT(0u, scene->mNumMeshes);
+}
+
+// ------------------------------------------------------------------------------------------------
+static const char* const AnimatedModel = ASSIMP_TEST_MODELS_DIR "/../models-nonbsd/FBX/2013_BINARY/multiple_animations_test.fbx";
+
+// ------------------------------------------------------------------------------------------------
+TEST(utFBXImporter, filtersAnimationStacks)
+{
+    Importer importer;
+    importer.SetPropertyString(AI_CONFIG_IMPORT_FBX_ANIMATION_STACKS, "spin");
+    const aiScene* scene = importer.ReadFile(AnimatedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    ASSERT_EQ(1u, scene->mNumAnimations);
+    EXPECT_STREQ("spin", scene->mAnimations[0]->mName.C_Str());
+    EXPECT_EQ(1u, scene->mNumMeshes);
+
+    importer.SetPropertyString(AI_CONFIG_IMPORT_FBX_ANIMATION_STACKS, "anim 1;spin");
+    scene = importer.ReadFile(AnimatedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    ASSERT_EQ(2u, scene->mNumAnimations);
+    EXPECT_STREQ("anim 1", scene->mAnimations[0]->mName.C_Str());
+    EXPECT_STREQ("spin", scene->mAnimations[1]->mName.C_Str());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utFBXImporter, skipsAnimations)
+{
+    Importer importer;
+    importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_READ_ANIMATIONS, false);
+    const aiScene* scene = importer.ReadFile(AnimatedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    EXPECT_EQ(0u, scene->mNumAnimations);
+    EXPECT_EQ(1u, scene->mNumMeshes);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utFBXImporter, skipsMeshes)
+{
+    Importer importer;
+    importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_READ_MESHES, false);
+    const aiScene* scene = importer.ReadFile(AnimatedModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    EXPECT_EQ(0u, scene->mNumMeshes);
+    EXPECT_EQ(3u, scene->mNumAnimations);
+    EXPECT_TRUE((scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) != 0);
+    ASSERT_TRUE(NULL != scene->mRootNode);
+    EXPECT_LT(0u, scene->mRootNode->mNumChildren);
+}
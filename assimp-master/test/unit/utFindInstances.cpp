@@ -0,0 +1,219 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/scene.h>
+#include <assimp/instances.h>
+#include <assimp/Importer.hpp>
+#include <FindInstancesProcess.h>
+
+#include <vector>
+
+using namespace Assimp;
+
+class FindInstancesProcessTest : public ::testing::Test
+{
+protected:
+    // a skinned quad, 'variant' displaces one vertex to make the mesh unique
+    static aiMesh* CreateQuad(unsigned int variant) {
+        aiMesh* mesh = new aiMesh();
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        mesh->mNumVertices = 4;
+        mesh->mVertices = new aiVector3D[4];
+        mesh->mNormals = new aiVector3D[4];
+        mesh->mTextureCoords[0] = new aiVector3D[4];
+        mesh->mNumUVComponents[0] = 2;
+        for (unsigned int i = 0; i < 4; ++i) {
+            mesh->mVertices[i] = aiVector3D((float)(i & 1), (float)(i >> 1), 0.f);
+            mesh->mNormals[i] = aiVector3D(0.f, 0.f, 1.f);
+            mesh->mTextureCoords[0][i] = aiVector3D((float)(i & 1), (float)(i >> 1), 0.f);
+        }
+        mesh->mVertices[3].z = (float)variant;
+
+        static const unsigned int indices[] = { 0, 1, 2, 1, 3, 2 };
+        mesh->mNumFaces = 2;
+        mesh->mFaces = new aiFace[2];
+        for (unsigned int f = 0; f < 2; ++f) {
+            mesh->mFaces[f].mNumIndices = 3;
+            mesh->mFaces[f].mIndices = new unsigned int[3];
+            std::copy(indices + f * 3, indices + f * 3 + 3, mesh->mFaces[f].mIndices);
+        }
+
+        mesh->mNumBones = 1;
+        mesh->mBones = new aiBone*[1];
+        aiBone* bone = mesh->mBones[0] = new aiBone();
+        bone->mName.Set("root");
+        bone->mNumWeights = 4;
+        bone->mWeights = new aiVertexWeight[4];
+        for (unsigned int i = 0; i < 4; ++i) {
+            bone->mWeights[i] = aiVertexWeight(i, 1.f);
+        }
+        return mesh;
+    }
+
+    // one node per mesh, the meshes cycle through 'numVariants' shapes
+    static aiScene* CreateScene(unsigned int numMeshes, unsigned int numVariants) {
+        aiScene* scene = new aiScene();
+        scene->mRootNode = new aiNode();
+        scene->mRootNode->mNumChildren = numMeshes;
+        scene->mRootNode->mChildren = new aiNode*[numMeshes];
+        scene->mNumMeshes = numMeshes;
+        scene->mMeshes = new aiMesh*[numMeshes];
+        for (unsigned int i = 0; i < numMeshes; ++i) {
+            scene->mMeshes[i] = CreateQuad(i % numVariants);
+
+            aiNode* node = scene->mRootNode->mChildren[i] = new aiNode();
+            node->mParent = scene->mRootNode;
+            node->mTransformation.a4 = (float)i;
+            node->mNumMeshes = 1;
+            node->mMeshes = new unsigned int[1];
+            node->mMeshes[0] = i;
+        }
+        return scene;
+    }
+
+    static void Run(aiScene* scene, int threads) {
+        Importer importer;
+        importer.SetPropertyInteger(AI_CONFIG_PP_FI_THREADS, threads);
+
+        FindInstancesProcess process;
+        process.SetupProperties(&importer);
+        process.Execute(scene);
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testContentHash)
+{
+    aiMesh* a = CreateQuad(0), *b = CreateQuad(0), *c = CreateQuad(1);
+    EXPECT_EQ(GetMeshContentHash(a), GetMeshContentHash(b));
+    EXPECT_NE(GetMeshContentHash(a), GetMeshContentHash(c));
+
+    // bones are part of the hash
+    b->mBones[0]->mWeights[2].mWeight = 0.5f;
+    EXPECT_NE(GetMeshContentHash(a), GetMeshContentHash(b));
+    delete a;
+    delete b;
+    delete c;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testFindInstances)
+{
+    aiScene* scene = CreateScene(12, 3);
+    Run(scene, 1);
+
+    // skinned meshes are joined as well
+    ASSERT_EQ(3u, scene->mNumMeshes);
+    for (unsigned int i = 0; i < 12; ++i) {
+        const aiNode* node = scene->mRootNode->mChildren[i];
+        ASSERT_EQ(1u, node->mNumMeshes);
+        EXPECT_EQ(i % 3, node->mMeshes[0]);
+        EXPECT_EQ((float)(i % 3), scene->mMeshes[node->mMeshes[0]]->mVertices[3].z);
+    }
+    delete scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testNearlyEqualMeshesAreJoined)
+{
+    // the copies differ in the last bits only, which changes their content
+    // hash but stays well within the position epsilon
+    aiScene* scene = CreateScene(4, 1);
+    scene->mMeshes[1]->mVertices[0].x += 1e-6f;
+    scene->mMeshes[2]->mNormals[1].z -= 1e-6f;
+    scene->mMeshes[3]->mTextureCoords[0][2].y += 1e-5f;
+    ASSERT_NE(GetMeshContentHash(scene->mMeshes[0]), GetMeshContentHash(scene->mMeshes[1]));
+    Run(scene, 1);
+
+    EXPECT_EQ(1u, scene->mNumMeshes);
+    for (unsigned int i = 0; i < 4; ++i) {
+        EXPECT_EQ(0u, scene->mRootNode->mChildren[i]->mMeshes[0]);
+    }
+    delete scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testDifferentBonesAreKept)
+{
+    aiScene* scene = CreateScene(2, 1);
+    scene->mMeshes[1]->mBones[0]->mName.Set("other");
+    Run(scene, 1);
+    EXPECT_EQ(2u, scene->mNumMeshes);
+    delete scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testParallelMatchesSerial)
+{
+    aiScene* serial = CreateScene(1000, 7);
+    aiScene* parallel = CreateScene(1000, 7);
+    Run(serial, 1);
+    Run(parallel, 4);
+
+    ASSERT_EQ(7u, serial->mNumMeshes);
+    ASSERT_EQ(serial->mNumMeshes, parallel->mNumMeshes);
+    for (unsigned int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(serial->mRootNode->mChildren[i]->mMeshes[0], parallel->mRootNode->mChildren[i]->mMeshes[0]);
+    }
+    delete serial;
+    delete parallel;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(FindInstancesProcessTest, testInstanceTable)
+{
+    aiScene* scene = CreateScene(6, 2);
+    Run(scene, 1);
+
+    ASSERT_EQ(6u, aiGetNumMeshInstances(scene));
+    std::vector<aiMeshInstance> instances(6);
+    aiGetMeshInstances(scene, &instances[0]);
+
+    // grouped by mesh, in node order within each group
+    static const unsigned int nodes[] = { 0, 2, 4, 1, 3, 5 };
+    for (unsigned int i = 0; i < 6; ++i) {
+        EXPECT_EQ(i / 3, instances[i].mMesh);
+        EXPECT_EQ(scene->mRootNode->mChildren[nodes[i]], instances[i].mNode);
+        EXPECT_EQ((float)nodes[i], instances[i].mTransformation.a4);
+    }
+    delete scene;
+}
@@ -0,0 +1,233 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+#include "TestModelFactory.h"
+
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <GenLODsProcess.h>
+
+#include <vector>
+
+using namespace Assimp;
+
+class GenLODsTest : public ::testing::Test
+{
+protected:
+    // A gently curved grid of dim x dim quads. With 'seam', the vertex column
+    // in the middle is duplicated with different UVs, like the border between
+    // two UV islands. With 'bones', the left and right half follow different
+    // bones.
+    static aiMesh* CreateGrid(unsigned int dim, bool seam, bool bones) {
+        const unsigned int flags = TestModelFactory::Grid_TexCoords
+            | (seam ? TestModelFactory::Grid_UVSeam : 0)
+            | (bones ? TestModelFactory::Grid_Bones : 0);
+        return TestModelFactory::CreateGrid(dim, flags, 0.05f);
+    }
+
+    static bool HasPosition(const aiMesh* mesh, const aiVector3D& p) {
+        for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+            if (mesh->mVertices[i] == p) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void CheckLOD(const aiMesh* lod, const aiMesh* orig) {
+        ASSERT_TRUE(NULL != lod);
+        EXPECT_EQ(aiPrimitiveType_TRIANGLE, lod->mPrimitiveTypes);
+        ASSERT_TRUE(lod->HasTextureCoords(0));
+        for (unsigned int f = 0; f < lod->mNumFaces; ++f) {
+            const aiFace& face = lod->mFaces[f];
+            ASSERT_EQ(3u, face.mNumIndices);
+            for (unsigned int k = 0; k < 3; ++k) {
+                ASSERT_LT(face.mIndices[k], lod->mNumVertices);
+            }
+
+            // no face is flipped, the grid faces +z
+            const aiVector3D& a = lod->mVertices[face.mIndices[0]];
+            const aiVector3D n = (lod->mVertices[face.mIndices[1]] - a) ^ (lod->mVertices[face.mIndices[2]] - a);
+            EXPECT_GT(n.z, 0.f);
+        }
+
+        // the borders of the grid are kept
+        const unsigned int dim = (unsigned int)orig->mVertices[orig->mNumVertices - 1].y;
+        for (unsigned int i = 0; i <= dim; ++i) {
+            EXPECT_TRUE(HasPosition(lod, aiVector3D((float)i, 0.f, orig->mVertices[i].z)));
+        }
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenLODsTest, testChain)
+{
+    aiMesh* mesh = CreateGrid(32, false, false);
+    GenLODsProcess process;
+    std::vector<float> ratios;
+    ratios.push_back(0.25f);
+    ratios.push_back(0.5f);
+    ratios.push_back(7.f);
+    process.SetRatios(ratios);
+
+    std::vector<aiMesh*> lods;
+    process.GenMeshLODs(mesh, lods);
+
+    // invalid ratios are dropped, the others sorted
+    ASSERT_EQ(2u, lods.size());
+    EXPECT_LE(lods[0]->mNumFaces, mesh->mNumFaces / 2);
+    EXPECT_LE(lods[1]->mNumFaces, mesh->mNumFaces / 4);
+    EXPECT_LT(lods[1]->mNumVertices, lods[0]->mNumVertices);
+    EXPECT_STREQ("_LOD1", lods[0]->mName.C_Str());
+    for (unsigned int i = 0; i < lods.size(); ++i) {
+        CheckLOD(lods[i], mesh);
+        delete lods[i];
+    }
+    delete mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenLODsTest, testSeamsAndBones)
+{
+    aiMesh* mesh = CreateGrid(32, true, true);
+    GenLODsProcess process;
+    std::vector<aiMesh*> lods;
+    process.GenMeshLODs(mesh, lods);
+    ASSERT_FALSE(lods.empty());
+
+    for (unsigned int i = 0; i < lods.size(); ++i) {
+        const aiMesh* lod = lods[i];
+        CheckLOD(lod, mesh);
+        EXPECT_LT(lod->mNumFaces, mesh->mNumFaces);
+
+        // both sides of the seam survive with their own UVs
+        for (unsigned int y = 0; y <= 32; ++y) {
+            unsigned int found = 0;
+            for (unsigned int v = 0; v < lod->mNumVertices; ++v) {
+                if (lod->mVertices[v].x == 16.f && lod->mVertices[v].y == (float)y) {
+                    ++found;
+                }
+            }
+            EXPECT_EQ(2u, found);
+        }
+
+        // every vertex keeps its weights, and vertices only merged
+        // with vertices following the same bone
+        ASSERT_EQ(2u, lod->mNumBones);
+        for (unsigned int b = 0; b < 2; ++b) {
+            const aiBone* bone = lod->mBones[b];
+            EXPECT_EQ(lod->mNumVertices, bone->mNumWeights);
+            for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+                const aiVertexWeight& weight = bone->mWeights[w];
+                ASSERT_LT(weight.mVertexId, lod->mNumVertices);
+                const bool isRight = lod->mVertices[weight.mVertexId].x > 16.f;
+                EXPECT_EQ(isRight == (b == 1) ? 0.75f : 0.25f, weight.mWeight);
+            }
+        }
+        for (unsigned int f = 0; f < lod->mNumFaces; ++f) {
+            const aiFace& face = lod->mFaces[f];
+            float minX = 32.f, maxX = 0.f;
+            for (unsigned int k = 0; k < 3; ++k) {
+                minX = std::min(minX, lod->mVertices[face.mIndices[k]].x);
+                maxX = std::max(maxX, lod->mVertices[face.mIndices[k]].x);
+            }
+            EXPECT_FALSE(minX < 16.f && maxX > 16.f);
+        }
+        delete lods[i];
+    }
+    delete mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenLODsTest, testSceneLinks)
+{
+    std::vector<aiScene*> scenes;
+    for (unsigned int threads = 1; threads <= 4; threads += 3) {
+        aiScene* scene = new aiScene();
+        scene->mNumMeshes = 3;
+        scene->mMeshes = new aiMesh*[3];
+        for (unsigned int i = 0; i < 3; ++i) {
+            scene->mMeshes[i] = CreateGrid(16 + i * 4, false, false);
+        }
+        scene->mRootNode = new aiNode();
+        scene->mRootNode->mNumMeshes = 2;
+        scene->mRootNode->mMeshes = new unsigned int[2];
+        scene->mRootNode->mMeshes[0] = 2;
+        scene->mRootNode->mMeshes[1] = 0;
+
+        Importer importer;
+        importer.SetPropertyString(AI_CONFIG_PP_LOD_RATIOS, "0.5 0.2");
+        importer.SetPropertyInteger(AI_CONFIG_PP_LOD_THREADS, (int)threads);
+        GenLODsProcess process;
+        process.SetupProperties(&importer);
+        process.Execute(scene);
+        scenes.push_back(scene);
+    }
+
+    const aiScene* scene = scenes[0];
+    ASSERT_EQ(9u, scene->mNumMeshes);
+    ASSERT_TRUE(NULL != scene->mRootNode->mMetaData);
+    EXPECT_EQ(4u, scene->mRootNode->mMetaData->mNumProperties);
+
+    // LOD_<slot>_<level>, the first slot references mesh 2
+    int32_t index = 0;
+    ASSERT_TRUE(scene->mRootNode->mMetaData->Get("LOD_0_1", index));
+    EXPECT_EQ(7, index);
+    ASSERT_TRUE(scene->mRootNode->mMetaData->Get("LOD_0_2", index));
+    EXPECT_EQ(8, index);
+    ASSERT_TRUE(scene->mRootNode->mMetaData->Get("LOD_1_2", index));
+    EXPECT_EQ(4, index);
+    EXPECT_LT(scene->mMeshes[8]->mNumFaces, scene->mMeshes[7]->mNumFaces);
+    EXPECT_LT(scene->mMeshes[7]->mNumFaces, scene->mMeshes[2]->mNumFaces);
+
+    // parallel and serial results are identical
+    ASSERT_EQ(scene->mNumMeshes, scenes[1]->mNumMeshes);
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        const aiMesh* a = scene->mMeshes[i], *b = scenes[1]->mMeshes[i];
+        ASSERT_EQ(a->mNumFaces, b->mNumFaces);
+        ASSERT_EQ(a->mNumVertices, b->mNumVertices);
+        for (unsigned int f = 0; f < a->mNumFaces; ++f) {
+            EXPECT_EQ(0, memcmp(a->mFaces[f].mIndices, b->mFaces[f].mIndices, sizeof(unsigned int) * 3));
+        }
+    }
+    delete scenes[0];
+    delete scenes[1];
+}
@@ -0,0 +1,177 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+#include "TestModelFactory.h"
+
+#include <assimp/scene.h>
+#include <assimp/cexport.h>
+#include <assimp/postprocess.h>
+#include <assimp/Importer.hpp>
+#include <GenMeshletsProcess.h>
+
+#include <math.h>
+#include <vector>
+
+using namespace Assimp;
+
+class GenMeshletsTest : public ::testing::Test
+{
+protected:
+    // a wavy grid of dim x dim quads in row order
+    static aiMesh* CreateGrid(unsigned int dim) {
+        return TestModelFactory::CreateGrid(dim, 0, 1.f);
+    }
+
+    // checks limits, coverage and bounds of the meshlets of a mesh
+    static void CheckMeshlets(const aiMesh* mesh, unsigned int maxVertices, unsigned int maxTriangles) {
+        ASSERT_TRUE(mesh->HasMeshlets());
+
+        unsigned int face = 0;
+        for (unsigned int i = 0; i < mesh->mNumMeshlets; ++i) {
+            const aiMeshlet& meshlet = mesh->mMeshlets[i];
+            EXPECT_LE(meshlet.mNumVertices, maxVertices);
+            EXPECT_LE(meshlet.mNumTriangles, maxTriangles);
+            EXPECT_GT(meshlet.mNumTriangles, 0u);
+
+            // every face is covered exactly once, in order
+            for (unsigned int t = 0; t < meshlet.mNumTriangles; ++t, ++face) {
+                ASSERT_LT(face, mesh->mNumFaces);
+                for (unsigned int c = 0; c < 3; ++c) {
+                    const unsigned int l = meshlet.mTriangles[t * 3 + c];
+                    ASSERT_LT(l, meshlet.mNumVertices);
+                    EXPECT_EQ(mesh->mFaces[face].mIndices[c], meshlet.mVertices[l]);
+                }
+            }
+
+            // the sphere encloses all vertices
+            for (unsigned int v = 0; v < meshlet.mNumVertices; ++v) {
+                EXPECT_LE((mesh->mVertices[meshlet.mVertices[v]] - meshlet.mCenter).Length(), meshlet.mRadius);
+            }
+
+            // the cone encloses all normals
+            if (meshlet.mConeCutoff < 1.f) {
+                const float minDot = sqrtf(1.f - meshlet.mConeCutoff * meshlet.mConeCutoff);
+                for (unsigned int t = 0; t < meshlet.mNumTriangles; ++t) {
+                    const aiVector3D& a = mesh->mVertices[meshlet.mVertices[meshlet.mTriangles[t * 3]]];
+                    const aiVector3D& b = mesh->mVertices[meshlet.mVertices[meshlet.mTriangles[t * 3 + 1]]];
+                    const aiVector3D& c = mesh->mVertices[meshlet.mVertices[meshlet.mTriangles[t * 3 + 2]]];
+                    const aiVector3D n = ((b - a) ^ (c - a)).Normalize();
+                    EXPECT_GE(n * meshlet.mConeAxis, minDot - 1e-5f);
+                }
+            }
+        }
+        EXPECT_EQ(mesh->mNumFaces, face);
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenMeshletsTest, testDefaultLimits)
+{
+    aiMesh* mesh = CreateGrid(40);
+    GenMeshletsProcess process;
+    process.GenMeshMeshlets(mesh);
+
+    CheckMeshlets(mesh, 64, 124);
+    EXPECT_GE(mesh->mNumMeshlets, mesh->mNumFaces / 124);
+    delete mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenMeshletsTest, testCustomLimits)
+{
+    static const unsigned int limits[][2] = { { 3, 1 }, { 16, 500 }, { 256, 16 }, { 1000, 1000 } };
+    for (unsigned int i = 0; i < 4; ++i) {
+        aiMesh* mesh = CreateGrid(24);
+        GenMeshletsProcess process;
+        process.SetLimits(limits[i][0], limits[i][1]);
+        process.GenMeshMeshlets(mesh);
+
+        // vertex limits above 256 are clamped
+        CheckMeshlets(mesh, std::min(limits[i][0], 256u), limits[i][1]);
+        delete mesh;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenMeshletsTest, testBackFacing)
+{
+    // a flat quad facing +z
+    aiMesh* mesh = CreateGrid(1);
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+        mesh->mVertices[i].z = 0.f;
+    }
+    GenMeshletsProcess process;
+    process.GenMeshMeshlets(mesh);
+
+    ASSERT_EQ(1u, mesh->mNumMeshlets);
+    const aiMeshlet& meshlet = mesh->mMeshlets[0];
+    EXPECT_NEAR(1.f, meshlet.mConeAxis.z, 1e-5f);
+    EXPECT_NEAR(0.f, meshlet.mConeCutoff, 1e-5f);
+    EXPECT_TRUE(meshlet.IsBackFacing(aiVector3D(0.5f, 0.5f, -10.f)));
+    EXPECT_FALSE(meshlet.IsBackFacing(aiVector3D(0.5f, 0.5f, 10.f)));
+
+    // close to the plane, the viewer might see the front through the bounds
+    EXPECT_FALSE(meshlet.IsBackFacing(aiVector3D(0.5f, 0.5f, -0.1f)));
+    delete mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(GenMeshletsTest, testImport)
+{
+    Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_PP_ML_MAX_VERTICES, 32);
+    const aiScene* scene = importer.ReadFile(ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae",
+        aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenMeshlets);
+    ASSERT_TRUE(NULL != scene);
+
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        CheckMeshlets(scene->mMeshes[i], 32, AI_ML_DEFAULT_MAX_TRIANGLES);
+    }
+
+    // meshlets survive a copy of the scene
+    aiScene* copy = NULL;
+    aiCopyScene(scene, &copy);
+    ASSERT_TRUE(NULL != copy);
+    EXPECT_EQ(scene->mMeshes[0]->mNumMeshlets, copy->mMeshes[0]->mNumMeshlets);
+    EXPECT_NE(scene->mMeshes[0]->mMeshlets, copy->mMeshes[0]->mMeshlets);
+    CheckMeshlets(copy->mMeshes[0], 32, AI_ML_DEFAULT_MAX_TRIANGLES);
+    aiFreeScene(copy);
+}
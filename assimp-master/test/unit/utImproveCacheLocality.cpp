@@ -39,4 +39,174 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ---------------------------------------------------------------------------
 */
 
-#include "UnitTestPCH.h"
\ No newline at end of file
+#include "UnitTestPCH.h"
+#include "TestModelFactory.h"
+
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <ImproveCacheLocality.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+using namespace Assimp;
+
+class ImproveCacheLocalityTest : public ::testing::Test
+{
+protected:
+    typedef std::array<aiVector3D, 3> Triangle;
+
+    // a flat grid of dim x dim quads with the faces in a scrambled order,
+    // which gives the optimizer something to do
+    static aiMesh* CreateGrid(unsigned int dim) {
+        return TestModelFactory::CreateGrid(dim, TestModelFactory::Grid_Scrambled | TestModelFactory::Grid_IndexNormals);
+    }
+
+    static aiScene* CreateScene(unsigned int numMeshes, unsigned int dim) {
+        aiScene* scene = new aiScene();
+        scene->mNumMeshes = numMeshes;
+        scene->mMeshes = new aiMesh*[numMeshes];
+        for (unsigned int i = 0; i < numMeshes; ++i) {
+            scene->mMeshes[i] = CreateGrid(dim + i);
+        }
+        return scene;
+    }
+
+    // the triangles by position, rotated to start with the smallest position
+    // so that the winding order is checked, too
+    static std::vector<Triangle> CollectTriangles(const aiMesh* mesh) {
+        std::vector<Triangle> out;
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
+            const unsigned int* idx = mesh->mFaces[f].mIndices;
+            Triangle tri;
+            for (unsigned int i = 0; i < 3; ++i) {
+                tri[i] = mesh->mVertices[idx[i]];
+            }
+            std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+            out.push_back(tri);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    static void Run(aiScene* scene, int algorithm, bool reorder, int threads) {
+        Importer importer;
+        importer.SetPropertyInteger(AI_CONFIG_PP_ICL_ALGORITHM, algorithm);
+        importer.SetPropertyBool(AI_CONFIG_PP_ICL_REORDER_VERTICES, reorder);
+        importer.SetPropertyInteger(AI_CONFIG_PP_ICL_THREADS, threads);
+
+        ImproveCacheLocalityProcess process;
+        process.SetupProperties(&importer);
+        process.Execute(scene);
+    }
+
+    void CheckAlgorithm(int algorithm) {
+        aiScene* scene = CreateScene(1, 32);
+        const std::vector<Triangle> before = CollectTriangles(scene->mMeshes[0]);
+        const unsigned int missesIn = ImproveCacheLocalityProcess::CountCacheMisses(scene->mMeshes[0], PP_ICL_PTCACHE_SIZE);
+
+        Run(scene, algorithm, false, 1);
+
+        EXPECT_TRUE(before == CollectTriangles(scene->mMeshes[0]));
+        const unsigned int missesOut = ImproveCacheLocalityProcess::CountCacheMisses(scene->mMeshes[0], PP_ICL_PTCACHE_SIZE);
+        EXPECT_LT(missesOut, missesIn);
+
+        // a regular grid can't get much better than one miss per triangle
+        EXPECT_LT((float)missesOut / scene->mMeshes[0]->mNumFaces, 1.0f);
+        delete scene;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(ImproveCacheLocalityTest, testCountCacheMisses)
+{
+    aiMesh* mesh = CreateGrid(1);
+
+    // two triangles sharing an edge, four vertices
+    EXPECT_EQ(4u, ImproveCacheLocalityProcess::CountCacheMisses(mesh, 4));
+    EXPECT_EQ(4u, ImproveCacheLocalityProcess::CountCacheMisses(mesh, 3));
+    EXPECT_EQ(6u, ImproveCacheLocalityProcess::CountCacheMisses(mesh, 1));
+    delete mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(ImproveCacheLocalityTest, testTipsify)
+{
+    CheckAlgorithm(aiCacheLocalityAlgorithm_Tipsify);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(ImproveCacheLocalityTest, testForsyth)
+{
+    CheckAlgorithm(aiCacheLocalityAlgorithm_Forsyth);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(ImproveCacheLocalityTest, testReorderVertices)
+{
+    aiScene* scene = CreateScene(1, 16);
+    aiMesh* mesh = scene->mMeshes[0];
+
+    // every vertex is weighted by its own index to check the remapping
+    mesh->mNumBones = 1;
+    mesh->mBones = new aiBone*[1];
+    aiBone* bone = mesh->mBones[0] = new aiBone();
+    bone->mNumWeights = mesh->mNumVertices;
+    bone->mWeights = new aiVertexWeight[mesh->mNumVertices];
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+        bone->mWeights[i] = aiVertexWeight(i, (float)i);
+    }
+
+    const std::vector<Triangle> before = CollectTriangles(mesh);
+    Run(scene, aiCacheLocalityAlgorithm_Forsyth, true, 1);
+    EXPECT_TRUE(before == CollectTriangles(mesh));
+
+    // the vertices are numbered in the order of their first use
+    unsigned int next = 0;
+    for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
+        for (unsigned int i = 0; i < 3; ++i) {
+            const unsigned int v = mesh->mFaces[f].mIndices[i];
+            ASSERT_LE(v, next);
+            if (v == next) {
+                ++next;
+            }
+        }
+    }
+    EXPECT_EQ(mesh->mNumVertices, next);
+
+    // normals and weights travel with their vertices
+    const unsigned int row = 17;
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+        const unsigned int original = (unsigned int)(mesh->mVertices[i].y * row + mesh->mVertices[i].x);
+        EXPECT_EQ((float)original, mesh->mNormals[i].z);
+
+        const aiVertexWeight& weight = bone->mWeights[original];
+        EXPECT_EQ(i, weight.mVertexId);
+        EXPECT_EQ((float)original, weight.mWeight);
+    }
+    delete scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(ImproveCacheLocalityTest, testParallelMatchesSerial)
+{
+    static const int algorithms[] = { aiCacheLocalityAlgorithm_Tipsify, aiCacheLocalityAlgorithm_Forsyth };
+    for (unsigned int a = 0; a < 2; ++a) {
+        aiScene* serial = CreateScene(8, 12);
+        aiScene* parallel = CreateScene(8, 12);
+        Run(serial, algorithms[a], true, 1);
+        Run(parallel, algorithms[a], true, 4);
+
+        for (unsigned int m = 0; m < serial->mNumMeshes; ++m) {
+            const aiMesh* ms = serial->mMeshes[m], *mp = parallel->mMeshes[m];
+            ASSERT_EQ(ms->mNumFaces, mp->mNumFaces);
+            for (unsigned int f = 0; f < ms->mNumFaces; ++f) {
+                EXPECT_EQ(0, memcmp(ms->mFaces[f].mIndices, mp->mFaces[f].mIndices, sizeof(unsigned int) * 3));
+            }
+            EXPECT_EQ(0, memcmp(ms->mVertices, mp->mVertices, sizeof(aiVector3D) * ms->mNumVertices));
+        }
+        delete serial;
+        delete parallel;
+    }
+}
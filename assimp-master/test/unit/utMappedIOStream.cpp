@@ -0,0 +1,114 @@
+/*-------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+-------------------------------------------------------------------------*/
+#include "UnitTestPCH.h"
+
+#include "MappedIOStream.h"
+#include <assimp/Importer.hpp>
+#include <assimp/IOSystem.hpp>
+
+using namespace ::Assimp;
+
+static const size_t Size = 1000;
+
+class utMappedIOStream : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        tmpnam( m_file );
+        std::FILE *fs( std::fopen( m_file, "wb" ) );
+        ASSERT_TRUE( nullptr != fs );
+        for ( size_t i = 0; i < Size; ++i ) {
+            m_data[ i ] = static_cast<char>( 'a' + i % 26 );
+        }
+        std::fwrite( m_data, 1, Size, fs );
+        std::fclose( fs );
+    }
+
+    virtual void TearDown() {
+        remove( m_file );
+    }
+
+    char m_file[ L_tmpnam ];
+    char m_data[ Size ];
+};
+
+TEST_F( utMappedIOStream, openFailsForMissingFileTest ) {
+    remove( m_file );
+    EXPECT_EQ( nullptr, MappedIOStream::Open( m_file ) );
+}
+
+TEST_F( utMappedIOStream, readSeekTest ) {
+    MappedIOStream *stream( MappedIOStream::Open( m_file ) );
+    ASSERT_TRUE( nullptr != stream );
+    EXPECT_EQ( Size, stream->FileSize() );
+    EXPECT_EQ( 0, memcmp( m_data, stream->GetData(), Size ) );
+
+    char buffer[ Size ];
+    EXPECT_EQ( 1U, stream->Read( buffer, 10, 1 ) );
+    EXPECT_EQ( 0, memcmp( m_data, buffer, 10 ) );
+    EXPECT_EQ( 10U, stream->Tell() );
+
+    EXPECT_EQ( AI_SUCCESS, stream->Seek( 5, aiOrigin_END ) );
+    EXPECT_EQ( Size - 5, stream->Tell() );
+
+    // only complete elements are read
+    EXPECT_EQ( 2U, stream->Read( buffer, 2, 4 ) );
+    EXPECT_EQ( 0, memcmp( m_data + Size - 5, buffer, 4 ) );
+
+    EXPECT_EQ( AI_SUCCESS, stream->Seek( 0, aiOrigin_END ) );
+    EXPECT_EQ( AI_FAILURE, stream->Seek( 1, aiOrigin_CUR ) );
+    EXPECT_EQ( AI_FAILURE, stream->Seek( Size + 1, aiOrigin_SET ) );
+    EXPECT_EQ( 0U, stream->Write( buffer, 1, 1 ) );
+    delete stream;
+}
+
+TEST_F( utMappedIOStream, defaultIOSystemMapsReadOnlyFilesTest ) {
+    Importer importer;
+    IOSystem *io( importer.GetIOHandler() );
+
+    IOStream *stream( io->Open( m_file, "rb" ) );
+    ASSERT_TRUE( nullptr != stream );
+    EXPECT_TRUE( nullptr != dynamic_cast<MappedIOStream*>( stream ) );
+    EXPECT_EQ( Size, stream->FileSize() );
+    io->Close( stream );
+
+    stream = io->Open( m_file, "r" );
+    ASSERT_TRUE( nullptr != stream );
+    EXPECT_EQ( nullptr, dynamic_cast<MappedIOStream*>( stream ) );
+    io->Close( stream );
+}
@@ -43,6 +43,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/scene.h>
 #include <MaterialSystem.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace ::std;
 using namespace ::Assimp;
 
@@ -127,3 +131,126 @@ TEST_F(MaterialSystemTest, testStringProperty)
     EXPECT_EQ(AI_SUCCESS, pcMat->Get("testKey6",0,0,s));
     EXPECT_STREQ("Hello, this is a small test", s.data);
 }
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(MaterialSystemTest, testManyPropertiesReplaceAndRemove)
+{
+    // enough properties to grow the list and the index several times
+    for (int i = 0; i < 100; ++i) {
+        this->pcMat->AddProperty(&i, 1, "testKey7", i % 4, i / 4);
+    }
+    EXPECT_EQ(100u, pcMat->mNumProperties);
+
+    int value = 1000;
+    this->pcMat->AddProperty(&value, 1, "testKey7", 1, 5);
+    EXPECT_EQ(100u, pcMat->mNumProperties);
+
+    EXPECT_EQ(AI_SUCCESS, pcMat->RemoveProperty("testKey7", 2, 0));
+    EXPECT_EQ(AI_FAILURE, pcMat->RemoveProperty("testKey7", 2, 0));
+    EXPECT_EQ(99u, pcMat->mNumProperties);
+
+    for (int i = 0; i < 100; ++i) {
+        int out = -1;
+        const aiReturn ret = pcMat->Get("testKey7", i % 4, i / 4, out);
+        if (2 == i) {
+            EXPECT_EQ(AI_FAILURE, ret);
+        } else {
+            EXPECT_EQ(AI_SUCCESS, ret);
+            EXPECT_EQ(21 == i ? 1000 : i, out);
+        }
+    }
+    EXPECT_EQ(AI_FAILURE, pcMat->Get("testKey8", 0, 0, value));
+
+    // the undocumented wildcard still finds the first match
+    const aiMaterialProperty* prop = NULL;
+    EXPECT_EQ(AI_SUCCESS, aiGetMaterialProperty(pcMat, "testKey7", UINT_MAX, 3, &prop));
+    ASSERT_TRUE(NULL != prop);
+    EXPECT_EQ(0u, prop->mSemantic);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(MaterialSystemTest, testDirectlyModifiedPropertyList)
+{
+    int value = 1;
+    this->pcMat->AddProperty(&value, 1, "testKey9");
+    value = 2;
+    this->pcMat->AddProperty(&value, 1, "testKey10");
+
+    // shrink the list without the setters, like some post processing steps do
+    delete pcMat->mProperties[0];
+    pcMat->mProperties[0] = pcMat->mProperties[1];
+    --pcMat->mNumProperties;
+
+    EXPECT_EQ(AI_FAILURE, pcMat->Get("testKey9", 0, 0, value));
+    EXPECT_EQ(AI_SUCCESS, pcMat->Get("testKey10", 0, 0, value));
+    EXPECT_EQ(2, value);
+
+    // replace an entry in place, the index must be updated explicitly
+    aiMaterialProperty* prop = pcMat->mProperties[0];
+    prop->mKey.Set("testKey11");
+    pcMat->UpdatePropertyIndex();
+    EXPECT_EQ(AI_FAILURE, pcMat->Get("testKey10", 0, 0, value));
+    EXPECT_EQ(AI_SUCCESS, pcMat->Get("testKey11", 0, 0, value));
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(MaterialSystemTest, testIndexInvalidatedByEveryChange)
+{
+    for (int i = 0; i < 64; ++i) {
+        this->pcMat->AddProperty(&i, 1, "testKey12", 0, i);
+    }
+
+    // replace entries with data of the same length, lookups must see the new values
+    for (int i = 0; i < 64; i += 2) {
+        const int value = -i;
+        this->pcMat->AddProperty(&value, 1, "testKey12", 0, i);
+        int out = 0;
+        EXPECT_EQ(AI_SUCCESS, pcMat->Get("testKey12", 0, i, out));
+        EXPECT_EQ(-i, out);
+    }
+
+    // remove every other property, the others keep their values
+    for (int i = 0; i < 64; i += 2) {
+        EXPECT_EQ(AI_SUCCESS, pcMat->RemoveProperty("testKey12", 0, i));
+    }
+    EXPECT_EQ(32u, pcMat->mNumProperties);
+    for (int i = 0; i < 64; ++i) {
+        int out = -1;
+        EXPECT_EQ(i % 2 ? AI_SUCCESS : AI_FAILURE, pcMat->Get("testKey12", 0, i, out));
+        if (i % 2) {
+            EXPECT_EQ(i, out);
+        }
+    }
+
+    pcMat->Clear();
+    int out = -1;
+    EXPECT_EQ(AI_FAILURE, pcMat->Get("testKey12", 0, 1, out));
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(MaterialSystemTest, testConcurrentLookupsRebuildOnce)
+{
+    for (int i = 0; i < 200; ++i) {
+        this->pcMat->AddProperty(&i, 1, "testKey13", 0, i);
+    }
+    // leaves the index dirty, the readers below race to rebuild it
+    EXPECT_EQ(AI_SUCCESS, pcMat->RemoveProperty("testKey13", 0, 0));
+
+    const aiMaterial* mat = pcMat;
+    std::atomic<unsigned int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([mat, &mismatches]() {
+            for (int i = 1; i < 200; ++i) {
+                int out = -1;
+                if (AI_SUCCESS != mat->Get("testKey13", 0, i, out) || out != i) {
+                    ++mismatches;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    EXPECT_EQ(0u, mismatches.load());
+}
@@ -44,6 +44,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <assimp/config.h>
+#include <sstream>
 
 using namespace Assimp;
 
@@ -187,3 +189,129 @@ TEST_F( utObjImportExport, obj_import_test ) {
     EXPECT_TRUE( differ.isEqual( expected, scene ) );
     differ.showReport();
 }
+
+// ------------------------------------------------------------------------------------------------
+//  Builds a file with CRLF and LF line ends, relative indices, points, lines, groups, objects and
+//  faces which are ignored, so the chunk borders of the parallel parser fall everywhere.
+static std::string createLargeObjModel() {
+    std::ostringstream stream;
+    stream << "# generated\n";
+    unsigned int numVertices = 0, numTexCoords = 0;
+    for ( unsigned int block = 0; block < 40; ++block ) {
+        stream << ( block % 3 == 0 ? "o obj" : "g group" ) << block % 7 << "\r\n";
+        stream << "usemtl mat" << block % 2 << "\n";
+        for ( unsigned int i = 0; i < 12; ++i ) {
+            stream << "v " << block * 0.25f << " " << i * -1.5f << " " << ( block + i ) * 0.125f << "\n";
+            if ( i % 4 == 0 ) {
+                stream << "v 1 2 3 " << i + 1 << "\n";
+            }
+            stream << "vn 0 " << i % 2 << " 1\n";
+        }
+        numVertices += 15;
+        if ( block > 10 ) {
+            stream << "vt 0." << block << " 0.5\nvt 0.25 0.75 0\n";
+            numTexCoords += 2;
+        }
+        for ( unsigned int i = 1; i + 2 <= numVertices && i < 12; ++i ) {
+            if ( 0 == numTexCoords ) {
+                stream << "f " << i << "//" << i << " " << i + 1 << "//" << i + 1 << " -1//-1\n";
+            } else {
+                stream << "f " << numVertices - i << "/1/" << i << " -" << i << "/-1/-2 " << i + 2 << "/2/1\r\n";
+            }
+        }
+        stream << "l 1 2 3\np " << numVertices << "\n\n";
+        if ( block % 5 == 0 ) {
+            stream << "f\np 1/1\ns off\n# comment\n";
+        }
+    }
+    // not terminated, ignored by the parser
+    stream << "f 1 2 3";
+    return stream.str();
+}
+
+// ------------------------------------------------------------------------------------------------
+static void expectIdenticalArrays( const void *expected, const void *actual, size_t size ) {
+    ASSERT_EQ( nullptr == expected, nullptr == actual );
+    if ( nullptr != expected ) {
+        EXPECT_EQ( 0, ::memcmp( expected, actual, size ) );
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+static void expectIdenticalNodes( const aiNode *expected, const aiNode *actual ) {
+    EXPECT_STREQ( expected->mName.C_Str(), actual->mName.C_Str() );
+    ASSERT_EQ( expected->mNumMeshes, actual->mNumMeshes );
+    expectIdenticalArrays( expected->mMeshes, actual->mMeshes, sizeof( unsigned int ) * expected->mNumMeshes );
+    ASSERT_EQ( expected->mNumChildren, actual->mNumChildren );
+    for ( unsigned int i = 0; i < expected->mNumChildren; ++i ) {
+        expectIdenticalNodes( expected->mChildren[ i ], actual->mChildren[ i ] );
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+static void expectIdenticalScenes( const aiScene *expected, const aiScene *actual ) {
+    ASSERT_NE( nullptr, expected );
+    ASSERT_NE( nullptr, actual );
+    EXPECT_EQ( expected->mNumMaterials, actual->mNumMaterials );
+    expectIdenticalNodes( expected->mRootNode, actual->mRootNode );
+    ASSERT_EQ( expected->mNumMeshes, actual->mNumMeshes );
+    for ( unsigned int i = 0; i < expected->mNumMeshes; ++i ) {
+        const aiMesh *expMesh = expected->mMeshes[ i ], *mesh = actual->mMeshes[ i ];
+        EXPECT_STREQ( expMesh->mName.C_Str(), mesh->mName.C_Str() );
+        EXPECT_EQ( expMesh->mPrimitiveTypes, mesh->mPrimitiveTypes );
+        EXPECT_EQ( expMesh->mMaterialIndex, mesh->mMaterialIndex );
+        ASSERT_EQ( expMesh->mNumVertices, mesh->mNumVertices );
+        const size_t size = sizeof( aiVector3D ) * expMesh->mNumVertices;
+        expectIdenticalArrays( expMesh->mVertices, mesh->mVertices, size );
+        expectIdenticalArrays( expMesh->mNormals, mesh->mNormals, size );
+        expectIdenticalArrays( expMesh->mTextureCoords[ 0 ], mesh->mTextureCoords[ 0 ], size );
+        expectIdenticalArrays( expMesh->mColors[ 0 ], mesh->mColors[ 0 ], sizeof( aiColor4D ) * expMesh->mNumVertices );
+        ASSERT_EQ( expMesh->mNumFaces, mesh->mNumFaces );
+        for ( unsigned int j = 0; j < expMesh->mNumFaces; ++j ) {
+            ASSERT_EQ( expMesh->mFaces[ j ].mNumIndices, mesh->mFaces[ j ].mNumIndices );
+            expectIdenticalArrays( expMesh->mFaces[ j ].mIndices, mesh->mFaces[ j ].mIndices,
+                sizeof( unsigned int ) * expMesh->mFaces[ j ].mNumIndices );
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+static void expectParallelParseMatchesSerial( const std::string &model ) {
+    Importer serialImporter;
+    serialImporter.SetPropertyInteger( AI_CONFIG_IMPORT_OBJ_PARSE_THREADS, 1 );
+    const aiScene *expected = serialImporter.ReadFileFromMemory( model.c_str(), model.size(), 0, "obj" );
+    ASSERT_NE( nullptr, expected );
+
+    static const int threadCounts[] = { 2, 3, 8 };
+    for ( size_t i = 0; i < sizeof( threadCounts ) / sizeof( threadCounts[ 0 ] ); ++i ) {
+        Importer importer;
+        importer.SetPropertyInteger( AI_CONFIG_IMPORT_OBJ_PARSE_THREADS, threadCounts[ i ] );
+        const aiScene *scene = importer.ReadFileFromMemory( model.c_str(), model.size(), 0, "obj" );
+        expectIdenticalScenes( expected, scene );
+    }
+}
+
+TEST_F( utObjImportExport, parallelParseMatchesSerial ) {
+    expectParallelParseMatchesSerial( ObjModel );
+    expectParallelParseMatchesSerial( createLargeObjModel() );
+}
+
+TEST_F( utObjImportExport, parallelParseMatchesSerialWithVertexColors ) {
+    std::string model = "v 0 0 0 1 0 0\nv 1 0 0 0 1 0\nv 1 1 0 0 0 1\nv 0 1 0 1 1 1\n";
+    for ( unsigned int i = 0; i < 50; ++i ) {
+        model += "f 1 2 3\nf -4 -2 -1\n";
+    }
+    expectParallelParseMatchesSerial( model );
+}
+
+TEST_F( utObjImportExport, parallelParseReportsErrors ) {
+    // the serial replay of the statement raises the error in the parallel parse, too
+    std::string model;
+    for ( unsigned int i = 0; i < 20; ++i ) {
+        model += "v 1 2 3\nvt 1\nf 1 1 1\n";
+    }
+    Importer importer;
+    importer.SetPropertyInteger( AI_CONFIG_IMPORT_OBJ_PARSE_THREADS, 4 );
+    EXPECT_EQ( nullptr, importer.ReadFileFromMemory( model.c_str(), model.size(), 0, "obj" ) );
+    EXPECT_NE( std::string::npos, std::string( importer.GetErrorString() ).find( "Invalid number of components" ) );
+}
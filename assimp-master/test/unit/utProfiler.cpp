@@ -0,0 +1,155 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+
+#include <string>
+
+using namespace ::std;
+using namespace ::Assimp;
+
+class utProfiler : public ::testing::Test
+{
+public:
+    virtual void SetUp() {
+        pImp = new Importer();
+    }
+
+    virtual void TearDown() {
+        delete pImp;
+    }
+
+protected:
+    const aiProfileEntry* FindEntry(const char* name) const {
+        for (unsigned int i = 0; i < pImp->GetProfileEntryCount(); ++i) {
+            const aiProfileEntry* entry = pImp->GetProfileEntry(i);
+            if (string(entry->mName.C_Str()) == name) {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    Importer* pImp;
+};
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utProfiler, disabledByDefault)
+{
+    ASSERT_TRUE(NULL != pImp->ReadFile(ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae", aiProcess_Triangulate));
+    EXPECT_EQ(0U, pImp->GetProfileEntryCount());
+    EXPECT_TRUE(NULL == pImp->GetProfileEntry(0));
+    EXPECT_TRUE(pImp->GetProfileReport(aiProfileFormat_JSON).empty());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utProfiler, recordsPhasesAndSteps)
+{
+    pImp->SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+    ASSERT_TRUE(NULL != pImp->ReadFile(ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae",
+        aiProcess_Triangulate | aiProcess_JoinIdenticalVertices));
+
+    const aiProfileEntry* total = FindEntry("total");
+    const aiProfileEntry* import = FindEntry("import");
+    const aiProfileEntry* triangulate = FindEntry("postprocess/Triangulate");
+    ASSERT_TRUE(NULL != total);
+    ASSERT_TRUE(NULL != import);
+    ASSERT_TRUE(NULL != triangulate);
+    ASSERT_TRUE(NULL != FindEntry("postprocess/JoinIdenticalVertices"));
+
+    EXPECT_EQ(0U, total->mDepth);
+    EXPECT_EQ(1U, import->mDepth);
+    EXPECT_EQ(2U, triangulate->mDepth);
+    EXPECT_LE(import->mDuration, total->mDuration);
+    EXPECT_GE(import->mStart, total->mStart);
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+    EXPECT_GT(total->mPeakResidentMemory, 0U);
+#endif
+
+    // a new import starts a new profile
+    const unsigned int count = pImp->GetProfileEntryCount();
+    ASSERT_TRUE(NULL != pImp->ReadFile(ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae",
+        aiProcess_Triangulate | aiProcess_JoinIdenticalVertices));
+    EXPECT_EQ(count, pImp->GetProfileEntryCount());
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utProfiler, closesRegionsOfFailedImports)
+{
+    FILE* file = ::fopen("profilerUnknownFormat.xyz", "wb");
+    ASSERT_TRUE(NULL != file);
+    // no reader accepts these bytes, not even by signature
+    const unsigned char junk[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    ::fwrite(junk, 1, sizeof(junk), file);
+    ::fclose(file);
+
+    pImp->SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+    EXPECT_TRUE(NULL == pImp->ReadFile("profilerUnknownFormat.xyz", aiProcess_Triangulate));
+    ::remove("profilerUnknownFormat.xyz");
+
+    // only closed regions sample the peak memory
+    ASSERT_EQ(1U, pImp->GetProfileEntryCount());
+    EXPECT_EQ(0U, FindEntry("total")->mDepth);
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+    EXPECT_GT(FindEntry("total")->mPeakResidentMemory, 0U);
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(utProfiler, exportsReports)
+{
+    pImp->SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+    ASSERT_TRUE(NULL != pImp->ReadFile(ASSIMP_TEST_MODELS_DIR "/Collada/duck.dae", aiProcess_Triangulate));
+
+    const string json = pImp->GetProfileReport(aiProfileFormat_JSON);
+    EXPECT_EQ('{', json[0]);
+    EXPECT_NE(string::npos, json.find("\"regions\""));
+    EXPECT_NE(string::npos, json.find("\"name\": \"postprocess/Triangulate\""));
+    EXPECT_NE(string::npos, json.find("\"peak_rss_bytes\""));
+
+    const string trace = pImp->GetProfileReport(aiProfileFormat_ChromeTrace);
+    EXPECT_NE(string::npos, trace.find("\"traceEvents\""));
+    EXPECT_NE(string::npos, trace.find("\"ph\": \"X\""));
+    EXPECT_NE(string::npos, trace.find("\"name\": \"import\""));
+}
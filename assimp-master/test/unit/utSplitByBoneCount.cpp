@@ -0,0 +1,197 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/scene.h>
+#include <SplitByBoneCountProcess.h>
+
+using namespace std;
+using namespace Assimp;
+
+class SplitByBoneCountTest : public ::testing::Test
+{
+public:
+
+    virtual void SetUp();
+    virtual void TearDown();
+
+protected:
+
+    // Builds a scene of one mesh with a triangle per entry of faceBones, each of its
+    // vertices is influenced by all bones listed for the face
+    aiScene* CreateScene(const std::vector< std::vector<unsigned int> >& faceBones, unsigned int numBones);
+    void Split(aiScene* scene, size_t maxBones);
+
+    aiScene* pcScene;
+};
+
+// ------------------------------------------------------------------------------------------------
+void SplitByBoneCountTest::SetUp()
+{
+    pcScene = NULL;
+}
+
+// ------------------------------------------------------------------------------------------------
+void SplitByBoneCountTest::TearDown()
+{
+    delete pcScene;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* SplitByBoneCountTest::CreateScene(const std::vector< std::vector<unsigned int> >& faceBones, unsigned int numBones)
+{
+    aiMesh* mesh = new aiMesh();
+    mesh->mName.Set("mesh");
+    mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    mesh->mNumVertices = static_cast<unsigned int>(faceBones.size() * 3);
+    mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+    mesh->mNumFaces = static_cast<unsigned int>(faceBones.size());
+    mesh->mFaces = new aiFace[mesh->mNumFaces];
+    for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+        aiFace& face = mesh->mFaces[i];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        for (unsigned int j = 0; j < 3; ++j) {
+            face.mIndices[j] = i * 3 + j;
+            mesh->mVertices[i * 3 + j] = aiVector3D(float(i), float(j), 0.0f);
+        }
+    }
+
+    mesh->mNumBones = numBones;
+    mesh->mBones = new aiBone*[numBones];
+    for (unsigned int b = 0; b < numBones; ++b) {
+        std::vector<aiVertexWeight> weights;
+        for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+            const std::vector<unsigned int>& bones = faceBones[i];
+            if (std::find(bones.begin(), bones.end(), b) == bones.end())
+                continue;
+            for (unsigned int j = 0; j < 3; ++j)
+                weights.push_back(aiVertexWeight(i * 3 + j, 1.0f / bones.size()));
+        }
+        aiBone* bone = mesh->mBones[b] = new aiBone();
+        bone->mName.Set(std::string(1, char('a' + b)));
+        bone->mNumWeights = static_cast<unsigned int>(weights.size());
+        bone->mWeights = new aiVertexWeight[weights.size()];
+        std::copy(weights.begin(), weights.end(), bone->mWeights);
+    }
+
+    aiScene* scene = new aiScene();
+    scene->mNumMeshes = 1;
+    scene->mMeshes = new aiMesh*[1];
+    scene->mMeshes[0] = mesh;
+    scene->mRootNode = new aiNode();
+    scene->mRootNode->mNumMeshes = 1;
+    scene->mRootNode->mMeshes = new unsigned int[1];
+    scene->mRootNode->mMeshes[0] = 0;
+    return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+void SplitByBoneCountTest::Split(aiScene* scene, size_t maxBones)
+{
+    SplitByBoneCountProcess process;
+    process.mMaxBoneCount = maxBones;
+    process.Execute(scene);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(SplitByBoneCountTest, testBoneLimit)
+{
+    std::vector< std::vector<unsigned int> > faceBones(10);
+    for (unsigned int i = 0; i < 10; ++i)
+        faceBones[i].push_back(i);
+    pcScene = CreateScene(faceBones, 10);
+    Split(pcScene, 4);
+
+    EXPECT_EQ(3U, pcScene->mNumMeshes);
+    EXPECT_EQ(3U, pcScene->mRootNode->mNumMeshes);
+    unsigned int numFaces = 0;
+    for (unsigned int m = 0; m < pcScene->mNumMeshes; ++m) {
+        const aiMesh* mesh = pcScene->mMeshes[m];
+        EXPECT_LE(mesh->mNumBones, 4U);
+        numFaces += mesh->mNumFaces;
+        for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+            EXPECT_GT(mesh->mBones[b]->mNumWeights, 0U);
+            for (unsigned int w = 0; w < mesh->mBones[b]->mNumWeights; ++w)
+                EXPECT_LT(mesh->mBones[b]->mWeights[w].mVertexId, mesh->mNumVertices);
+        }
+    }
+    EXPECT_EQ(10U, numFaces);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(SplitByBoneCountTest, testSkippedFaceBonesNotCounted)
+{
+    // face 1 doesn't fit beside face 0, face 2 only needs a bone face 0 brought in already
+    std::vector< std::vector<unsigned int> > faceBones(3);
+    faceBones[0].push_back(0);
+    faceBones[0].push_back(1);
+    faceBones[1].push_back(2);
+    faceBones[1].push_back(3);
+    faceBones[2].push_back(0);
+    pcScene = CreateScene(faceBones, 4);
+    Split(pcScene, 3);
+
+    ASSERT_EQ(2U, pcScene->mNumMeshes);
+    EXPECT_EQ(2U, pcScene->mMeshes[0]->mNumFaces);
+    EXPECT_EQ(2U, pcScene->mMeshes[0]->mNumBones);
+    EXPECT_EQ(1U, pcScene->mMeshes[1]->mNumFaces);
+    EXPECT_EQ(2U, pcScene->mMeshes[1]->mNumBones);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST_F(SplitByBoneCountTest, testFaceAboveLimit)
+{
+    // the second face alone needs more bones than allowed, it must end up in a submesh of its own
+    std::vector< std::vector<unsigned int> > faceBones(3);
+    faceBones[0].push_back(0);
+    for (unsigned int b = 1; b < 7; ++b)
+        faceBones[1].push_back(b);
+    faceBones[2].push_back(0);
+    pcScene = CreateScene(faceBones, 7);
+    Split(pcScene, 4);
+
+    ASSERT_EQ(2U, pcScene->mNumMeshes);
+    EXPECT_EQ(2U, pcScene->mMeshes[0]->mNumFaces);
+    EXPECT_EQ(1U, pcScene->mMeshes[0]->mNumBones);
+    EXPECT_EQ(1U, pcScene->mMeshes[1]->mNumFaces);
+    EXPECT_EQ(6U, pcScene->mMeshes[1]->mNumBones);
+}
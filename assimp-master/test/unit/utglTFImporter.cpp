@@ -0,0 +1,115 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+copyright notice, this list of conditions and the
+following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+copyright notice, this list of conditions and the
+following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+contributors may be used to endorse or promote products
+derived from this software without specific prior
+written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+#include "UnitTestPCH.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace ::Assimp;
+
+static const char* const BinaryModel = ASSIMP_TEST_MODELS_DIR "/glTF/BoxTextured-glTF-Binary/BoxTextured.glb";
+static const char* const TextModel = ASSIMP_TEST_MODELS_DIR "/glTF/BoxTextured-glTF/BoxTextured.gltf";
+
+// ------------------------------------------------------------------------------------------------
+static void ExpectSameMeshes(const aiScene* a, const aiScene* b)
+{
+    ASSERT_EQ(a->mNumMeshes, b->mNumMeshes);
+    for (unsigned int i = 0; i < a->mNumMeshes; ++i) {
+        const aiMesh* ma = a->mMeshes[i];
+        const aiMesh* mb = b->mMeshes[i];
+        ASSERT_EQ(ma->mNumVertices, mb->mNumVertices);
+        EXPECT_EQ(0, memcmp(ma->mVertices, mb->mVertices, ma->mNumVertices * sizeof(aiVector3D)));
+        ASSERT_EQ(ma->HasNormals(), mb->HasNormals());
+        if (ma->HasNormals()) {
+            EXPECT_EQ(0, memcmp(ma->mNormals, mb->mNormals, ma->mNumVertices * sizeof(aiVector3D)));
+        }
+        ASSERT_EQ(ma->HasTextureCoords(0), mb->HasTextureCoords(0));
+        if (ma->HasTextureCoords(0)) {
+            EXPECT_EQ(0, memcmp(ma->mTextureCoords[0], mb->mTextureCoords[0], ma->mNumVertices * sizeof(aiVector3D)));
+        }
+        ASSERT_EQ(ma->mNumFaces, mb->mNumFaces);
+        for (unsigned int f = 0; f < ma->mNumFaces; ++f) {
+            ASSERT_EQ(ma->mFaces[f].mNumIndices, mb->mFaces[f].mNumIndices);
+            EXPECT_EQ(0, memcmp(ma->mFaces[f].mIndices, mb->mFaces[f].mIndices, ma->mFaces[f].mNumIndices * sizeof(unsigned int)));
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utglTFImporter, binaryBodyMatchesExternalBuffer)
+{
+    Importer text;
+    const aiScene* reference = text.ReadFile(TextModel, 0);
+    ASSERT_TRUE(NULL != reference);
+    ASSERT_LT(0u, reference->mNumMeshes);
+    EXPECT_LT(0u, reference->mMeshes[0]->mNumFaces);
+
+    // the body of the mapped .glb file is used in place
+    Importer binary;
+    const aiScene* scene = binary.ReadFile(BinaryModel, 0);
+    ASSERT_TRUE(NULL != scene);
+    ExpectSameMeshes(reference, scene);
+}
+
+// ------------------------------------------------------------------------------------------------
+TEST(utglTFImporter, binaryFromMemory)
+{
+    FILE* file = fopen(BinaryModel, "rb");
+    ASSERT_TRUE(NULL != file);
+    fseek(file, 0, SEEK_END);
+    std::vector<char> data(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    ASSERT_EQ(data.size(), fread(&data[0], 1, data.size(), file));
+    fclose(file);
+
+    Importer fromFile;
+    const aiScene* reference = fromFile.ReadFile(BinaryModel, 0);
+    ASSERT_TRUE(NULL != reference);
+
+    Importer fromMemory;
+    const aiScene* scene = fromMemory.ReadFileFromMemory(&data[0], data.size(), 0, "glb");
+    ASSERT_TRUE(NULL != scene);
+    ExpectSameMeshes(reference, scene);
+}
@@ -0,0 +1,488 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file  Benchmark.cpp
+ *  @brief Implementation of the 'assimp bench' utility  */
+
+#include "Main.h"
+
+#include <assimp/importerdesc.h>
+#include <assimp/importprofile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <dirent.h>
+#	include <sys/stat.h>
+#endif
+
+const char* AICMD_MSG_BENCH_HELP_E =
+"assimp bench <dir|file> [<dir|file> ...] [-n<runs>] [-b<baseline>] [--out=<report>] [--threshold=<percent>] [--set=<property>=<int>] [common parameters]\n"
+"\tImport every model found in the given directories several times and report\n"
+"\tmedian/p95 import time, throughput and scene memory per file format and\n"
+"\tthe time of each post-processing step per file format. Directories are\n"
+"\tsearched recursively.\n"
+"\t-n<runs>,--runs=<runs>: Number of imports per file, defaults to 5\n"
+"\t--out=<file>: Write the results to a JSON report\n"
+"\t-b<file>,--baseline=<file>: Compare against a report written by a previous run\n"
+"\t--threshold=<percent>: Slowdown of the median tolerated before a format\n"
+"\t    is flagged as regression, defaults to 10\n"
+"\t--set=<property>=<int>: Set an integer importer property for all imports,\n"
+"\t    i.e. --set=IMPORT_FBX_INFLATE_THREADS=1 to get a serial FBX baseline\n"
+"\tThe peak RSS is the high-water mark of the whole process, reported once\n"
+"\tfor all imports as it can't be attributed to a single format.\n"
+"\tThe exit code is 0 if no regression was detected.\n";
+
+namespace {
+
+// -----------------------------------------------------------------------------------
+/** Timings collected for one group of imports (a file format or a step) */
+struct BenchSamples
+{
+	BenchSamples()
+		: bytes		(0)
+		, files		(0)
+		, failures	(0)
+		, sceneBytes	(0)
+	{}
+
+	std::vector<double> times; // in ms
+	std::vector<double> releaseTimes; // in ms, FreeScene() after each import
+	size_t bytes;
+	unsigned int files;
+	unsigned int failures;
+	size_t sceneBytes;
+};
+
+// -----------------------------------------------------------------------------------
+/** Aggregated results, as written to and read from a report */
+struct BenchResult
+{
+	double median;
+	double p95;
+	double releaseMedian;
+	double throughput; // in MB/s
+};
+
+typedef std::map<std::string, BenchSamples> SampleMap;
+
+// step timings of each format, keyed by the format name
+typedef std::map<std::string, SampleMap> StepMap;
+
+// -----------------------------------------------------------------------------------
+// Nearest-rank percentile of an unsorted set of samples
+double Percentile(std::vector<double> samples, double p)
+{
+	if (samples.empty()) {
+		return 0.0;
+	}
+	std::sort(samples.begin(),samples.end());
+	size_t rank = static_cast<size_t>(p * samples.size() + 0.5);
+	rank = std::min(std::max(rank, static_cast<size_t>(1)), samples.size());
+	return samples[rank-1];
+}
+
+// -----------------------------------------------------------------------------------
+BenchResult Summarize(const BenchSamples& s)
+{
+	BenchResult r;
+	r.median = Percentile(s.times,0.5);
+	r.p95 = Percentile(s.times,0.95);
+	r.releaseMedian = Percentile(s.releaseTimes,0.5);
+
+	double total = 0.0;
+	for (size_t i = 0; i < s.times.size(); ++i) {
+		total += s.times[i];
+	}
+	// only successful runs contribute to the byte count
+	r.throughput = total > 0.0 ? (s.bytes / (1024.0 * 1024.0)) / (total / 1000.0) : 0.0;
+	return r;
+}
+
+// -----------------------------------------------------------------------------------
+size_t GetFileSize(const std::string& path)
+{
+	FILE* f = fopen(path.c_str(),"rb");
+	if (!f) {
+		return 0;
+	}
+	fseek(f,0,SEEK_END);
+	const long size = ftell(f);
+	fclose(f);
+	return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+// -----------------------------------------------------------------------------------
+std::string GetExtension(const std::string& path)
+{
+	const std::string::size_type dot = path.find_last_of('.');
+	const std::string::size_type sep = path.find_last_of("/\\");
+	if (dot == std::string::npos || (sep != std::string::npos && dot < sep)) {
+		return std::string();
+	}
+	std::string ext = path.substr(dot+1);
+	std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
+	return ext;
+}
+
+// -----------------------------------------------------------------------------------
+// Recursively collect all files with an extension known to the importer
+void CollectFiles(const std::string& path, std::vector<std::string>& out)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA info;
+	HANDLE h = FindFirstFileA((path + "\\*").c_str(),&info);
+	if (h == INVALID_HANDLE_VALUE) {
+		// not a directory
+		if (GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+			out.push_back(path);
+		}
+		return;
+	}
+	do {
+		if (!strcmp(info.cFileName,".") || !strcmp(info.cFileName,"..")) {
+			continue;
+		}
+		const std::string child = path + "\\" + info.cFileName;
+		if (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			CollectFiles(child,out);
+		}
+		else if (globalImporter->IsExtensionSupported(GetExtension(child))) {
+			out.push_back(child);
+		}
+	}
+	while (FindNextFileA(h,&info));
+	FindClose(h);
+#else
+	DIR* dir = opendir(path.c_str());
+	if (!dir) {
+		// not a directory
+		struct stat st;
+		if (0 == stat(path.c_str(),&st)) {
+			out.push_back(path);
+		}
+		return;
+	}
+	std::vector<std::string> children;
+	while (struct dirent* ent = readdir(dir)) {
+		if (!strcmp(ent->d_name,".") || !strcmp(ent->d_name,"..")) {
+			continue;
+		}
+		children.push_back(path + "/" + ent->d_name);
+	}
+	closedir(dir);
+
+	// readdir() returns the entries in no particular order
+	std::sort(children.begin(),children.end());
+	for (size_t i = 0; i < children.size(); ++i) {
+		struct stat st;
+		if (0 != stat(children[i].c_str(),&st)) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			CollectFiles(children[i],out);
+		}
+		else if (globalImporter->IsExtensionSupported(GetExtension(children[i]))) {
+			out.push_back(children[i]);
+		}
+	}
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Run all imports of a single file and add the timings to the format and step groups.
+// peakResident receives the process-wide high-water mark seen so far.
+void BenchFile(const std::string& path, unsigned int runs, unsigned int flags,
+	SampleMap& formats, StepMap& steps, size_t& peakResident)
+{
+	const size_t size = GetFileSize(path);
+	std::string format = GetExtension(path);
+
+	bool counted = false;
+	for (unsigned int i = 0; i < runs; ++i) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const aiScene* scene = globalImporter->ReadFile(path,flags);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (!counted) {
+			// group by the name of the importer that handled the file, if known
+			const size_t idx = globalImporter->GetImporterIndex(format.c_str());
+			const aiImporterDesc* desc = idx != static_cast<size_t>(-1) ? globalImporter->GetImporterInfo(idx) : NULL;
+			if (desc) {
+				format = desc->mName;
+			}
+			++formats[format].files;
+			counted = true;
+		}
+
+		BenchSamples& fmt = formats[format];
+		if (!scene) {
+			++fmt.failures;
+			printf("  %s: import failed: %s\n",path.c_str(),globalImporter->GetErrorString());
+			return;
+		}
+
+		fmt.times.push_back(ms);
+		fmt.bytes += size;
+
+		aiMemoryInfo mem;
+		globalImporter->GetMemoryRequirements(mem);
+		fmt.sceneBytes = std::max(fmt.sceneBytes,static_cast<size_t>(mem.total));
+
+		for (unsigned int e = 0; e < globalImporter->GetProfileEntryCount(); ++e) {
+			const aiProfileEntry* entry = globalImporter->GetProfileEntry(e);
+			peakResident = std::max(peakResident,entry->mPeakResidentMemory);
+			if (entry->mDepth > 0) {
+				steps[format][entry->mName.C_Str()].times.push_back(entry->mDuration);
+			}
+		}
+
+		// released here so the next import isn't charged for it
+		const std::chrono::steady_clock::time_point release = std::chrono::steady_clock::now();
+		globalImporter->FreeScene();
+		fmt.releaseTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - release).count());
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// Read the per-format medians of a report written by WriteReport()
+bool ReadBaseline(const std::string& path, std::map<std::string, double>& out)
+{
+	FILE* f = fopen(path.c_str(),"rt");
+	if (!f) {
+		return false;
+	}
+	char line[1024];
+	bool inFormats = false;
+	while (fgets(line,sizeof(line),f)) {
+		if (strstr(line,"\"formats\"")) {
+			inFormats = true;
+			continue;
+		}
+		if (strstr(line,"\"steps\"")) {
+			break;
+		}
+		const char* name = strstr(line,"\"name\": \"");
+		const char* median = strstr(line,"\"median_ms\": ");
+		if (!inFormats || !name || !median) {
+			continue;
+		}
+		name += 9;
+		const char* end = strchr(name,'\"');
+		if (end) {
+			out[std::string(name,end)] = atof(median + 13);
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Write one JSON object per line so ReadBaseline() can parse it without a JSON library.
+// format is NULL for the format group itself, else the format the steps belong to.
+void WriteGroup(FILE* f, const SampleMap& map, const char* format, bool last)
+{
+	for (SampleMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+		const BenchResult r = Summarize(it->second);
+		fprintf(f,"    { ");
+		if (format) {
+			fprintf(f,"\"format\": \"%s\", ",format);
+		}
+		fprintf(f,"\"name\": \"%s\", \"runs\": %u, \"median_ms\": %.4f, \"p95_ms\": %.4f",
+			it->first.c_str(),static_cast<unsigned int>(it->second.times.size()),r.median,r.p95);
+		if (!format) {
+			fprintf(f,", \"release_median_ms\": %.4f, \"files\": %u, \"failures\": %u, \"mb_per_s\": %.4f, \"scene_bytes\": %lu",
+				r.releaseMedian,it->second.files,it->second.failures,r.throughput,static_cast<unsigned long>(it->second.sceneBytes));
+		}
+		SampleMap::const_iterator next = it;
+		fprintf(f," }%s\n",++next == map.end() && last ? "" : ",");
+	}
+}
+
+// -----------------------------------------------------------------------------------
+bool WriteReport(const std::string& path, unsigned int runs, unsigned int flags,
+	const SampleMap& formats, const StepMap& steps, size_t peakResident)
+{
+	FILE* f = fopen(path.c_str(),"wt");
+	if (!f) {
+		return false;
+	}
+	fprintf(f,"{\n  \"runs\": %u,\n  \"flags\": %u,\n  \"peak_rss_bytes\": %lu,\n  \"formats\": [\n",
+		runs,flags,static_cast<unsigned long>(peakResident));
+	WriteGroup(f,formats,NULL,true);
+	fprintf(f,"  ],\n  \"steps\": [\n");
+	for (StepMap::const_iterator it = steps.begin(); it != steps.end(); ++it) {
+		StepMap::const_iterator next = it;
+		WriteGroup(f,it->second,it->first.c_str(),++next == steps.end());
+	}
+	fprintf(f,"  ]\n}\n");
+	fclose(f);
+	return true;
+}
+
+} // ! namespace
+
+// -----------------------------------------------------------------------------------
+int Assimp_Benchmark (const char* const* params, unsigned int num)
+{
+	if (num < 1) {
+		printf("assimp bench: Invalid number of arguments. "
+			"See \'assimp bench --help\'\n");
+		return 1;
+	}
+
+	// --help
+	if (!strcmp( params[0],"-h")||!strcmp( params[0],"--help")||!strcmp( params[0],"-?") ) {
+		printf("%s",AICMD_MSG_BENCH_HELP_E);
+		return 0;
+	}
+
+	ImportData import;
+	ProcessStandardArguments(import,params,num);
+
+	unsigned int runs = 5;
+	double threshold = 10.0;
+	std::string baseline, out;
+	std::vector<std::string> inputs;
+	for (unsigned int i = 0; i < num; ++i) {
+		if (!strncmp(params[i],"--runs=",7) || !strncmp(params[i],"-n",2)) {
+			runs = std::max(1,atoi(params[i] + (params[i][1] == '-' ? 7 : 2)));
+		}
+		else if (!strncmp(params[i],"--baseline=",11) || !strncmp(params[i],"-b",2)) {
+			baseline = std::string(params[i] + (params[i][1] == '-' ? 11 : 2));
+		}
+		else if (!strncmp(params[i],"--out=",6)) {
+			out = std::string(params[i] + 6);
+		}
+		else if (!strncmp(params[i],"--threshold=",12)) {
+			threshold = atof(params[i] + 12);
+		}
+		else if (!strncmp(params[i],"--set=",6)) {
+			const char* const sep = strchr(params[i] + 6,'=');
+			if (!sep) {
+				printf("assimp bench: Expected --set=<property>=<int>, got %s\n",params[i]);
+				return 1;
+			}
+			globalImporter->SetPropertyInteger(std::string(params[i] + 6,sep).c_str(),atoi(sep + 1));
+		}
+		else if (params[i][0] != '-') {
+			inputs.push_back(params[i]);
+		}
+	}
+
+	std::vector<std::string> files;
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		CollectFiles(inputs[i],files);
+	}
+	if (files.empty()) {
+		printf("assimp bench: No importable files found\n");
+		return 2;
+	}
+
+	// the step timings are taken from the import profiler
+	globalImporter->SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME,true);
+
+	printf("Benchmarking %u files, %u runs each ...\n",static_cast<unsigned int>(files.size()),runs);
+	SampleMap formats;
+	StepMap steps;
+	size_t peakResident = 0;
+	for (size_t i = 0; i < files.size(); ++i) {
+		BenchFile(files[i],runs,import.ppFlags,formats,steps,peakResident);
+	}
+
+	std::map<std::string, double> reference;
+	if (baseline.length() && !ReadBaseline(baseline,reference)) {
+		printf("assimp bench: Unable to read baseline %s\n",baseline.c_str());
+		return 3;
+	}
+
+	PrintHorBar();
+	printf("%-24s %6s %6s %11s %11s %11s %10s\n","format","files","failed","median ms","p95 ms","release ms","MB/s");
+	unsigned int regressions = 0;
+	for (SampleMap::const_iterator it = formats.begin(); it != formats.end(); ++it) {
+		const BenchResult r = Summarize(it->second);
+		printf("%-24.24s %6u %6u %11.3f %11.3f %11.3f %10.2f",it->first.c_str(),it->second.files,
+			it->second.failures,r.median,r.p95,r.releaseMedian,r.throughput);
+
+		std::map<std::string, double>::const_iterator ref = reference.find(it->first);
+		if (ref != reference.end() && ref->second > 0.0) {
+			const double change = (r.median / ref->second - 1.0) * 100.0;
+			printf("  %+6.1f%%",change);
+			if (change > threshold) {
+				printf("  REGRESSION");
+				++regressions;
+			}
+		}
+		printf("\n");
+	}
+
+	printf("Peak RSS of the process: %lu KB\n",static_cast<unsigned long>(peakResident / 1024));
+
+	PrintHorBar();
+	printf("%-24s %-40s %6s %11s %11s\n","format","step","runs","median ms","p95 ms");
+	for (StepMap::const_iterator fmt = steps.begin(); fmt != steps.end(); ++fmt) {
+		for (SampleMap::const_iterator it = fmt->second.begin(); it != fmt->second.end(); ++it) {
+			const BenchResult r = Summarize(it->second);
+			printf("%-24.24s %-40.40s %6u %11.3f %11.3f\n",fmt->first.c_str(),it->first.c_str(),
+				static_cast<unsigned int>(it->second.times.size()),r.median,r.p95);
+		}
+	}
+	PrintHorBar();
+
+	if (out.length()) {
+		if (!WriteReport(out,runs,import.ppFlags,formats,steps,peakResident)) {
+			printf("assimp bench: Unable to write report %s\n",out.c_str());
+			return 4;
+		}
+		printf("Report written to %s\n",out.c_str());
+	}
+
+	if (regressions) {
+		printf("assimp bench: %u format(s) slower than the baseline by more than %.1f%%\n",regressions,threshold);
+		return 5;
+	}
+	return 0;
+}
@@ -67,6 +67,8 @@ const char* AICMD_MSG_HELP =
 " \textract    - Extract embedded texture images\n"
 " \tdump       - Convert models to a binary or textual dump (ASSBIN/ASSXML)\n"
 " \tcmpdump    - Compare dumps created using \'assimp dump <file> -s ...\'\n"
+" \tbench      - Measure import performance of all models in a directory\n"
+" \tbake       - Convert the textures of models to block compressed DDS files\n"
 " \tversion    - Display Assimp version\n"
 "\n Use \'assimp <verb> --help\' for detailed help on a command.\n"
 ;
@@ -217,6 +219,18 @@ int main (int argc, char* argv[])
 		return Assimp_Extract (&argv[2],argc-2);
 	}
 
+	// assimp bench
+	// Measure the import performance of a set of models
+	if (! strcmp(argv[1], "bench")) {
+		return Assimp_Benchmark (&argv[2],argc-2);
+	}
+
+	// assimp bake
+	// Convert the textures referenced by models to GPU ready DDS files
+	if (! strcmp(argv[1], "bake")) {
+		return Assimp_Bake (&argv[2],argc-2);
+	}
+
 	// assimp testbatchload
 	// Used by /test/other/streamload.py to load a list of files
 	// using the same importer instance to check for incompatible
@@ -117,6 +117,10 @@ struct ImportData
 	bool log;
 };
 
+// ------------------------------------------------------------------------------
+/** Print a horizontal separator line */
+void PrintHorBar();
+
 // ------------------------------------------------------------------------------
 /** Process standard arguments
  *
@@ -195,6 +199,24 @@ int Assimp_Info (
 	const char* const* params, 
 	unsigned int num);
 
+// ------------------------------------------------------------------------------
+/** @brief assimp bench utility
+ *  @param params Command line parameters to 'assimp bench'
+ *  @param Number of params
+ *  @return 0 for success, 5 if a regression against the baseline was found */
+int Assimp_Benchmark (
+	const char* const* params, 
+	unsigned int num);
+
+// ------------------------------------------------------------------------------
+/** @brief assimp bake utility
+ *  @param params Command line parameters to 'assimp bake'
+ *  @param Number of params
+ *  @return 0 for success, 3 if a texture failed to convert */
+int Assimp_Bake (
+	const char* const* params, 
+	unsigned int num);
+
 // ------------------------------------------------------------------------------
 /** @brief assimp testbatchload utility
  *  @param params Command line parameters to 'assimp testbatchload'
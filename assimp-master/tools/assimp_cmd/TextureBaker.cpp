@@ -0,0 +1,1205 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2016, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file  TextureBaker.cpp
+ *  @brief Implementation of the 'assimp bake' utility  */
+
+#include "Main.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define AI_BAKE_SSE2
+#endif
+
+const char* AICMD_MSG_BAKE_HELP_E =
+"assimp bake <model> [<model> ...] [-f<format>] [--filter=<filter>] [--linear] [-j<threads>] [--force]\n"
+"\tConvert the textures referenced by the given models into DDS files with a\n"
+"\tfull mip chain of block compressed data, written next to each source image\n"
+"\tas <name>.dds. PNG and TGA sources are converted, DDS sources are left alone.\n"
+"\tSources whose width or height is not a multiple of 4 are skipped, D3D11\n"
+"\tdoesn't create block compressed textures of that size.\n"
+"\t-f<format>,--format=<format>: bc1, bc3, bc7 or auto, the default. auto\n"
+"\t    picks bc1 for opaque images and bc3 for images with alpha\n"
+"\t--filter=<filter>: Mip filter, kaiser (default) or box\n"
+"\t--linear: Filter the color channels as stored instead of as sRGB, for\n"
+"\t    normal maps and other non-color data\n"
+"\t-j<threads>,--threads=<threads>: Compression threads, defaults to the number of cores\n"
+"\t--force: Also rebuild DDS files that are newer than their source\n"
+"\tThe exit code is 0 if every texture was converted or skipped.\n";
+
+namespace {
+
+enum BlockFormat
+{
+	FORMAT_AUTO,
+	FORMAT_BC1,
+	FORMAT_BC3,
+	FORMAT_BC7
+};
+
+// -----------------------------------------------------------------------------------
+/** 8 bit RGBA image as decoded from a source file */
+struct Image
+{
+	Image() : width(0), height(0) {}
+
+	unsigned int width, height;
+	std::vector<uint8_t> rgba;
+};
+
+// -----------------------------------------------------------------------------------
+/** RGBA image with float channels, the working format of the mip filter */
+struct FloatImage
+{
+	FloatImage() : width(0), height(0) {}
+
+	unsigned int width, height;
+	std::vector<float> rgba;
+};
+
+// -----------------------------------------------------------------------------------
+/** Filter tap, relative to the first of the two source texels of a destination texel */
+struct Tap
+{
+	int offset;
+	float weight;
+};
+
+// -----------------------------------------------------------------------------------
+bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& out)
+{
+	FILE* f = fopen(path.c_str(),"rb");
+	if (!f) {
+		return false;
+	}
+	fseek(f,0,SEEK_END);
+	const long size = ftell(f);
+	fseek(f,0,SEEK_SET);
+	out.resize(size > 0 ? size : 0);
+	const bool ok = size > 0 && fread(&out[0],1,out.size(),f) == out.size();
+	fclose(f);
+	return ok;
+}
+
+// -----------------------------------------------------------------------------------
+uint32_t ReadBE32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// -----------------------------------------------------------------------------------
+uint8_t Paeth(int a, int b, int c)
+{
+	const int p = a + b - c;
+	const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	return static_cast<uint8_t>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+// -----------------------------------------------------------------------------------
+// Non-interlaced PNG of any color type, 16 bit samples are cut to their high byte
+bool DecodePNG(const std::vector<uint8_t>& file, Image& out, std::string& error)
+{
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+	if (file.size() < 8 || memcmp(&file[0],signature,8)) {
+		error = "not a PNG file";
+		return false;
+	}
+	unsigned int width = 0, height = 0, depth = 0, colorType = 0, interlace = 0;
+	std::vector<uint8_t> idat, palette, paletteAlpha;
+	for (size_t pos = 8; pos + 12 <= file.size();) {
+		const uint32_t length = ReadBE32(&file[pos]);
+		const uint8_t* type = &file[pos + 4];
+		const uint8_t* data = &file[pos + 8];
+		if (length > file.size() - pos - 12) {
+			error = "truncated chunk";
+			return false;
+		}
+		if (!memcmp(type,"IHDR",4) && length >= 13) {
+			width = ReadBE32(data);
+			height = ReadBE32(data + 4);
+			depth = data[8];
+			colorType = data[9];
+			interlace = data[12];
+		}
+		else if (!memcmp(type,"PLTE",4)) {
+			palette.assign(data,data + length);
+		}
+		else if (!memcmp(type,"tRNS",4)) {
+			paletteAlpha.assign(data,data + length);
+		}
+		else if (!memcmp(type,"IDAT",4)) {
+			idat.insert(idat.end(),data,data + length);
+		}
+		else if (!memcmp(type,"IEND",4)) {
+			break;
+		}
+		pos += 12 + length;
+	}
+
+	static const unsigned int channelsOfType[7] = { 1, 0, 3, 1, 2, 0, 4 };
+	const unsigned int channels = colorType < 7 ? channelsOfType[colorType] : 0;
+	if (!width || !height || !channels || (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16)) {
+		error = "unsupported PNG header";
+		return false;
+	}
+	if (interlace) {
+		error = "interlaced PNGs are not supported";
+		return false;
+	}
+	if (colorType == 3 && palette.empty()) {
+		error = "missing palette";
+		return false;
+	}
+
+	const size_t bitsPerPixel = channels * depth;
+	const size_t rowBytes = (width * bitsPerPixel + 7) / 8;
+	const size_t stride = std::max<size_t>(1,bitsPerPixel / 8);
+	std::vector<uint8_t> raw((rowBytes + 1) * height);
+	uLongf rawSize = static_cast<uLongf>(raw.size());
+	if (idat.empty() || uncompress(&raw[0],&rawSize,&idat[0],static_cast<uLong>(idat.size())) != Z_OK || rawSize != raw.size()) {
+		error = "corrupt image data";
+		return false;
+	}
+
+	// undo the per row filters in place, each row is preceded by its filter type
+	for (unsigned int y = 0; y < height; ++y) {
+		uint8_t* row = &raw[y * (rowBytes + 1) + 1];
+		const uint8_t* prior = y ? row - (rowBytes + 1) : NULL;
+		const uint8_t filter = row[-1];
+		for (size_t i = 0; i < rowBytes; ++i) {
+			const int a = i >= stride ? row[i - stride] : 0;
+			const int b = prior ? prior[i] : 0;
+			const int c = prior && i >= stride ? prior[i - stride] : 0;
+			switch (filter) {
+			case 0: break;
+			case 1: row[i] = static_cast<uint8_t>(row[i] + a); break;
+			case 2: row[i] = static_cast<uint8_t>(row[i] + b); break;
+			case 3: row[i] = static_cast<uint8_t>(row[i] + ((a + b) >> 1)); break;
+			case 4: row[i] = static_cast<uint8_t>(row[i] + Paeth(a,b,c)); break;
+			default:
+				error = "invalid row filter";
+				return false;
+			}
+		}
+	}
+
+	out.width = width;
+	out.height = height;
+	out.rgba.resize(width * height * 4);
+	const unsigned int maxValue = (1u << std::min(depth,8u)) - 1;
+	for (unsigned int y = 0; y < height; ++y) {
+		const uint8_t* row = &raw[y * (rowBytes + 1) + 1];
+		for (unsigned int x = 0; x < width; ++x) {
+			uint8_t s[4];
+			for (unsigned int c = 0; c < channels; ++c) {
+				const size_t bit = (static_cast<size_t>(x) * channels + c) * depth;
+				if (depth >= 8) {
+					// the high byte of 16 bit samples comes first
+					s[c] = row[bit / 8];
+				}
+				else {
+					const unsigned int v = (row[bit / 8] >> (8 - depth - bit % 8)) & maxValue;
+					s[c] = static_cast<uint8_t>(colorType == 3 ? v : v * 255 / maxValue);
+				}
+			}
+			uint8_t* p = &out.rgba[(y * width + x) * 4];
+			switch (colorType) {
+			case 0: p[0] = p[1] = p[2] = s[0]; p[3] = 255; break;
+			case 2: p[0] = s[0]; p[1] = s[1]; p[2] = s[2]; p[3] = 255; break;
+			case 4: p[0] = p[1] = p[2] = s[0]; p[3] = s[1]; break;
+			case 6: p[0] = s[0]; p[1] = s[1]; p[2] = s[2]; p[3] = s[3]; break;
+			case 3:
+				if (s[0] * 3u + 2 >= palette.size()) {
+					error = "palette index out of range";
+					return false;
+				}
+				p[0] = palette[s[0] * 3];
+				p[1] = palette[s[0] * 3 + 1];
+				p[2] = palette[s[0] * 3 + 2];
+				p[3] = s[0] < paletteAlpha.size() ? paletteAlpha[s[0]] : 255;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------------
+// True color and grayscale TGA, plain or run length encoded
+bool DecodeTGA(const std::vector<uint8_t>& file, Image& out, std::string& error)
+{
+	if (file.size() < 18) {
+		error = "truncated header";
+		return false;
+	}
+	const uint8_t* h = &file[0];
+	const unsigned int type = h[2];
+	const unsigned int width = h[12] | (h[13] << 8);
+	const unsigned int height = h[14] | (h[15] << 8);
+	const unsigned int bits = h[16];
+	const unsigned int descriptor = h[17];
+	const bool gray = type == 3 || type == 11;
+	if ((type != 2 && type != 3 && type != 10 && type != 11) || !width || !height ||
+		(gray ? bits != 8 : (bits != 24 && bits != 32))) {
+		error = "unsupported TGA type";
+		return false;
+	}
+	const unsigned int bytesPerPixel = bits / 8;
+	// a 32 bit image without alpha bits in the descriptor has undefined alpha
+	const bool alpha = bits == 32 && (descriptor & 0x0f);
+	size_t pos = 18 + h[0];
+	if (h[1]) {
+		const unsigned int entries = h[5] | (h[6] << 8);
+		pos += (entries * h[7] + 7) / 8;
+	}
+
+	std::vector<uint8_t> pixels(width * height * bytesPerPixel);
+	if (type < 8) {
+		if (pos + pixels.size() > file.size()) {
+			error = "truncated image data";
+			return false;
+		}
+		memcpy(&pixels[0],&file[pos],pixels.size());
+	}
+	else {
+		for (size_t i = 0; i < pixels.size();) {
+			if (pos >= file.size()) {
+				error = "truncated image data";
+				return false;
+			}
+			const uint8_t packet = file[pos++];
+			const size_t count = std::min<size_t>((packet & 0x7f) + 1,(pixels.size() - i) / bytesPerPixel);
+			const bool run = (packet & 0x80) != 0;
+			const size_t needed = run ? bytesPerPixel : count * bytesPerPixel;
+			if (pos + needed > file.size()) {
+				error = "truncated image data";
+				return false;
+			}
+			for (size_t n = 0; n < count; ++n, i += bytesPerPixel) {
+				memcpy(&pixels[i],&file[run ? pos : pos + n * bytesPerPixel],bytesPerPixel);
+			}
+			pos += needed;
+		}
+	}
+
+	out.width = width;
+	out.height = height;
+	out.rgba.resize(width * height * 4);
+	const bool topDown = (descriptor & 0x20) != 0;
+	for (unsigned int y = 0; y < height; ++y) {
+		const uint8_t* src = &pixels[(topDown ? y : height - 1 - y) * width * bytesPerPixel];
+		uint8_t* dst = &out.rgba[y * width * 4];
+		for (unsigned int x = 0; x < width; ++x, src += bytesPerPixel, dst += 4) {
+			if (gray) {
+				dst[0] = dst[1] = dst[2] = src[0];
+				dst[3] = 255;
+			}
+			else {
+				dst[0] = src[2];
+				dst[1] = src[1];
+				dst[2] = src[0];
+				dst[3] = alpha ? src[3] : 255;
+			}
+		}
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------------
+float SRGBToLinear(float c)
+{
+	return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f,2.4f);
+}
+
+// -----------------------------------------------------------------------------------
+float LinearToSRGB(float c)
+{
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c,1.0f / 2.4f) - 0.055f;
+}
+
+// -----------------------------------------------------------------------------------
+void ToFloat(const Image& in, bool srgb, FloatImage& out)
+{
+	float table[256];
+	for (unsigned int i = 0; i < 256; ++i) {
+		table[i] = srgb ? SRGBToLinear(i / 255.0f) : i / 255.0f;
+	}
+	out.width = in.width;
+	out.height = in.height;
+	out.rgba.resize(in.rgba.size());
+	for (size_t i = 0; i < in.rgba.size(); i += 4) {
+		out.rgba[i] = table[in.rgba[i]];
+		out.rgba[i + 1] = table[in.rgba[i + 1]];
+		out.rgba[i + 2] = table[in.rgba[i + 2]];
+		out.rgba[i + 3] = in.rgba[i + 3] / 255.0f;
+	}
+}
+
+// -----------------------------------------------------------------------------------
+void ToBytes(const FloatImage& in, bool srgb, Image& out)
+{
+	out.width = in.width;
+	out.height = in.height;
+	out.rgba.resize(in.rgba.size());
+	for (size_t i = 0; i < in.rgba.size(); ++i) {
+		// the filters ring, so values slightly outside 0..1 are expected
+		float c = std::min(std::max(in.rgba[i],0.0f),1.0f);
+		if (srgb && (i & 3) != 3) {
+			c = LinearToSRGB(c);
+		}
+		out.rgba[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+	}
+}
+
+// -----------------------------------------------------------------------------------
+float BesselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 20; ++k) {
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// -----------------------------------------------------------------------------------
+// Taps halving the resolution. Kaiser windowed sinc with a support of three destination
+// texels and alpha 4, or a 2x2 box.
+std::vector<Tap> BuildTaps(bool kaiser)
+{
+	std::vector<Tap> taps;
+	if (!kaiser) {
+		const Tap box[2] = { { 0, 0.5f }, { 1, 0.5f } };
+		taps.assign(box,box + 2);
+		return taps;
+	}
+	const float width = 3.0f, alpha = 4.0f, pi = 3.14159265f;
+	float total = 0.0f;
+	for (int offset = -5; offset <= 6; ++offset) {
+		// distance of the source texel center from the destination texel center, in
+		// destination texels
+		const float t = (offset - 0.5f) * 0.5f;
+		const float sinc = fabsf(t) < 1e-6f ? 1.0f : sinf(pi * t) / (pi * t);
+		const float r = t / width;
+		const float window = BesselI0(alpha * sqrtf(std::max(0.0f,1.0f - r * r))) / BesselI0(alpha);
+		Tap tap = { offset, sinc * window };
+		taps.push_back(tap);
+		total += tap.weight;
+	}
+	for (size_t i = 0; i < taps.size(); ++i) {
+		taps[i].weight /= total;
+	}
+	return taps;
+}
+
+// -----------------------------------------------------------------------------------
+// dst = sum of weight * src[clamped offsets], one RGBA texel at a time
+inline void FilterTexel(const float* src, const int* offsets, const float* weights, size_t numTaps, float* dst)
+{
+#ifdef AI_BAKE_SSE2
+	__m128 sum = _mm_setzero_ps();
+	for (size_t t = 0; t < numTaps; ++t) {
+		sum = _mm_add_ps(sum,_mm_mul_ps(_mm_loadu_ps(src + offsets[t]),_mm_set1_ps(weights[t])));
+	}
+	_mm_storeu_ps(dst,sum);
+#else
+	float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (size_t t = 0; t < numTaps; ++t) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			sum[c] += src[offsets[t] + c] * weights[t];
+		}
+	}
+	memcpy(dst,sum,sizeof(sum));
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Next level of the mip chain, filtered horizontally and then vertically. Taps falling
+// off the image are clamped to the edge.
+void Downsample(const FloatImage& src, const std::vector<Tap>& taps, FloatImage& dst)
+{
+	dst.width = std::max(1u,src.width / 2);
+	dst.height = std::max(1u,src.height / 2);
+	dst.rgba.resize(dst.width * dst.height * 4);
+	std::vector<float> tmp(dst.width * src.height * 4);
+	std::vector<int> offsets(taps.size());
+	std::vector<float> weights(taps.size());
+	for (size_t t = 0; t < taps.size(); ++t) {
+		weights[t] = taps[t].weight;
+	}
+
+	for (unsigned int x = 0; x < dst.width; ++x) {
+		for (size_t t = 0; t < taps.size(); ++t) {
+			const int sx = std::min(std::max(static_cast<int>(2 * x) + taps[t].offset,0),static_cast<int>(src.width) - 1);
+			offsets[t] = sx * 4;
+		}
+		for (unsigned int y = 0; y < src.height; ++y) {
+			FilterTexel(&src.rgba[y * src.width * 4],&offsets[0],&weights[0],taps.size(),&tmp[(y * dst.width + x) * 4]);
+		}
+	}
+	for (unsigned int y = 0; y < dst.height; ++y) {
+		for (size_t t = 0; t < taps.size(); ++t) {
+			const int sy = std::min(std::max(static_cast<int>(2 * y) + taps[t].offset,0),static_cast<int>(src.height) - 1);
+			offsets[t] = sy * dst.width * 4;
+		}
+		for (unsigned int x = 0; x < dst.width; ++x) {
+			FilterTexel(&tmp[x * 4],&offsets[0],&weights[0],taps.size(),&dst.rgba[(y * dst.width + x) * 4]);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// Principal axis of the block through power iteration, then the extent of the pixels
+// along it. Channels is 3 or 4.
+void FitLine(const float pixels[16][4], unsigned int channels, float e0[4], float e1[4])
+{
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (unsigned int i = 0; i < 16; ++i) {
+		for (unsigned int c = 0; c < channels; ++c) {
+			mean[c] += pixels[i][c] / 16.0f;
+		}
+	}
+	float cov[4][4] = {};
+	for (unsigned int i = 0; i < 16; ++i) {
+		for (unsigned int a = 0; a < channels; ++a) {
+			for (unsigned int b = 0; b < channels; ++b) {
+				cov[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+			}
+		}
+	}
+	float axis[4] = { 1.0f, 1.0f, 1.0f, channels == 4 ? 1.0f : 0.0f };
+	for (unsigned int iter = 0; iter < 8; ++iter) {
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float len = 0.0f;
+		for (unsigned int a = 0; a < channels; ++a) {
+			for (unsigned int b = 0; b < channels; ++b) {
+				next[a] += cov[a][b] * axis[b];
+			}
+			len = std::max(len,fabsf(next[a]));
+		}
+		if (len < 1e-12f) {
+			break;
+		}
+		for (unsigned int a = 0; a < channels; ++a) {
+			axis[a] = next[a] / len;
+		}
+	}
+	float norm = 0.0f;
+	for (unsigned int c = 0; c < channels; ++c) {
+		norm += axis[c] * axis[c];
+	}
+	norm = norm > 0.0f ? 1.0f / sqrtf(norm) : 0.0f;
+
+	float lo = 0.0f, hi = 0.0f;
+	for (unsigned int i = 0; i < 16; ++i) {
+		float t = 0.0f;
+		for (unsigned int c = 0; c < channels; ++c) {
+			t += (pixels[i][c] - mean[c]) * axis[c] * norm;
+		}
+		lo = std::min(lo,t);
+		hi = std::max(hi,t);
+	}
+	for (unsigned int c = 0; c < 4; ++c) {
+		e0[c] = c < channels ? mean[c] + axis[c] * norm * lo : 0.0f;
+		e1[c] = c < channels ? mean[c] + axis[c] * norm * hi : 0.0f;
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// Least squares endpoints for fixed interpolation weights. Returns false if the
+// weights don't determine them.
+bool RefineLine(const float pixels[16][4], const float weights[16], unsigned int channels, float e0[4], float e1[4])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (unsigned int i = 0; i < 16; ++i) {
+		const float b = weights[i], a = 1.0f - b;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (unsigned int c = 0; c < channels; ++c) {
+			ax[c] += a * pixels[i][c];
+			bx[c] += b * pixels[i][c];
+		}
+	}
+	const float det = aa * bb - ab * ab;
+	if (fabsf(det) < 1e-6f) {
+		return false;
+	}
+	for (unsigned int c = 0; c < channels; ++c) {
+		e0[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / det,0.0f),255.0f);
+		e1[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / det,0.0f),255.0f);
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------------
+uint16_t To565(const float c[4])
+{
+	const int r = static_cast<int>(std::min(std::max(c[0],0.0f),255.0f) * 31.0f / 255.0f + 0.5f);
+	const int g = static_cast<int>(std::min(std::max(c[1],0.0f),255.0f) * 63.0f / 255.0f + 0.5f);
+	const int b = static_cast<int>(std::min(std::max(c[2],0.0f),255.0f) * 31.0f / 255.0f + 0.5f);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+// -----------------------------------------------------------------------------------
+void From565(uint16_t v, int out[3])
+{
+	const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+	out[0] = (r << 3) | (r >> 2);
+	out[1] = (g << 2) | (g >> 4);
+	out[2] = (b << 3) | (b >> 2);
+}
+
+// -----------------------------------------------------------------------------------
+// Indices of the 4 color palette of c0 and c1, returns the squared error
+int PickBC1Indices(const float pixels[16][4], uint16_t c0, uint16_t c1, uint32_t& indices)
+{
+	int p[4][3];
+	From565(c0,p[0]);
+	From565(c1,p[1]);
+	for (unsigned int c = 0; c < 3; ++c) {
+		p[2][c] = (2 * p[0][c] + p[1][c]) / 3;
+		p[3][c] = (p[0][c] + 2 * p[1][c]) / 3;
+	}
+	indices = 0;
+	int total = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		int best = 0, bestError = INT_MAX;
+		for (int k = 0; k < 4; ++k) {
+			int error = 0;
+			for (unsigned int c = 0; c < 3; ++c) {
+				const int d = static_cast<int>(pixels[i][c] + 0.5f) - p[k][c];
+				error += d * d;
+			}
+			if (error < bestError) {
+				bestError = error;
+				best = k;
+			}
+		}
+		indices |= static_cast<uint32_t>(best) << (2 * i);
+		total += bestError;
+	}
+	return total;
+}
+
+// -----------------------------------------------------------------------------------
+// BC1 color block, always in the 4 color mode
+void CompressBC1Color(const float pixels[16][4], uint8_t out[8])
+{
+	float e0[4], e1[4];
+	FitLine(pixels,3,e0,e1);
+	uint16_t c0 = To565(e1), c1 = To565(e0);
+	uint32_t indices;
+	int error = PickBC1Indices(pixels,c0,c1,indices);
+
+	// one least squares step on the weights the first fit picked
+	static const float weightOfIndex[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	float weights[16];
+	for (unsigned int i = 0; i < 16; ++i) {
+		weights[i] = weightOfIndex[(indices >> (2 * i)) & 3];
+	}
+	if (RefineLine(pixels,weights,3,e0,e1)) {
+		const uint16_t r0 = To565(e0), r1 = To565(e1);
+		uint32_t refined;
+		const int refinedError = PickBC1Indices(pixels,r0,r1,refined);
+		if (refinedError < error) {
+			c0 = r0;
+			c1 = r1;
+			indices = refined;
+			error = refinedError;
+		}
+	}
+
+	// c0 > c1 selects the 4 color mode, swapping the endpoints maps 0<->1 and 2<->3
+	if (c0 < c1) {
+		std::swap(c0,c1);
+		indices ^= 0x55555555;
+	}
+	else if (c0 == c1) {
+		indices = 0;
+	}
+	out[0] = static_cast<uint8_t>(c0);
+	out[1] = static_cast<uint8_t>(c0 >> 8);
+	out[2] = static_cast<uint8_t>(c1);
+	out[3] = static_cast<uint8_t>(c1 >> 8);
+	for (unsigned int i = 0; i < 4; ++i) {
+		out[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// BC3 alpha block in the 8 value mode
+void CompressBC3Alpha(const float pixels[16][4], uint8_t out[8])
+{
+	int lo = 255, hi = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		const int a = static_cast<int>(pixels[i][3] + 0.5f);
+		lo = std::min(lo,a);
+		hi = std::max(hi,a);
+	}
+	out[0] = static_cast<uint8_t>(hi);
+	out[1] = static_cast<uint8_t>(lo);
+	uint64_t indices = 0;
+	if (hi != lo) {
+		int palette[8] = { hi, lo };
+		for (int k = 1; k < 7; ++k) {
+			palette[k + 1] = ((7 - k) * hi + k * lo) / 7;
+		}
+		for (unsigned int i = 0; i < 16; ++i) {
+			const int a = static_cast<int>(pixels[i][3] + 0.5f);
+			uint64_t best = 0;
+			for (int k = 1; k < 8; ++k) {
+				if (abs(palette[k] - a) < abs(palette[best] - a)) {
+					best = k;
+				}
+			}
+			indices |= best << (3 * i);
+		}
+	}
+	for (unsigned int i = 0; i < 6; ++i) {
+		out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// 7 bit endpoint plus the shared p-bit closest to the 8 bit target
+void QuantizeBC7Endpoint(const float target[4], int out[4], int& pbit)
+{
+	int best[2][4];
+	float error[2] = { 0.0f, 0.0f };
+	for (int p = 0; p < 2; ++p) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			const int e = std::min(std::max(static_cast<int>((target[c] - p) / 2.0f + 0.5f),0),127);
+			best[p][c] = e;
+			const float d = static_cast<float>((e << 1) | p) - target[c];
+			error[p] += d * d;
+		}
+	}
+	pbit = error[1] < error[0] ? 1 : 0;
+	memcpy(out,best[pbit],sizeof(best[pbit]));
+}
+
+// -----------------------------------------------------------------------------------
+int PickBC7Indices(const float pixels[16][4], const int e0[4], int p0, const int e1[4], int p1, uint8_t indices[16])
+{
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	int palette[16][4];
+	for (unsigned int k = 0; k < 16; ++k) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			const int a = (e0[c] << 1) | p0, b = (e1[c] << 1) | p1;
+			palette[k][c] = ((64 - weights[k]) * a + weights[k] * b + 32) >> 6;
+		}
+	}
+	int total = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		int best = 0, bestError = INT_MAX;
+		for (int k = 0; k < 16; ++k) {
+			int error = 0;
+			for (unsigned int c = 0; c < 4; ++c) {
+				const int d = static_cast<int>(pixels[i][c] + 0.5f) - palette[k][c];
+				error += d * d;
+			}
+			if (error < bestError) {
+				bestError = error;
+				best = k;
+			}
+		}
+		indices[i] = static_cast<uint8_t>(best);
+		total += bestError;
+	}
+	return total;
+}
+
+// -----------------------------------------------------------------------------------
+// BC7 mode 6 only: one subset, RGBA endpoints of 7 bits plus p-bit, 4 bit indices.
+// Not the best mode for every block, but a single fit per block keeps it fast.
+void CompressBC7(const float pixels[16][4], uint8_t out[16])
+{
+	float f0[4], f1[4];
+	FitLine(pixels,4,f0,f1);
+	int e0[4], e1[4], p0, p1;
+	QuantizeBC7Endpoint(f0,e0,p0);
+	QuantizeBC7Endpoint(f1,e1,p1);
+	uint8_t indices[16];
+	int error = PickBC7Indices(pixels,e0,p0,e1,p1,indices);
+
+	float weights[16];
+	for (unsigned int i = 0; i < 16; ++i) {
+		static const int w[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		weights[i] = w[indices[i]] / 64.0f;
+	}
+	if (RefineLine(pixels,weights,4,f0,f1)) {
+		int r0[4], r1[4], q0, q1;
+		QuantizeBC7Endpoint(f0,r0,q0);
+		QuantizeBC7Endpoint(f1,r1,q1);
+		uint8_t refined[16];
+		const int refinedError = PickBC7Indices(pixels,r0,q0,r1,q1,refined);
+		if (refinedError < error) {
+			memcpy(e0,r0,sizeof(e0));
+			memcpy(e1,r1,sizeof(e1));
+			p0 = q0;
+			p1 = q1;
+			memcpy(indices,refined,sizeof(indices));
+		}
+	}
+
+	// the MSB of the first index is implied 0
+	if (indices[0] & 8) {
+		std::swap(e0,e1);
+		std::swap(p0,p1);
+		for (unsigned int i = 0; i < 16; ++i) {
+			indices[i] = static_cast<uint8_t>(15 - indices[i]);
+		}
+	}
+
+	memset(out,0,16);
+	unsigned int bit = 0;
+	struct Writer {
+		static void Put(uint8_t* dst, unsigned int& pos, unsigned int value, unsigned int bits) {
+			for (unsigned int i = 0; i < bits; ++i, ++pos) {
+				dst[pos / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (pos % 8));
+			}
+		}
+	};
+	Writer::Put(out,bit,1 << 6,7);
+	for (unsigned int c = 0; c < 4; ++c) {
+		Writer::Put(out,bit,e0[c],7);
+		Writer::Put(out,bit,e1[c],7);
+	}
+	Writer::Put(out,bit,p0,1);
+	Writer::Put(out,bit,p1,1);
+	Writer::Put(out,bit,indices[0],3);
+	for (unsigned int i = 1; i < 16; ++i) {
+		Writer::Put(out,bit,indices[i],4);
+	}
+}
+
+// -----------------------------------------------------------------------------------
+unsigned int BlockBytes(BlockFormat format)
+{
+	return format == FORMAT_BC1 ? 8 : 16;
+}
+
+// -----------------------------------------------------------------------------------
+// Compress the 4x4 block rows [first, last) of img, partial blocks repeat the edge
+void CompressRows(const Image& img, BlockFormat format, unsigned int first, unsigned int last, uint8_t* out)
+{
+	const unsigned int blocksX = (img.width + 3) / 4;
+	for (unsigned int by = first; by < last; ++by) {
+		for (unsigned int bx = 0; bx < blocksX; ++bx) {
+			float pixels[16][4];
+			for (unsigned int i = 0; i < 16; ++i) {
+				const unsigned int x = std::min(bx * 4 + i % 4,img.width - 1);
+				const unsigned int y = std::min(by * 4 + i / 4,img.height - 1);
+				const uint8_t* p = &img.rgba[(y * img.width + x) * 4];
+				for (unsigned int c = 0; c < 4; ++c) {
+					pixels[i][c] = p[c];
+				}
+			}
+			uint8_t* block = out + (by * blocksX + bx) * BlockBytes(format);
+			switch (format) {
+			case FORMAT_BC1:
+				CompressBC1Color(pixels,block);
+				break;
+			case FORMAT_BC3:
+				CompressBC3Alpha(pixels,block);
+				CompressBC1Color(pixels,block + 8);
+				break;
+			default:
+				CompressBC7(pixels,block);
+				break;
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// Blocks of one mip level, the block rows are split between the threads
+void CompressLevel(const Image& img, BlockFormat format, unsigned int threads, std::vector<uint8_t>& out)
+{
+	const unsigned int blocksX = (img.width + 3) / 4, blocksY = (img.height + 3) / 4;
+	const size_t start = out.size();
+	out.resize(start + blocksX * blocksY * BlockBytes(format));
+	const unsigned int workers = std::max(1u,std::min(threads,blocksY));
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < workers; ++t) {
+		pool.push_back(std::thread(CompressRows,std::cref(img),format,blocksY * t / workers,
+			blocksY * (t + 1) / workers,&out[start]));
+	}
+	CompressRows(img,format,0,blocksY / workers,&out[start]);
+	for (size_t t = 0; t < pool.size(); ++t) {
+		pool[t].join();
+	}
+}
+
+// -----------------------------------------------------------------------------------
+void PutLE32(std::vector<uint8_t>& out, uint32_t v)
+{
+	for (unsigned int i = 0; i < 4; ++i) {
+		out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+	}
+}
+
+// -----------------------------------------------------------------------------------
+// DDS header for a 2D texture with a full mip chain. BC1 and BC3 use the DXT1/DXT5 four
+// character codes every loader knows, BC7 needs the DX10 extension header.
+void WriteDDSHeader(unsigned int width, unsigned int height, unsigned int mips, BlockFormat format, std::vector<uint8_t>& out)
+{
+	const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000,
+		DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+
+	out.insert(out.end(),"DDS ","DDS " + 4);
+	PutLE32(out,124);
+	PutLE32(out,DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+	PutLE32(out,height);
+	PutLE32(out,width);
+	PutLE32(out,((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format));
+	PutLE32(out,0);
+	PutLE32(out,mips);
+	for (unsigned int i = 0; i < 11; ++i) {
+		PutLE32(out,0);
+	}
+	// pixel format
+	const char* fourCC = format == FORMAT_BC1 ? "DXT1" : (format == FORMAT_BC3 ? "DXT5" : "DX10");
+	PutLE32(out,32);
+	PutLE32(out,DDPF_FOURCC);
+	out.insert(out.end(),fourCC,fourCC + 4);
+	for (unsigned int i = 0; i < 5; ++i) {
+		PutLE32(out,0);
+	}
+	PutLE32(out,DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP);
+	for (unsigned int i = 0; i < 4; ++i) {
+		PutLE32(out,0);
+	}
+	if (format == FORMAT_BC7) {
+		// DXGI_FORMAT_BC7_UNORM, not the _SRGB variant, the runtime samples the source
+		// images as UNORM as well
+		PutLE32(out,98);
+		PutLE32(out,3); // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+		PutLE32(out,0);
+		PutLE32(out,1);
+		PutLE32(out,0);
+	}
+}
+
+// -----------------------------------------------------------------------------------
+std::string GetLowerExtension(const std::string& path)
+{
+	const std::string::size_type dot = path.find_last_of('.');
+	const std::string::size_type sep = path.find_last_of("/\\");
+	if (dot == std::string::npos || (sep != std::string::npos && dot < sep)) {
+		return std::string();
+	}
+	std::string ext = path.substr(dot + 1);
+	std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
+	return ext;
+}
+
+// -----------------------------------------------------------------------------------
+bool FileExists(const std::string& path, time_t* modified = NULL)
+{
+	struct stat st;
+	if (stat(path.c_str(),&st) != 0) {
+		return false;
+	}
+	if (modified) {
+		*modified = st.st_mtime;
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------------
+// The reference as given, relative to the model, or its file name in the model's directory
+bool ResolveTexture(const std::string& modelDir, std::string ref, std::string& out)
+{
+#ifndef _WIN32
+	std::replace(ref.begin(),ref.end(),'\\','/');
+#endif
+	const std::string::size_type sep = ref.find_last_of("/\\");
+	const std::string candidates[3] = {
+		ref,
+		modelDir + ref,
+		modelDir + (sep == std::string::npos ? ref : ref.substr(sep + 1))
+	};
+	for (unsigned int i = 0; i < 3; ++i) {
+		if (FileExists(candidates[i])) {
+			out = candidates[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+// -----------------------------------------------------------------------------------
+/** Settings shared by all textures of a run */
+struct BakeOptions
+{
+	BlockFormat format;
+	bool kaiser;
+	bool srgb;
+	bool force;
+	unsigned int threads;
+};
+
+enum BakeResult
+{
+	BAKE_DONE,
+	BAKE_SKIPPED,
+	BAKE_FAILED
+};
+
+// -----------------------------------------------------------------------------------
+BakeResult BakeTexture(const std::string& src, const BakeOptions& opt)
+{
+	const std::string ext = GetLowerExtension(src);
+	if (ext == "dds") {
+		return BAKE_SKIPPED;
+	}
+	const std::string dst = src.substr(0,src.length() - ext.length()) + "dds";
+	time_t srcTime = 0, dstTime = 0;
+	FileExists(src,&srcTime);
+	if (!opt.force && FileExists(dst,&dstTime) && dstTime >= srcTime) {
+		printf("  %s: up to date\n",dst.c_str());
+		return BAKE_SKIPPED;
+	}
+
+	std::vector<uint8_t> file;
+	Image img;
+	std::string error;
+	if (!ReadWholeFile(src,file)) {
+		error = "unable to read the file";
+	}
+	else if (ext == "png") {
+		DecodePNG(file,img,error);
+	}
+	else if (ext == "tga") {
+		DecodeTGA(file,img,error);
+	}
+	else {
+		printf("  %s: unsupported format, skipped\n",src.c_str());
+		return BAKE_SKIPPED;
+	}
+	if (!img.width) {
+		printf("  %s: %s\n",src.c_str(),error.c_str());
+		return BAKE_FAILED;
+	}
+	// without a DDS the source is loaded as it is
+	if (img.width % 4 || img.height % 4) {
+		printf("  %s: %ux%u is not a multiple of 4, skipped\n",src.c_str(),img.width,img.height);
+		return BAKE_SKIPPED;
+	}
+
+	BlockFormat format = opt.format;
+	if (format == FORMAT_AUTO) {
+		format = FORMAT_BC1;
+		for (size_t i = 3; i < img.rgba.size(); i += 4) {
+			if (img.rgba[i] != 255) {
+				format = FORMAT_BC3;
+				break;
+			}
+		}
+	}
+
+	const std::vector<Tap> taps = BuildTaps(opt.kaiser);
+	const unsigned int width = img.width, height = img.height;
+	FloatImage level;
+	ToFloat(img,opt.srgb,level);
+	std::vector<uint8_t> out;
+	unsigned int mips = 1;
+	for (unsigned int w = width, h = height; w > 1 || h > 1; w = std::max(1u,w / 2), h = std::max(1u,h / 2)) {
+		++mips;
+	}
+	WriteDDSHeader(width,height,mips,format,out);
+	CompressLevel(img,format,opt.threads,out);
+	while (level.width > 1 || level.height > 1) {
+		// every level is filtered from the previous one in float, never from 8 bit data
+		FloatImage next;
+		Downsample(level,taps,next);
+		std::swap(level,next);
+		ToBytes(level,opt.srgb,img);
+		CompressLevel(img,format,opt.threads,out);
+	}
+
+	FILE* f = fopen(dst.c_str(),"wb");
+	if (!f || fwrite(&out[0],1,out.size(),f) != out.size()) {
+		if (f) {
+			fclose(f);
+		}
+		printf("  %s: unable to write\n",dst.c_str());
+		return BAKE_FAILED;
+	}
+	fclose(f);
+	static const char* formatNames[4] = { "", "BC1", "BC3", "BC7" };
+	printf("  %s -> %s (%s, %ux%u, %u mips, %u KB)\n",src.c_str(),dst.c_str(),formatNames[format],
+		width,height,mips,static_cast<unsigned int>(out.size() / 1024));
+	return BAKE_DONE;
+}
+
+// -----------------------------------------------------------------------------------
+// Every texture file referenced by the materials of the scene, without embedded ones
+void CollectTextures(const aiScene* scene, const std::string& modelPath, std::set<std::string>& out)
+{
+	const std::string::size_type sep = modelPath.find_last_of("/\\");
+	const std::string modelDir = sep == std::string::npos ? std::string() : modelPath.substr(0,sep + 1);
+	for (unsigned int m = 0; m < scene->mNumMaterials; ++m) {
+		const aiMaterial* mat = scene->mMaterials[m];
+		for (unsigned int type = aiTextureType_DIFFUSE; type <= aiTextureType_UNKNOWN; ++type) {
+			const unsigned int count = mat->GetTextureCount(static_cast<aiTextureType>(type));
+			for (unsigned int i = 0; i < count; ++i) {
+				aiString ref;
+				if (mat->GetTexture(static_cast<aiTextureType>(type),i,&ref) != AI_SUCCESS || ref.data[0] == '*') {
+					continue;
+				}
+				std::string path;
+				if (ResolveTexture(modelDir,ref.C_Str(),path)) {
+					out.insert(path);
+				}
+				else {
+					printf("  %s: texture %s not found\n",modelPath.c_str(),ref.C_Str());
+				}
+			}
+		}
+	}
+}
+
+} // ! namespace
+
+// -----------------------------------------------------------------------------------
+int Assimp_Bake (const char* const* params, unsigned int num)
+{
+	if (num < 1) {
+		printf("assimp bake: Invalid number of arguments. "
+			"See \'assimp bake --help\'\n");
+		return 1;
+	}
+
+	// --help
+	if (!strcmp( params[0],"-h")||!strcmp( params[0],"--help")||!strcmp( params[0],"-?") ) {
+		printf("%s",AICMD_MSG_BAKE_HELP_E);
+		return 0;
+	}
+
+	BakeOptions opt;
+	opt.format = FORMAT_AUTO;
+	opt.kaiser = true;
+	opt.srgb = true;
+	opt.force = false;
+	opt.threads = std::max(1u,std::thread::hardware_concurrency());
+	std::vector<std::string> models;
+	for (unsigned int i = 0; i < num; ++i) {
+		if (!strncmp(params[i],"--format=",9) || !strncmp(params[i],"-f",2)) {
+			const std::string name = params[i] + (params[i][1] == '-' ? 9 : 2);
+			if (name == "bc1") {
+				opt.format = FORMAT_BC1;
+			}
+			else if (name == "bc3") {
+				opt.format = FORMAT_BC3;
+			}
+			else if (name == "bc7") {
+				opt.format = FORMAT_BC7;
+			}
+			else if (name != "auto") {
+				printf("assimp bake: Unknown format %s\n",name.c_str());
+				return 1;
+			}
+		}
+		else if (!strncmp(params[i],"--filter=",9)) {
+			const std::string name = params[i] + 9;
+			if (name != "box" && name != "kaiser") {
+				printf("assimp bake: Unknown filter %s\n",name.c_str());
+				return 1;
+			}
+			opt.kaiser = name == "kaiser";
+		}
+		else if (!strncmp(params[i],"--threads=",10) || !strncmp(params[i],"-j",2)) {
+			opt.threads = std::max(1,atoi(params[i] + (params[i][1] == '-' ? 10 : 2)));
+		}
+		else if (!strcmp(params[i],"--linear")) {
+			opt.srgb = false;
+		}
+		else if (!strcmp(params[i],"--force")) {
+			opt.force = true;
+		}
+		else if (params[i][0] != '-') {
+			models.push_back(params[i]);
+		}
+		else {
+			printf("assimp bake: warning, unknown option %s is ignored\n",params[i]);
+		}
+	}
+
+	// the materials are all that is needed, so no post processing
+	std::set<std::string> textures;
+	for (size_t i = 0; i < models.size(); ++i) {
+		const aiScene* scene = globalImporter->ReadFile(models[i],0);
+		if (!scene) {
+			printf("assimp bake: Unable to load %s: %s\n",models[i].c_str(),globalImporter->GetErrorString());
+			continue;
+		}
+		CollectTextures(scene,models[i],textures);
+		globalImporter->FreeScene();
+	}
+	if (textures.empty()) {
+		printf("assimp bake: No textures found\n");
+		return 2;
+	}
+
+	printf("Baking %u textures ...\n",static_cast<unsigned int>(textures.size()));
+	unsigned int counts[3] = { 0, 0, 0 };
+	for (std::set<std::string>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+		++counts[BakeTexture(*it,opt)];
+	}
+	printf("assimp bake: %u converted, %u skipped, %u failed\n",counts[BAKE_DONE],counts[BAKE_SKIPPED],counts[BAKE_FAILED]);
+	return counts[BAKE_FAILED] ? 3 : 0;
+}
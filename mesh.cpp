@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include "MeshImport.h"
 #include "util.h"
 #include "StringComparison.h"
 #include "D3DCompiler.h"
@@ -7,9 +8,6 @@
 #define TEX_COORD_LOCATION   1
 #define NORMAL_LOCATION      2
 
-extern int FindValidPath(aiString* p_szString);
-extern bool TryLongerPath(char* szTemp, aiString* p_szString);
-
 const D3D11_INPUT_ELEMENT_DESC PosTex[2] =
 {
 	{ "POSITION",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -21,9 +19,10 @@ Mesh::MeshTexture::MeshTexture(const std::string& FileName)
 {
 	//	m_textureTarget = TextureTarget;
 	m_fileName = FileName;
+	m_Handle = NULL;
 }
 
-bool Mesh::MeshTexture::Load(ID3D11Device* device, aiScene* pScene, aiMaterial* material)
+bool Mesh::MeshTexture::Load(aiScene* pScene, aiMaterial* material, const std::string& ModelFile, TexturePathResolver& Resolver, TextureCache& Cache)
 {
 	ID3D11Texture2D *pTexture = NULL;
 	// first get a valid path to the texture
@@ -32,8 +31,9 @@ bool Mesh::MeshTexture::Load(ID3D11Device* device, aiScene* pScene, aiMaterial*
 	// DIFFUSE TEXTURE ------------------------------------------------
 	if (AI_SUCCESS == aiGetMaterialString(pcMat, AI_MATKEY_TEXTURE_DIFFUSE(0), &szPath))
 	{
-		if (5 == FindValidPath(&szPath))
+		if ('*' == szPath.data[0])
 		{
+			// '*' as first character indicates an embedded file
 			std::string sz = "[ERROR] Unable to load embedded texture (#1): ";
 			sz.append(szPath.data);
 			MessageBoxA(NULL, sz.c_str(), "EE", MB_OK);
@@ -41,60 +41,69 @@ bool Mesh::MeshTexture::Load(ID3D11Device* device, aiScene* pScene, aiMaterial*
 		}
 		else
 		{
-			HR(D3DX11CreateShaderResourceViewFromFileA(device,szPath.C_Str(), 0, 0, &mDiffuseMapSRV, 0));
+			// the cache reports the reference itself if nothing on disk matches
+			std::string Path = szPath.C_Str();
+			Resolver.Resolve(ModelFile, szPath.C_Str(), Path);
+			m_Handle = Cache.Acquire(Path);
 		}
 	}
 	return true;
 }
-void Mesh::MeshEntry::Init(ID3D11Device* device)
-{
-	mVertexStride = sizeof(MeshVertex);
-	D3D11_BUFFER_DESC vbd;
-	vbd.Usage = D3D11_USAGE_IMMUTABLE;
-	vbd.ByteWidth = sizeof(MeshVertex) * m_Vertex.size();
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = 0;
-	vbd.MiscFlags = 0;
-	vbd.StructureByteStride = 0;
-	D3D11_SUBRESOURCE_DATA vinitData;
-	vinitData.pSysMem = &m_Vertex[0];// &indices[0]
-	HR(device->CreateBuffer(&vbd, &vinitData, &mVB));
-	//ReleaseCOM(mIB);
-	D3D11_BUFFER_DESC ibd;
-	ibd.Usage = D3D11_USAGE_IMMUTABLE;
-	ibd.ByteWidth = sizeof(UINT) * m_Indices.size();
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.CPUAccessFlags = 0;
-	ibd.MiscFlags = 0;
-	ibd.StructureByteStride = 0;
-	D3D11_SUBRESOURCE_DATA iinitData;
-	iinitData.pSysMem = &m_Indices[0];//.data();
-	HR(device->CreateBuffer(&ibd, &iinitData, &mIB));
-}
 Mesh::Mesh()
 {
 //	worldviewproj = XMMatrixIdentity();
 	m_pScene = NULL;
+	m_pOwnedScene = NULL;
+	m_TextureResolver = NULL;
+	m_TextureCache = NULL;
+	m_pOwnedTextureCache = NULL;
+	mVB = NULL;
+	mIB = NULL;
 }
 Mesh::~Mesh()
 {
 	Clear();
+	SAFE_DELETE(m_pOwnedTextureCache);
+}
+
+TextureCache& Mesh::GetTextureCache()
+{
+	if (m_TextureCache)
+	{
+		return *m_TextureCache;
+	}
+	if (!m_pOwnedTextureCache)
+	{
+		m_pOwnedTextureCache = new TextureCache(new D3D11TextureBackend(device));
+	}
+	return *m_pOwnedTextureCache;
 }
 void Mesh::Clear()
 {
+	// the worker writes into m_Entries, let it wind down first
+	CancelLoadMesh();
 	for (int i = 0; i < m_Textures.size(); i++)
 	{
+		if (m_Textures[i])
+		{
+			GetTextureCache().Release(m_Textures[i]->m_Handle);
+		}
 		SAFE_DELETE(m_Textures[i]);
 	}
+	ReleaseCOM(mIB);
+	ReleaseCOM(mVB);
+	m_Pool.Reset(0);
 	for (int i = 0; i < m_Entries.size(); i++)
 	{
-		ReleaseCOM(m_Entries[i].mIB);
-		ReleaseCOM(m_Entries[i].mVB);
 		m_Entries[i].m_Vertex.clear();
 		m_Entries[i].m_Indices.clear();
 	}
+	if (m_pOwnedScene)
+	{
+		m_pScene = NULL;
+		SAFE_DELETE(m_pOwnedScene);
+	}
 }
-char g_szFileName_mesh[MAX_PATH];
 
 bool Mesh::Init(ID3D11Device * d3d11device)
 {
@@ -156,12 +165,11 @@ bool Mesh::Init(ID3D11Device * d3d11device)
 
 bool Mesh::LoadMesh(const std::string& Filename)
 {
-	strcpy(g_szFileName_mesh, Filename.c_str());
 	// Release the previously loaded mesh (if it exists)
 	Clear();
 	bool Ret = false;
-#define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices)
-	m_pScene = m_Importer.ReadFile(Filename.c_str(), ASSIMP_LOAD_FLAGS);
+#define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality)
+	m_pScene = SetupCacheOptimizer(m_Importer).ReadFile(Filename.c_str(), ASSIMP_LOAD_FLAGS);
 	if (m_pScene)
 	{
 		Ret = InitMeshFromScene(m_pScene, Filename);
@@ -174,6 +182,53 @@ bool Mesh::LoadMesh(const std::string& Filename)
 	return Ret;
 }
 
+bool Mesh::LoadMeshAsync(Assimp::AsyncImporter& Importer, const std::string& Filename)
+{
+	// Release the previously loaded mesh (if it exists)
+	Clear();
+	m_pScene = NULL;
+	m_PendingFileName = Filename;
+	m_PendingImport = Importer.ReadFile(Filename, ASSIMP_LOAD_FLAGS, &SetupCacheOptimizer(*new Assimp::Importer()), NULL,
+		[this](const aiScene* pScene)
+	{
+		PrepareMesh(pScene);
+		return true;
+	});
+	return m_PendingImport.IsValid();
+}
+
+bool Mesh::FinishLoadMesh()
+{
+	if (!m_PendingImport.IsValid())
+	{
+		return IsLoaded();
+	}
+	if (!m_PendingImport.IsReady())
+	{
+		return false;
+	}
+	m_pOwnedScene = m_PendingImport.GetScene();
+	if (!m_pOwnedScene)
+	{
+		printf("Error parsing '%s':'%s'\n", m_PendingFileName.c_str(), m_PendingImport.GetErrorString());
+		m_PendingImport = Assimp::AsyncImport();
+		return false;
+	}
+	m_PendingImport = Assimp::AsyncImport();
+	m_pScene = m_pOwnedScene;
+	return CreateDeviceResources(m_pScene, m_PendingFileName);
+}
+
+void Mesh::CancelLoadMesh()
+{
+	if (m_PendingImport.IsValid())
+	{
+		m_PendingImport.Cancel();
+		m_PendingImport.Wait();
+		m_PendingImport = Assimp::AsyncImport();
+	}
+}
+
 bool Mesh::Update(float dt, const XMMATRIX& worldViewProj)
 {
 //	worldviewproj = worldViewProj;
@@ -181,6 +236,12 @@ bool Mesh::Update(float dt, const XMMATRIX& worldViewProj)
 }
 
 bool Mesh::InitMeshFromScene(const aiScene* pScene, const std::string& Filename)
+{
+	PrepareMesh(pScene);
+	return CreateDeviceResources(pScene, Filename);
+}
+
+void Mesh::PrepareMesh(const aiScene* pScene)
 {
 	m_Entries.resize(pScene->mNumMeshes);
 	m_Textures.resize(pScene->mNumMaterials);
@@ -190,6 +251,26 @@ bool Mesh::InitMeshFromScene(const aiScene* pScene, const std::string& Filename)
 		const aiMesh* paiMesh = pScene->mMeshes[i];
 		InitMesh(i, paiMesh);
 	}
+	m_Pool.Reset(sizeof(MeshVertex));
+	for (int i = 0; i < m_Entries.size(); i++)
+	{
+		MeshEntry& Entry = m_Entries[i];
+		const GeometryPool::Range& Range = m_Pool.GetRange(m_Pool.Add(Entry.m_Vertex.empty() ? NULL : &Entry.m_Vertex[0], Entry.m_Vertex.size(),
+			Entry.m_Indices.empty() ? NULL : &Entry.m_Indices[0], Entry.m_Indices.size()));
+		Entry.mIndexBufferFormat = Range.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		Entry.BaseVertex = Range.BaseVertex;
+		Entry.StartIndex = Range.StartIndex;
+		Entry.NumIndices = Range.NumIndices;
+	}
+}
+
+bool Mesh::CreateDeviceResources(const aiScene* pScene, const std::string& Filename)
+{
+	if (!m_Pool.GetVertexData().empty() && !m_Pool.GetIndexData().empty())
+	{
+		CreatePoolBuffers(device, m_Pool, &mVB, &mIB);
+	}
+	m_Pool.ReleaseData();
 	if (!InitMaterials(pScene, Filename))
 	{
 		return false;
@@ -219,7 +300,6 @@ void Mesh::InitMesh(unsigned int MeshIndex, const aiMesh* paiMesh)
 		m_Entries[MeshIndex].m_Indices.push_back(Face.mIndices[1]);
 		m_Entries[MeshIndex].m_Indices.push_back(Face.mIndices[2]);
 	}
-	m_Entries[MeshIndex].Init(device);
 }
 
 bool Mesh::InitMaterials(const aiScene* pScene, const std::string& Filename)
@@ -253,7 +333,7 @@ bool Mesh::InitMaterials(const aiScene* pScene, const std::string& Filename)
 			{
 				std::string FullPath = /*Dir + "/" +*/ Path.data;
 				m_Textures[i] = new MeshTexture(FullPath.c_str());
-				if (!m_Textures[i]->Load(device, (aiScene*)pScene, (aiMaterial*)pMaterial))
+				if (!m_Textures[i]->Load((aiScene*)pScene, (aiMaterial*)pMaterial, Filename, m_TextureResolver ? *m_TextureResolver : DefaultTexturePathResolver(), GetTextureCache()))
 				{
 					MessageBoxA(NULL, "Error loading texture", FullPath.c_str(), MB_OK);
 					//printf("Error loading texture '%s'\n", Filename.c_str());
@@ -301,12 +381,14 @@ void Mesh::Render(ID3D11DeviceContext*& md3dImmediateContext)
 			XMMATRIX worldViewProj = world*viewProj;
 			m_StaticMesh_fxWorldViewProj->SetMatrix(reinterpret_cast<float*>(&worldViewProj));
 			StaticMesh_DiffuseMap = mStaticMeshFX->GetVariableByName("gDiffuseMap")->AsShaderResource();
-			ID3D11ShaderResourceView* tex = m_Textures[m_Entries[i].MaterialIndex]->mDiffuseMapSRV;
+			const MeshTexture* pTexture = m_Textures[m_Entries[i].MaterialIndex];
+			// NULL until the cache's worker has created it
+			ID3D11ShaderResourceView* tex = pTexture ? (ID3D11ShaderResourceView*)GetTextureCache().GetResource(pTexture->m_Handle) : NULL;
 			StaticMesh_DiffuseMap->SetResource(tex);
-			md3dImmediateContext->IASetVertexBuffers(0, 1, &m_Entries[i].mVB, &stride, &offset);
-			md3dImmediateContext->IASetIndexBuffer(m_Entries[i].mIB, DXGI_FORMAT_R32_UINT, 0);
+			md3dImmediateContext->IASetVertexBuffers(0, 1, &mVB, &stride, &offset);
+			md3dImmediateContext->IASetIndexBuffer(mIB, m_Entries[i].mIndexBufferFormat, 0);
 			mStaticMeshTech->GetPassByIndex(p)->Apply(0, md3dImmediateContext);
-			md3dImmediateContext->DrawIndexed(m_Entries[i].m_Indices.size(), 0, 0);
+			md3dImmediateContext->DrawIndexed(m_Entries[i].NumIndices, m_Entries[i].StartIndex, m_Entries[i].BaseVertex);
 		}
 	}
 	md3dImmediateContext->RSSetState(0);
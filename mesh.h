@@ -8,6 +8,7 @@
 
 #include <assimp/cimport.h>
 #include <assimp/Importer.hpp>
+#include <assimp/AsyncImporter.hpp>
 #include <assimp/ai_assert.h>
 #include <assimp/cfileio.h>
 #include <assimp/postprocess.h>
@@ -19,6 +20,9 @@
 #include "util.h"
 #include "OgreMath.h"
 #include "ogldev_math_3d.h"
+#include "GeometryPool.h"
+#include "TexturePathResolver.h"
+#include "TextureCache.h"
 #include <d3dx11.h>
 #include "d3dx11Effect.h"
 #include <xnamath.h>
@@ -62,14 +66,17 @@ public:
 	{
 		MeshEntry()
 		{
+			mIndexBufferFormat = DXGI_FORMAT_R32_UINT;
+			mVertexStride = sizeof(MeshVertex);
+			BaseVertex = 0;
+			StartIndex = 0;
 			NumIndices = 0;
 			MaterialIndex = INVALID_MATERIAL;
 		}
-		void Init(ID3D11Device* device);
-		ID3D11Buffer* mVB;
-		ID3D11Buffer* mIB;
-		DXGI_FORMAT mIndexBufferFormat; // Always 16-bit
+		DXGI_FORMAT mIndexBufferFormat; // 16-bit unless the entry has more than 65536 vertices
 		UINT mVertexStride;
+		UINT BaseVertex; // offsets of the entry in mVB / mIB
+		UINT StartIndex;
 		std::vector<MeshVertex> m_Vertex;
 		std::vector<unsigned int> m_Indices;
 		unsigned int NumIndices;
@@ -79,22 +86,51 @@ public:
 	{
 		MeshTexture() {};
 		MeshTexture(const std::string& FileName);
-		bool Load(ID3D11Device* device, aiScene* pScene, aiMaterial* material);
+		bool Load(aiScene* pScene, aiMaterial* material, const std::string& ModelFile, TexturePathResolver& Resolver, TextureCache& Cache);
 		std::string m_fileName;
-		ID3D11ShaderResourceView* mDiffuseMapSRV;
+		TextureCache::Handle m_Handle; // NULL for embedded textures
 	};
 	ID3D11Device* device;
 	Mesh();
 	~Mesh();
 	bool Init(ID3D11Device* d3d11device);
+	// Texture references of the next loads are looked up through Resolver, which must outlive
+	// the mesh. NULL uses DefaultTexturePathResolver().
+	void SetTextureResolver(TexturePathResolver* Resolver)
+	{
+		m_TextureResolver = Resolver;
+	}
+	// Shares the textures with the other meshes using Cache, which must outlive the mesh.
+	// Call before the first load. NULL gives the mesh a cache of its own.
+	void SetTextureCache(TextureCache* Cache)
+	{
+		m_TextureCache = Cache;
+	}
+	TextureCache& GetTextureCache();
 	bool LoadMesh(const std::string& Filename);
+	// Starts loading on a worker of Importer, vertices are prepared there as well.
+	bool LoadMeshAsync(Assimp::AsyncImporter& Importer, const std::string& Filename);
+	// Call once per frame from the render thread, creates the D3D resources once the import is done.
+	// Returns true if the mesh is ready to be rendered.
+	bool FinishLoadMesh();
+	void CancelLoadMesh();
+	bool IsLoaded() const
+	{
+		return m_pScene != NULL;
+	}
 	bool Update(float dt, const XMMATRIX& worldViewProj);
 	void Render(ID3D11DeviceContext*& md3dImmediateContext);
 	bool InitMeshFromScene(const aiScene* pScene, const std::string& Filename);
+	void PrepareMesh(const aiScene* pScene);
+	bool CreateDeviceResources(const aiScene* pScene, const std::string& Filename);
 	void InitMesh(unsigned int MeshIndex,	const aiMesh* paiMesh);
 	bool InitMaterials(const aiScene* pScene, const std::string& Filename);
 	void Clear();
 	std::vector<MeshEntry> m_Entries;
+	// all entries live in one vertex and one index buffer
+	GeometryPool m_Pool;
+	ID3D11Buffer* mVB;
+	ID3D11Buffer* mIB;
 	std::vector<MeshTexture*> m_Textures;
 	D3D_PRIMITIVE_TOPOLOGY primitive_type;
 	ID3D11RasterizerState* WireframeRS;
@@ -107,6 +143,12 @@ public:
 	Camera* m_Camera;
 	const aiScene* m_pScene;
 	Assimp::Importer m_Importer;
+	Assimp::AsyncImport m_PendingImport;
+	std::string m_PendingFileName;
+	aiScene* m_pOwnedScene; // scene handed over by an async import
+	TexturePathResolver* m_TextureResolver;
+	TextureCache* m_TextureCache;
+	TextureCache* m_pOwnedTextureCache;
 };
 #endif	
 
@@ -1,4 +1,5 @@
 #include "skinnedmesh.h"
+#include "MeshImport.h"
 #include "util.h"
 #include "StringComparison.h"
 #include "D3DCompiler.h"
@@ -9,8 +10,6 @@
 #define NORMAL_LOCATION      2
 #define BONE_ID_LOCATION     3
 #define BONE_WEIGHT_LOCATION 4
-int FindValidPath(aiString* p_szString);
-bool TryLongerPath(char* szTemp, aiString* p_szString);
 
 const D3D11_INPUT_ELEMENT_DESC PosTexSkinned[4] =
 {
@@ -21,28 +20,41 @@ const D3D11_INPUT_ELEMENT_DESC PosTexSkinned[4] =
 	{ "BONEINDICES",  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 36, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 };
 
-void VertexBoneData::AddBoneData(float BoneID, float Weight)
+// influences 5 to 8 come from a second stream of VertexBoneData
+const D3D11_INPUT_ELEMENT_DESC PosTexSkinned8[6] =
 {
-	for (int i = 0; i < ARRAY_SIZE_IN_ELEMENTS(IDs); i++)
+	{ "POSITION",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD",     0, DXGI_FORMAT_R32G32_FLOAT,    0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "WEIGHTS",      0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "BONEINDICES",  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 36, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "WEIGHTS",      1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "BONEINDICES",  1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+};
+
+// the optional NORMAL element isn't read by ColorTechPacked, the input
+// assembler ignores elements the shader doesn't consume
+static unsigned int BuildPackedInputDesc(const PackedVertexLayout& Layout, D3D11_INPUT_ELEMENT_DESC Desc[5])
+{
+	const D3D11_INPUT_ELEMENT_DESC Elements[5] =
 	{
-		if (Weights[i] == 0.0)
-		{
-			IDs[i] = BoneID;
-			Weights[i] = Weight;
-			return;
-		}
-	}
-	// should never get here - more bones than we have space for
-	assert(0);
+		{ "POSITION",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD",     0, DXGI_FORMAT_R16G16_FLOAT, 0, Layout.m_TexOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "WEIGHTS",      0, Layout.m_Weights16 ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM, 0, Layout.m_WeightOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "BONEINDICES",  0, DXGI_FORMAT_R8G8B8A8_UINT, 0, Layout.m_BoneOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",       0, DXGI_FORMAT_R16G16_SNORM, 0, Layout.m_NormalOffset, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+	std::copy(Elements, Elements + 5, Desc);
+	return Layout.m_Normal ? 5 : 4;
 }
 
 SkinnedMesh::Texture::Texture(const std::string& FileName)
 {
 //	m_textureTarget = TextureTarget;
 	m_fileName = FileName;
+	m_Handle = NULL;
 }
 
-bool SkinnedMesh::Texture::Load(ID3D11Device* device, aiScene* pScene, aiMaterial* material)
+bool SkinnedMesh::Texture::Load(aiScene* pScene, aiMaterial* material, const std::string& ModelFile, TexturePathResolver& Resolver, TextureCache& Cache)
 {
 	ID3D11Texture2D *pTexture = NULL;
 	// first get a valid path to the texture
@@ -53,8 +65,9 @@ bool SkinnedMesh::Texture::Load(ID3D11Device* device, aiScene* pScene, aiMateria
 	//
 	if (AI_SUCCESS == aiGetMaterialString(pcMat, AI_MATKEY_TEXTURE_DIFFUSE(0), &szPath))
 	{
-		if (5 == FindValidPath(&szPath))
+		if ('*' == szPath.data[0])
 		{
+			// '*' as first character indicates an embedded file
 			std::string sz = "[ERROR] Unable to load embedded texture (#1): ";
 			sz.append(szPath.data);
 			MessageBoxA(NULL, sz.c_str(), "EE", MB_OK);
@@ -62,47 +75,73 @@ bool SkinnedMesh::Texture::Load(ID3D11Device* device, aiScene* pScene, aiMateria
 		}
 		else
 		{
-			HR(D3DX11CreateShaderResourceViewFromFileA(device,szPath.C_Str(), 0, 0, &mDiffuseMapSRV, 0));
+			// the cache reports the reference itself if nothing on disk matches
+			std::string Path = szPath.C_Str();
+			Resolver.Resolve(ModelFile, szPath.C_Str(), Path);
+			m_Handle = Cache.Acquire(Path);
 		}
 	}
 	return true;
 }
 
-void SkinnedMesh::SkinnedMeshEntry::Init(ID3D11Device* device)
-{
-	mVertexStride = sizeof(SkinnedVertex);
-	D3D11_BUFFER_DESC vbd;
-	vbd.Usage = D3D11_USAGE_IMMUTABLE;
-	vbd.ByteWidth = sizeof(SkinnedVertex) * m_Vertex.size();
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = 0;
-	vbd.MiscFlags = 0;
-	vbd.StructureByteStride = 0;
-	D3D11_SUBRESOURCE_DATA vinitData;
-	vinitData.pSysMem = &m_Vertex[0];// &indices[0]
-	HR(device->CreateBuffer(&vbd, &vinitData, &mVB));
-	D3D11_BUFFER_DESC ibd;
-	ibd.Usage = D3D11_USAGE_IMMUTABLE;
-	ibd.ByteWidth = sizeof(UINT) * m_Indices.size();
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.CPUAccessFlags = 0;
-	ibd.MiscFlags = 0;
-	ibd.StructureByteStride = 0;
-	D3D11_SUBRESOURCE_DATA iinitData;
-	iinitData.pSysMem = &m_Indices[0];//.data();
-	HR(device->CreateBuffer(&ibd, &iinitData, &mIB));
-}
-
 SkinnedMesh::SkinnedMesh()
 {
 	m_NumBones = 0;
 	m_pScene = NULL;
-	
+	m_pOwnedScene = NULL;
+	m_TextureResolver = NULL;
+	m_TextureCache = NULL;
+	m_pOwnedTextureCache = NULL;
+	m_VertexFormat = SKINNED_VERTEX_FLOAT;
+	mPackedTech = NULL;
+	mPackedInputLayout = NULL;
+	mVB = NULL;
+	mIB = NULL;
+	m_Packed = false;
+	mExtraVB = NULL;
+	m_ExtraInfluences = false;
+	m_MaxInfluences = NUM_BONES_PER_VEREX;
+	mTech8 = NULL;
+	mInputLayout8 = NULL;
+	mDualQuatTech = NULL;
+	mPackedDualQuatTech = NULL;
+	m_RigidSkeleton = false;
+	m_DualQuatSkinning = false;
 }
 
 SkinnedMesh::~SkinnedMesh()
 {
 	Clear();
+	SAFE_DELETE(m_pOwnedTextureCache);
+	ReleaseCOM(mPackedInputLayout);
+}
+
+TextureCache& SkinnedMesh::GetTextureCache()
+{
+	if (m_TextureCache)
+	{
+		return *m_TextureCache;
+	}
+	if (!m_pOwnedTextureCache)
+	{
+		m_pOwnedTextureCache = new TextureCache(new D3D11TextureBackend(device));
+	}
+	return *m_pOwnedTextureCache;
+}
+
+void SkinnedMesh::SetVertexFormat(SkinnedVertexFormat Format, const PackedVertexLayout& Layout)
+{
+	m_VertexFormat = Format;
+	if (Layout.m_Stride != m_PackedLayout.m_Stride || Layout.m_Weights16 != m_PackedLayout.m_Weights16)
+	{
+		ReleaseCOM(mPackedInputLayout);
+	}
+	m_PackedLayout = Layout;
+}
+
+void SkinnedMesh::SetMaxInfluences(unsigned int MaxInfluences)
+{
+	m_MaxInfluences = MaxInfluences > NUM_BONES_PER_VEREX ? BoneInfluenceBuilder::MAX_INFLUENCES : NUM_BONES_PER_VEREX;
 }
 
 bool SkinnedMesh::Init(ID3D11Device* d3d11device)
@@ -136,9 +175,14 @@ bool SkinnedMesh::Init(ID3D11Device* d3d11device)
 	// Done with compiled shader.
 	ReleaseCOM(compiledShader);
 	mTech = mFX->GetTechniqueByName("ColorTech");
+	mPackedTech = mFX->GetTechniqueByName("ColorTechPacked");
+	mTech8 = mFX->GetTechniqueByName("ColorTech8");
+	mDualQuatTech = mFX->GetTechniqueByName("ColorTechDualQuat");
+	mPackedDualQuatTech = mFX->GetTechniqueByName("ColorTechPackedDualQuat");
 	mfxWorldViewProj = mFX->GetVariableByName("gWorldViewProj")->AsMatrix();
 	DiffuseMap = mFX->GetVariableByName("gDiffuseMap")->AsShaderResource();
 	BoneTransforms = mFX->GetVariableByName("gBoneTransforms")->AsMatrix();
+	BoneDualQuats = mFX->GetVariableByName("gBoneDualQuats")->AsVector();
 	D3DX11_PASS_DESC passDesc;
 	mTech->GetPassByIndex(0)->GetDesc(&passDesc);
 	hr = device->CreateInputLayout(PosTexSkinned, 4, passDesc.pIAInputSignature, passDesc.IAInputSignatureSize, &mInputLayout);
@@ -146,6 +190,12 @@ bool SkinnedMesh::Init(ID3D11Device* d3d11device)
 	{
 		return false;
 	}
+	mTech8->GetPassByIndex(0)->GetDesc(&passDesc);
+	hr = device->CreateInputLayout(PosTexSkinned8, 6, passDesc.pIAInputSignature, passDesc.IAInputSignatureSize, &mInputLayout8);
+	if (FAILED(hr))
+	{
+		return false;
+	}
 	D3D11_RASTERIZER_DESC wireframeDesc;
 	ZeroMemory(&wireframeDesc, sizeof(D3D11_RASTERIZER_DESC));
 	wireframeDesc.FillMode = D3D11_FILL_SOLID;
@@ -171,32 +221,48 @@ bool SkinnedMesh::Update(float dt, const XMFLOAT4X4& world)
 std::vector<SkinnedMesh*>  SkinnedMesh::renderQueue;
 void SkinnedMesh::Clear()
 {
+	// the worker writes into m_Entries and the bone maps, let it wind down first
+	CancelLoadMesh();
 	for (int i = 0; i < m_Textures.size(); i++)
 	{
+		if (m_Textures[i])
+		{
+			GetTextureCache().Release(m_Textures[i]->m_Handle);
+		}
 		SAFE_DELETE(m_Textures[i]);
 	}
+	ReleaseCOM(mIB);
+	ReleaseCOM(mVB);
+	ReleaseCOM(mExtraVB);
+	m_Pool.Reset(0);
+	m_ExtraPool.Reset(0);
+	m_Packed = false;
+	m_ExtraInfluences = false;
 	for (int i = 0; i < m_Entries.size(); i++)
 	{
-		ReleaseCOM(m_Entries[i].mIB);
-		ReleaseCOM(m_Entries[i].mVB);
 		m_Entries[i].m_Vertex.clear();
+		m_Entries[i].m_Normals.clear();
+		m_Entries[i].m_Hitboxes = HitboxProxy();
+		m_Entries[i].m_PackedVertex.clear();
+		m_Entries[i].m_ExtraBones.clear();
 		m_Entries[i].m_Indices.clear();
 	}
+	if (m_pOwnedScene)
+	{
+		m_pScene = NULL;
+		SAFE_DELETE(m_pOwnedScene);
+	}
 }
 
-char g_szFileName[MAX_PATH];
 bool SkinnedMesh::LoadMesh(const std::string& Filename)
 {
-	strcpy(g_szFileName, Filename.c_str());
 	// Release the previously loaded mesh (if it exists)
 	Clear();
 	bool Ret = false;
-#define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices)
-		m_pScene = m_Importer.ReadFile(Filename.c_str(), ASSIMP_LOAD_FLAGS);
+#define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_SplitByBoneCount)
+	m_pScene = SetupCacheOptimizer(m_Importer, MAX_PALETTE_BONES).ReadFile(Filename.c_str(), ASSIMP_LOAD_FLAGS);
 	if (m_pScene)
 	{
-		m_GlobalInverseTransform = m_pScene->mRootNode->mTransformation;
-		m_GlobalInverseTransform.Inverse();
 		Ret = InitSkinnedMeshFromScene(m_pScene, Filename);
 	}
 	else
@@ -208,16 +274,147 @@ bool SkinnedMesh::LoadMesh(const std::string& Filename)
 	return Ret;
 }
 
+bool SkinnedMesh::LoadMeshAsync(Assimp::AsyncImporter& Importer, const std::string& Filename)
+{
+	// Release the previously loaded mesh (if it exists)
+	Clear();
+	m_pScene = NULL;
+	m_PendingFileName = Filename;
+	// bone maps and vertices only touch CPU memory, so build them on the worker as well
+	m_PendingImport = Importer.ReadFile(Filename, ASSIMP_LOAD_FLAGS, &SetupCacheOptimizer(*new Assimp::Importer(), MAX_PALETTE_BONES), NULL,
+		[this](const aiScene* pScene)
+	{
+		PrepareSkinnedMesh(pScene);
+		return true;
+	});
+	return m_PendingImport.IsValid();
+}
+
+bool SkinnedMesh::FinishLoadMesh()
+{
+	if (!m_PendingImport.IsValid())
+	{
+		return IsLoaded();
+	}
+	if (!m_PendingImport.IsReady())
+	{
+		return false;
+	}
+	m_pOwnedScene = m_PendingImport.GetScene();
+	if (!m_pOwnedScene)
+	{
+		printf("Error parsing '%s':'%s'\n", m_PendingFileName.c_str(), m_PendingImport.GetErrorString());
+		m_PendingImport = Assimp::AsyncImport();
+		return false;
+	}
+	m_PendingImport = Assimp::AsyncImport();
+	m_pScene = m_pOwnedScene;
+	return CreateDeviceResources(m_pScene, m_PendingFileName);
+}
+
+void SkinnedMesh::CancelLoadMesh()
+{
+	if (m_PendingImport.IsValid())
+	{
+		m_PendingImport.Cancel();
+		m_PendingImport.Wait();
+		m_PendingImport = Assimp::AsyncImport();
+	}
+}
+
 bool SkinnedMesh::InitSkinnedMeshFromScene(const aiScene* pScene, const std::string& Filename)
 {
+	PrepareSkinnedMesh(pScene);
+	return CreateDeviceResources(pScene, Filename);
+}
+void SkinnedMesh::PrepareSkinnedMesh(const aiScene* pScene)
+{
+	m_GlobalInverseTransform = pScene->mRootNode->mTransformation;
+	m_GlobalInverseTransform.Inverse();
 	m_Entries.resize(pScene->mNumMeshes);
 	m_Textures.resize(pScene->mNumMaterials);
+	m_InfluenceStats = BoneInfluenceStats();
 	// Initialize the meshes in the scene one by one
 	for (int i = 0; i < m_Entries.size(); i++)
 	{
 		const aiMesh* paiMesh = pScene->mMeshes[i];
 		InitSkinnedMesh(i, paiMesh);
 	}
+	m_RigidSkeleton = IsRigidSkeleton(pScene);
+	if (!m_RigidSkeleton)
+	{
+		printf("The skeleton scales, it keeps matrix skinning since dual quaternions can't scale\n");
+	}
+	if (m_InfluenceStats.NumTruncated)
+	{
+		printf("%u of %u vertices have more than %u bone influences (up to %u), dropped %.2f%% of their weight on average and %.2f%% at most\n",
+			m_InfluenceStats.NumTruncated, m_InfluenceStats.NumVertices, m_MaxInfluences, m_InfluenceStats.MaxInfluences,
+			100.0f * m_InfluenceStats.MeanDroppedWeight(), 100.0f * m_InfluenceStats.MaxDroppedWeight);
+	}
+	// the second stream is only worth it if a vertex actually has more than 4 influences
+	m_ExtraInfluences = m_MaxInfluences > NUM_BONES_PER_VEREX && m_InfluenceStats.MaxInfluences > NUM_BONES_PER_VEREX;
+	m_ExtraPool.Reset(sizeof(VertexBoneData));
+	for (int i = 0; i < m_Entries.size(); i++)
+	{
+		if (m_ExtraInfluences && !m_Entries[i].m_ExtraBones.empty())
+		{
+			m_ExtraPool.Add(&m_Entries[i].m_ExtraBones[0], m_Entries[i].m_ExtraBones.size(), NULL, 0);
+		}
+		else if (!m_ExtraInfluences)
+		{
+			std::vector<VertexBoneData>().swap(m_Entries[i].m_ExtraBones);
+		}
+	}
+	// the entries share one vertex buffer and thus the layout, a single mesh the
+	// packed layout can't represent keeps all of them float
+	m_Packed = m_VertexFormat == SKINNED_VERTEX_PACKED && !m_ExtraInfluences;
+	for (int i = 0; i < m_Entries.size() && m_Packed; i++)
+	{
+		m_Packed = PackSkinnedMesh(m_Entries[i], pScene->mMeshes[i]);
+	}
+	m_Pool.Reset(m_Packed ? m_PackedLayout.m_Stride : sizeof(SkinnedVertex));
+	unsigned int FloatBytes = 0;
+	for (int i = 0; i < m_Entries.size(); i++)
+	{
+		SkinnedMeshEntry& Entry = m_Entries[i];
+		const void* pVertices = NULL;
+		if (!Entry.m_Vertex.empty())
+		{
+			pVertices = m_Packed ? (const void*)&Entry.m_PackedVertex[0] : (const void*)&Entry.m_Vertex[0];
+		}
+		const GeometryPool::Range& Range = m_Pool.GetRange(m_Pool.Add(pVertices, Entry.m_Vertex.size(),
+			Entry.m_Indices.empty() ? NULL : &Entry.m_Indices[0], Entry.m_Indices.size()));
+		Entry.mVertexStride = m_Pool.GetVertexStride();
+		Entry.mIndexBufferFormat = Range.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		Entry.BaseVertex = Range.BaseVertex;
+		Entry.StartIndex = Range.StartIndex;
+		Entry.NumIndices = Range.NumIndices;
+		std::vector<unsigned char>().swap(Entry.m_PackedVertex);
+		FloatBytes += (sizeof(SkinnedVertex) + sizeof(UINT)) * Entry.m_Vertex.size();
+	}
+	printf("Skinned mesh memory: %u bytes (%u bytes with float vertices and 32-bit indices)\n",
+		(unsigned int)(m_Pool.GetVertexData().size() + m_Pool.GetIndexData().size()), FloatBytes);
+}
+bool SkinnedMesh::CreateDeviceResources(const aiScene* pScene, const std::string& Filename)
+{
+	if (m_Packed && !mPackedInputLayout)
+	{
+		D3D11_INPUT_ELEMENT_DESC Desc[5];
+		const unsigned int NumElements = BuildPackedInputDesc(m_PackedLayout, Desc);
+		D3DX11_PASS_DESC passDesc;
+		mPackedTech->GetPassByIndex(0)->GetDesc(&passDesc);
+		HR(device->CreateInputLayout(Desc, NumElements, passDesc.pIAInputSignature, passDesc.IAInputSignatureSize, &mPackedInputLayout));
+	}
+	if (!m_Pool.GetVertexData().empty() && !m_Pool.GetIndexData().empty())
+	{
+		CreatePoolBuffers(device, m_Pool, &mVB, &mIB);
+	}
+	if (m_ExtraInfluences && !m_ExtraPool.GetVertexData().empty())
+	{
+		CreatePoolBuffers(device, m_ExtraPool, &mExtraVB, NULL);
+	}
+	m_Pool.ReleaseData();
+	m_ExtraPool.ReleaseData();
 	if (!InitMaterials(pScene, Filename))
 	{
 		return false;
@@ -229,8 +426,10 @@ void SkinnedMesh::InitSkinnedMesh(unsigned int MeshIndex,const aiMesh* paiMesh)
 	m_Entries[MeshIndex].MaterialIndex = paiMesh->mMaterialIndex;
 	std::vector<VertexBoneData> Bones;
 	const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
-	Bones.resize(paiMesh->mNumVertices);
-	LoadBones(MeshIndex, paiMesh, Bones);
+	const aiVector3D Up(0.0f, 0.0f, 1.0f);
+	BoneInfluenceStats Stats;
+	LoadBones(MeshIndex, paiMesh, Bones, m_MaxInfluences > NUM_BONES_PER_VEREX ? &m_Entries[MeshIndex].m_ExtraBones : NULL, Stats);
+	m_InfluenceStats.Merge(Stats);
 	for (unsigned int i = 0; i < paiMesh->mNumVertices; i++)
 	{
 		const aiVector3D* pPos = &(paiMesh->mVertices[i]);
@@ -238,6 +437,12 @@ void SkinnedMesh::InitSkinnedMesh(unsigned int MeshIndex,const aiMesh* paiMesh)
 		const aiVector3D* pTexCoord = paiMesh->HasTextureCoords(0) ? &(paiMesh->mTextureCoords[0][i]) : &Zero3D;
 		SkinnedVertex v(Vector3f(pPos->x, pPos->y, pPos->z),Vector2f(pTexCoord->x, pTexCoord->y),VertexBoneData(Bones[i]));
 		m_Entries[MeshIndex].m_Vertex.push_back(v);
+		const aiVector3D* pNormal = paiMesh->HasNormals() ? &(paiMesh->mNormals[i]) : &Up;
+		m_Entries[MeshIndex].m_Normals.push_back(Vector3f(pNormal->x, pNormal->y, pNormal->z));
+	}
+	if (paiMesh->mNumVertices)
+	{
+		BuildHitboxProxy(&m_Entries[MeshIndex].m_Vertex[0], paiMesh->mNumVertices, m_Entries[MeshIndex].m_Hitboxes);
 	}
 	for (unsigned int i = 0; i < paiMesh->mNumFaces; i++)
 	{
@@ -247,10 +452,37 @@ void SkinnedMesh::InitSkinnedMesh(unsigned int MeshIndex,const aiMesh* paiMesh)
 		m_Entries[MeshIndex].m_Indices.push_back(Face.mIndices[1]);
 		m_Entries[MeshIndex].m_Indices.push_back(Face.mIndices[2]);
 	}
-	m_Entries[MeshIndex].Init(device);
 }
-void SkinnedMesh::LoadBones(unsigned int MeshIndex, const aiMesh* pMesh, std::vector<VertexBoneData>& Bones)
+bool SkinnedMesh::PackSkinnedMesh(SkinnedMeshEntry& Entry, const aiMesh* paiMesh)
+{
+	const unsigned int Stride = m_PackedLayout.m_Stride;
+	const aiVector3D Up(0.0f, 0.0f, 1.0f);
+	Entry.m_PackedVertex.resize(Stride * Entry.m_Vertex.size());
+	for (unsigned int i = 0; i < Entry.m_Vertex.size(); i++)
+	{
+		const aiVector3D* pNormal = paiMesh->HasNormals() ? &(paiMesh->mNormals[i]) : &Up;
+		const Vector3f Normal(pNormal->x, pNormal->y, pNormal->z);
+		unsigned char* pPacked = &Entry.m_PackedVertex[i * Stride];
+		PackSkinnedVertex(m_PackedLayout, Entry.m_Vertex[i], Normal, pPacked);
+		if (!CheckPackedVertex(m_PackedLayout, Entry.m_Vertex[i], Normal, pPacked))
+		{
+			printf("Mesh '%s' exceeds the tolerances of the packed vertex format, keeping floats\n", paiMesh->mName.C_Str());
+			std::vector<unsigned char>().swap(Entry.m_PackedVertex);
+			return false;
+		}
+	}
+	return true;
+}
+void SkinnedMesh::LoadBones(unsigned int MeshIndex, const aiMesh* pMesh, std::vector<VertexBoneData>& Bones, std::vector<VertexBoneData>* pExtraBones, BoneInfluenceStats& Stats)
 {
+	BoneInfluenceBuilder Builder(pMesh->mNumVertices, m_MaxInfluences);
+	// vertices index the entry's palette, which maps to the global bones
+	std::vector<unsigned int>& Palette = m_Entries[MeshIndex].m_Palette;
+	Palette.resize(pMesh->mNumBones);
+	if (pMesh->mNumBones > MAX_PALETTE_BONES)
+	{
+		printf("Mesh %u uses %u bones, only %u can be drawn\n", MeshIndex, pMesh->mNumBones, MAX_PALETTE_BONES);
+	}
 	for (unsigned int i = 0; i < pMesh->mNumBones; i++)
 	{
 		unsigned int BoneIndex = 0;
@@ -269,176 +501,10 @@ void SkinnedMesh::LoadBones(unsigned int MeshIndex, const aiMesh* pMesh, std::ve
 		{
 			BoneIndex = m_BoneMapping[BoneName];
 		}
-		for (int j = 0; j < pMesh->mBones[i]->mNumWeights; j++)
-		{
-			unsigned int VertexID =/* m_Entries[MeshIndex].BaseVertex +*/ pMesh->mBones[i]->mWeights[j].mVertexId;
-			float Weight = pMesh->mBones[i]->mWeights[j].mWeight;
-			Bones[VertexID].AddBoneData(BoneIndex, Weight);
-		}
-	}
-}
-bool TryLongerPath(char* szTemp, aiString* p_szString)
-{
-	char szTempB[MAX_PATH];
-	strcpy(szTempB, szTemp);
-	// go to the beginning of the file name
-	char* szFile = strrchr(szTempB, '\\');
-	if (!szFile)szFile = strrchr(szTempB, '/');
-	char* szFile2 = szTemp + (szFile - szTempB) + 1;
-	szFile++;
-	char* szExt = strrchr(szFile, '.');
-	if (!szExt)return false;
-	szExt++;
-	*szFile = 0;
-	strcat(szTempB, "*.*");
-	const unsigned int iSize = (const unsigned int)(szExt - 1 - szFile);
-	HANDLE          h;
-	WIN32_FIND_DATAA info;
-	// build a list of files
-	h = FindFirstFileA(szTempB, &info);
-	if (h != INVALID_HANDLE_VALUE)
-	{
-		do
-		{
-			if (!(strcmp(info.cFileName, ".") == 0 || strcmp(info.cFileName, "..") == 0))
-			{
-				char* szExtFound = strrchr(info.cFileName, '.');
-				if (szExtFound)
-				{
-					++szExtFound;
-					if (0 == Assimp::ASSIMP_stricmp(szExtFound, szExt))
-					{
-						const unsigned int iSizeFound = (const unsigned int)(
-							szExtFound - 1 - info.cFileName);
-
-						for (unsigned int i = 0; i < iSizeFound; ++i)
-							info.cFileName[i] = (CHAR)tolower(info.cFileName[i]);
-
-						if (0 == memcmp(info.cFileName, szFile2, min(iSizeFound, iSize)))
-						{
-							// we have it. Build the full path ...
-							char* sz = strrchr(szTempB, '*');
-							*(sz - 2) = 0x0;
-
-							strcat(szTempB, info.cFileName);
-
-							// copy the result string back to the aiString
-							const size_t iLen = strlen(szTempB);
-							size_t iLen2 = iLen + 1;
-							iLen2 = iLen2 > MAXLEN ? MAXLEN : iLen2;
-							memcpy(p_szString->data, szTempB, iLen2);
-							p_szString->length = iLen;
-							return true;
-						}
-					}
-					// check whether the 8.3 DOS name is matching
-					if (0 == Assimp::ASSIMP_stricmp(info.cAlternateFileName, p_szString->data))
-					{
-						strcat(szTempB, info.cAlternateFileName);
-						// copy the result string back to the aiString
-						const size_t iLen = strlen(szTempB);
-						size_t iLen2 = iLen + 1;
-						iLen2 = iLen2 > MAXLEN ? MAXLEN : iLen2;
-						memcpy(p_szString->data, szTempB, iLen2);
-						p_szString->length = iLen;
-						return true;
-					}
-				}
-			}
-		} while (FindNextFileA(h, &info));
-
-		FindClose(h);
+		Palette[i] = BoneIndex;
+		Builder.AddBone(i, pMesh->mBones[i]->mWeights, pMesh->mBones[i]->mNumWeights);
 	}
-	return false;
-}
-int FindValidPath(aiString* p_szString)
-{
-	ai_assert(NULL != p_szString);
-	aiString pcpy = *p_szString;
-	if ('*' == p_szString->data[0])
-	{
-		// '*' as first character indicates an embedded file
-		return 5;
-	}
-	// first check whether we can directly load the file
-	FILE* pFile = fopen(p_szString->data, "rb");
-	if (pFile)fclose(pFile);
-	else
-	{
-		// check whether we can use the directory of  the asset as relative base
-		char szTemp[MAX_PATH * 2], tmp2[MAX_PATH * 2];
-		strcpy(szTemp, g_szFileName);
-		strcpy(tmp2, szTemp);
-		char* szData = p_szString->data;
-		if (*szData == '\\' || *szData == '/')++szData;
-		char* szEnd = strrchr(szTemp, '\\');
-		if (!szEnd)
-		{
-			szEnd = strrchr(szTemp, '/');
-			if (!szEnd)szEnd = szTemp;
-		}
-		szEnd++;
-		*szEnd = 0;
-		strcat(szEnd, szData);
-		pFile = fopen(szTemp, "rb");
-		if (!pFile)
-		{
-			// convert the string to lower case
-			for (unsigned int i = 0;; ++i)
-			{
-				if ('\0' == szTemp[i])break;
-				szTemp[i] = (char)tolower(szTemp[i]);
-			}
-			if (TryLongerPath(szTemp, p_szString))return 1;
-			*szEnd = 0;
-			// search common sub directories
-			strcat(szEnd, "tex\\");
-			strcat(szEnd, szData);
-			pFile = fopen(szTemp, "rb");
-			if (!pFile)
-			{
-				if (TryLongerPath(szTemp, p_szString))return 1;
-				*szEnd = 0;
-				strcat(szEnd, "textures\\");
-				strcat(szEnd, szData);
-				pFile = fopen(szTemp, "rb");
-				if (!pFile)
-				{
-					if (TryLongerPath(szTemp, p_szString))return 1;
-				}
-				// patch by mark sibly to look for textures files in the asset's base directory.
-				const char *path = pcpy.data;
-				const char *p = strrchr(path, '/');
-				if (!p) p = strrchr(path, '\\');
-				if (p) 
-				{
-					char *q = strrchr(tmp2, '/');
-					if (!q) q = strrchr(tmp2, '\\');
-					if (q) 
-					{
-						strcpy(q + 1, p + 1);
-						if ((pFile = fopen(tmp2, "r"))) 
-						{
-							fclose(pFile);
-							strcpy(p_szString->data, tmp2);
-							p_szString->length = strlen(tmp2);
-							return 1;
-						}
-					}
-				}
-				return 0;
-			}
-		}
-		fclose(pFile);
-
-		// copy the result string back to the aiString
-		const size_t iLen = strlen(szTemp);
-		size_t iLen2 = iLen + 1;
-		iLen2 = iLen2 > MAXLEN ? MAXLEN : iLen2;
-		memcpy(p_szString->data, szTemp, iLen2);
-		p_szString->length = iLen;
-	}
-	return 1;
+	Builder.Build(Bones, pExtraBones, Stats);
 }
 bool SkinnedMesh::InitMaterials(const aiScene* pScene, const std::string& Filename)
 {
@@ -470,7 +536,7 @@ bool SkinnedMesh::InitMaterials(const aiScene* pScene, const std::string& Filena
 			{
 				std::string FullPath = Dir + "/" + Path.data;
 				m_Textures[i] = new Texture(FullPath.c_str());
-				if (!m_Textures[i]->Load(device, (aiScene*)pScene, (aiMaterial*)pMaterial))
+				if (!m_Textures[i]->Load((aiScene*)pScene, (aiMaterial*)pMaterial, Filename, m_TextureResolver ? *m_TextureResolver : DefaultTexturePathResolver(), GetTextureCache()))
 				{
 					MessageBoxA(NULL,"Error loading texture", FullPath.c_str(),MB_OK);
 					//printf("Error loading texture '%s'\n", Filename.c_str());
@@ -501,16 +567,39 @@ void SkinnedMesh::Render(ID3D11DeviceContext*& md3dImmediateContext)
 	md3dImmediateContext->IASetPrimitiveTopology(primitive_type);
 	//md3dImmediateContext->RSSetState(WireframeRS);
 	//ﶯ
-	md3dImmediateContext->IASetInputLayout(mInputLayout);
 	D3DX11_TECHNIQUE_DESC techDesc;
-	BoneTransforms->SetMatrixArray(reinterpret_cast<const float*>(&Transforms[0]), 0, Transforms.size());
+	// the 8 influence technique only takes matrices
+	const bool DualQuats = m_DualQuatSkinning && m_RigidSkeleton && !m_ExtraInfluences && DualQuatTransforms.size() == m_NumBones;
+	ID3DX11EffectTechnique* Tech = m_Packed ? (DualQuats ? mPackedDualQuatTech : mPackedTech) :
+		(m_ExtraInfluences ? mTech8 : (DualQuats ? mDualQuatTech : mTech));
+	md3dImmediateContext->IASetInputLayout(m_Packed ? mPackedInputLayout : (m_ExtraInfluences ? mInputLayout8 : mInputLayout));
 	for (int i = 0; i < m_Entries.size(); i++)
 	{
-		mTech->GetDesc(&techDesc);
+		// upload only the matrices of the bones this entry references
+		if (DualQuats)
+		{
+			GatherPalette(m_Entries[i], m_PaletteDualQuats);
+			const UINT NumPaletteBones = min((UINT)m_PaletteDualQuats.size(), (UINT)MAX_PALETTE_BONES);
+			if (NumPaletteBones)
+			{
+				BoneDualQuats->SetFloatVectorArray(m_PaletteDualQuats[0].Real, 0, 2 * NumPaletteBones);
+			}
+		}
+		else
+		{
+			GatherPalette(m_Entries[i], m_PaletteTransforms);
+			const UINT NumPaletteBones = min((UINT)m_PaletteTransforms.size(), (UINT)MAX_PALETTE_BONES);
+			if (NumPaletteBones)
+			{
+				BoneTransforms->SetMatrixArray(reinterpret_cast<const float*>(&m_PaletteTransforms[0]), 0, NumPaletteBones);
+			}
+		}
+		Tech->GetDesc(&techDesc);
 		for (UINT p = 0; p < techDesc.Passes; ++p)
 		{
-			UINT stride = sizeof(SkinnedVertex);
-			UINT offset = 0;
+			ID3D11Buffer* Buffers[2] = { mVB, mExtraVB };
+			UINT strides[2] = { m_Entries[i].mVertexStride, sizeof(VertexBoneData) };
+			UINT offsets[2] = { 0, 0 };
 			XMMATRIX world = XMMatrixIdentity();
 			XMMATRIX rotation = XMMatrixRotationX(-0);
 			XMMATRIX scale = XMMatrixScaling(0.24, 0.24, 0.24);
@@ -519,16 +608,142 @@ void SkinnedMesh::Render(ID3D11DeviceContext*& md3dImmediateContext)
 			XMMATRIX worldViewProj = world*viewProj;
 			mfxWorldViewProj->SetMatrix(reinterpret_cast<float*>(&worldViewProj));
 			DiffuseMap = mFX->GetVariableByName("gDiffuseMap")->AsShaderResource();
-			ID3D11ShaderResourceView* tex = m_Textures[m_Entries[i].MaterialIndex]->mDiffuseMapSRV;
+			const Texture* pTexture = m_Textures[m_Entries[i].MaterialIndex];
+			// NULL until the cache's worker has created it
+			ID3D11ShaderResourceView* tex = pTexture ? (ID3D11ShaderResourceView*)GetTextureCache().GetResource(pTexture->m_Handle) : NULL;
 			DiffuseMap->SetResource(tex);
-			md3dImmediateContext->IASetVertexBuffers(0, 1, &m_Entries[i].mVB, &stride, &offset);
-			md3dImmediateContext->IASetIndexBuffer(m_Entries[i].mIB, DXGI_FORMAT_R32_UINT, 0);
-			mTech->GetPassByIndex(p)->Apply(0, md3dImmediateContext);
-			md3dImmediateContext->DrawIndexed(m_Entries[i].m_Indices.size(), 0, 0);
+			md3dImmediateContext->IASetVertexBuffers(0, m_ExtraInfluences ? 2 : 1, Buffers, strides, offsets);
+			md3dImmediateContext->IASetIndexBuffer(mIB, m_Entries[i].mIndexBufferFormat, 0);
+			Tech->GetPassByIndex(p)->Apply(0, md3dImmediateContext);
+			md3dImmediateContext->DrawIndexed(m_Entries[i].NumIndices, m_Entries[i].StartIndex, m_Entries[i].BaseVertex);
 		}
 	}
 	md3dImmediateContext->RSSetState(0);
 }
+void SkinnedMesh::GatherPalette(const SkinnedMeshEntry& Entry, std::vector<Matrix4f>& Palette) const
+{
+	Palette.resize(Entry.m_Palette.size());
+	for (unsigned int b = 0; b < Entry.m_Palette.size(); b++)
+	{
+		Palette[b] = Transforms[Entry.m_Palette[b]];
+	}
+}
+void SkinnedMesh::GatherPalette(const SkinnedMeshEntry& Entry, std::vector<DualQuat>& Palette) const
+{
+	Palette.resize(Entry.m_Palette.size());
+	for (unsigned int b = 0; b < Entry.m_Palette.size(); b++)
+	{
+		Palette[b] = DualQuatTransforms[Entry.m_Palette[b]];
+	}
+}
+SkinningJob SkinnedMesh::MakeSkinningJob(const SkinnedMeshEntry& Entry, const std::vector<Matrix4f>& Palette) const
+{
+	SkinningJob Job;
+	Job.pVertices = Entry.m_Vertex.empty() ? NULL : &Entry.m_Vertex[0];
+	Job.pExtraBones = Entry.m_ExtraBones.empty() ? NULL : &Entry.m_ExtraBones[0];
+	Job.NumVertices = Entry.m_Vertex.size();
+	Job.pPalette = Palette.empty() ? NULL : &Palette[0];
+	Job.NumPalette = Palette.size();
+	return Job;
+}
+void SkinnedMesh::SkinEntry(unsigned int EntryIndex, std::vector<Vector3f>& Positions, std::vector<Vector3f>* pNormals)
+{
+	const SkinnedMeshEntry& Entry = m_Entries[EntryIndex];
+	std::vector<Matrix4f> Palette;
+	GatherPalette(Entry, Palette);
+	SkinningJob Job = MakeSkinningJob(Entry, Palette);
+	Positions.resize(Job.NumVertices);
+	if (pNormals)
+	{
+		pNormals->resize(Job.NumVertices);
+	}
+	if (!Job.NumVertices)
+	{
+		return;
+	}
+	Job.pOutPositions = &Positions[0];
+	if (pNormals)
+	{
+		Job.pNormals = &Entry.m_Normals[0];
+		Job.pOutNormals = &(*pNormals)[0];
+	}
+	m_CpuSkinner.Skin(Job);
+}
+void SkinnedMesh::SkinHitboxes(unsigned int EntryIndex, std::vector<Vector3f>& Corners)
+{
+	const SkinnedMeshEntry& Entry = m_Entries[EntryIndex];
+	std::vector<Matrix4f> Palette;
+	GatherPalette(Entry, Palette);
+	SkinningJob Job;
+	Job.NumVertices = Entry.m_Hitboxes.m_Vertex.size();
+	Corners.resize(Job.NumVertices);
+	if (!Job.NumVertices)
+	{
+		return;
+	}
+	Job.pVertices = &Entry.m_Hitboxes.m_Vertex[0];
+	Job.pPalette = Palette.empty() ? NULL : &Palette[0];
+	Job.NumPalette = Palette.size();
+	Job.pOutPositions = &Corners[0];
+	// a few dozen corners, threads would cost more than they save
+	SkinVerticesSIMD(Job, 0, Job.NumVertices);
+}
+void SkinnedMesh::BenchmarkCpuSkinning(unsigned int Iterations)
+{
+	const CpuSkinner SingleThread(1);
+	unsigned int NumVertices = 0;
+	double ReferenceSeconds = 0.0, SingleSeconds = 0.0, ThreadedSeconds = 0.0;
+	float MaxError = 0.0f, MaxDualQuatError = 0.0f;
+	const bool DualQuats = DualQuatTransforms.size() == m_NumBones;
+	for (int i = 0; i < m_Entries.size(); i++)
+	{
+		const SkinnedMeshEntry& Entry = m_Entries[i];
+		if (Entry.m_Vertex.empty())
+		{
+			continue;
+		}
+		std::vector<Matrix4f> Palette;
+		GatherPalette(Entry, Palette);
+		std::vector<Vector3f> Positions(Entry.m_Vertex.size()), Normals(Entry.m_Vertex.size());
+		SkinningJob Job = MakeSkinningJob(Entry, Palette);
+		Job.pNormals = &Entry.m_Normals[0];
+		Job.pOutPositions = &Positions[0];
+		Job.pOutNormals = &Normals[0];
+
+		MaxError = max(MaxError, CompareSkinningWithReference(m_CpuSkinner, Job));
+		if (DualQuats)
+		{
+			// same pose from both palettes, as long as BoneTransformDualQuat ran this frame
+			std::vector<DualQuat> DualQuatPalette;
+			GatherPalette(Entry, DualQuatPalette);
+			SkinningJob DualQuatJob = Job;
+			DualQuatJob.pDualQuats = DualQuatPalette.empty() ? NULL : &DualQuatPalette[0];
+			MaxDualQuatError = max(MaxDualQuatError, CompareRigidDualQuatWithMatrices(DualQuatJob));
+		}
+		const double Work = (double)Job.NumVertices * Iterations;
+		NumVertices += Job.NumVertices;
+		const clock_t Start = clock();
+		for (unsigned int n = 0; n < Iterations; n++)
+		{
+			SkinVerticesReference(Job, 0, Job.NumVertices);
+		}
+		ReferenceSeconds += (double)(clock() - Start) / CLOCKS_PER_SEC;
+		SingleSeconds += Work / max(BenchmarkSkinning(SingleThread, Job, Iterations), 1.0);
+		ThreadedSeconds += Work / max(BenchmarkSkinning(m_CpuSkinner, Job, Iterations), 1.0);
+	}
+	if (!NumVertices)
+	{
+		return;
+	}
+	const double Work = (double)NumVertices * Iterations * 1e-6;
+	printf("CPU skinning of %u vertices: scalar %.1f, SIMD %.1f, %u threads %.1f million vertices/s, largest deviation %g\n",
+		NumVertices, ReferenceSeconds > 0.0 ? Work / ReferenceSeconds : 0.0, Work / SingleSeconds, m_CpuSkinner.GetNumThreads(),
+		Work / ThreadedSeconds, MaxError);
+	if (DualQuats)
+	{
+		printf("Rigidly skinned with dual quaternions instead of matrices, largest deviation %g\n", MaxDualQuatError);
+	}
+}
 unsigned int SkinnedMesh::FindPosition(float AnimationTime, const aiNodeAnim* pNodeAnim)
 {
 	for (unsigned int i = 0; i < pNodeAnim->mNumPositionKeys - 1; i++)
@@ -623,6 +838,69 @@ void SkinnedMesh::CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime,
 	Out = Start + Factor * Delta;
 }
 static bool readaniminfo = false;
+void SkinnedMesh::ReadNodeHeirarchyDualQuat(float AnimationTime, const aiNode* pNode, const DualQuat& ParentTransform)
+{
+	std::string NodeName(pNode->mName.data);
+	const aiNodeAnim* pNodeAnim = FindNodeAnim(m_pScene->mAnimations[0], NodeName);
+	DualQuat NodeTransformation;
+	if (pNodeAnim)
+	{
+		// IsRigidSkeleton made sure the scaling keys are all one
+		aiQuaternion RotationQ;
+		CalcInterpolatedRotation(RotationQ, AnimationTime, pNodeAnim);
+		aiVector3D Translation;
+		CalcInterpolatedPosition(Translation, AnimationTime, pNodeAnim);
+		NodeTransformation = DualQuat(RotationQ, Translation);
+	}
+	else
+	{
+		DualQuatFromMatrix(Matrix4f(pNode->mTransformation), NodeTransformation);
+	}
+	const DualQuat GlobalTransformation = ParentTransform * NodeTransformation;
+	std::map<std::string, unsigned int>::const_iterator it = m_BoneMapping.find(NodeName);
+	if (it != m_BoneMapping.end())
+	{
+		BoneInfo& Bone = m_BoneInfo[it->second];
+		Bone.FinalDualQuat = m_GlobalInverseDualQuat * GlobalTransformation * Bone.BoneOffsetDualQuat;
+	}
+	for (unsigned int i = 0; i < pNode->mNumChildren; i++)
+	{
+		ReadNodeHeirarchyDualQuat(AnimationTime, pNode->mChildren[i], GlobalTransformation);
+	}
+}
+// Dual quaternions can't scale. The skeleton is combined from them directly if neither its
+// static transforms nor the scaling keys of its animations scale.
+bool SkinnedMesh::IsRigidSkeleton(const aiScene* pScene)
+{
+	bool Rigid = DualQuatFromMatrix(m_GlobalInverseTransform, m_GlobalInverseDualQuat);
+	for (unsigned int i = 0; i < m_BoneInfo.size(); i++)
+	{
+		Rigid = DualQuatFromMatrix(m_BoneInfo[i].BoneOffset, m_BoneInfo[i].BoneOffsetDualQuat) && Rigid;
+	}
+	std::vector<const aiNode*> Nodes(1, pScene->mRootNode);
+	while (Rigid && !Nodes.empty())
+	{
+		const aiNode* pNode = Nodes.back();
+		Nodes.pop_back();
+		DualQuat NodeTransformation;
+		Rigid = DualQuatFromMatrix(Matrix4f(pNode->mTransformation), NodeTransformation);
+		Nodes.insert(Nodes.end(), pNode->mChildren, pNode->mChildren + pNode->mNumChildren);
+	}
+	for (unsigned int a = 0; Rigid && a < pScene->mNumAnimations; a++)
+	{
+		const aiAnimation* pAnimation = pScene->mAnimations[a];
+		for (unsigned int c = 0; Rigid && c < pAnimation->mNumChannels; c++)
+		{
+			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[c];
+			for (unsigned int k = 0; Rigid && k < pNodeAnim->mNumScalingKeys; k++)
+			{
+				const aiVector3D& Scaling = pNodeAnim->mScalingKeys[k].mValue;
+				Rigid = fabs(Scaling.x - 1.0f) <= 1e-3f && fabs(Scaling.y - 1.0f) <= 1e-3f && fabs(Scaling.z - 1.0f) <= 1e-3f;
+			}
+		}
+	}
+	return Rigid;
+}
 void SkinnedMesh::ReadNodeHeirarchy(float AnimationTime, const aiNode* pNode, const Matrix4f& ParentTransform)
 {
 	std::string NodeName(pNode->mName.data);
@@ -715,10 +993,8 @@ bool SkinnedMesh::WriteAnimInfo(const char * filename, const aiNodeAnim* animinf
 	fclose(file);
 	return false;
 }
-void SkinnedMesh::BoneTransform(float TimeInSeconds, std::vector<Matrix4f>& Transforms)
+float SkinnedMesh::GetAnimationTime(float TimeInSeconds)
 {
-	Matrix4f Identity;
-	Identity.InitIdentity();
 	float TicksPerSecond = (float)(m_pScene->mAnimations[0]->mTicksPerSecond != 0 ? m_pScene->mAnimations[0]->mTicksPerSecond : 25.0f);
 	float TimeInTicks = TimeInSeconds * TicksPerSecond;
 	float start_frame = m_AnimationMaps[m_CurrentAction].StartIndex;
@@ -730,7 +1006,13 @@ void SkinnedMesh::BoneTransform(float TimeInSeconds, std::vector<Matrix4f>& Tran
 	float AnimationTime = fmod(TimeInTicks, Animation_duration);
 	AnimationTime = AnimationTime + Animation_start_point;
 	//float AnimationTime = fmod(TimeInTicks, /*float(m_pScene->mAnimations[0]->mDuration)*/10);
-	ReadNodeHeirarchy(AnimationTime, m_pScene->mRootNode, Identity);
+	return AnimationTime;
+}
+void SkinnedMesh::BoneTransform(float TimeInSeconds, std::vector<Matrix4f>& Transforms)
+{
+	Matrix4f Identity;
+	Identity.InitIdentity();
+	ReadNodeHeirarchy(GetAnimationTime(TimeInSeconds), m_pScene->mRootNode, Identity);
 	readaniminfo = true;
 	Transforms.resize(m_NumBones);
 	for (int i = 0; i < m_NumBones; i++)
@@ -738,6 +1020,21 @@ void SkinnedMesh::BoneTransform(float TimeInSeconds, std::vector<Matrix4f>& Tran
 		Transforms[i] =  m_BoneInfo[i].FinalTransformation;
 	}
 }
+void SkinnedMesh::BoneTransformDualQuat(float TimeInSeconds, std::vector<DualQuat>& Transforms)
+{
+	if (!m_RigidSkeleton)
+	{
+		// converting the final matrices would drop their scale, Render uses them instead
+		Transforms.clear();
+		return;
+	}
+	ReadNodeHeirarchyDualQuat(GetAnimationTime(TimeInSeconds), m_pScene->mRootNode, DualQuat());
+	Transforms.resize(m_NumBones);
+	for (int i = 0; i < m_NumBones; i++)
+	{
+		Transforms[i] = m_BoneInfo[i].FinalDualQuat;
+	}
+}
 const aiNodeAnim* SkinnedMesh::FindNodeAnim(const aiAnimation* pAnimation, const std::string NodeName)
 {
 	char title[100];
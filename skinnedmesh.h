@@ -8,6 +8,7 @@
 
 #include <assimp/cimport.h>
 #include <assimp/Importer.hpp>
+#include <assimp/AsyncImporter.hpp>
 #include <assimp/ai_assert.h>
 #include <assimp/cfileio.h>
 #include <assimp/postprocess.h>
@@ -18,6 +19,12 @@
 #include <assimp/DefaultLogger.hpp>
 #include "util.h"
 #include "ogldev_math_3d.h"
+#include "SkinnedVertex.h"
+#include "CpuSkinning.h"
+#include "DualQuat.h"
+#include "GeometryPool.h"
+#include "TexturePathResolver.h"
+#include "TextureCache.h"
 #include <d3dx11.h>
 #include "d3dx11Effect.h"
 #include <xnamath.h>
@@ -32,47 +39,6 @@ using namespace ogldev;
 
 #define INVALID_MATERIAL 0xFFFFFFFF
 class Camera;
-struct VertexBoneData
-{
-	float Weights[NUM_BONES_PER_VEREX];
-	float IDs[NUM_BONES_PER_VEREX];
-	VertexBoneData(const VertexBoneData& vbd)
-	{
-		IDs[0] = vbd.IDs[0];
-		IDs[1] = vbd.IDs[1];
-		IDs[2] = vbd.IDs[2];
-		IDs[3] = vbd.IDs[3];
-
-		Weights[0] = vbd.Weights[0];
-		Weights[1] = vbd.Weights[1];
-		Weights[2] = vbd.Weights[2];
-		Weights[3] = vbd.Weights[3];
-	}
-	VertexBoneData()
-	{
-		Reset();
-	};
-	void Reset()
-	{
-		ZERO_MEM(IDs);
-		ZERO_MEM(Weights);
-	}
-	void AddBoneData(float BoneID, float Weight);
-};
-struct SkinnedVertex
-{
-	Vector3f m_pos;
-	Vector2f m_tex;
-	VertexBoneData bonedata;
-	SkinnedVertex() { }
-	SkinnedVertex(const Vector3f& pos, const Vector2f& tex /*const nv::vec3f& normal*/,const VertexBoneData& boneinfo)
-	{
-		m_pos = pos;
-		m_tex = tex;
-		//m_normal = normal;
-		bonedata = boneinfo;
-	}
-};
 struct AnimationFrame
 {
 	float StartIndex;
@@ -86,6 +52,8 @@ public:
 	{
 		Matrix4f BoneOffset;
 		Matrix4f FinalTransformation;
+		DualQuat BoneOffsetDualQuat;
+		DualQuat FinalDualQuat;
 		BoneInfo()
 		{
 			BoneOffset.SetZero();
@@ -107,16 +75,27 @@ public:
 	{
 		SkinnedMeshEntry()
 		{
+			mIndexBufferFormat = DXGI_FORMAT_R32_UINT;
+			mVertexStride = sizeof(SkinnedVertex);
+			BaseVertex = 0;
+			StartIndex = 0;
 			NumIndices = 0;
 			MaterialIndex = INVALID_MATERIAL;
 		}
-		void Init(ID3D11Device* device);
-		ID3D11Buffer* mVB;
-		ID3D11Buffer* mIB;
-		DXGI_FORMAT mIndexBufferFormat; // Always 16-bit
+		DXGI_FORMAT mIndexBufferFormat; // 16-bit unless the entry has more than 65536 vertices
 		UINT mVertexStride;
+		UINT BaseVertex; // offsets of the entry in mVB / mIB
+		UINT StartIndex;
 		std::vector<SkinnedVertex> m_Vertex;
+		std::vector<Vector3f> m_Normals; // bind pose normals for CPU skinning
+		HitboxProxy m_Hitboxes;
+		// staging copy of m_Vertex in the packed layout, released once pooled
+		std::vector<unsigned char> m_PackedVertex;
+		// influences 5 to 8, only kept with SetMaxInfluences(8)
+		std::vector<VertexBoneData> m_ExtraBones;
 		std::vector<unsigned int> m_Indices;
+		// global bone index of each bone index used by the vertices, at most MAX_PALETTE_BONES
+		std::vector<unsigned int> m_Palette;
 		unsigned int NumIndices;
 		unsigned int MaterialIndex;
 	};
@@ -125,9 +104,9 @@ public:
 	{
 		Texture() {};
 		Texture(const std::string& FileName);
-		bool Load(ID3D11Device* device, aiScene* pScene, aiMaterial* material);
+		bool Load(aiScene* pScene, aiMaterial* material, const std::string& ModelFile, TexturePathResolver& Resolver, TextureCache& Cache);
 		std::string m_fileName;
-		ID3D11ShaderResourceView* mDiffuseMapSRV;
+		TextureCache::Handle m_Handle; // NULL for embedded textures
 	};
 
 	unsigned int NumBones() const
@@ -141,10 +120,64 @@ public:
 	XMFLOAT4X4 mWorldMatrix;
 	bool Init(ID3D11Device* d3d11device);
 	bool Update(float dt, const XMFLOAT4X4& world);
+	// Selects the vertex layout of the next load. Meshes the packed layout can't
+	// represent within tolerance (more than 256 bones, UVs beyond +-2) stay float.
+	void SetVertexFormat(SkinnedVertexFormat Format, const PackedVertexLayout& Layout = PackedVertexLayout());
+	// 4 or 8 bone influences per vertex for the next load. The strongest ones are kept and
+	// renormalized, influences 5 to 8 go to a second vertex stream if any vertex has them.
+	// 8 influences always use the float vertex format.
+	void SetMaxInfluences(unsigned int MaxInfluences);
+	// Texture references of the next loads are looked up through Resolver, which must outlive
+	// the mesh. NULL uses DefaultTexturePathResolver().
+	void SetTextureResolver(TexturePathResolver* Resolver)
+	{
+		m_TextureResolver = Resolver;
+	}
+	// Shares the textures with the other meshes using Cache, which must outlive the mesh.
+	// Call before the first load. NULL gives the mesh a cache of its own.
+	void SetTextureCache(TextureCache* Cache)
+	{
+		m_TextureCache = Cache;
+	}
+	TextureCache& GetTextureCache();
 	bool LoadMesh(const std::string& Filename);
+	// Starts loading on a worker of Importer, bone maps and vertices are prepared there as well.
+	bool LoadMeshAsync(Assimp::AsyncImporter& Importer, const std::string& Filename);
+	// Call once per frame from the render thread, creates the D3D resources once the import is done.
+	// Returns true if the mesh is ready to be rendered.
+	bool FinishLoadMesh();
+	void CancelLoadMesh();
+	bool IsLoaded() const
+	{
+		return m_pScene != NULL;
+	}
 	void Render(ID3D11DeviceContext*& md3dImmediateContext);
 	std::vector<Matrix4f> Transforms;
+	std::vector<Matrix4f> m_PaletteTransforms; // Transforms gathered for the drawn entry
+	std::vector<DualQuat> m_PaletteDualQuats; // DualQuatTransforms gathered for the drawn entry
+	// Skins an entry on the CPU with the current Transforms, for hit detection and headless
+	// use. Normals are skinned as well if pNormals is given.
+	void SkinEntry(unsigned int EntryIndex, std::vector<Vector3f>& Positions, std::vector<Vector3f>* pNormals);
+	// Skins only the hitbox proxy of an entry, 8 corners per box in HitboxProxy order
+	void SkinHitboxes(unsigned int EntryIndex, std::vector<Vector3f>& Corners);
+	// Prints vertices per second of the scalar, SIMD and threaded CPU skinning of all
+	// entries and the largest deviation from the scalar version
+	void BenchmarkCpuSkinning(unsigned int Iterations);
 	void BoneTransform(float TimeInSeconds, std::vector<Matrix4f>& Transforms);
+	// Same pose as 32 byte dual quaternions, combined straight from the interpolated rotations
+	// and translations. Empty for a skeleton which scales somewhere, it stays on matrices.
+	void BoneTransformDualQuat(float TimeInSeconds, std::vector<DualQuat>& Transforms);
+	std::vector<DualQuat> DualQuatTransforms;
+	// Renders with DualQuatTransforms instead of Transforms, except with 8 influences or a
+	// skeleton that scales
+	void SetDualQuatSkinning(bool Enable)
+	{
+		m_DualQuatSkinning = Enable;
+	}
+	bool GetDualQuatSkinning() const
+	{
+		return m_DualQuatSkinning;
+	}
 	bool WriteAnimInfo(const char * filename, const aiNodeAnim* animinfo);
 	void CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim);
 	void CalcInterpolatedRotation(aiQuaternion& Out, float AnimationTime, const aiNodeAnim* pNodeAnim);
@@ -154,19 +187,43 @@ public:
 	unsigned int FindPosition(float AnimationTime, const aiNodeAnim* pNodeAnim);
 	const aiNodeAnim* FindNodeAnim(const aiAnimation* pAnimation, const std::string NodeName);
 	void ReadNodeHeirarchy(float AnimationTime, const aiNode* pNode, const Matrix4f& ParentTransform);
+	void ReadNodeHeirarchyDualQuat(float AnimationTime, const aiNode* pNode, const DualQuat& ParentTransform);
+	float GetAnimationTime(float TimeInSeconds);
+	bool IsRigidSkeleton(const aiScene* pScene);
 	bool InitSkinnedMeshFromScene(const aiScene* pScene, const std::string& Filename);
+	void PrepareSkinnedMesh(const aiScene* pScene);
+	bool CreateDeviceResources(const aiScene* pScene, const std::string& Filename);
 	void InitSkinnedMesh(unsigned int MeshIndex,const aiMesh* paiMesh);
-	void LoadBones(unsigned int MeshIndex, const aiMesh* paiMesh, std::vector<VertexBoneData>& Bones);
+	bool PackSkinnedMesh(SkinnedMeshEntry& Entry, const aiMesh* paiMesh);
+	void GatherPalette(const SkinnedMeshEntry& Entry, std::vector<Matrix4f>& Palette) const;
+	void GatherPalette(const SkinnedMeshEntry& Entry, std::vector<DualQuat>& Palette) const;
+	SkinningJob MakeSkinningJob(const SkinnedMeshEntry& Entry, const std::vector<Matrix4f>& Palette) const;
+	void LoadBones(unsigned int MeshIndex, const aiMesh* paiMesh, std::vector<VertexBoneData>& Bones, std::vector<VertexBoneData>* pExtraBones, BoneInfluenceStats& Stats);
 	bool InitMaterials(const aiScene* pScene, const std::string& Filename);
 	void Clear();
 	std::string m_CurrentAction;
 	std::vector<SkinnedMeshEntry> m_Entries;
+	// all entries live in one vertex and one index buffer
+	GeometryPool m_Pool;
+	ID3D11Buffer* mVB;
+	ID3D11Buffer* mIB;
+	bool m_Packed; // m_Pool holds packed vertices
+	// second stream with influences 5 to 8, BaseVertex of the entries applies to it as well
+	GeometryPool m_ExtraPool;
+	ID3D11Buffer* mExtraVB;
+	bool m_ExtraInfluences;
+	unsigned int m_MaxInfluences;
+	BoneInfluenceStats m_InfluenceStats; // of the last load
 	std::vector<Texture*> m_Textures;
+	CpuSkinner m_CpuSkinner;
 	std::map<std::string, unsigned int> m_BoneMapping; // maps a bone name to its index
 	std::map<std::string, AnimationFrame> m_AnimationMaps;//maps a action name to its frame number and count
 	unsigned int m_NumBones;
 	std::vector<BoneInfo> m_BoneInfo;
 	Matrix4f m_GlobalInverseTransform;
+	DualQuat m_GlobalInverseDualQuat;
+	bool m_RigidSkeleton; // no scaling anywhere, dual quaternions can be combined directly
+	bool m_DualQuatSkinning;
 	D3D_PRIMITIVE_TOPOLOGY primitive_type;
 	ID3D11RasterizerState* WireframeRS;
 	ID3DX11Effect* mFX;
@@ -174,12 +231,27 @@ public:
 	ID3DX11EffectMatrixVariable* mfxWorldViewProj;
 	ID3DX11EffectShaderResourceVariable* DiffuseMap;
 	ID3DX11EffectMatrixVariable* BoneTransforms;
+	ID3DX11EffectVectorVariable* BoneDualQuats;
 	ID3D11InputLayout* mInputLayout;
+	SkinnedVertexFormat m_VertexFormat;
+	PackedVertexLayout m_PackedLayout;
+	ID3DX11EffectTechnique* mPackedTech;
+	ID3DX11EffectTechnique* mTech8;
+	ID3DX11EffectTechnique* mDualQuatTech;
+	ID3DX11EffectTechnique* mPackedDualQuatTech;
+	ID3D11InputLayout* mInputLayout8;
+	ID3D11InputLayout* mPackedInputLayout; // created for m_PackedLayout on first use
 	static std::vector<SkinnedMesh*> renderQueue;
 	static void BatchRender(ID3D11DeviceContext*& md3dImmediateContext);
 	Camera* m_Camera;
 	const aiScene* m_pScene;
 	Assimp::Importer m_Importer;
+	Assimp::AsyncImport m_PendingImport;
+	std::string m_PendingFileName;
+	aiScene* m_pOwnedScene; // scene handed over by an async import
+	TexturePathResolver* m_TextureResolver;
+	TextureCache* m_TextureCache;
+	TextureCache* m_pOwnedTextureCache;
 };
 #endif	
 
@@ -41,6 +41,9 @@ float fmax(float a, float b);
 
 #define MAX_BONES  100
 
+// bones one draw may reference, the size of gBoneTransforms in FX/color.fx
+#define MAX_PALETTE_BONES 96
+
 #define INVALID_MATERIAL 0xFFFFFFFF
 //***************************************************************************************
 // d3dUtil.h by Frank Luna (C) 2011 All Rights Reserved.